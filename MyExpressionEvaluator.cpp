@@ -29,13 +29,14 @@
 //////////////////////////////////////////////////////////////////////////////
 
 
-#include "stdafx.h"
+#include "StdAfx.h"
 #include <math.h>
 #include <conio.h>
 #include <iostream>
 
 #include "simpleeditor.h"
 #include "evaluator.h"
+#include "memocache.h"
 #include "variable.h"
 #include "MyExpressionEvaluator.h"
 
@@ -51,6 +52,80 @@ using namespace std;
 #include "testdata.h"
 #endif // TESTMODE
 
+// Define BENCHMODE to run the performance benchmarks in benchmark.cpp
+// instead of the interactive evaluator.
+//#define BENCHMODE
+
+#ifdef BENCHMODE
+#include "benchmark.h"
+#endif // BENCHMODE
+
+// Define GENERATEMODE to generate C++ source from a file of expressions
+// (see codegenerator.h) instead of running the interactive evaluator:
+//   MyExpressionEvaluator <expressions file> <base name of the .h/.cpp>
+// Each line of the file is "Name: expression". Blank lines and lines
+// starting with // are ignored.
+//#define GENERATEMODE
+
+#ifdef GENERATEMODE
+#include <fstream>
+#include "codegenerator.h"
+
+static bool GenerateCode(const char *szInput, const char *szBaseName)
+{
+  ifstream Input(szInput);
+  CCodeGenerator Generator;
+  string sLine;
+  int nLine = 0;
+  bool bOK = true;
+
+  if (!Input)
+  {
+    cout << "Unable to read " << szInput << endl;
+    return false;
+  }
+
+  while (getline(Input, sLine))
+  {
+    size_t Colon = sLine.find(':');
+    size_t First = sLine.find_first_not_of(" \t\r");
+    string sName;
+    string sExpression;
+
+    nLine++;
+    if (First == string::npos || sLine.compare(First, 2, "//") == 0)
+      continue;
+    if (Colon != string::npos)
+    {
+      sName = sLine.substr(First, Colon - First);
+      sName.erase(sName.find_last_not_of(" \t") + 1);
+      sExpression = sLine.substr(Colon+1);
+      sExpression.erase(0, sExpression.find_first_not_of(" \t"));
+      sExpression.erase(sExpression.find_last_not_of(" \t\r") + 1);
+    }
+    if (Colon == string::npos || !Generator.AddFunction(sName.c_str(), sExpression.c_str()))
+    {
+      cout << szInput << "(" << nLine << "): ";
+      if (Colon == string::npos || Generator.GetErrorNumber() == ERR_UNKNOWN)
+        cout << "expected \"Name: expression\", with a unique C++ identifier for the name" << endl;
+      else
+        cout << CEvaluator::GetErrorDescription(Generator.GetErrorNumber()) << endl;
+      bOK = false;
+    }
+  }
+
+  if (!bOK)
+    return false;
+  if (!Generator.WriteFiles(szBaseName))
+  {
+    cout << "Unable to write " << szBaseName << ".h/.cpp" << endl;
+    return false;
+  }
+  cout << Generator.GetNumberOfFunctions() << " functions written to " << szBaseName << ".h/.cpp" << endl;
+  return true;
+}
+#endif // GENERATEMODE
+
 class CConsoleEvaluator : public CEvaluator
 {
   public:
@@ -103,7 +178,7 @@ static void ShowBanner(void)
 static bool RequestExpression(string &sExpression)
 {
   bool rc;
-  CSimpleEditor *pEd = new CSimpleEditor(true, true, "+-*/ .()"); // bAllowNumerics, bAllowAlpha, sAllowOtherCharacters
+  CSimpleEditor *pEd = new CSimpleEditor(true, true, "+-*/ .()<>=!&|"); // bAllowNumerics, bAllowAlpha, sAllowOtherCharacters
 
   if (pEd == NULL)
   {
@@ -160,7 +235,17 @@ int main(int argc, char* argv[])
 
 #ifdef TESTMODE
   TestEvaluator(pEvaluator);
+#elif defined(BENCHMODE)
+  BenchmarkEvaluator();
+#elif defined(GENERATEMODE)
+  if (argc == 3)
+    GenerateCode(argv[1], argv[2]);
+  else
+    cout << "Usage: " << argv[0] << " <expressions file> <base name>" << endl;
 #else // TESTMODE
+  // Users often accept the defaults again, so remember recent results.
+  pEvaluator->EnableMemo(MEMO_DEFAULT_CAPACITY);
+
   if (RequestExpression(*pExpression))
   {
     if (pEvaluator->SetExpression(pExpression->c_str()))
@@ -0,0 +1,340 @@
+// asyncevaluator.cpp :
+// Implementation of the asynchronous evaluator, its fetch tasks and timer queue.
+// Jonathan Gilmore, 19/10/2026
+//
+// A fetch and the coroutine waiting for it may finish and suspend on
+// different threads at the same moment. They settle which of them resumes the
+// waiter with one atomic on the fetch's promise (pWaiter): the waiter stores
+// its address there unless the fetch has already stored FETCH_DONE, and the
+// fetch, on finishing, swaps in FETCH_DONE and resumes whatever it found.
+//
+
+#include "StdAfx.h"
+#include <exception>
+#include <future>
+#include <memory>
+#include "asyncevaluator.h"
+
+using namespace std;
+
+static char FetchDoneMarker;
+#define FETCH_DONE ((void *)&FetchDoneMarker)
+
+////////////////////////////////////////////////////////////////////////////
+// CFetchTask implementation
+////////////////////////////////////////////////////////////////////////////
+CFetchTask::promise_type::promise_type()
+  : pWaiter(NULL)
+{
+  Result.bOK = false;
+  Result.lfValue = 0.0;
+}
+
+CFetchTask CFetchTask::promise_type::get_return_object(void)
+{
+  return CFetchTask(tHANDLE::from_promise(*this));
+}
+
+suspend_never CFetchTask::promise_type::initial_suspend(void) const noexcept
+{
+  return suspend_never();
+}
+
+CFetchTask::CFinalAwaiter CFetchTask::promise_type::final_suspend(void) const noexcept
+{
+  return CFinalAwaiter();
+}
+
+void CFetchTask::promise_type::return_value(const tFETCH &Fetch)
+{
+  Result = Fetch;
+}
+
+void CFetchTask::promise_type::unhandled_exception(void)
+{
+  Result.bOK = false;
+  Result.lfValue = 0.0;
+}
+
+bool CFetchTask::CFinalAwaiter::await_ready(void) const noexcept
+{
+  return false; // The frame stays, for the waiter to read Result and then destroy it
+}
+
+coroutine_handle<> CFetchTask::CFinalAwaiter::await_suspend(tHANDLE Fetch) noexcept
+{
+  void *pWaiter = Fetch.promise().pWaiter.exchange(FETCH_DONE, memory_order_acq_rel);
+
+  if (pWaiter)
+    return coroutine_handle<>::from_address(pWaiter);
+  return noop_coroutine();
+}
+
+void CFetchTask::CFinalAwaiter::await_resume(void) const noexcept
+{
+}
+
+CFetchTask::CFetchTask(tHANDLE Handle)
+  : hFetch(Handle)
+{
+}
+
+CFetchTask::CFetchTask(CFetchTask &&Other) noexcept
+  : hFetch(Other.hFetch)
+{
+  Other.hFetch = NULL;
+}
+
+CFetchTask::~CFetchTask(void)
+{
+  if (hFetch)
+    hFetch.destroy();
+}
+
+CFetchTask::CAwaiter CFetchTask::operator co_await(void) const noexcept
+{
+  CAwaiter Awaiter;
+
+  Awaiter.hFetch = hFetch;
+  return Awaiter;
+}
+
+bool CFetchTask::CAwaiter::await_ready(void) const noexcept
+{
+  return hFetch.promise().pWaiter.load(memory_order_acquire) == FETCH_DONE;
+}
+
+bool CFetchTask::CAwaiter::await_suspend(coroutine_handle<> Waiter) noexcept
+{
+  void *pExpected = NULL;
+
+  // False (carry on without suspending) if the fetch finished meanwhile.
+  // Nothing may be touched after a successful exchange: the waiter may
+  // already be running again on the fetch's thread.
+  return hFetch.promise().pWaiter.compare_exchange_strong(pExpected, Waiter.address(), memory_order_acq_rel);
+}
+
+tFETCH CFetchTask::CAwaiter::await_resume(void) const noexcept
+{
+  return hFetch.promise().Result;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CTimerQueue implementation
+////////////////////////////////////////////////////////////////////////////
+CTimerQueue::CTimerQueue()
+  : bStopping(false)
+{
+  Thread = thread(&CTimerQueue::TimerLoop, this);
+}
+
+CTimerQueue::~CTimerQueue(void)
+{
+  {
+    lock_guard<mutex> Lock(Mutex);
+    bStopping = true;
+  }
+  Changed.notify_one();
+  Thread.join();
+}
+
+CTimerQueue::CSleep CTimerQueue::Sleep(chrono::steady_clock::duration Delay)
+{
+  CSleep Sleep;
+
+  Sleep.pQueue = this;
+  Sleep.Due = chrono::steady_clock::now() + Delay;
+  return Sleep;
+}
+
+bool CTimerQueue::CSleep::await_ready(void) const noexcept
+{
+  return Due <= chrono::steady_clock::now();
+}
+
+void CTimerQueue::CSleep::await_suspend(coroutine_handle<> Sleeper)
+{
+  pQueue->Add(Due, Sleeper);
+}
+
+void CTimerQueue::CSleep::await_resume(void) const noexcept
+{
+}
+
+void CTimerQueue::Add(chrono::steady_clock::time_point Due, coroutine_handle<> Sleeper)
+{
+  bool bSoonest;
+
+  {
+    lock_guard<mutex> Lock(Mutex);
+    bSoonest = qTimer.empty() || Due < qTimer.top().first;
+    qTimer.push(make_pair(Due, Sleeper.address()));
+  }
+  if (bSoonest)
+    Changed.notify_one();
+}
+
+void CTimerQueue::TimerLoop(void)
+{
+  unique_lock<mutex> Lock(Mutex);
+  vector<void *> vDue;
+
+  for (;;)
+  {
+    chrono::steady_clock::time_point Now = chrono::steady_clock::now();
+
+    while (!qTimer.empty() && (bStopping || qTimer.top().first <= Now))
+    {
+      vDue.push_back(qTimer.top().second);
+      qTimer.pop();
+    }
+    if (!vDue.empty())
+    {
+      // Resumed without the lock, since they may well sleep again.
+      Lock.unlock();
+      for (size_t i=0; i<vDue.size(); i++)
+        coroutine_handle<>::from_address(vDue[i]).resume();
+      vDue.clear();
+      Lock.lock();
+      continue;
+    }
+    if (bStopping)
+      break;
+    if (qTimer.empty())
+      Changed.wait(Lock);
+    else
+      Changed.wait_until(Lock, qTimer.top().first);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// tagEVALUATIONTASK
+// The coroutine type of CAsyncEvaluator::Run(): it starts at once and, being
+// waited for by nobody, frees itself when it finishes.
+////////////////////////////////////////////////////////////////////////////
+struct tagEVALUATIONTASK
+{
+  struct promise_type
+  {
+    tagEVALUATIONTASK get_return_object(void) { return tagEVALUATIONTASK(); }
+    suspend_never initial_suspend(void) const noexcept { return suspend_never(); }
+    suspend_never final_suspend(void) const noexcept { return suspend_never(); }
+    void return_void(void) {}
+    void unhandled_exception(void) { terminate(); }
+  };
+};
+
+// Moves the coroutine on to one of the pool's threads
+struct CResumeOn
+{
+  CThreadPool *pPool;
+
+  bool await_ready(void) const noexcept { return false; }
+  void await_suspend(coroutine_handle<> Coroutine) { pPool->Submit([Coroutine]() { Coroutine.resume(); }); }
+  void await_resume(void) const noexcept {}
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CAsyncEvaluator implementation
+////////////////////////////////////////////////////////////////////////////
+CAsyncEvaluator::CAsyncEvaluator(CAsyncProvider &Provider, int nThreads)
+  : pProvider(&Provider), nPending(0), Pool(nThreads)
+{
+}
+
+CAsyncEvaluator::~CAsyncEvaluator(void)
+{
+  Wait();
+}
+
+void CAsyncEvaluator::Submit(const CCompiledExpression &Compiled, tDONE Done)
+{
+  {
+    lock_guard<mutex> Lock(Mutex);
+    nPending++;
+  }
+  Run(Compiled, Done);
+}
+
+tagEVALUATIONTASK CAsyncEvaluator::Run(const CCompiledExpression &Compiled, tDONE Done)
+{
+  int nSlots = Compiled.GetNumberOfVariables();
+  vector<CFetchTask> vFetch;
+  vector<double> vValue(nSlots + 1);
+  tERRNO ErrNo = ERR_OK;
+  double lfResult = 0.0;
+
+  // Every fetch is started before any is waited for, so that they overlap.
+  vFetch.reserve(nSlots);
+  for (int Slot=0; Slot<nSlots; Slot++)
+    vFetch.push_back(pProvider->Fetch(Compiled.GetVariableName(Slot)));
+  for (int Slot=0; Slot<nSlots; Slot++)
+  {
+    tFETCH Fetch = co_await vFetch[Slot];
+
+    if (!Fetch.bOK)
+      ErrNo = ERR_EVALUATION_FAILED;
+    vValue[Slot] = Fetch.lfValue;
+  }
+  vFetch.clear();
+
+  co_await CResumeOn { &Pool };
+  if (ErrNo == ERR_OK)
+    lfResult = Compiled.Evaluate(&vValue[0], &ErrNo);
+  Done(lfResult, ErrNo);
+  Finished();
+}
+
+void CAsyncEvaluator::Finished(void)
+{
+  // Notified under the lock, since once Wait() returns this may be destroyed.
+  lock_guard<mutex> Lock(Mutex);
+  nPending--;
+  if (nPending == 0)
+    AllDone.notify_all();
+}
+
+void CAsyncEvaluator::Wait(void)
+{
+  unique_lock<mutex> Lock(Mutex);
+  while (nPending > 0)
+    AllDone.wait(Lock);
+}
+
+size_t CAsyncEvaluator::GetPending(void)
+{
+  lock_guard<mutex> Lock(Mutex);
+  return nPending;
+}
+
+void CAsyncEvaluator::EvaluateAll(const vector<const CCompiledExpression *> &vpCompiled,
+                                  vector<double> &vResult, vector<tERRNO> &vErrNo)
+{
+  vResult.assign(vpCompiled.size(), 0.0);
+  vErrNo.assign(vpCompiled.size(), ERR_OK);
+  for (size_t i=0; i<vpCompiled.size(); i++)
+  {
+    double *pResult = &vResult[i];
+    tERRNO *pErrNo = &vErrNo[i];
+
+    Submit(*vpCompiled[i], [pResult, pErrNo](double lfResult, tERRNO ErrNo)
+    {
+      *pResult = lfResult;
+      *pErrNo = ErrNo;
+    });
+  }
+  Wait();
+}
+
+double CAsyncEvaluator::Evaluate(const CCompiledExpression &Compiled, tERRNO *pErrNo)
+{
+  // Shared, since the callback may still be in set_value() when get() returns
+  shared_ptr<promise<pair<double, tERRNO> > > pResult(new promise<pair<double, tERRNO> >);
+  future<pair<double, tERRNO> > Future = pResult->get_future();
+
+  Submit(Compiled, [pResult](double lfResult, tERRNO ErrNo) { pResult->set_value(make_pair(lfResult, ErrNo)); });
+  pair<double, tERRNO> Value = Future.get();
+  if (pErrNo)
+    *pErrNo = Value.second;
+  return Value.first;
+}
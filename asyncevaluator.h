@@ -0,0 +1,211 @@
+// asyncevaluator.h :
+// Interface/Include file for asyncevaluator.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CAsyncEvaluator Class
+// Evaluates compiled expressions whose variables come from a slow source
+// (a cache, a file, another process), without a thread waiting on each value.
+//
+// CEvaluator::InitialiseVariables() asks for one variable at a time and blocks
+// until it has it, so an expression with five variables waits for five
+// fetches one after another. Here a CAsyncProvider instead gives each value as
+// a C++20 coroutine (CFetchTask). All of an expression's fetches are started
+// before any is waited for, and an evaluation waiting for its values holds no
+// thread, so any number of evaluations can have fetches outstanding at once.
+// Once it has its values, an evaluation moves to a small thread pool (the
+// executor) to be evaluated, and its callback is called there.
+//
+// A provider's Fetch() is a coroutine returning CFetchTask. It may give the
+// value at once (a cache hit) with co_return, without ever suspending, or
+// co_await something first, e.g. CTimerQueue::Sleep() or an awaitable of its
+// own for an asynchronous read. Fetch() may be called from any thread, and
+// several calls may be under way at once.
+//
+//   class CCacheProvider : public CAsyncProvider
+//   {
+//     CFetchTask Fetch(char VariableName)
+//     {
+//       co_await ReadCache(VariableName);        // However the source is read
+//       co_return tFETCH { true, lfValue };
+//     }
+//   };
+//
+//   CAsyncEvaluator Async(Provider);
+//   Async.Submit(Compiled, [](double lfResult, tERRNO ErrNo) { ... });
+//   Async.Wait();
+//
+// A fetch which fails (bOK false) makes its evaluation fail with
+// ERR_EVALUATION_FAILED, as a cancelled InitialiseVariable() does.
+//
+// Needs C++20 (/std:c++20, or -std=c++20 with g++ 10 or later).
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(ASYNCEVALUATOR_H_INCLUDED_)
+#define ASYNCEVALUATOR_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "compiledexpression.h"
+#include "threadpool.h"
+
+#define ASYNC_DEFAULT_THREADS 2
+
+typedef struct tagFETCH
+{
+  bool bOK;                    // false if the value could not be had
+  double lfValue;
+} tFETCH;
+
+////////////////////////////////////////////////////////////////////////////
+// CFetchTask
+// What a provider's Fetch() coroutine returns. It starts running at once, and
+// may finish on any thread; co_await gives its tFETCH, once, without blocking.
+////////////////////////////////////////////////////////////////////////////
+class CFetchTask
+{
+  public:
+    struct promise_type;
+    typedef std::coroutine_handle<promise_type> tHANDLE;
+
+    struct CFinalAwaiter
+    {
+      bool await_ready(void) const noexcept;
+      std::coroutine_handle<> await_suspend(tHANDLE Fetch) noexcept;   // Resumes whoever is waiting
+      void await_resume(void) const noexcept;
+    };
+
+    struct promise_type
+    {
+      tFETCH Result;
+      std::atomic<void *> pWaiter;           // The coroutine waiting for Result, or FETCH_DONE
+
+      promise_type();
+      CFetchTask get_return_object(void);
+      std::suspend_never initial_suspend(void) const noexcept;
+      CFinalAwaiter final_suspend(void) const noexcept;
+      void return_value(const tFETCH &Fetch);
+      void unhandled_exception(void);        // The fetch fails
+    };
+
+    struct CAwaiter
+    {
+      tHANDLE hFetch;
+
+      bool await_ready(void) const noexcept;
+      bool await_suspend(std::coroutine_handle<> Waiter) noexcept;
+      tFETCH await_resume(void) const noexcept;
+    };
+
+    CFetchTask(CFetchTask &&Other) noexcept;
+    ~CFetchTask();                           // Only once it has finished, e.g. after co_await
+
+    CAwaiter operator co_await(void) const noexcept;
+
+  private:
+    explicit CFetchTask(tHANDLE Handle);
+    CFetchTask(const CFetchTask &);
+    CFetchTask &operator=(const CFetchTask &);
+
+    tHANDLE hFetch;
+};
+
+class CAsyncProvider
+{
+  public:
+    virtual ~CAsyncProvider() {}
+    virtual CFetchTask Fetch(char VariableName) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CTimerQueue
+// One thread, which resumes coroutines when their time comes, for providers
+// which wait (to retry, or to simulate latency) without holding a thread.
+// Coroutines still sleeping when it is destroyed are resumed early.
+////////////////////////////////////////////////////////////////////////////
+class CTimerQueue
+{
+  public:
+    struct CSleep
+    {
+      CTimerQueue *pQueue;
+      std::chrono::steady_clock::time_point Due;
+
+      bool await_ready(void) const noexcept;
+      void await_suspend(std::coroutine_handle<> Sleeper);
+      void await_resume(void) const noexcept;
+    };
+
+    CTimerQueue();
+    ~CTimerQueue();
+
+    CSleep Sleep(std::chrono::steady_clock::duration Delay);   // co_await resumes on the timer thread
+
+  private:
+    typedef std::pair<std::chrono::steady_clock::time_point, void *> tTIMER;   // Due, coroutine address
+
+    CTimerQueue(const CTimerQueue &);
+    CTimerQueue &operator=(const CTimerQueue &);
+
+    void Add(std::chrono::steady_clock::time_point Due, std::coroutine_handle<> Sleeper);
+    void TimerLoop(void);
+
+    std::priority_queue<tTIMER, std::vector<tTIMER>, std::greater<tTIMER> > qTimer;   // Soonest first
+    std::mutex Mutex;
+    std::condition_variable Changed;
+    bool bStopping;
+    std::thread Thread;
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CAsyncEvaluator
+////////////////////////////////////////////////////////////////////////////
+struct tagEVALUATIONTASK;
+
+class CAsyncEvaluator
+{
+  public:
+    typedef std::function<void(double lfResult, tERRNO ErrNo)> tDONE;
+
+    CAsyncEvaluator(CAsyncProvider &Provider, int nThreads = ASYNC_DEFAULT_THREADS);
+    ~CAsyncEvaluator();                      // Waits for every evaluation submitted
+
+    // Starts an evaluation, and returns without waiting for it. Done is called
+    // on one of the executor's threads. Compiled must last until then.
+    void Submit(const CCompiledExpression &Compiled, tDONE Done);
+    void Wait(void);                         // Until every evaluation submitted has been done
+
+    // Evaluates each of vpCompiled, all at once, and waits for them all.
+    void EvaluateAll(const std::vector<const CCompiledExpression *> &vpCompiled,
+                     std::vector<double> &vResult, std::vector<tERRNO> &vErrNo);
+    // One evaluation, waiting for it. Not from within a provider or a callback.
+    double Evaluate(const CCompiledExpression &Compiled, tERRNO *pErrNo = NULL);
+
+    size_t GetPending(void);                 // Submitted, and not yet done
+
+  private:
+    CAsyncEvaluator(const CAsyncEvaluator &);
+    CAsyncEvaluator &operator=(const CAsyncEvaluator &);
+
+    tagEVALUATIONTASK Run(const CCompiledExpression &Compiled, tDONE Done);
+    void Finished(void);
+
+    CAsyncProvider *pProvider;
+    std::mutex Mutex;
+    std::condition_variable AllDone;
+    size_t nPending;
+    CThreadPool Pool;                        // Last, so that it is stopped first
+};
+
+#endif // !defined(ASYNCEVALUATOR_H_INCLUDED_)
@@ -0,0 +1,1576 @@
+// benchmark.cpp : Performance benchmarks for MyExpressionEvaluator.
+// Jonathan Gilmore, 19/10/2026
+
+#include "StdAfx.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "evaluator.h"
+#include "compiledexpression.h"
+#include "expressionhandle.h"
+#include "expressionpack.h"
+#include "memocache.h"
+#include "perfcounters.h"
+#include "streamevaluator.h"
+#include "threadpool.h"
+#include "asyncevaluator.h"
+#include "testformulas.h"
+#include "benchmark.h"
+
+using namespace std;
+
+// Results are accumulated here so that the optimiser cannot discard the work.
+static volatile double lfSink;
+
+static double SecondsSince(chrono::steady_clock::time_point Start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+}
+
+static char VariableNameForSlot(int i)
+{
+  return (char)((i < 26) ? 'a' + i : 'A' + (i - 26));
+}
+
+// Builds e.g. "a+b+c+...", cycling through all 52 variable names.
+static string LongChain(int nTerms, char cOperator)
+{
+  string s;
+
+  for (int i=0; i<nTerms; i++)
+  {
+    if (i > 0)
+      s += cOperator;
+    s += VariableNameForSlot(i % 52);
+  }
+  return s;
+}
+
+// A pseudo-random formula of roughly nTerms terms, with nested braces,
+// in the style of a rule base entry. uRandom is the generator state.
+static string RandomFormula(unsigned int &uRandom, int nTerms)
+{
+  static const char Operators[] = "+-*/";
+  string s;
+  int Depth = 0;
+
+  for (int i=0; i<nTerms; i++)
+  {
+    uRandom = uRandom * 1103515245 + 12345;
+    unsigned int r = uRandom >> 8;
+
+    if (i > 0)
+      s += Operators[r % 4];
+    if (r % 5 == 0 && i < nTerms-2)
+    {
+      s += '(';
+      Depth++;
+    }
+    if (r % 3 == 0)
+      s += VariableNameForSlot((r >> 4) % 52);
+    else
+      s += to_string((r >> 4) % 1000 + 1) + ".5";
+    if (Depth > 0 && r % 7 == 0)
+    {
+      s += ')';
+      Depth--;
+    }
+  }
+  while (Depth-- > 0)
+    s += ')';
+  return s;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CBenchmarkEvaluator
+// Supplies variable values from a fixed table, indexed by variable name.
+////////////////////////////////////////////////////////////////////////////
+class CBenchmarkEvaluator : public CEvaluator
+{
+  public:
+    double aValue[128];
+    bool InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet)
+    {
+      ValueRet = aValue[(unsigned char)VariableName];
+      return true;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CLatencyEvaluator and CLatencyProvider
+// Supply variable values from a fixed table after a fixed latency: the one
+// blocking its thread for each value, the other without a thread waiting.
+////////////////////////////////////////////////////////////////////////////
+class CLatencyEvaluator : public CBenchmarkEvaluator
+{
+  public:
+    chrono::microseconds Latency;
+    bool InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet)
+    {
+      this_thread::sleep_for(Latency);
+      return CBenchmarkEvaluator::InitialiseVariable(VariableName, DefaultValue, ValueRet);
+    }
+};
+
+class CLatencyProvider : public CAsyncProvider
+{
+  public:
+    CLatencyProvider(CTimerQueue &Timer) : pTimer(&Timer) {}
+
+    double aValue[128];
+    chrono::microseconds Latency;
+    CFetchTask Fetch(char VariableName)
+    {
+      co_await pTimer->Sleep(Latency);
+      co_return tFETCH { true, aValue[(unsigned char)VariableName] };
+    }
+
+    CTimerQueue *pTimer;
+};
+
+////////////////////////////////////////////////////////////////////////////
+// Tree-height reduction
+// Long + and * chains, interpreted, compiled as written and compiled with
+// COMPILE_REASSOCIATE.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkReassociation(void)
+{
+  static const int TermCounts[] = { 8, 32, 128, 512, 2048 };
+  const int nTotalTerms = 2000000; // Roughly the same work for each chain length
+
+  cout << "Tree-height reduction (ns per evaluation)" << endl;
+  cout << "  op  terms   interpreted    compiled  reassociated  speedup  height" << endl;
+
+  for (int Op=0; Op<2; Op++)
+  {
+    char cOperator = Op ? '*' : '+';
+
+    for (size_t t=0; t<sizeof(TermCounts)/sizeof(TermCounts[0]); t++)
+    {
+      int nTerms = TermCounts[t];
+      int nEvaluations = nTotalTerms / nTerms;
+      string sExpression = LongChain(nTerms, cOperator);
+      CBenchmarkEvaluator Interpreter;
+      CCompiledExpression Serial;
+      CCompiledExpression Balanced;
+      vector<double> vValue;
+      double lfSum = 0.0;
+
+      Serial.Compile(sExpression.c_str());
+      Balanced.Compile(sExpression.c_str(), COMPILE_REASSOCIATE);
+
+      // Values close to 1 keep long products finite.
+      for (int i=0; i<Serial.GetNumberOfVariables(); i++)
+      {
+        double lfValue = 1.0 + (i % 7) * 1e-4;
+        vValue.push_back(lfValue);
+        Interpreter.aValue[(unsigned char)Serial.GetVariableName(i)] = lfValue;
+      }
+
+      Interpreter.SetExpression(sExpression.c_str());
+      Interpreter.InitialiseVariables();
+      int nInterpreted = (nEvaluations / 20 > 0) ? nEvaluations / 20 : 1; // The interpreter is much slower
+      chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+      for (int i=0; i<nInterpreted; i++)
+        lfSum += Interpreter.EvaluateExpression();
+      double lfInterpreted = SecondsSince(Start) * 1e9 / nInterpreted;
+
+      Start = chrono::steady_clock::now();
+      for (int i=0; i<nEvaluations; i++)
+        lfSum += Serial.Evaluate(&vValue[0]);
+      double lfSerial = SecondsSince(Start) * 1e9 / nEvaluations;
+
+      Start = chrono::steady_clock::now();
+      for (int i=0; i<nEvaluations; i++)
+        lfSum += Balanced.Evaluate(&vValue[0]);
+      double lfBalanced = SecondsSince(Start) * 1e9 / nEvaluations;
+
+      lfSink = lfSink + lfSum;
+
+      printf("  %c  %6d  %12.1f  %10.1f  %12.1f  %6.2fx  %3d -> %d\n",
+             cOperator, nTerms, lfInterpreted, lfSerial, lfBalanced,
+             lfSerial / lfBalanced, Serial.GetHeight(), Balanced.GetHeight());
+    }
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Memoization
+// The same expression over value tuples drawn from a given number of
+// categories per variable, with and without a memo cache. Few categories
+// means mostly hits; "unique" means every tuple is new (all misses), which
+// shows the cost of the cache when it does not help.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkMemo(void)
+{
+  static const int Categories[] = { 2, 4, 8, 16, 0 }; // 0 = every tuple unique
+  const char *szExpression = "(a + 10) * 50 / ((b - 6) * 9) + c * (d - e) / (c + 2.5) - a * b * c";
+  const int nTuples = 200000;
+  const int nInterpreted = 20000;
+
+  cout << "Memoization (ns per evaluation), 5 variables" << endl;
+  cout << "  categories  compiled  +memo  interpreted  +memo  hit rate" << endl;
+
+  for (size_t c=0; c<sizeof(Categories)/sizeof(Categories[0]); c++)
+  {
+    CCompiledExpression Plain;
+    CCompiledExpression Memo;
+    CBenchmarkEvaluator Interpreter;
+    vector<double> vValue;
+    unsigned int uRandom = 12345;
+    double lfSum = 0.0;
+
+    Plain.Compile(szExpression);
+    Memo.Compile(szExpression);
+    Memo.EnableMemo(MEMO_DEFAULT_CAPACITY);
+
+    int nVariables = Plain.GetNumberOfVariables();
+    vValue.resize((size_t)nTuples * nVariables);
+    for (size_t i=0; i<vValue.size(); i++)
+    {
+      uRandom = uRandom * 1103515245 + 12345;
+      if (Categories[c])
+        vValue[i] = 7.0 + (uRandom >> 16) % Categories[c];
+      else
+        vValue[i] = 7.0 + (uRandom >> 8) * 1e-6;
+    }
+
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    for (int i=0; i<nTuples; i++)
+      lfSum += Plain.Evaluate(&vValue[(size_t)i * nVariables]);
+    double lfPlain = SecondsSince(Start) * 1e9 / nTuples;
+
+    Start = chrono::steady_clock::now();
+    for (int i=0; i<nTuples; i++)
+      lfSum += Memo.Evaluate(&vValue[(size_t)i * nVariables]);
+    double lfMemo = SecondsSince(Start) * 1e9 / nTuples;
+    double lfHitRate = Memo.GetMemo()->GetHitRate();
+
+    // The interpreter, as the interactive loop uses it
+    double alfInterpreted[2];
+    for (int bMemo=0; bMemo<2; bMemo++)
+    {
+      if (bMemo)
+        Interpreter.EnableMemo(MEMO_DEFAULT_CAPACITY);
+      Interpreter.SetExpression(szExpression);
+      Start = chrono::steady_clock::now();
+      for (int i=0; i<nInterpreted; i++)
+      {
+        for (int v=0; v<nVariables; v++)
+          Interpreter.aValue[(unsigned char)Plain.GetVariableName(v)] = vValue[(size_t)i * nVariables + v];
+        Interpreter.InitialiseVariables();
+        lfSum += Interpreter.EvaluateExpression();
+      }
+      alfInterpreted[bMemo] = SecondsSince(Start) * 1e9 / nInterpreted;
+    }
+
+    lfSink = lfSink + lfSum;
+
+    if (Categories[c])
+      printf("  %10d", Categories[c]);
+    else
+      printf("  %10s", "unique");
+    printf("  %8.1f  %5.1f  %11.1f  %5.1f  %7.1f%%\n",
+           lfPlain, lfMemo, alfInterpreted[0], alfInterpreted[1], lfHitRate * 100.0);
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Specialisation
+// An expression with per tenant parameters (p..w) bound, varying x, y, u and v.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkSpecialise(void)
+{
+  const char *szExpression = "(p*x + q*y + r) / (s + t*u) * (v - w/2) + p*q*r/(s+1) - (t*w - q)*(p + r)";
+  const char *szBound = "pqrstw";
+  const int nEvaluations = 500000;
+  CCompiledExpression Original;
+  CCompiledExpression Residual;
+  vector<CVariable> vBinding;
+  vector<double> vValue;
+  vector<double> vResidualValue;
+  double lfSum = 0.0;
+
+  Original.Compile(szExpression);
+  for (const char *p=szBound; *p; p++)
+  {
+    double lfValue = 1.5 + (*p - 'p') * 0.25;
+    vBinding.push_back(CVariable(*p));
+    vBinding.back().SetValue(lfValue);
+  }
+  Original.Specialise(vBinding, Residual);
+
+  // The bound values in the original's slots, the others varied below
+  vValue.resize(Original.GetNumberOfVariables());
+  for (size_t i=0; i<vBinding.size(); i++)
+    vValue[Original.GetVariableSlot(vBinding[i].GetName())] = vBinding[i].GetValue();
+  vResidualValue.resize(Residual.GetNumberOfVariables());
+
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  for (int i=0; i<nEvaluations; i++)
+  {
+    for (int r=0; r<Residual.GetNumberOfVariables(); r++)
+      vValue[Original.GetVariableSlot(Residual.GetVariableName(r))] = i + r;
+    lfSum += Original.Evaluate(&vValue[0]);
+  }
+  double lfOriginal = SecondsSince(Start) * 1e9 / nEvaluations;
+
+  Start = chrono::steady_clock::now();
+  for (int i=0; i<nEvaluations; i++)
+  {
+    for (int r=0; r<Residual.GetNumberOfVariables(); r++)
+      vResidualValue[r] = i + r;
+    lfSum += Residual.Evaluate(&vResidualValue[0]);
+  }
+  double lfResidual = SecondsSince(Start) * 1e9 / nEvaluations;
+
+  lfSink = lfSink + lfSum;
+
+  cout << "Specialisation (ns per evaluation), " << vBinding.size() << " of "
+       << Original.GetNumberOfVariables() << " variables bound" << endl;
+  printf("  original  %6.1f  (%d nodes)\n", lfOriginal, Original.GetNumberOfNodes());
+  printf("  residual  %6.1f  (%d nodes)  %.2fx\n", lfResidual, Residual.GetNumberOfNodes(), lfOriginal / lfResidual);
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Bulk compilation
+// A rule base of random formulas, compiled one by one on one thread, and
+// by CCompiledExpression::CompileAll() with increasing numbers of threads.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkCompileAll(void)
+{
+  const int nFormulas = 200000;
+  vector<string> vFormula;
+  vector<CCompiledExpression> vCompiled;
+  vector<tERRNO> vErrNo;
+  unsigned int uRandom = 4321;
+  int nCores = CThreadPool::GetDefaultNumberOfThreads();
+
+  for (int i=0; i<nFormulas; i++)
+    vFormula.push_back(RandomFormula(uRandom, 4 + i % 17));
+
+  cout << "Bulk compilation of " << nFormulas << " formulas (" << nCores << " cores)" << endl;
+
+  // Kept, as a rule base would be
+  vCompiled.resize(nFormulas);
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  for (int i=0; i<nFormulas; i++)
+    vCompiled[i].Compile(vFormula[i].c_str());
+  double lfSerial = SecondsSince(Start);
+  printf("  one by one       %8.0f formulas/s\n", nFormulas / lfSerial);
+
+  for (int nThreads=1; ; nThreads*=2)
+  {
+    if (nThreads > nCores)
+      nThreads = nCores;
+
+    vCompiled.clear();
+    Start = chrono::steady_clock::now();
+    CCompiledExpression::CompileAll(vFormula, vCompiled, vErrNo, COMPILE_DEFAULT, nThreads);
+    double lfSeconds = SecondsSince(Start);
+
+    printf("  %2d thread(s)     %8.0f formulas/s  %5.2fx\n", nThreads, nFormulas / lfSeconds, lfSerial / lfSeconds);
+    if (nThreads >= nCores)
+      break;
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Fused reduction
+// Sum/min/max/mean/variance of an expression over a batch of rows: storing
+// every result and reducing afterwards, against Aggregate().
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkAggregate(void)
+{
+  const size_t nRows = 4000000;
+  const char *szExpression = "(a + 10) * 50 / ((b - 6) * 9) + c * a";
+  CCompiledExpression Compiled;
+  vector<vector<double> > vColumn;
+  vector<const double *> vColumnPointer;
+  vector<double> vRow;
+  tAGGREGATE Result;
+  double lfSum = 0.0;
+
+  Compiled.Compile(szExpression);
+  vColumn.resize(Compiled.GetNumberOfVariables());
+  for (size_t v=0; v<vColumn.size(); v++)
+  {
+    vColumn[v].resize(nRows);
+    for (size_t i=0; i<nRows; i++)
+      vColumn[v][i] = (double)((i * (v + 3)) % 1000) * 0.01;
+    vColumnPointer.push_back(&vColumn[v][0]);
+  }
+  vRow.resize(vColumn.size());
+
+  cout << "Reduction over " << nRows << " rows (ns per row)" << endl;
+
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  {
+    vector<double> vResult(nRows);
+    vector<bool> vError(nRows);
+    tERRNO ErrNo;
+
+    for (size_t i=0; i<nRows; i++)
+    {
+      for (size_t v=0; v<vColumn.size(); v++)
+        vRow[v] = vColumn[v][i];
+      vResult[i] = Compiled.Evaluate(&vRow[0], &ErrNo);
+      vError[i] = (ErrNo != ERR_OK);
+    }
+    double lfMean = 0.0;
+    double lfM2 = 0.0;
+    double n = 0.0;
+    for (size_t i=0; i<nRows; i++)
+    {
+      if (!vError[i])
+      {
+        n++;
+        double lfDelta = vResult[i] - lfMean;
+        lfMean += lfDelta / n;
+        lfM2 += lfDelta * (vResult[i] - lfMean);
+      }
+    }
+    lfSum += lfMean + lfM2;
+  }
+  double lfMaterialised = SecondsSince(Start) * 1e9 / nRows;
+  printf("  store then reduce  %6.1f  (%.0f MB of results)\n", lfMaterialised, nRows * sizeof(double) / 1e6);
+
+  int nCores = CThreadPool::GetDefaultNumberOfThreads();
+  for (int nThreads=1; ; nThreads*=2)
+  {
+    if (nThreads > nCores)
+      nThreads = nCores;
+    Start = chrono::steady_clock::now();
+    Compiled.Aggregate(&vColumnPointer[0], nRows, Result, nThreads);
+    double lfFused = SecondsSince(Start) * 1e9 / nRows;
+    lfSum += Result.lfMean;
+    printf("  Aggregate, %2d thread(s)  %6.1f  %5.2fx\n", nThreads, lfFused, lfMaterialised / lfFused);
+    if (nThreads >= nCores)
+      break;
+  }
+  lfSink = lfSink + lfSum;
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Filtering
+// The mean of a - b over the rows where a*2 > b+10 (about 1 row in 10):
+// evaluating a*2 - (b+10) for every row and comparing in our own loop, as
+// callers had to before there were comparison operators, against Filter()
+// followed by Aggregate() of just the selected rows.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkFilter(void)
+{
+  const size_t nRows = 2000000;
+  CCompiledExpression Difference;
+  CCompiledExpression Predicate;
+  CCompiledExpression Value;
+  vector<double> vA(nRows);
+  vector<double> vB(nRows);
+  const double *ppColumns[2];
+  vector<unsigned int> vSelected;
+  tAGGREGATE Result;
+  unsigned int uRandom = 99;
+  double lfSum = 0.0;
+
+  Difference.Compile("a*2 - (b+10)");
+  Predicate.Compile("a*2 > b+10");
+  Value.Compile("a - b");
+  for (size_t i=0; i<nRows; i++)
+  {
+    uRandom = uRandom * 1103515245 + 12345;
+    vA[i] = (uRandom >> 16) % 100;
+    uRandom = uRandom * 1103515245 + 12345;
+    vB[i] = (uRandom >> 16) % 1000;
+  }
+  ppColumns[0] = &vA[0];
+  ppColumns[1] = &vB[0];
+
+  cout << "Filtering " << nRows << " rows (ns per row)" << endl;
+
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  {
+    vector<double> vDifference(nRows);
+    double aRow[2];
+    double n = 0.0;
+    double lfMean = 0.0;
+
+    Difference.EvaluateBatch(ppColumns, nRows, &vDifference[0]);
+    for (size_t i=0; i<nRows; i++)
+    {
+      if (vDifference[i] > 0.0)
+      {
+        aRow[0] = vA[i];
+        aRow[1] = vB[i];
+        n++;
+        lfMean += (Value.Evaluate(aRow) - lfMean) / n;
+      }
+    }
+    lfSum += lfMean;
+  }
+  double lfOwnLoop = SecondsSince(Start) * 1e9 / nRows;
+
+  Start = chrono::steady_clock::now();
+  Predicate.Filter(ppColumns, nRows, vSelected);
+  Value.Aggregate(ppColumns, nRows, Result, 1, &vSelected[0], vSelected.size());
+  double lfFiltered = SecondsSince(Start) * 1e9 / nRows;
+  lfSum += Result.lfMean;
+  lfSink = lfSink + lfSum;
+
+  printf("  own compare loop      %6.1f\n", lfOwnLoop);
+  printf("  Filter + Aggregate    %6.1f  %5.2fx  (%.1f%% selected)\n",
+         lfFiltered, lfOwnLoop / lfFiltered, 100.0 * vSelected.size() / nRows);
+  cout << endl;
+}
+
+// Loads a rule set from pResource (NULL for the default), then unloads it.
+static void LoadAndUnload(const vector<string> &vFormula, pmr::memory_resource *pResource,
+                          double &lfLoadSeconds, double &lfUnloadSeconds)
+{
+  vector<CCompiledExpression> *pvCompiled = new vector<CCompiledExpression>;
+  vector<tERRNO> vErrNo;
+
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  CCompiledExpression::CompileAll(vFormula, *pvCompiled, vErrNo, COMPILE_DEFAULT, 1, pResource);
+  lfLoadSeconds = SecondsSince(Start);
+
+  Start = chrono::steady_clock::now();
+  delete pvCompiled;
+  lfUnloadSeconds = SecondsSince(Start);
+}
+
+static void BenchmarkAllocator(void)
+{
+  const int nFormulas = 200000;
+  vector<string> vFormula;
+  unsigned int uRandom = 8765;
+  double lfLoad;
+  double lfUnload;
+  double lfArenaLoad;
+  double lfArenaUnload;
+
+  for (int i=0; i<nFormulas; i++)
+    vFormula.push_back(RandomFormula(uRandom, 4 + i % 17));
+
+  cout << "Loading and unloading " << nFormulas << " formulas (one thread)" << endl;
+
+  LoadAndUnload(vFormula, NULL, lfLoad, lfUnload);
+
+  // The arena itself is released with the rule set, so that is part of unloading.
+  pmr::monotonic_buffer_resource *pArena = new pmr::monotonic_buffer_resource;
+  LoadAndUnload(vFormula, pArena, lfArenaLoad, lfArenaUnload);
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  delete pArena;
+  lfArenaUnload += SecondsSince(Start);
+
+  printf("  default          load %7.1f ms  unload %7.1f ms\n", lfLoad * 1000.0, lfUnload * 1000.0);
+  printf("  arena            load %7.1f ms  unload %7.1f ms  %5.2fx  %5.2fx\n",
+         lfArenaLoad * 1000.0, lfArenaUnload * 1000.0, lfLoad / lfArenaLoad, lfUnload / lfArenaUnload);
+  cout << endl;
+}
+
+static void BenchmarkHotSwap(void)
+{
+  const char *szExpression = "a*b + c*d - e/f + a*c*e";
+  const int nEvaluations = 2000000;
+  CCompiledExpression Compiled;
+  CExpressionHandle Handle;
+  atomic<bool> bStop(false);
+  double aValues[6] = { 1.5, 2.5, 3.5, 4.5, 5.5, 6.5 };
+  double lfSum = 0.0;
+  int nPublished = 0;
+
+  Compiled.Compile(szExpression);
+  Handle.Publish(szExpression);
+  int iReader = Handle.RegisterReader();
+
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  for (int i=0; i<nEvaluations; i++)
+  {
+    aValues[0] = i;
+    lfSum += Compiled.Evaluate(aValues);
+  }
+  double lfDirect = SecondsSince(Start) * 1e9 / nEvaluations;
+
+  Start = chrono::steady_clock::now();
+  for (int i=0; i<nEvaluations; i++)
+  {
+    CExpressionHandle::CReadGuard Guard(Handle, iReader);
+
+    aValues[0] = i;
+    lfSum += Guard.Get()->Evaluate(aValues);
+  }
+  double lfHandle = SecondsSince(Start) * 1e9 / nEvaluations;
+
+  // Again, with a writer publishing new versions as fast as it can
+  thread Writer([&]()
+  {
+    while (!bStop)
+    {
+      Handle.Publish(szExpression);
+      nPublished++;
+    }
+  });
+  Start = chrono::steady_clock::now();
+  for (int i=0; i<nEvaluations; i++)
+  {
+    CExpressionHandle::CReadGuard Guard(Handle, iReader);
+
+    aValues[0] = i;
+    lfSum += Guard.Get()->Evaluate(aValues);
+  }
+  double lfSwapping = SecondsSince(Start) * 1e9 / nEvaluations;
+  bStop = true;
+  Writer.join();
+  Handle.UnregisterReader(iReader);
+
+  lfSink = lfSink + lfSum;
+
+  cout << "Hot swappable expression (ns per evaluation)" << endl;
+  printf("  compiled, direct      %6.1f\n", lfDirect);
+  printf("  through the handle    %6.1f\n", lfHandle);
+  printf("  while publishing      %6.1f  (%d versions published)\n", lfSwapping, nPublished);
+  cout << endl;
+}
+
+static void BenchmarkGenerated(void)
+{
+  const int nEvaluations = 20000;
+  const int nRows = 1000000;
+
+  cout << "Generated code (ns per evaluation)" << endl;
+  cout << "  formula   interpreted  compiled  generated  compiled batch  generated batch" << endl;
+
+  for (int f=0; testformulasFunctions[f].szName != NULL; f++)
+  {
+    const tGENERATEDFUNCTION &Function = testformulasFunctions[f];
+    int nVariables = (int)strlen(Function.szVariables);
+    CBenchmarkEvaluator Interpreter;
+    CCompiledExpression Compiled;
+    vector<vector<double> > vvColumn(nVariables, vector<double>(nRows));
+    vector<const double *> vpColumn(nVariables + 1);
+    vector<double> vResult(nRows);
+    double aValues[52];
+    double lfSum = 0.0;
+
+    // Only the formulas with variables; the others are constants.
+    if (nVariables == 0)
+      continue;
+
+    for (int i=0; i<nVariables; i++)
+    {
+      for (int r=0; r<nRows; r++)
+        vvColumn[i][r] = 1.5 + (r * (i + 3)) % 17;
+      vpColumn[i] = &vvColumn[i][0];
+      aValues[i] = vvColumn[i][0];
+      Interpreter.aValue[(unsigned char)Function.szVariables[i]] = aValues[i];
+    }
+    Compiled.Compile(Function.szExpression);
+    Interpreter.SetExpression(Function.szExpression);
+    Interpreter.InitialiseVariables();
+
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    for (int i=0; i<nEvaluations; i++)
+      lfSum += Interpreter.EvaluateExpression();
+    double lfInterpreted = SecondsSince(Start) * 1e9 / nEvaluations;
+
+    Start = chrono::steady_clock::now();
+    for (int r=0; r<nRows; r++)
+    {
+      aValues[0] = vvColumn[0][r];
+      lfSum += Compiled.Evaluate(aValues);
+    }
+    double lfCompiled = SecondsSince(Start) * 1e9 / nRows;
+
+    Start = chrono::steady_clock::now();
+    for (int r=0; r<nRows; r++)
+    {
+      aValues[0] = vvColumn[0][r];
+      lfSum += Function.pScalar(aValues, NULL);
+    }
+    double lfGenerated = SecondsSince(Start) * 1e9 / nRows;
+
+    Start = chrono::steady_clock::now();
+    Compiled.EvaluateBatch(&vpColumn[0], nRows, &vResult[0]);
+    double lfCompiledBatch = SecondsSince(Start) * 1e9 / nRows;
+    lfSum += vResult[nRows-1];
+
+    Start = chrono::steady_clock::now();
+    Function.pBatch(&vpColumn[0], nRows, &vResult[0], NULL);
+    double lfGeneratedBatch = SecondsSince(Start) * 1e9 / nRows;
+    lfSum += vResult[nRows-1];
+
+    lfSink = lfSink + lfSum;
+    printf("  %-8s  %11.1f  %8.1f  %9.1f  %14.1f  %15.1f\n", Function.szName,
+           lfInterpreted, lfCompiled, lfGenerated, lfCompiledBatch, lfGeneratedBatch);
+  }
+  cout << endl;
+}
+
+static void BenchmarkProfile(void)
+{
+  const char *szExpression = "(a + 10) * 50 / ((b - 6) * 9) + c * (d - e) / (c + 2.5) - a * b * c";
+  const size_t nRows = 4096;
+  const int nBatches = 64;
+  CCompiledExpression Compiled;
+  vector<vector<double> > vvColumn;
+  vector<const double *> vpColumn;
+  vector<double> vResult(nRows);
+  double alfNs[2];
+
+  Compiled.Compile(szExpression);
+  vvColumn.assign(Compiled.GetNumberOfVariables(), vector<double>(nRows));
+  for (size_t i=0; i<vvColumn.size(); i++)
+  {
+    for (size_t r=0; r<nRows; r++)
+      vvColumn[i][r] = 7.0 + (r * (i + 3)) % 17;
+    vpColumn.push_back(&vvColumn[i][0]);
+  }
+
+  for (int bProfile=0; bProfile<2; bProfile++)
+  {
+    if (bProfile)
+      Compiled.EnableProfile();
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    for (int b=0; b<nBatches; b++)
+      Compiled.EvaluateBatch(&vpColumn[0], nRows, &vResult[0]);
+    alfNs[bProfile] = SecondsSince(Start) * 1e9 / (nRows * nBatches);
+    lfSink = lfSink + vResult[0];
+  }
+
+  cout << "Profiling (ns per row, batches of " << nRows << ", one in " << PROFILE_SAMPLE_BATCHES << " timed)" << endl;
+  printf("  not profiling  %6.1f\n", alfNs[0]);
+  printf("  profiling      %6.1f  %.2fx\n", alfNs[1], alfNs[1] / alfNs[0]);
+  Compiled.PrintProfile(cout);
+  cout << endl;
+}
+
+static void BenchmarkBatchLimits(void)
+{
+  const char *szExpression = "a*b + c*d - e/f + a*c*e";
+  const size_t nRows = 1000000;
+  const int nRepeats = 5;
+  CCompiledExpression Compiled;
+  vector<vector<double> > vvColumn;
+  vector<const double *> vpColumn;
+  vector<double> vResult(nRows);
+  atomic<bool> bCancel(false);
+  tBATCHLIMITS Limits;
+  double lfPlain = HUGE_VAL;
+  double lfLimited = HUGE_VAL;
+
+  Compiled.Compile(szExpression);
+  vvColumn.assign(Compiled.GetNumberOfVariables(), vector<double>(nRows));
+  for (size_t i=0; i<vvColumn.size(); i++)
+  {
+    for (size_t r=0; r<nRows; r++)
+      vvColumn[i][r] = 1.5 + (r * (i + 3)) % 17;
+    vpColumn.push_back(&vvColumn[i][0]);
+  }
+
+  // Both checks made, but neither ever stops the batch. Best of several runs,
+  // alternating, so that both see the same conditions.
+  CCompiledExpression::InitialiseLimits(Limits);
+  Limits.pCancel = &bCancel;
+  Limits.Deadline = chrono::steady_clock::now() + chrono::hours(1);
+  for (int i=0; i<nRepeats; i++)
+  {
+    size_t Cursor = 0;
+
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    Compiled.EvaluateBatch(&vpColumn[0], nRows, &vResult[0]);
+    lfPlain = min(lfPlain, SecondsSince(Start));
+
+    Start = chrono::steady_clock::now();
+    Compiled.EvaluateBatch(&vpColumn[0], nRows, &vResult[0], NULL, Limits, Cursor);
+    lfLimited = min(lfLimited, SecondsSince(Start));
+  }
+
+  // How soon a cancelled batch stops
+  size_t Cursor = 0;
+  chrono::steady_clock::time_point Cancelled;
+  thread Canceller([&]()
+  {
+    this_thread::sleep_for(chrono::milliseconds(20));
+    Cancelled = chrono::steady_clock::now();
+    bCancel = true;
+  });
+  Compiled.EvaluateBatch(&vpColumn[0], nRows, &vResult[0], NULL, Limits, Cursor);
+  double lfStop = SecondsSince(Cancelled);
+  Canceller.join();
+
+  lfSink = lfSink + vResult[0];
+
+  cout << "Batch limits (" << nRows << " rows, chunks of " << BATCH_DEFAULT_CHUNK_ROWS << ")" << endl;
+  printf("  unlimited         %6.1f ns per row\n", lfPlain * 1e9 / nRows);
+  printf("  cancel+deadline   %6.1f ns per row  %+.2f%%\n", lfLimited * 1e9 / nRows, 100.0 * (lfLimited / lfPlain - 1.0));
+  printf("  stopped %.0f us after cancelling, at row %u\n", lfStop * 1e6, (unsigned int)Cursor);
+  cout << endl;
+}
+
+static void BenchmarkKernels(void)
+{
+  static const char *aszExpression[] =
+  {
+    "a*x+b", "a*x-b", "b+a*x", "a*b+c*d", "(a-b)/c", "c*(a+b)", "(a*x+b)/(c*(d-e))",
+  };
+  static const unsigned int auFlags[3] = { COMPILE_NO_KERNELS, COMPILE_DEFAULT, COMPILE_FUSED_MULTIPLY_ADD };
+  const int nExpressions = sizeof(aszExpression) / sizeof(aszExpression[0]);
+  const size_t nRows = 4096;
+  const int nBatches = 256;
+  const int nRepeats = 3;
+
+  cout << "Fused kernels (ns per row, batches of " << nRows << ")" << endl;
+  printf("  %-20s %8s %8s %8s %8s  %s\n", "expression", "generic", "kernel", "fma", "gain", "kernels");
+  for (int e=0; e<nExpressions; e++)
+  {
+    CCompiledExpression aCompiled[3];
+    vector<vector<double> > vvColumn;
+    vector<const double *> vpColumn;
+    vector<double> vResult(nRows);
+    double alfNs[3];
+    string sKernels;
+
+    for (int f=0; f<3; f++)
+      aCompiled[f].Compile(aszExpression[e], auFlags[f]);
+    vvColumn.assign(aCompiled[0].GetNumberOfVariables(), vector<double>(nRows));
+    for (size_t i=0; i<vvColumn.size(); i++)
+    {
+      for (size_t r=0; r<nRows; r++)
+        vvColumn[i][r] = 1.5 + (r * (i + 3)) % 17;
+      vpColumn.push_back(&vvColumn[i][0]);
+    }
+    for (int k=0; k<aCompiled[1].GetNumberOfKernels(); k++)
+    {
+      if (k > 0)
+        sKernels += ", ";
+      sKernels += CCompiledExpression::GetKernelName(aCompiled[1].GetKernel(k).Type);
+    }
+
+    for (int f=0; f<3; f++)
+      alfNs[f] = HUGE_VAL;
+    for (int i=0; i<nRepeats; i++)
+    {
+      for (int f=0; f<3; f++)
+      {
+        chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+        for (int b=0; b<nBatches; b++)
+          aCompiled[f].EvaluateBatch(&vpColumn[0], nRows, &vResult[0]);
+        alfNs[f] = min(alfNs[f], SecondsSince(Start) * 1e9 / (nRows * nBatches));
+        lfSink = lfSink + vResult[0];
+      }
+    }
+    printf("  %-20s %8.1f %8.1f %8.1f %7.2fx  %s\n", aszExpression[e], alfNs[0], alfNs[1], alfNs[2],
+           alfNs[0] / alfNs[1], sKernels.c_str());
+  }
+  cout << endl;
+}
+
+static void BenchmarkGrid(void)
+{
+  // Most of the work depends only on a, the outer variable.
+  const char *szExpression = "(a + 10) * 50 / ((a - 6.5) * 9) + a*a*a*a / (a + 1) - b * (a - 3)";
+  tGRIDAXIS aAxis[2] = { { 0.0, 0.1, 1000 }, { 0.0, 0.5, 1000 } };
+  CCompiledExpression Compiled;
+  size_t nPoints;
+  vector<double> vResult;
+  vector<double> vExpected;
+  double alfNs[2];
+
+  Compiled.Compile(szExpression);
+  nPoints = Compiled.GetGridPoints(aAxis);
+  vResult.resize(nPoints);
+  vExpected.resize(nPoints);
+
+  // One point at a time, as a caller would without EvaluateGrid()
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  for (size_t i=0; i<aAxis[0].nCount; i++)
+  {
+    for (size_t j=0; j<aAxis[1].nCount; j++)
+    {
+      double aValues[2] = { aAxis[0].lfStart + (double)i * aAxis[0].lfStep, aAxis[1].lfStart + (double)j * aAxis[1].lfStep };
+      vExpected[i * aAxis[1].nCount + j] = Compiled.Evaluate(aValues);
+    }
+  }
+  alfNs[0] = SecondsSince(Start) * 1e9 / nPoints;
+
+  Start = chrono::steady_clock::now();
+  Compiled.EvaluateGrid(aAxis, &vResult[0]);
+  alfNs[1] = SecondsSince(Start) * 1e9 / nPoints;
+  lfSink = lfSink + vResult[nPoints - 1];
+
+  cout << "Grid (" << aAxis[0].nCount << " x " << aAxis[1].nCount << " points, ns per point)" << endl;
+  printf("  point by point   %6.1f\n", alfNs[0]);
+  printf("  EvaluateGrid()   %6.1f  %.2fx%s\n", alfNs[1], alfNs[0] / alfNs[1],
+         vResult == vExpected ? "" : "  RESULTS DIFFER");
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Large formulas
+// Memory and speed of the compiled form as formulas grow to millions of
+// nodes. Division is left out, since somewhere in millions of random terms
+// something is bound to divide by zero, and evaluation would stop there.
+// The interpreter recurses for each brace, so it is only timed where the
+// nesting is shallow enough for its stack.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkLargeFormulas(void)
+{
+  static const int TermCounts[] = { 10000, 100000, 1000000, 3000000 };
+  const int nInterpretedTerms = 10000;
+
+  cout << "Large formulas" << endl;
+  printf("  %8s %9s %8s %10s %10s %10s %12s %12s\n", "terms", "nodes", "literals", "bytes/node",
+         "bytes/term", "compile ms", "ns/node", "interp ns/node");
+  for (size_t t=0; t<sizeof(TermCounts)/sizeof(TermCounts[0]); t++)
+  {
+    unsigned int uRandom = 12345;
+    string sExpression = RandomFormula(uRandom, TermCounts[t]);
+    CCompiledExpression Compiled;
+    tERRNO ErrNo = ERR_OK;
+    vector<double> vValue;
+    double lfSum = 0.0;
+    double lfInterpreted = 0.0;
+
+    replace(sExpression.begin(), sExpression.end(), '/', '*');
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    Compiled.Compile(sExpression.c_str());
+    double lfCompileMs = SecondsSince(Start) * 1e3;
+    int nNodes = Compiled.GetNumberOfNodes();
+
+    for (int i=0; i<Compiled.GetNumberOfVariables(); i++)
+      vValue.push_back(1.0 + (i % 7) * 1e-4);
+    int nEvaluations = max(1, 20000000 / nNodes);
+    Start = chrono::steady_clock::now();
+    for (int i=0; i<nEvaluations; i++)
+      lfSum += Compiled.Evaluate(&vValue[0], &ErrNo);
+    double lfCompiled = SecondsSince(Start) * 1e9 / ((double)nEvaluations * nNodes);
+
+    if (TermCounts[t] <= nInterpretedTerms)
+    {
+      CBenchmarkEvaluator Interpreter;
+      int nInterpreted = max(1, nEvaluations / 20);
+
+      for (int i=0; i<Compiled.GetNumberOfVariables(); i++)
+        Interpreter.aValue[(unsigned char)Compiled.GetVariableName(i)] = vValue[i];
+      Interpreter.SetExpression(sExpression.c_str());
+      Interpreter.InitialiseVariables();
+      Start = chrono::steady_clock::now();
+      for (int i=0; i<nInterpreted; i++)
+        lfSum += Interpreter.EvaluateExpression();
+      lfInterpreted = SecondsSince(Start) * 1e9 / ((double)nInterpreted * nNodes);
+    }
+    lfSink = lfSink + lfSum;
+
+    printf("  %8d %9d %8d %10.1f %10.1f %10.1f %12.2f ", TermCounts[t], nNodes, Compiled.GetNumberOfLiterals(),
+           (double)Compiled.GetMemoryUsage() / nNodes, (double)Compiled.GetMemoryUsage() / TermCounts[t],
+           lfCompileMs, lfCompiled);
+    if (lfInterpreted > 0.0)
+      printf("%12.2f", lfInterpreted);
+    else
+      printf("%12s", "-");
+    printf("%s\n", (ErrNo == ERR_OK) ? "" : "  EVALUATION FAILED");
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Range analysis
+// Division heavy expressions with and without declared bounds, i.e. with
+// and without the check for a zero divisor on each division.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkRanges(void)
+{
+  static const char *aszExpression[] =
+  {
+    "a/b", "a/b + c/d - e/b", "(a-b)/c + d/(e+c)", "((a/b)/c)/d / ((e/b)/c)",
+  };
+  const int nExpressions = sizeof(aszExpression) / sizeof(aszExpression[0]);
+  const size_t nRows = 4096;
+  const int nBatches = 256;
+  const int nRepeats = 5;
+
+  cout << "Range analysis (ns per row, batches of " << nRows << ", variables in [7, 100])" << endl;
+  printf("  %-26s %8s %8s %8s  %s\n", "expression", "checked", "bounded", "gain", "warnings");
+  for (int e=0; e<nExpressions; e++)
+  {
+    CCompiledExpression aCompiled[2];
+    vector<vector<double> > vvColumn;
+    vector<const double *> vpColumn;
+    vector<double> vResult(nRows);
+    vector<tERRNO> vErrNo(nRows);
+    vector<int> vWarning;
+    double alfNs[2] = { HUGE_VAL, HUGE_VAL };
+
+    for (int b=0; b<2; b++)
+      aCompiled[b].Compile(aszExpression[e]);
+    for (int Slot=0; Slot<aCompiled[1].GetNumberOfVariables(); Slot++)
+      aCompiled[1].SetBounds(aCompiled[1].GetVariableName(Slot), 7.0, 100.0);
+    vvColumn.assign(aCompiled[0].GetNumberOfVariables(), vector<double>(nRows));
+    for (size_t i=0; i<vvColumn.size(); i++)
+    {
+      for (size_t r=0; r<nRows; r++)
+        vvColumn[i][r] = 7.0 + (r * (i + 3)) % 93;
+      vpColumn.push_back(&vvColumn[i][0]);
+    }
+
+    for (int i=0; i<nRepeats; i++)
+    {
+      for (int b=0; b<2; b++)
+      {
+        chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+        for (int n=0; n<nBatches; n++)
+          aCompiled[b].EvaluateBatch(&vpColumn[0], nRows, &vResult[0], &vErrNo[0]);
+        alfNs[b] = min(alfNs[b], SecondsSince(Start) * 1e9 / (nRows * nBatches));
+        lfSink = lfSink + vResult[0];
+      }
+    }
+    printf("  %-26s %8.1f %8.1f %7.2fx  %d -> %d\n", aszExpression[e], alfNs[0], alfNs[1], alfNs[0] / alfNs[1],
+           (int)aCompiled[0].GetDivideWarnings(vWarning), (int)aCompiled[1].GetDivideWarnings(vWarning));
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Asynchronous variable providers
+// Evaluations of a five variable expression whose values each take 1ms to
+// fetch: one at a time with blocking InitialiseVariables(), and all at once
+// with CAsyncEvaluator on two threads.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkAsync(void)
+{
+  const char *szExpression = "a*b + c/d - e";
+  const chrono::microseconds Latency(1000);
+  const int nBlocking = 50;
+  const int anAsync[] = { 100, 1000, 10000 };
+  CLatencyEvaluator Interpreter;
+  CTimerQueue Timer;
+  CLatencyProvider Provider(Timer);
+  CCompiledExpression Compiled;
+
+  for (int i=0; i<128; i++)
+    Interpreter.aValue[i] = Provider.aValue[i] = 1.5 + i % 11;
+  Interpreter.Latency = Provider.Latency = Latency;
+  Interpreter.SetExpression(szExpression);
+  Compiled.Compile(szExpression);
+
+  cout << "Asynchronous variable providers (" << szExpression << ", 1ms per variable)" << endl;
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  for (int i=0; i<nBlocking; i++)
+  {
+    Interpreter.InitialiseVariables();
+    lfSink = lfSink + Interpreter.EvaluateExpression();
+  }
+  double lfBlocking = nBlocking / SecondsSince(Start);
+  printf("  %-34s %10.0f evaluations/s\n", "blocking, one at a time", lfBlocking);
+
+  CAsyncEvaluator Async(Provider);
+  for (size_t n=0; n<sizeof(anAsync) / sizeof(anAsync[0]); n++)
+  {
+    vector<const CCompiledExpression *> vpCompiled(anAsync[n], &Compiled);
+    vector<double> vResult;
+    vector<tERRNO> vErrNo;
+    char szLabel[64];
+
+    Start = chrono::steady_clock::now();
+    Async.EvaluateAll(vpCompiled, vResult, vErrNo);
+    double lfAsync = anAsync[n] / SecondsSince(Start);
+    lfSink = lfSink + vResult[0];
+    sprintf(szLabel, "async, %d at once", anAsync[n]);
+    printf("  %-34s %10.0f evaluations/s %8.1fx\n", szLabel, lfAsync, lfAsync / lfBlocking);
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Expression packs
+// A rule base of 4 shapes of rule, each rule with constants of its own, all
+// evaluated on one row at a time: interpreted one by one, compiled one by
+// one, and grouped by shape in a CExpressionPack.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkPack(void)
+{
+  static const char *aszShape[] =
+  {
+    "a*%d + b*%d", "(a-%d)/(b+%d)", "a*%d + b*%d > c*%d", "%d*a*a + %d*a + %d",
+  };
+  const int nShapes = sizeof(aszShape) / sizeof(aszShape[0]);
+  const int anRules[] = { 100, 1000, 10000 };
+  const int nRows = 200;
+  unsigned int uRandom = 12345;
+
+  cout << "Expression packs (ns per rule per row, " << nShapes << " shapes of rule)" << endl;
+  printf("  %8s %8s %12s %10s %10s %8s\n", "rules", "groups", "interpreted", "compiled", "packed", "gain");
+  for (size_t r=0; r<sizeof(anRules) / sizeof(anRules[0]); r++)
+  {
+    int nRules = anRules[r];
+    vector<string> vFormula;
+    vector<CCompiledExpression> vCompiled(nRules);
+    vector<const CCompiledExpression *> vpCompiled;
+    CBenchmarkEvaluator Interpreter;
+    CExpressionPack Pack;
+    char szFormula[128];
+    double aValues[8];
+    double aOwnValues[8];
+    vector<double> vResult(nRules);
+    vector<tERRNO> vErrNo(nRules);
+
+    for (int i=0; i<nRules; i++)
+    {
+      int aK[3];
+
+      for (int k=0; k<3; k++)
+      {
+        uRandom = uRandom * 1103515245 + 12345;
+        aK[k] = 1 + (uRandom >> 16) % 100;
+      }
+      sprintf(szFormula, aszShape[i % nShapes], aK[0], aK[1], aK[2]);
+      vFormula.push_back(szFormula);
+      vCompiled[i].Compile(szFormula);
+      vpCompiled.push_back(&vCompiled[i]);
+    }
+    size_t nGroups = Pack.Build(vpCompiled);
+
+    // Interpreted, on the first 1000 rules only
+    int nInterpreted = min(nRules, 1000);
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    for (int i=0; i<nInterpreted; i++)
+    {
+      Interpreter.aValue['a'] = 1.5;
+      Interpreter.aValue['b'] = 2.5;
+      Interpreter.aValue['c'] = 3.5;
+      Interpreter.SetExpression(vFormula[i].c_str());
+      Interpreter.InitialiseVariables();
+      lfSink = lfSink + Interpreter.EvaluateExpression();
+    }
+    double lfInterpreted = SecondsSince(Start) * 1e9 / nInterpreted;
+
+    Start = chrono::steady_clock::now();
+    for (int Row=0; Row<nRows; Row++)
+    {
+      for (int Slot=0; Slot<Pack.GetNumberOfVariables(); Slot++)
+        aValues[Slot] = 1.5 + Slot + Row * 0.01;
+      for (int i=0; i<nRules; i++)
+      {
+        const CCompiledExpression &Compiled = vCompiled[i];
+
+        for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+          aOwnValues[Slot] = aValues[Pack.GetVariableSlot(Compiled.GetVariableName(Slot))];
+        vResult[i] = Compiled.Evaluate(aOwnValues, &vErrNo[i]);
+      }
+      lfSink = lfSink + vResult[Row % nRules];
+    }
+    double lfCompiled = SecondsSince(Start) * 1e9 / ((double)nRows * nRules);
+
+    Start = chrono::steady_clock::now();
+    for (int Row=0; Row<nRows; Row++)
+    {
+      for (int Slot=0; Slot<Pack.GetNumberOfVariables(); Slot++)
+        aValues[Slot] = 1.5 + Slot + Row * 0.01;
+      Pack.Evaluate(aValues, &vResult[0], &vErrNo[0]);
+      lfSink = lfSink + vResult[Row % nRules];
+    }
+    double lfPacked = SecondsSince(Start) * 1e9 / ((double)nRows * nRules);
+
+    printf("  %8d %8d %12.1f %10.1f %10.1f %7.2fx\n", nRules, (int)nGroups, lfInterpreted, lfCompiled, lfPacked,
+           lfCompiled / lfPacked);
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Tiled batches
+// Random formulas of 10, 100 and 1000 operators over a batch, row by row with
+// Evaluate() as EvaluateBatch() used to, and in tiles of various sizes,
+// including the one chosen by calibration.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkTiles(void)
+{
+  const int anOperators[] = { 10, 100, 1000 };
+  const size_t anTileRows[] = { 16, 64, 256, 1024, 4096 };
+  const int nTileSizes = sizeof(anTileRows) / sizeof(anTileRows[0]);
+  const size_t nRows = 32768;
+  const int nRepeats = 3;
+  unsigned int uRandom = 4242;
+  vector<vector<double> > vvColumn(52, vector<double>(nRows));
+  vector<double> vResult(nRows);
+  vector<tERRNO> vErrNo(nRows);
+
+  CCompiledExpression::SetTileRows(0);
+  size_t nCalibratedRows = CCompiledExpression::GetTileRows();
+  for (int i=0; i<52; i++)
+  {
+    for (size_t r=0; r<nRows; r++)
+      vvColumn[i][r] = 1.5 + (r * (i + 3)) % 17;
+  }
+
+  cout << "Tiled batches (ns per row, " << nRows << " rows, calibrated tile " << nCalibratedRows << " rows)" << endl;
+  printf("  %9s %9s", "operators", "by row");
+  for (int t=0; t<nTileSizes; t++)
+    printf(" %8d", (int)anTileRows[t]);
+  printf(" %10s %8s\n", "calibrated", "gain");
+  for (size_t f=0; f<sizeof(anOperators) / sizeof(anOperators[0]); f++)
+  {
+    CCompiledExpression Compiled;
+    vector<const double *> vpColumn;
+    vector<double> vRow(53);
+    double lfByRow = HUGE_VAL;
+    double alfTiled[nTileSizes + 1];
+
+    string sFormula = RandomFormula(uRandom, anOperators[f] + 1);
+
+    // Without division, which would soon take long chains into denormals
+    replace(sFormula.begin(), sFormula.end(), '/', '*');
+    Compiled.Compile(sFormula.c_str());
+    for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+    {
+      char Name = Compiled.GetVariableName(Slot);
+      vpColumn.push_back(&vvColumn[(Name >= 'a') ? Name - 'a' : Name - 'A' + 26][0]);
+    }
+    vpColumn.push_back(NULL);
+
+    for (int i=0; i<nRepeats; i++)
+    {
+      chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+      for (size_t r=0; r<nRows; r++)
+      {
+        for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+          vRow[Slot] = vpColumn[Slot][r];
+        vResult[r] = Compiled.Evaluate(&vRow[0], &vErrNo[r]);
+      }
+      lfByRow = min(lfByRow, SecondsSince(Start) * 1e9 / nRows);
+      lfSink = lfSink + vResult[0];
+    }
+
+    for (int t=0; t<=nTileSizes; t++)
+    {
+      CCompiledExpression::SetTileRows((t < nTileSizes) ? anTileRows[t] : nCalibratedRows);
+      alfTiled[t] = HUGE_VAL;
+      for (int i=0; i<nRepeats; i++)
+      {
+        chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+        Compiled.EvaluateBatch(&vpColumn[0], nRows, &vResult[0], &vErrNo[0]);
+        alfTiled[t] = min(alfTiled[t], SecondsSince(Start) * 1e9 / nRows);
+        lfSink = lfSink + vResult[0];
+      }
+    }
+
+    printf("  %9d %9.1f", anOperators[f], lfByRow);
+    for (int t=0; t<nTileSizes; t++)
+      printf(" %8.1f", alfTiled[t]);
+    printf(" %10.1f %7.2fx\n", alfTiled[nTileSizes], lfByRow / alfTiled[nTileSizes]);
+  }
+  cout << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Background compilation
+// Time from setting a new formula to its first result: compiling first
+// (with COMPILE_REASSOCIATE), and interpreting at once while compiling in the
+// background; then the time until the compiled form took over, and the cost
+// of an evaluation before (which may be compiled already, if compiling was
+// quick) and after.
+////////////////////////////////////////////////////////////////////////////
+static void BenchmarkBackgroundCompile(void)
+{
+  const int anTerms[] = { 100, 1000, 10000 };
+  unsigned int uRandom = 777;
+
+  cout << "Background compilation (ms to first result, ms to optimised, us per evaluation)" << endl;
+  printf("  %8s %14s %12s %10s %12s %10s\n", "terms", "compile first", "background", "optimised",
+         "interpreted", "compiled");
+  for (size_t t=0; t<sizeof(anTerms) / sizeof(anTerms[0]); t++)
+  {
+    string sFormula = RandomFormula(uRandom, anTerms[t]);
+    CBenchmarkEvaluator Evaluator;
+    CCompiledExpression Compiled;
+    tEXPRESSIONMETRICS Metrics;
+    vector<double> vValue(53);
+
+    replace(sFormula.begin(), sFormula.end(), '/', '*');
+    for (int i=0; i<128; i++)
+      Evaluator.aValue[i] = 1.0 + (i % 7) * 0.001;
+    for (int Slot=0; Slot<52; Slot++)
+      vValue[Slot] = Evaluator.aValue[(unsigned char)VariableNameForSlot(Slot)];
+
+    // Compiling first: the first result waits for the compiler
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    Compiled.Compile(sFormula.c_str(), COMPILE_REASSOCIATE);
+    for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+      vValue[Slot] = Evaluator.aValue[(unsigned char)Compiled.GetVariableName(Slot)];
+    lfSink = lfSink + Compiled.Evaluate(&vValue[0]);
+    double lfCompileFirst = SecondsSince(Start);
+
+    // In the background: interpreted until the compiled form is ready
+    Evaluator.EnableBackgroundCompile(COMPILE_REASSOCIATE);
+    Evaluator.SetExpression(sFormula.c_str());
+    Evaluator.InitialiseVariables();
+    int nInterpreted = 0;
+    Start = chrono::steady_clock::now();
+    do
+    {
+      lfSink = lfSink + Evaluator.EvaluateExpression();
+      nInterpreted++;
+    } while (!Evaluator.IsOptimised() && nInterpreted < 1000);
+    double lfInterpreted = SecondsSince(Start) / nInterpreted;
+    Evaluator.WaitForOptimised(60000);
+    Evaluator.GetExpressionMetrics(Metrics);
+
+    int nCompiled = 0;
+    Start = chrono::steady_clock::now();
+    while (SecondsSince(Start) < 0.05)
+    {
+      lfSink = lfSink + Evaluator.EvaluateExpression();
+      nCompiled++;
+    }
+    double lfCompiled = SecondsSince(Start) / nCompiled;
+
+    printf("  %8d %14.3f %12.3f %10.3f %12.1f %10.1f\n", anTerms[t], lfCompileFirst * 1e3,
+           Metrics.lfFirstResultSeconds * 1e3, Metrics.lfOptimisedSeconds * 1e3, lfInterpreted * 1e6, lfCompiled * 1e6);
+  }
+  cout << endl;
+}
+
+// A batch of four skewed categorical columns of each cardinality, evaluated
+// decoded by EvaluateBatch() (the decoding not timed) and by
+// EvaluateDictionary() straight from the codes.
+static void BenchmarkDictionary(void)
+{
+  const size_t anCardinality[] = { 4, 16, 64, 1024 };
+  const size_t nRows = 1000000;
+  const int nRepeats = 3;
+  unsigned int uRandom = 777;
+  vector<vector<unsigned int> > vvCode(4, vector<unsigned int>(nRows));
+  vector<vector<double> > vvDecoded(4, vector<double>(nRows));
+  vector<double> vResult(nRows);
+  vector<tERRNO> vErrNo(nRows);
+  CCompiledExpression Compiled;
+
+  Compiled.Compile("(a*b + c*d)*0.5 - (a+c)*(b-d)*0.25 + a*d*c - b*b + 3*c");
+  cout << "Dictionary-encoded batches (" << nRows << " rows of 4 skewed columns)" << endl;
+  printf("  %11s %12s %11s %13s %8s\n", "cardinality", "combinations", "batch ms", "dictionary ms", "speedup");
+  for (size_t c=0; c<sizeof(anCardinality) / sizeof(anCardinality[0]); c++)
+  {
+    vector<double> vDictionary(anCardinality[c]);
+    tDICTCOLUMN aColumn[4];
+    const double *apDecoded[5];
+    double lfBatch = HUGE_VAL;
+    double lfDictionary = HUGE_VAL;
+    size_t nCombinations = 0;
+
+    for (size_t k=0; k<anCardinality[c]; k++)
+      vDictionary[k] = 1.0 + k * 0.125;
+    for (int Slot=0; Slot<4; Slot++)
+    {
+      // u^4 of a uniform u: the low codes are much the commonest
+      for (size_t r=0; r<nRows; r++)
+      {
+        uRandom = uRandom * 1103515245 + 12345;
+        double u = (uRandom >> 8) / 16777216.0;
+        vvCode[Slot][r] = (unsigned int)(u * u * u * u * anCardinality[c]);
+        vvDecoded[Slot][r] = vDictionary[vvCode[Slot][r]];
+      }
+      aColumn[Compiled.GetVariableSlot((char)('a' + Slot))].pCode = &vvCode[Slot][0];
+      aColumn[Compiled.GetVariableSlot((char)('a' + Slot))].pDictionary = &vDictionary[0];
+      aColumn[Compiled.GetVariableSlot((char)('a' + Slot))].nDictionary = vDictionary.size();
+      apDecoded[Compiled.GetVariableSlot((char)('a' + Slot))] = &vvDecoded[Slot][0];
+    }
+    apDecoded[4] = NULL;
+
+    for (int i=0; i<nRepeats; i++)
+    {
+      chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+      Compiled.EvaluateBatch(apDecoded, nRows, &vResult[0], &vErrNo[0]);
+      lfBatch = min(lfBatch, SecondsSince(Start) * 1e3);
+      lfSink = lfSink + vResult[nRows - 1];
+
+      Start = chrono::steady_clock::now();
+      nCombinations = Compiled.EvaluateDictionary(aColumn, nRows, &vResult[0], &vErrNo[0]);
+      lfDictionary = min(lfDictionary, SecondsSince(Start) * 1e3);
+      lfSink = lfSink + vResult[nRows - 1];
+    }
+    printf("  %11d %12d %11.2f %13.2f %7.1fx\n", (int)anCardinality[c], (int)nCombinations, lfBatch, lfDictionary,
+           lfBatch / lfDictionary);
+  }
+  cout << endl;
+}
+
+// Counts after the time on a line, or just the time without counters
+static void PrintBenchmarkCounts(const CPerfCounters &Counters, const tPERFCOUNTS &Counts, double lfUnits,
+                                 const char *szUnit)
+{
+  if (Counters.IsOpen())
+    CPerfCounters::PrintCounts(cout, Counts, lfUnits, szUnit);
+  else
+    cout << endl;
+}
+
+// The interpreter, compiled evaluation and a compiled batch over formulas of
+// increasing length, with the hardware counters per evaluation and, for the
+// interpreter, which parses the text every time, per byte of text.
+static void BenchmarkCounters(void)
+{
+  const int anTerms[] = { 5, 50, 500 };
+  const int nWork = 2000000;               // Roughly the same number of terms for each formula
+  unsigned int uRandom = 1234;
+  CPerfCounters Counters;
+  tPERFCOUNTS Counts;
+
+  CCompiledExpression::GetTileRows();     // Calibrated before anything is timed
+  cout << "Hardware counters" << endl;
+  if (!Counters.Open())
+    cout << "  Not available (" << Counters.GetErrorText() << "); times only" << endl;
+  for (size_t f=0; f<sizeof(anTerms) / sizeof(anTerms[0]); f++)
+  {
+    string sFormula = RandomFormula(uRandom, anTerms[f]);
+    int nEvaluations = nWork / anTerms[f];
+    int nInterpreted = max(nEvaluations / 20, 1);   // The interpreter is much slower
+    CBenchmarkEvaluator Interpreter;
+    CCompiledExpression Compiled;
+    vector<vector<double> > vvColumn;
+    vector<const double *> vpColumn;
+    vector<double> vValue;
+    vector<double> vResult(nEvaluations);
+    double lfSum = 0.0;
+
+    // Without division, which would soon take long chains into denormals
+    replace(sFormula.begin(), sFormula.end(), '/', '*');
+    Compiled.Compile(sFormula.c_str());
+    for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+    {
+      double lfValue = 1.0 + Slot * 1e-3;
+
+      vValue.push_back(lfValue);
+      vvColumn.push_back(vector<double>(nEvaluations, lfValue));
+      vpColumn.push_back(&vvColumn.back()[0]);
+      Interpreter.aValue[(unsigned char)Compiled.GetVariableName(Slot)] = lfValue;
+    }
+    vValue.push_back(0.0);
+    vpColumn.push_back(NULL);
+    Interpreter.SetExpression(sFormula.c_str());
+    Interpreter.InitialiseVariables();
+    cout << "  " << anTerms[f] << " terms, " << sFormula.size() << " bytes" << endl;
+
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    Counters.Start();
+    for (int i=0; i<nInterpreted; i++)
+      lfSum += Interpreter.EvaluateExpression();
+    Counters.Stop(Counts);
+    printf("    interpreted %9.1f ns  ", SecondsSince(Start) * 1e9 / nInterpreted);
+    PrintBenchmarkCounts(Counters, Counts, nInterpreted, "evaluation");
+    if (Counters.IsOpen())
+    {
+      printf("    %26s", "");
+      PrintBenchmarkCounts(Counters, Counts, (double)nInterpreted * sFormula.size(), "byte");
+    }
+
+    Start = chrono::steady_clock::now();
+    Counters.Start();
+    for (int i=0; i<nEvaluations; i++)
+      lfSum += Compiled.Evaluate(&vValue[0]);
+    Counters.Stop(Counts);
+    printf("    compiled    %9.1f ns  ", SecondsSince(Start) * 1e9 / nEvaluations);
+    PrintBenchmarkCounts(Counters, Counts, nEvaluations, "evaluation");
+
+    Start = chrono::steady_clock::now();
+    Counters.Start();
+    Compiled.EvaluateBatch(&vpColumn[0], nEvaluations, &vResult[0]);
+    Counters.Stop(Counts);
+    printf("    batch       %9.1f ns  ", SecondsSince(Start) * 1e9 / nEvaluations);
+    PrintBenchmarkCounts(Counters, Counts, nEvaluations, "row");
+
+    lfSink = lfSink + lfSum + vResult[0];
+  }
+  cout << endl;
+}
+
+// Moving averages of widths 10, 100 and 1000 over a stream: pushed one sample
+// at a time and in batches, each of which moves the window on in constant
+// time, against summing the whole window again at every sample.
+static void BenchmarkStream(void)
+{
+  const int anWidth[] = { 10, 100, 1000 };
+  const size_t nSamples = 1000000;
+  vector<double> vSample(nSamples);
+  vector<double> vResult(nSamples);
+  const double *ppInputs[1] = { &vSample[0] };
+
+  for (size_t k=0; k<nSamples; k++)
+    vSample[k] = 100.0 + (double)(k % 97) * 0.25;
+  CCompiledExpression::GetTileRows();     // Calibrated before anything is timed
+  cout << "Streaming moving average, ns per sample" << endl;
+  for (size_t w=0; w<sizeof(anWidth) / sizeof(anWidth[0]); w++)
+  {
+    int Width = anWidth[w];
+    string sFormula = "a[-" + to_string(Width - 1) + ":0]/" + to_string(Width);
+    CStreamEvaluator Stream;
+    double lfSum = 0.0;
+
+    Stream.SetExpression(sFormula.c_str());
+
+    chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    for (size_t k=0; k<nSamples; k++)
+      lfSum += Stream.Push(&vSample[k]);
+    double lfPush = SecondsSince(Start);
+
+    Stream.Reset();
+    Start = chrono::steady_clock::now();
+    Stream.PushBatch(ppInputs, nSamples, &vResult[0]);
+    double lfBatch = SecondsSince(Start);
+
+    // Every window summed in full
+    Start = chrono::steady_clock::now();
+    for (size_t k=Width-1; k<nSamples; k++)
+    {
+      double lfWindow = 0.0;
+
+      for (size_t j=k+1-Width; j<=k; j++)
+        lfWindow += vSample[j];
+      vResult[k] = lfWindow / Width;
+    }
+    double lfNaive = SecondsSince(Start);
+
+    printf("  %-14s push %6.1f  batch %6.1f  naive %7.1f\n", sFormula.c_str(),
+           lfPush * 1e9 / nSamples, lfBatch * 1e9 / nSamples, lfNaive * 1e9 / nSamples);
+    lfSink = lfSink + lfSum + vResult[nSamples - 1];
+  }
+  cout << endl;
+}
+
+void BenchmarkEvaluator(void)
+{
+  BenchmarkReassociation();
+  BenchmarkMemo();
+  BenchmarkSpecialise();
+  BenchmarkCompileAll();
+  BenchmarkAggregate();
+  BenchmarkFilter();
+  BenchmarkAllocator();
+  BenchmarkHotSwap();
+  BenchmarkGenerated();
+  BenchmarkProfile();
+  BenchmarkBatchLimits();
+  BenchmarkKernels();
+  BenchmarkGrid();
+  BenchmarkLargeFormulas();
+  BenchmarkRanges();
+  BenchmarkAsync();
+  BenchmarkPack();
+  BenchmarkTiles();
+  BenchmarkBackgroundCompile();
+  BenchmarkDictionary();
+  BenchmarkCounters();
+  BenchmarkStream();
+}
@@ -0,0 +1,14 @@
+// benchmark.h :
+// Include file for benchmark.cpp
+// Jonathan Gilmore, 19/10/2026
+
+#if !defined(BENCHMARK_H_INCLUDED_)
+#define BENCHMARK_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+extern void BenchmarkEvaluator(void);
+
+#endif // !defined(BENCHMARK_H_INCLUDED_)
@@ -0,0 +1,403 @@
+// codegenerator.cpp :
+// Implementation of code generator class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+////////////////////////////////////////////////////////////////////////////////////////
+// The compiled form of each expression is already in the interpreter's order:
+// its nodes are in post-order, each operator after both of its operands. So the
+// generated function is just the nodes in turn, each operator and negation
+// becoming a local of its own (t<node>), and each leaf written in place where
+// it is used. A divide checks its divisor first, as the interpreter does,
+// unless range analysis has shown the divisor cannot be zero (it is a
+// non-zero constant, say, or a square plus one; see NODE_FLAG_SAFE_DIVIDE).
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <string.h>
+#include <fstream>
+
+#include "codegenerator.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////
+// CParsingEvaluator
+// CEvaluator for parsing only; no values are ever asked for.
+////////////////////////////////////////////////////////////////////////////
+class CParsingEvaluator : public CEvaluator
+{
+  public:
+    bool InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet)
+    {
+      return false;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CCodeGenerator implementation
+////////////////////////////////////////////////////////////////////////////
+CCodeGenerator::CCodeGenerator(void)
+{
+  ErrNo = ERR_OK;
+}
+
+CCodeGenerator::~CCodeGenerator(void)
+{
+}
+
+tERRNO CCodeGenerator::GetErrorNumber(void) const
+{
+  return ErrNo;
+}
+
+int CCodeGenerator::GetNumberOfFunctions(void) const
+{
+  return (int)vFunction.size();
+}
+
+bool CCodeGenerator::IsIdentifier(const char *szName) // static
+{
+  if (szName == NULL || !(isalpha((unsigned char)szName[0]) || szName[0] == '_'))
+    return false;
+  for (const char *p=szName; *p; p++)
+  {
+    if (!(isalnum((unsigned char)*p) || *p == '_'))
+      return false;
+  }
+  return true;
+}
+
+bool CCodeGenerator::AddFunction(const char *szName, const char *szExpression)
+{
+  CParsingEvaluator Parser;
+  tFUNCTION Function;
+
+  ErrNo = ERR_OK;
+  if (!IsIdentifier(szName))
+  {
+    ErrNo = ERR_UNKNOWN;
+    return false;
+  }
+  for (size_t i=0; i<vFunction.size(); i++)
+  {
+    if (vFunction[i].sName == szName)
+    {
+      ErrNo = ERR_UNKNOWN;
+      return false;
+    }
+  }
+
+  if (!Parser.SetExpression(szExpression) || !Parser.Compile(Function.Compiled))
+  {
+    ErrNo = Parser.GetErrorNumber();
+    return false;
+  }
+  if (Function.Compiled.HasHistory())
+  {
+    ErrNo = ERR_INVALID_HISTORY; // A generated function has no history to take lags from
+    return false;
+  }
+  Function.sName = szName;
+  Function.sExpression = szExpression;
+  vFunction.push_back(Function);
+  return true;
+}
+
+string CCodeGenerator::GetFileName(const char *szBaseName) // static
+{
+  const char *pSlash = strrchr(szBaseName, '/');
+  const char *pBackslash = strrchr(szBaseName, '\\');
+
+  if (pBackslash > pSlash)
+    pSlash = pBackslash;
+  return pSlash ? pSlash + 1 : szBaseName;
+}
+
+string CCodeGenerator::GetIdentifier(const char *szBaseName) // static
+{
+  string sIdentifier = GetFileName(szBaseName);
+
+  for (size_t i=0; i<sIdentifier.length(); i++)
+  {
+    if (!isalnum((unsigned char)sIdentifier[i]))
+      sIdentifier[i] = '_';
+  }
+  if (sIdentifier.empty() || isdigit((unsigned char)sIdentifier[0]))
+    sIdentifier = "_" + sIdentifier;
+  return sIdentifier;
+}
+
+string CCodeGenerator::GetLiteral(double lfValue) // static
+{
+  char szLiteral[32];
+
+  if (isinf(lfValue))
+    return (lfValue > 0) ? "HUGE_VAL" : "(-HUGE_VAL)";
+
+  // Enough digits to read back as exactly the same double
+  sprintf(szLiteral, "%.17g", lfValue);
+  if (strpbrk(szLiteral, ".e") == NULL)
+    strcat(szLiteral, ".0");
+  if (szLiteral[0] == '-')
+    return string("(") + szLiteral + ")";
+  return szLiteral;
+}
+
+string CCodeGenerator::GetStringLiteral(const string &s) // static
+{
+  string sLiteral = "\"";
+
+  for (size_t i=0; i<s.length(); i++)
+  {
+    if (s[i] == '"' || s[i] == '\\')
+      sLiteral += '\\';
+    sLiteral += s[i];
+  }
+  return sLiteral + "\"";
+}
+
+// Whether any node reads a variable; constant folding may have removed them all.
+bool CCodeGenerator::UsesVariables(const CCompiledExpression &Compiled) // static
+{
+  for (int n=0; n<Compiled.GetNumberOfNodes(); n++)
+  {
+    if (Compiled.GetNode(n).Type == NODE_VARIABLE)
+      return true;
+  }
+  return false;
+}
+
+void CCodeGenerator::WriteBody(ostream &os, const tFUNCTION &Function, bool bBatch) const
+{
+  const CCompiledExpression &Compiled = Function.Compiled;
+  const char *szIndent = bBatch ? "    " : "  ";
+  vector<string> vText(Compiled.GetNumberOfNodes());
+
+  for (int n=0; n<Compiled.GetNumberOfNodes(); n++)
+  {
+    const tNODE &Node = Compiled.GetNode(n);
+    char szLocal[16];
+
+    sprintf(szLocal, "t%d", n);
+    switch (Node.Type)
+    {
+      case NODE_CONSTANT:
+        vText[n] = GetLiteral(Compiled.GetLiteral(Node.iLiteral));
+        break;
+
+      case NODE_VARIABLE:
+      {
+        char szValue[32];
+
+        if (bBatch)
+          sprintf(szValue, "ppColumns[%d][Row]", Node.iVariable);
+        else
+          sprintf(szValue, "pValues[%d]", Node.iVariable);
+        vText[n] = szValue;
+        break;
+      }
+
+      case NODE_NEGATE:
+        os << szIndent << "const double " << szLocal << " = -" << vText[Node.iLeft] << ";\n";
+        vText[n] = szLocal;
+        break;
+
+      case NODE_OPERATOR:
+      {
+        const string &sLeft = vText[Node.iLeft];
+        const string &sRight = vText[Node.iRight];
+
+        // No check where range analysis shows the divisor cannot be zero, e.g. a constant
+        if (Node.cOperator == '/' && !(Node.Flags & NODE_FLAG_SAFE_DIVIDE))
+        {
+          os << szIndent << "if (" << sRight << " == 0.0)\n"
+             << szIndent << "{\n";
+          if (bBatch)
+            os << szIndent << "  pResults[Row] = 0.0;\n"
+               << szIndent << "  if (pErrNo)\n"
+               << szIndent << "    pErrNo[Row] = ERR_DIVIDE_BY_ZERO;\n"
+               << szIndent << "  continue;\n";
+          else
+            os << szIndent << "  if (pErrNo)\n"
+               << szIndent << "    *pErrNo = ERR_DIVIDE_BY_ZERO;\n"
+               << szIndent << "  return 0.0;\n";
+          os << szIndent << "}\n";
+        }
+
+        os << szIndent << "const double " << szLocal << " = ";
+        switch (Node.cOperator)
+        {
+          case '+': case '-': case '*': case '/':
+            os << sLeft << " " << Node.cOperator << " " << sRight << ";\n";
+            break;
+          case '<': case '>':
+            os << "(" << sLeft << " " << Node.cOperator << " " << sRight << ") ? 1.0 : 0.0;\n";
+            break;
+          case OP_LESS_EQUAL:
+            os << "(" << sLeft << " <= " << sRight << ") ? 1.0 : 0.0;\n";
+            break;
+          case OP_GREATER_EQUAL:
+            os << "(" << sLeft << " >= " << sRight << ") ? 1.0 : 0.0;\n";
+            break;
+          case OP_EQUAL:
+            os << "(" << sLeft << " == " << sRight << ") ? 1.0 : 0.0;\n";
+            break;
+          case OP_NOT_EQUAL:
+            os << "(" << sLeft << " != " << sRight << ") ? 1.0 : 0.0;\n";
+            break;
+          case OP_AND:
+            os << "(" << sLeft << " != 0.0 && " << sRight << " != 0.0) ? 1.0 : 0.0;\n";
+            break;
+          case OP_OR:
+            os << "(" << sLeft << " != 0.0 || " << sRight << " != 0.0) ? 1.0 : 0.0;\n";
+            break;
+        }
+        vText[n] = szLocal;
+        break;
+      }
+    }
+  }
+
+  if (bBatch)
+  {
+    os << szIndent << "pResults[Row] = " << vText.back() << ";\n"
+       << szIndent << "if (pErrNo)\n"
+       << szIndent << "  pErrNo[Row] = ERR_OK;\n";
+  }
+  else
+  {
+    os << szIndent << "if (pErrNo)\n"
+       << szIndent << "  *pErrNo = ERR_OK;\n"
+       << szIndent << "return " << vText.back() << ";\n";
+  }
+}
+
+void CCodeGenerator::WriteHeader(ostream &os, const char *szBaseName) const
+{
+  string sFileName = GetFileName(szBaseName);
+  string sIdentifier = GetIdentifier(szBaseName);
+  string sGuard = sIdentifier;
+
+  for (size_t i=0; i<sGuard.length(); i++)
+    sGuard[i] = (char)toupper((unsigned char)sGuard[i]);
+  sGuard += "_H_INCLUDED_";
+
+  os << "// " << sFileName << ".h :\n"
+     << "// Generated by CCodeGenerator (see codegenerator.h) from " << vFunction.size() << " expressions.\n"
+     << "// Do not edit; regenerate instead.\n"
+     << "\n"
+     << "#if !defined(" << sGuard << ")\n"
+     << "#define " << sGuard << "\n"
+     << "\n"
+     << "#if _MSC_VER > 1000\n"
+     << "#pragma once\n"
+     << "#endif // _MSC_VER > 1000\n"
+     << "\n"
+     << "#include <stddef.h>\n"
+     << "#include \"evaluator.h\"\n"
+     << "\n"
+     << "#if !defined(GENERATEDFUNCTION_DEFINED_)\n"
+     << "#define GENERATEDFUNCTION_DEFINED_\n"
+     << "typedef double (*tGENERATEDSCALAR)(const double *pValues, tERRNO *pErrNo);\n"
+     << "typedef void (*tGENERATEDBATCH)(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo);\n"
+     << "\n"
+     << "typedef struct tagGENERATEDFUNCTION\n"
+     << "{\n"
+     << "  const char *szName;\n"
+     << "  const char *szExpression;\n"
+     << "  const char *szVariables;   // Variable names, by slot\n"
+     << "  tGENERATEDSCALAR pScalar;\n"
+     << "  tGENERATEDBATCH pBatch;\n"
+     << "} tGENERATEDFUNCTION;\n"
+     << "#endif // !defined(GENERATEDFUNCTION_DEFINED_)\n"
+     << "\n";
+
+  for (size_t f=0; f<vFunction.size(); f++)
+  {
+    const tFUNCTION &Function = vFunction[f];
+
+    os << "// " << Function.sExpression << "\n"
+       << "extern const char " << Function.sName << "Variables[];\n"
+       << "double " << Function.sName << "(const double *pValues, tERRNO *pErrNo = NULL);\n"
+       << "void " << Function.sName << "Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);\n"
+       << "\n";
+  }
+
+  os << "// Every function above, then one with a NULL szName\n"
+     << "extern const tGENERATEDFUNCTION " << sIdentifier << "Functions[];\n"
+     << "\n"
+     << "#endif // !defined(" << sGuard << ")\n";
+}
+
+void CCodeGenerator::WriteSource(ostream &os, const char *szBaseName) const
+{
+  string sFileName = GetFileName(szBaseName);
+
+  os << "// " << sFileName << ".cpp :\n"
+     << "// Generated by CCodeGenerator (see codegenerator.h) from " << vFunction.size() << " expressions.\n"
+     << "// Do not edit; regenerate instead.\n"
+     << "// Compile without floating point contraction (/fp:precise, or -ffp-contract=off)\n"
+     << "// for results identical to the interpreter's.\n"
+     << "\n"
+     << "#include <math.h>\n"
+     << "#include \"" << sFileName << ".h\"\n";
+
+  for (size_t f=0; f<vFunction.size(); f++)
+  {
+    const tFUNCTION &Function = vFunction[f];
+    bool bVariables = UsesVariables(Function.Compiled);
+    string sVariables;
+
+    for (int i=0; i<Function.Compiled.GetNumberOfVariables(); i++)
+      sVariables += Function.Compiled.GetVariableName(i);
+
+    os << "\n"
+       << "////////////////////////////////////////////////////////////////////////////\n"
+       << "// " << Function.sExpression << "\n"
+       << "////////////////////////////////////////////////////////////////////////////\n"
+       << "const char " << Function.sName << "Variables[] = " << GetStringLiteral(sVariables) << ";\n"
+       << "\n"
+       << "double " << Function.sName << "(const double *" << (bVariables ? "pValues" : "") << ", tERRNO *pErrNo)\n"
+       << "{\n";
+    WriteBody(os, Function, false);
+    os << "}\n"
+       << "\n"
+       << "void " << Function.sName << "Batch(const double *const *" << (bVariables ? "ppColumns" : "")
+       << ", size_t nRows, double *pResults, tERRNO *pErrNo)\n"
+       << "{\n"
+       << "  for (size_t Row=0; Row<nRows; Row++)\n"
+       << "  {\n";
+    WriteBody(os, Function, true);
+    os << "  }\n"
+       << "}\n";
+  }
+
+  os << "\n"
+     << "const tGENERATEDFUNCTION " << GetIdentifier(szBaseName) << "Functions[] =\n"
+     << "{\n";
+  for (size_t f=0; f<vFunction.size(); f++)
+  {
+    const tFUNCTION &Function = vFunction[f];
+
+    os << "  { " << GetStringLiteral(Function.sName) << ", " << GetStringLiteral(Function.sExpression) << ", "
+       << Function.sName << "Variables, " << Function.sName << ", " << Function.sName << "Batch },\n";
+  }
+  os << "  { NULL, NULL, NULL, NULL, NULL }\n"
+     << "};\n";
+}
+
+bool CCodeGenerator::WriteFiles(const char *szBaseName) const
+{
+  ofstream Header((string(szBaseName) + ".h").c_str());
+  ofstream Source((string(szBaseName) + ".cpp").c_str());
+
+  if (!Header || !Source)
+    return false;
+  WriteHeader(Header, szBaseName);
+  WriteSource(Source, szBaseName);
+  return Header.good() && Source.good();
+}
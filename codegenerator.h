@@ -0,0 +1,81 @@
+// codegenerator.h :
+// Interface/Include file for codegenerator.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CCodeGenerator Class
+// Turns a set of expressions into C++ source (a header and a .cpp file), for
+// formulas which only change at release time and can be compiled into the
+// binary, doing away with both parsing and interpretation.
+//
+// Each expression is parsed by CEvaluator, as if it were to be evaluated, and
+// becomes two functions:
+//
+//   double Name(const double *pValues, tERRNO *pErrNo = NULL);
+//   void NameBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+//
+// which take their variables in the same slots as CCompiledExpression
+// (NameVariables[] gives the names by slot) and report errors the same way.
+// Every operation is a statement of its own, in the order the interpreter
+// does it, so results are identical as long as the generated code is compiled
+// without floating point contraction (/fp:precise, or -ffp-contract=off).
+//
+// The generated source also lists every function in <Base>Functions[], for
+// callers which look formulas up by name.
+//
+// Lags and windows (e.g. a[-1], see streamevaluator.h) are not supported:
+// AddFunction() fails with ERR_INVALID_HISTORY.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(CODEGENERATOR_H_INCLUDED_)
+#define CODEGENERATOR_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "compiledexpression.h"
+
+class CCodeGenerator
+{
+  public:
+    CCodeGenerator();
+    ~CCodeGenerator();
+
+    // szName must be a C++ identifier, and not already used.
+    // Returns false, leaving the set unchanged, if not or if szExpression has an error.
+    bool AddFunction(const char *szName, const char *szExpression);
+    tERRNO GetErrorNumber(void) const;                // ERR_UNKNOWN for a bad name
+    int GetNumberOfFunctions(void) const;
+
+    // szBaseName is the path without the extension, e.g. "rules/formulas"
+    // for rules/formulas.h and rules/formulas.cpp.
+    void WriteHeader(std::ostream &os, const char *szBaseName) const;
+    void WriteSource(std::ostream &os, const char *szBaseName) const;
+    bool WriteFiles(const char *szBaseName) const;   // false if either file cannot be written
+
+    static bool IsIdentifier(const char *szName);
+
+  private:
+    typedef struct tagFUNCTION
+    {
+      std::string sName;
+      std::string sExpression;
+      CCompiledExpression Compiled;
+    } tFUNCTION;
+
+    void WriteBody(std::ostream &os, const tFUNCTION &Function, bool bBatch) const;
+    static std::string GetFileName(const char *szBaseName);
+    static std::string GetIdentifier(const char *szBaseName);
+    static std::string GetLiteral(double lfValue);
+    static std::string GetStringLiteral(const std::string &s);
+    static bool UsesVariables(const CCompiledExpression &Compiled);
+
+    std::vector<tFUNCTION> vFunction;
+    tERRNO ErrNo;
+};
+
+#endif // !defined(CODEGENERATOR_H_INCLUDED_)
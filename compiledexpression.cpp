@@ -0,0 +1,3025 @@
+// compiledexpression.cpp :
+// Implementation of compiled expression class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+////////////////////////////////////////////////////////////////////////////////////////
+// The approach taken can be summarised as follows:
+// 1. Parse the expression to determine what variables are used, assigning each
+//    a slot in order of first appearance (as CEvaluator does).
+// 2. Parse the expression again with the same two stack (operand/operator)
+//    algorithm as CEvaluator::EvaluateExpression, but pushing node numbers
+//    onto the operand stack instead of values. Wherever the interpreter would
+//    calculate a result, a node is added instead. Because nodes are only ever
+//    added for operands at the top of the stack, they come out in post-order.
+//    Where the interpreter recurses for a brace, this keeps a stack of where
+//    each brace's operands and operators start (ParseExpression).
+// 3. Optionally rewrite the tree (e.g. COMPILE_REASSOCIATE), then put the
+//    nodes back into post-order (Linearise) ready for evaluation.
+// 4. Find the chains of operators over leaves which Evaluate() can run in
+//    a tight loop (PlanChains), then the smaller sub-trees it can run with
+//    a kernel of their own (PlanKernels).
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include "compiledexpression.h"
+#include "threadpool.h"
+
+using namespace std;
+
+// Operand stack entries kept on the (machine) stack during Evaluate().
+// Deeper expressions use a heap allocated operand stack.
+#define EVAL_LOCAL_STACK 64
+
+// Likewise for the terms of a balanced chain in EvaluateChain()
+#define CHAIN_LOCAL_TERMS 256
+
+// CompileAll() hands out expressions to its threads this many at a time
+#define COMPILE_ALL_BLOCK 64
+
+// Size of the arena on the stack for the temporaries of Compile() and Specialise().
+// Bigger expressions spill over to the default memory resource.
+#define COMPILE_SCRATCH_BYTES 8192
+
+// Rows evaluated together, node by node, while profiling
+#define PROFILE_BLOCK_ROWS 256
+
+// Rows in the batch CalibrateTileRows() times each tile size on, and times it is
+// timed (the fastest counts)
+#define TILE_CALIBRATE_ROWS    8192
+#define TILE_CALIBRATE_REPEATS 3
+
+// A step of Reassociate(): visit a node (copying it if it is a leaf), copy
+// a node over its already copied children, or balance a chain over its
+// already copied terms (vFlatTerm[iFirstTerm..+nTerms]).
+#define REASSOCIATE_VISIT   0
+#define REASSOCIATE_COPY    1
+#define REASSOCIATE_BALANCE 2
+
+typedef struct tagREASSOCIATESTEP
+{
+  int iNode;
+  int Action;
+  size_t iFirstTerm;
+  size_t nTerms;
+} tREASSOCIATESTEP;
+
+// Levels of a printed tree (PrintRanges(), PrintProfile()) shown by
+// indentation; deeper nodes give their level instead, so that a deep
+// expression does not print in space quadratic in its depth.
+#define PRINT_MAX_INDENT 32
+
+// Rows per tile in EvaluateBatch(); 0 until calibrated or set
+static atomic<size_t> TileRows(0);
+static mutex TileMutex;
+
+// The counts of each node while profiling, shared by copies of the object
+// as the memo cache is.
+struct CCompiledExpression::tagPROFILE
+{
+  std::mutex Mutex;                         // For vNode
+  std::vector<tNODEPROFILE> vNode;
+  std::atomic<unsigned long long> nBatches;
+  std::atomic<unsigned long long> nEvaluations;
+  std::atomic<unsigned long long> nTimedRows;
+  tPERFCOUNTS Hardware;                     // Over the timed rows, for vNode's Mutex too
+  unsigned long long nCountedRows;
+};
+
+// Hardware counters for the timed batches, opened on each thread's first use
+static CPerfCounters &GetThreadCounters(void)
+{
+  static thread_local CPerfCounters Counters;
+  static thread_local bool bOpened = false;
+
+  if (!bOpened)
+  {
+    Counters.Open();
+    bOpened = true;
+  }
+  return Counters;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CCompiledExpression implementation
+////////////////////////////////////////////////////////////////////////////
+CCompiledExpression::CCompiledExpression(pmr::memory_resource *pResource)
+  : vNode(pResource ? pResource : pmr::get_default_resource()),
+    vLiteral(pResource ? pResource : pmr::get_default_resource()),
+    vChain(pResource ? pResource : pmr::get_default_resource()),
+    vChainTerm(pResource ? pResource : pmr::get_default_resource()),
+    vKernel(pResource ? pResource : pmr::get_default_resource()),
+    vBound(pResource ? pResource : pmr::get_default_resource()),
+    vVariableName(pResource ? pResource : pmr::get_default_resource()),
+    vHistory(pResource ? pResource : pmr::get_default_resource())
+{
+  pScratch = pmr::get_default_resource();
+  pLiteralIndex = NULL;
+  uCompileFlags = COMPILE_DEFAULT;
+  MaxStackDepth = 0;
+  ErrNo = ERR_EMPTY_EXPRESSION; // Nothing compiled yet
+  ResultRange.lfLow = -HUGE_VAL;
+  ResultRange.lfHigh = HUGE_VAL;
+  nMemoCapacity = 0;
+  bProfile = false;
+}
+
+CCompiledExpression::~CCompiledExpression(void)
+{
+}
+
+tERRNO CCompiledExpression::GetErrorNumber(void) const
+{
+  return ErrNo;
+}
+
+int CCompiledExpression::GetNumberOfVariables(void) const
+{
+  return (int)vVariableName.size();
+}
+
+char CCompiledExpression::GetVariableName(int Slot) const
+{
+  return vVariableName[Slot];
+}
+
+int CCompiledExpression::GetVariableSlot(char VariableName) const
+{
+  for (size_t i=0; i<vVariableName.size(); i++)
+  {
+    if (vVariableName[i] == VariableName)
+      return (int)i;
+  }
+  return -1;
+}
+
+bool CCompiledExpression::HasHistory(void) const
+{
+  return !vHistory.empty();
+}
+
+bool CCompiledExpression::GetHistoryReference(int Slot, tHISTORYREF &Reference) const
+{
+  size_t iHistory = (unsigned char)vVariableName[Slot] - (unsigned char)HISTORY_FIRST_NAME;
+
+  if (iHistory >= vHistory.size())     // Including every letter, below HISTORY_FIRST_NAME
+    return false;
+  Reference = vHistory[iHistory];
+  return true;
+}
+
+string CCompiledExpression::GetVariableText(int Slot) const
+{
+  tHISTORYREF Reference;
+  char szReference[32];
+
+  if (!GetHistoryReference(Slot, Reference))
+    return string(1, vVariableName[Slot]);
+  if (Reference.Oldest == Reference.Newest)
+    snprintf(szReference, sizeof(szReference), "%c[-%d]", Reference.VariableName, Reference.Oldest);
+  else
+    snprintf(szReference, sizeof(szReference), "%c[-%d:%s%d]", Reference.VariableName, Reference.Oldest,
+             Reference.Newest ? "-" : "", Reference.Newest);
+  return szReference;
+}
+
+void CCompiledExpression::EnableMemo(size_t nCapacity)
+{
+  nMemoCapacity = nCapacity;
+  pMemo.reset(new CMemoCache(GetNumberOfVariables(), nCapacity));
+}
+
+void CCompiledExpression::DisableMemo(void)
+{
+  nMemoCapacity = 0;
+  pMemo.reset();
+}
+
+CMemoCache *CCompiledExpression::GetMemo(void) const
+{
+  return pMemo.get();
+}
+
+void CCompiledExpression::EnableProfile(void)
+{
+  bProfile = true;
+  pProfile.reset(new tagPROFILE);
+  pProfile->vNode.assign(vNode.size(), tNODEPROFILE());
+  pProfile->nBatches = 0;
+  pProfile->nEvaluations = 0;
+  pProfile->nTimedRows = 0;
+  CPerfCounters::ClearCounts(pProfile->Hardware);
+  pProfile->nCountedRows = 0;
+}
+
+void CCompiledExpression::DisableProfile(void)
+{
+  bProfile = false;
+  pProfile.reset();
+}
+
+bool CCompiledExpression::GetNodeProfile(int iNode, tNODEPROFILE &Profile) const
+{
+  if (!pProfile || iNode < 0 || iNode >= (int)vNode.size())
+    return false;
+
+  lock_guard<mutex> Lock(pProfile->Mutex);
+  Profile = pProfile->vNode[iNode];
+  return true;
+}
+
+bool CCompiledExpression::GetHardwareProfile(tPERFCOUNTS &Counts, unsigned long long &nRows) const
+{
+  if (!pProfile)
+    return false;
+
+  lock_guard<mutex> Lock(pProfile->Mutex);
+  Counts = pProfile->Hardware;
+  nRows = pProfile->nCountedRows;
+  return nRows > 0;
+}
+
+int CCompiledExpression::GetNumberOfNodes(void) const
+{
+  return (int)vNode.size();
+}
+
+const tNODE &CCompiledExpression::GetNode(int iNode) const
+{
+  return vNode[iNode];
+}
+
+int CCompiledExpression::GetRoot(void) const
+{
+  return (int)vNode.size() - 1;
+}
+
+int CCompiledExpression::GetNumberOfKernels(void) const
+{
+  return (int)vKernel.size();
+}
+
+const tKERNEL &CCompiledExpression::GetKernel(int iKernel) const
+{
+  return vKernel[iKernel];
+}
+
+const char *CCompiledExpression::GetKernelName(tKERNELTYPE Type) // static
+{
+  switch (Type)
+  {
+    case KERNEL_MUL_ADD:   return "multiply-add";
+    case KERNEL_ADD_MUL:   return "add-multiply";
+    case KERNEL_DOT2:      return "dot product";
+    case KERNEL_SUM_SCALE: return "sum-scale";
+    case KERNEL_SCALE_SUM: return "scale-sum";
+  }
+  return "unknown";
+}
+
+int CCompiledExpression::GetHeight(void) const
+{
+  vector<int> vHeight(vNode.size(), 0);
+  int Height = 0;
+
+  // Post-order means both children have been seen before their parent.
+  for (size_t i=0; i<vNode.size(); i++)
+  {
+    if (vNode[i].Type == NODE_NEGATE)
+      vHeight[i] = vHeight[vNode[i].iLeft] + 1;
+    else if (vNode[i].Type == NODE_OPERATOR)
+      vHeight[i] = max(vHeight[vNode[i].iLeft], vHeight[vNode[i].iRight]) + 1;
+    Height = vHeight[i];
+  }
+  return Height;
+}
+
+double CCompiledExpression::GetLiteral(int iLiteral) const
+{
+  return vLiteral[iLiteral];
+}
+
+int CCompiledExpression::GetNumberOfLiterals(void) const
+{
+  return (int)vLiteral.size();
+}
+
+size_t CCompiledExpression::GetMemoryUsage(void) const
+{
+  return sizeof(*this) +
+         vNode.capacity() * sizeof(tNODE) +
+         vLiteral.capacity() * sizeof(double) +
+         vChain.capacity() * sizeof(tCHAIN) +
+         vChainTerm.capacity() * sizeof(tCHAINTERM) +
+         vKernel.capacity() * sizeof(tKERNEL) +
+         vBound.capacity() * sizeof(tRANGE) +
+         vVariableName.capacity() +
+         vHistory.capacity() * sizeof(tHISTORYREF);
+}
+
+// iLeft is also the slot of a NODE_VARIABLE and the literal of a NODE_CONSTANT (see tNODE).
+static tNODE MakeNode(tNODETYPE Type, char cOperator, int iLeft, int iRight)
+{
+  tNODE Node;
+
+  Node.Type = (unsigned char)Type;
+  Node.cOperator = cOperator;
+  Node.Flags = 0;
+  Node.iLeft = iLeft;
+  Node.iRight = iRight;
+  return Node;
+}
+
+int CCompiledExpression::AddNode(tNODETYPE Type, char cOperator, int iLeft, int iRight)
+{
+  vNode.push_back(MakeNode(Type, cOperator, iLeft, iRight));
+  return (int)vNode.size() - 1;
+}
+
+int CCompiledExpression::AddConstant(double lfValue)
+// A NODE_CONSTANT, sharing the literal with any other of the same value.
+// Values are told apart by their bits, so that 0.0 and -0.0 stay distinct.
+{
+  unsigned long long Bits;
+  int iLiteral = -1;
+
+  memcpy(&Bits, &lfValue, sizeof(Bits));
+  if (pLiteralIndex)
+  {
+    pair<pmr::unordered_map<unsigned long long, int>::iterator, bool> Found =
+      pLiteralIndex->insert(make_pair(Bits, (int)vLiteral.size()));
+    iLiteral = Found.first->second;
+  }
+  else
+  {
+    for (size_t i=0; i<vLiteral.size() && iLiteral<0; i++)
+    {
+      if (memcmp(&vLiteral[i], &lfValue, sizeof(double)) == 0)
+        iLiteral = (int)i;
+    }
+    if (iLiteral < 0)
+      iLiteral = (int)vLiteral.size();
+  }
+  if (iLiteral == (int)vLiteral.size())
+    vLiteral.push_back(lfValue);
+  return AddNode(NODE_CONSTANT, 0, iLiteral, -1);
+}
+
+double CCompiledExpression::GetValue(const tNODE &Node) const
+{
+  return vLiteral[Node.iLiteral];
+}
+
+int CCompiledExpression::AddVariable(char ch)
+{
+  int Slot = GetVariableSlot(ch);
+
+  if (Slot < 0)
+  {
+    vVariableName.push_back(ch);
+    Slot = (int)vVariableName.size() - 1;
+  }
+  return Slot;
+}
+
+int CCompiledExpression::AddHistoryReference(char VariableName, int Oldest, int Newest)
+{
+  for (size_t i=0; i<vHistory.size(); i++)
+  {
+    if (vHistory[i].VariableName == VariableName && vHistory[i].Oldest == Oldest && vHistory[i].Newest == Newest)
+      return GetVariableSlot((char)(HISTORY_FIRST_NAME + i));
+  }
+  if (vHistory.size() >= HISTORY_MAX_REFERENCES)
+    return -1;
+
+  tHISTORYREF Reference = { VariableName, Oldest, Newest };
+  vHistory.push_back(Reference);
+  return AddVariable((char)(HISTORY_FIRST_NAME + vHistory.size() - 1));
+}
+
+// static
+// i is at the '[' after a variable name, and is left after the ']'. Accepts
+// [-k] and [-k:-j] with k >= j >= 0, and [0] for the current value.
+bool CCompiledExpression::ParseHistoryReference(const pmr::string &sExpr, size_t &i, int &Oldest, int &Newest)
+{
+  int aBack[2] = { 0, 0 };
+  int nBack = 0;
+
+  i++;
+  for (;;)
+  {
+    bool bMinus = false;
+    bool bDigits = false;
+    long Back = 0;
+
+    while (i < sExpr.length() && isspace(sExpr[i]))
+      i++;
+    if (i < sExpr.length() && sExpr[i] == '-')
+    {
+      bMinus = true;
+      i++;
+    }
+    while (i < sExpr.length() && isdigit(sExpr[i]))
+    {
+      if (Back <= HISTORY_MAX_SAMPLES)
+        Back = Back * 10 + (sExpr[i] - '0');
+      bDigits = true;
+      i++;
+    }
+    while (i < sExpr.length() && isspace(sExpr[i]))
+      i++;
+    // Only samples already seen: a[1] would be the future
+    if (!bDigits || (!bMinus && Back != 0) || Back > HISTORY_MAX_SAMPLES || i >= sExpr.length())
+      return false;
+    aBack[nBack++] = (int)Back;
+    if (sExpr[i] == ']')
+      break;
+    if (sExpr[i] != ':' || nBack == 2)
+      return false;
+    i++;
+  }
+  i++;
+  Oldest = aBack[0];
+  Newest = (nBack == 2) ? aBack[1] : aBack[0];
+  return Oldest >= Newest;
+}
+
+bool CCompiledExpression::Compile(const char *szExpression, unsigned int uFlags)
+{
+  char aScratch[COMPILE_SCRATCH_BYTES];
+  pmr::monotonic_buffer_resource Scratch(aScratch, sizeof(aScratch));
+  bool bCompiled;
+
+  {
+    pmr::unordered_map<unsigned long long, int> mLiteralIndex(&Scratch);
+
+    pScratch = &Scratch;
+    pLiteralIndex = &mLiteralIndex;
+    bCompiled = CompileExpression(szExpression, uFlags);
+    pLiteralIndex = NULL;
+    pScratch = pmr::get_default_resource();
+  }
+  return bCompiled;
+}
+
+bool CCompiledExpression::CompileExpression(const char *szExpression, unsigned int uFlags)
+{
+  pmr::string sExpr(szExpression, pScratch);
+  int PosOfLastVariable = -2;
+  int depth = 0;
+  size_t nTokens = 0;
+  int iRoot;
+
+  vNode.clear();
+  vLiteral.clear();
+  vChain.clear();
+  vChainTerm.clear();
+  vKernel.clear();
+  vBound.clear();
+  vVariableName.clear();
+  vHistory.clear();
+  ResultRange.lfLow = -HUGE_VAL;
+  ResultRange.lfHigh = HUGE_VAL;
+  uCompileFlags = uFlags;
+  MaxStackDepth = 0;
+  ErrNo = ERR_OK;
+  pMemo.reset(); // Any results cached belong to the old expression
+  pProfile.reset();
+
+  // First pass - the same checks as CEvaluator::ParseExpressionForVariableNames(),
+  // allocating variable slots as we go.
+  if (sExpr.length() == 0)
+  {
+    ErrNo = ERR_EMPTY_EXPRESSION;
+    return false;
+  }
+  for (size_t n=0; n<sExpr.length(); n++)
+  {
+    char ch = sExpr[n];
+
+    if (isalpha(ch))
+    {
+      size_t Next = n + 1;
+      int Oldest = 0;
+      int Newest = 0;
+
+      if ((int)n == PosOfLastVariable+1)
+      {
+        ErrNo = ERR_VARNAME_TOO_LONG;
+        return false;
+      }
+      PosOfLastVariable = (int)n;
+      nTokens++;
+      while (Next < sExpr.length() && isspace(sExpr[Next]))
+        Next++;
+      if (Next < sExpr.length() && sExpr[Next] == '[')
+      {
+        if (!ParseHistoryReference(sExpr, Next, Oldest, Newest) ||
+            (Oldest > 0 && AddHistoryReference(ch, Oldest, Newest) < 0))
+        {
+          ErrNo = ERR_INVALID_HISTORY;
+          return false;
+        }
+        n = Next - 1;
+      }
+      if (Oldest == 0)
+        AddVariable(ch);
+    }
+    else if (ch=='(')
+      depth++;
+    else if (ch==')')
+      depth--;
+    else if (CEvaluator::IsOperator(ch) || (isdigit(ch) && (n == 0 || !isdigit(sExpr[n-1]))))
+      nTokens++;
+  }
+  if (depth != 0)
+  {
+    ErrNo = ERR_UMATCHED_BRACES;
+    return false;
+  }
+
+  // Second pass - build the tree. Each variable, number and operator character
+  // makes at most one node, so the nodes need only one allocation.
+  vNode.reserve(nTokens);
+  if (!ParseExpression(sExpr, iRoot))
+  {
+    vNode.clear();
+    vLiteral.clear();
+    return false;
+  }
+
+  if (uFlags & COMPILE_REASSOCIATE)
+  {
+    pmr::vector<tNODE> vOut(pScratch);
+    iRoot = Reassociate(iRoot, vOut);
+    vNode.assign(vOut.begin(), vOut.end());
+  }
+
+  Linearise(iRoot);
+  if (nMemoCapacity)
+    pMemo.reset(new CMemoCache(GetNumberOfVariables(), nMemoCapacity));
+  if (bProfile)
+    EnableProfile();
+  return true;
+}
+
+bool CCompiledExpression::CompileAll(const vector<string> &vExpression,
+                                     vector<CCompiledExpression> &vCompiled,
+                                     vector<tERRNO> &vErrNo,
+                                     unsigned int uFlags, int nThreads,
+                                     pmr::memory_resource *pResource) // static
+{
+  size_t nExpressions = vExpression.size();
+  size_t nBlocks = (nExpressions + COMPILE_ALL_BLOCK - 1) / COMPILE_ALL_BLOCK;
+  atomic<size_t> NextBlock(0);
+  atomic<bool> bAllOK(true);
+
+  // Sized up front, so that each thread only ever touches its own elements.
+  vCompiled.clear();
+  vCompiled.reserve(nExpressions);
+  for (size_t i=0; i<nExpressions; i++)
+    vCompiled.emplace_back(pResource);
+  vErrNo.assign(nExpressions, ERR_OK);
+
+  if (nThreads <= 0)
+    nThreads = CThreadPool::GetDefaultNumberOfThreads();
+  if ((size_t)nThreads > nBlocks)
+    nThreads = (int)nBlocks;
+
+  // Expressions vary in length, so rather than give each thread a fixed
+  // share, each takes the next block as soon as it is free.
+  function<void()> Worker = [&]()
+  {
+    size_t Block;
+    bool bOK = true;
+
+    while ((Block = NextBlock.fetch_add(1)) < nBlocks)
+    {
+      size_t End = min(nExpressions, (Block + 1) * COMPILE_ALL_BLOCK);
+
+      for (size_t i=Block*COMPILE_ALL_BLOCK; i<End; i++)
+      {
+        if (!vCompiled[i].Compile(vExpression[i].c_str(), uFlags))
+        {
+          vErrNo[i] = vCompiled[i].GetErrorNumber();
+          bOK = false;
+        }
+      }
+    }
+    if (!bOK)
+      bAllOK = false;
+  };
+
+  if (nThreads <= 1)
+    Worker();
+  else
+  {
+    CThreadPool Pool(nThreads);
+
+    for (int t=0; t<nThreads; t++)
+      Pool.Submit(Worker);
+    Pool.Wait();
+  }
+  return bAllOK;
+}
+
+bool CCompiledExpression::ProcessOperators(pmr::vector<int> &vOperand, pmr::vector<char> &vOperator,
+                                           size_t OperandBase, size_t OperatorBase, int MinPrecedence)
+{
+  // As CEvaluator::ProcessOperators(), but building nodes rather than calculating,
+  // and only over the stack entries from the bases up (those of the innermost brace).
+  while (vOperator.size() > OperatorBase && CEvaluator::GetPrecedence(vOperator.back()) >= MinPrecedence)
+  {
+    if (vOperand.size() < OperandBase + 2)
+    {
+      ErrNo = ERR_OPERAND_EXPECTED;
+      return false;
+    }
+
+    char Operator = vOperator.back();
+    vOperator.pop_back();
+    int iOperand1 = vOperand.back();
+    vOperand.pop_back();
+    int iOperand2 = vOperand.back();
+    vOperand.pop_back();
+
+    vOperand.push_back(AddNode(NODE_OPERATOR, Operator, iOperand2, iOperand1));
+  }
+  return true;
+}
+
+bool CCompiledExpression::ParseExpression(const pmr::string &sExpr, int &iResult)
+// As CEvaluator::EvaluateExpression(), but without recursing for each '(':
+// an open brace starts a new level on the same stacks, and its close brace
+// finishes it.
+{
+  typedef struct tagBRACE
+  {
+    size_t OperandBase;          // Of the level outside the brace, to go back to
+    size_t OperatorBase;
+    bool NegateResult;           // A unary minus before the brace
+  } tBRACE;
+
+  tSTATE state = STATE_EXPECT_OPERAND;
+  bool NegateNextOperand = false;
+  pmr::vector<int> vOperand(pScratch);
+  pmr::vector<char> vOperator(pScratch);
+  pmr::vector<tBRACE> vBrace(pScratch);
+  size_t OperandBase = 0;        // Where the innermost brace's entries start
+  size_t OperatorBase = 0;
+  size_t i = 0;
+
+  while (i < sExpr.length())
+  {
+    char ch = sExpr[i];
+
+    if (isspace(ch)) // Ignore all spaces
+    {
+      i++;
+      continue;
+    }
+
+    switch (state)
+    {
+      case STATE_EXPECT_OPERAND:
+        if (ch == '(')
+        {
+          tBRACE Brace = { OperandBase, OperatorBase, NegateNextOperand };
+
+          i++;
+          vBrace.push_back(Brace);
+          NegateNextOperand = false;
+          OperandBase = vOperand.size();
+          OperatorBase = vOperator.size();
+        }
+        else if (ch == '-') // Unary Minus
+        {
+          i++;
+          NegateNextOperand = true;
+        }
+        else if (isalpha(ch)) // Variable, or a lag or window of one
+        {
+          int Slot = GetVariableSlot(ch);
+          size_t Next = i + 1;
+          int Oldest = 0;
+          int Newest = 0;
+
+          while (Next < sExpr.length() && isspace(sExpr[Next]))
+            Next++;
+          if (Next < sExpr.length() && sExpr[Next] == '[')
+          {
+            ParseHistoryReference(sExpr, Next, Oldest, Newest);   // Checked in the first pass
+            if (Oldest > 0)
+              Slot = AddHistoryReference(ch, Oldest, Newest);
+            i = Next - 1;
+          }
+
+          int iNode = AddNode(NODE_VARIABLE, 0, Slot, -1);
+
+          i++;
+          if (NegateNextOperand)
+          {
+            iNode = AddNode(NODE_NEGATE, 0, iNode, -1);
+            NegateNextOperand = false;
+          }
+          vOperand.push_back(iNode);
+          state = STATE_EXPECT_OPERATOR;
+        }
+        else if (isdigit(ch)) // Numeric constant
+        {
+          size_t Start = i;
+          double value;
+
+          while (i < sExpr.length() && (isdigit(sExpr[i]) || sExpr[i]=='.'))
+            i++;
+          value = atof(pmr::string(sExpr, Start, i - Start, pScratch).c_str());
+          if (NegateNextOperand)
+          {
+            value = -value;
+            NegateNextOperand = false;
+          }
+          vOperand.push_back(AddConstant(value));
+          state = STATE_EXPECT_OPERATOR;
+        }
+        else
+        {
+          ErrNo = ERR_OPERAND_EXPECTED;
+          return false;
+        }
+        break;
+
+      case STATE_EXPECT_OPERATOR:
+        if (ch == ')')
+        {
+          if (vBrace.empty())
+          {
+            ErrNo = ERR_UMATCHED_BRACES;
+            return false;
+          }
+          i++;
+          if (!ProcessOperators(vOperand, vOperator, OperandBase, OperatorBase))
+            return false;
+          if (vOperand.size() != OperandBase + 1)
+          {
+            ErrNo = ERR_TOO_MANY_OPERANDS;
+            return false;
+          }
+          if (vBrace.back().NegateResult)
+            vOperand.back() = AddNode(NODE_NEGATE, 0, vOperand.back(), -1);
+          OperandBase = vBrace.back().OperandBase;
+          OperatorBase = vBrace.back().OperatorBase;
+          vBrace.pop_back();
+        }
+        else if (CEvaluator::IsOperator(ch))
+        {
+          char cOperator;
+          int OperatorLength = CEvaluator::GetOperator(sExpr.c_str() + i, cOperator);
+
+          if (OperatorLength == 0)
+          {
+            ErrNo = ERR_UNKNOWN_OPERATOR;
+            return false;
+          }
+          if (vOperator.size() > OperatorBase && CEvaluator::GetPrecedence(cOperator) < PRECEDENCE_MULTIPLICATIVE)
+          {
+            if (!ProcessOperators(vOperand, vOperator, OperandBase, OperatorBase, CEvaluator::GetPrecedence(cOperator)))
+              return false;
+          }
+          vOperator.push_back(cOperator);
+          i += OperatorLength;
+          state = STATE_EXPECT_OPERAND;
+        }
+        else
+        {
+          ErrNo = ERR_OPERATOR_EXPECTED;
+          return false;
+        }
+        break;
+    }
+  }
+
+  if (state == STATE_EXPECT_OPERAND) // Trailing operator, or nothing between braces
+  {
+    ErrNo = ERR_OPERAND_EXPECTED;
+    return false;
+  }
+  if (!vBrace.empty())
+  {
+    ErrNo = ERR_UMATCHED_BRACES;
+    return false;
+  }
+  if (!ProcessOperators(vOperand, vOperator, 0, 0))
+    return false;
+  if (vOperand.size() != 1)
+  {
+    ErrNo = ERR_TOO_MANY_OPERANDS;
+    return false;
+  }
+
+  iResult = vOperand.back();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Tree-height reduction (COMPILE_REASSOCIATE)
+// The interpreter evaluates a+b+c+d as ((a+b)+c)+d, a chain of dependent
+// additions each of which must wait for the one before. The same sum as
+// (a+b)+(c+d) has two independent additions which the CPU can overlap.
+// A chain of + and - is flattened into its positive and negative terms,
+// each of which is summed as a balanced tree, i.e. (P1+P2+...) - (N1+N2+...).
+// Chains of * are treated likewise. / is not associative, so is left alone.
+////////////////////////////////////////////////////////////////////////////
+int CCompiledExpression::Balance(pmr::vector<int> &vTerm, char cOperator, pmr::vector<tNODE> &vOut)
+{
+  pmr::vector<int> vNext(pScratch);
+
+  while (vTerm.size() > 1)
+  {
+    vNext.clear();
+    for (size_t i=0; i+1<vTerm.size(); i+=2)
+    {
+      vOut.push_back(MakeNode(NODE_OPERATOR, cOperator, vTerm[i], vTerm[i+1]));
+      vNext.push_back((int)vOut.size() - 1);
+    }
+    if (vTerm.size() % 2)
+      vNext.push_back(vTerm.back());
+    vTerm.swap(vNext);
+  }
+  return vTerm[0];
+}
+
+int CCompiledExpression::Reassociate(int iRoot, pmr::vector<tNODE> &vOut)
+// Copies the tree at iRoot into vOut, rebalancing chains on the way.
+// Nodes in vOut are not in post-order; Linearise() sorts that out.
+// Works from a stack of its own rather than recursing, since an expression
+// may nest as deep as it is long.
+{
+  pmr::vector<tREASSOCIATESTEP> vStep(pScratch);
+  pmr::vector<pair<int,bool> > vFlatTerm(pScratch);   // (node, negated), of every chain in turn
+  pmr::vector<pair<int,bool> > vStack(pScratch);      // (node, negated)
+  pmr::vector<int> vResult(pScratch);                 // In vOut, of each node copied
+  pmr::vector<int> vPositive(pScratch);
+  pmr::vector<int> vNegative(pScratch);
+  tREASSOCIATESTEP Step = { iRoot, REASSOCIATE_VISIT, 0, 0 };
+
+  vStep.push_back(Step);
+  while (!vStep.empty())
+  {
+    Step = vStep.back();
+    vStep.pop_back();
+    tNODE Node = vNode[Step.iNode];
+
+    if (Step.Action == REASSOCIATE_VISIT)
+    {
+      if (Node.Type == NODE_NEGATE)
+      {
+        Step.Action = REASSOCIATE_COPY;
+        vStep.push_back(Step);
+        Step.iNode = Node.iLeft;
+        Step.Action = REASSOCIATE_VISIT;
+        vStep.push_back(Step);
+        continue;
+      }
+      if (Node.Type != NODE_OPERATOR)
+      {
+        vOut.push_back(Node);
+        vResult.push_back((int)vOut.size() - 1);
+        continue;
+      }
+
+      // Flatten the chain, keeping the terms in left to right order.
+      bool Additive = (Node.cOperator == '+' || Node.cOperator == '-');
+      size_t iFirstTerm = vFlatTerm.size();
+
+      vStack.clear();
+      vStack.push_back(make_pair(Step.iNode, false));
+      while (!vStack.empty())
+      {
+        int n = vStack.back().first;
+        bool Negated = vStack.back().second;
+        vStack.pop_back();
+
+        const tNODE &Term = vNode[n];
+        if (Term.Type == NODE_OPERATOR &&
+            ((Additive && (Term.cOperator == '+' || Term.cOperator == '-')) ||
+             (!Additive && Term.cOperator == '*' && Node.cOperator == '*')))
+        {
+          vStack.push_back(make_pair(Term.iRight, (Term.cOperator == '-') ? !Negated : Negated));
+          vStack.push_back(make_pair(Term.iLeft, Negated));
+        }
+        else
+          vFlatTerm.push_back(make_pair(n, Negated));
+      }
+
+      // The children, or the terms, are copied first, left to right
+      size_t nTerms = vFlatTerm.size() - iFirstTerm;
+      if (nTerms < CHAIN_MIN_TERMS)
+      {
+        vFlatTerm.resize(iFirstTerm);
+        Step.Action = REASSOCIATE_COPY;
+        vStep.push_back(Step);
+        Step.Action = REASSOCIATE_VISIT;
+        Step.iNode = Node.iRight;
+        vStep.push_back(Step);
+        Step.iNode = Node.iLeft;
+        vStep.push_back(Step);
+      }
+      else
+      {
+        Step.Action = REASSOCIATE_BALANCE;
+        Step.iFirstTerm = iFirstTerm;
+        Step.nTerms = nTerms;
+        vStep.push_back(Step);
+        for (size_t i=nTerms; i-->0; )
+        {
+          tREASSOCIATESTEP TermStep = { vFlatTerm[iFirstTerm + i].first, REASSOCIATE_VISIT, 0, 0 };
+          vStep.push_back(TermStep);
+        }
+      }
+      continue;
+    }
+
+    if (Step.Action == REASSOCIATE_COPY)
+    {
+      // The node itself, over its copied children
+      if (Node.Type == NODE_OPERATOR)
+      {
+        Node.iRight = vResult.back();
+        vResult.pop_back();
+      }
+      Node.iLeft = vResult.back();
+      vResult.pop_back();
+      vOut.push_back(Node);
+      vResult.push_back((int)vOut.size() - 1);
+      continue;
+    }
+
+    // REASSOCIATE_BALANCE: the copied terms, (P1+P2+...) - (N1+N2+...)
+    bool Additive = (Node.cOperator == '+' || Node.cOperator == '-');
+    size_t iFirstResult = vResult.size() - Step.nTerms;
+    int iPositive = -1;
+    int iNegative = -1;
+    int iChain;
+
+    vPositive.clear();
+    vNegative.clear();
+    for (size_t i=0; i<Step.nTerms; i++)
+    {
+      if (vFlatTerm[Step.iFirstTerm + i].second)
+        vNegative.push_back(vResult[iFirstResult + i]);
+      else
+        vPositive.push_back(vResult[iFirstResult + i]);
+    }
+    vResult.resize(iFirstResult);
+    if (!vPositive.empty())
+      iPositive = Balance(vPositive, Additive ? '+' : '*', vOut);
+    if (!vNegative.empty())
+      iNegative = Balance(vNegative, '+', vOut);
+
+    if (iNegative < 0)
+      iChain = iPositive;
+    else if (iPositive < 0)
+    {
+      vOut.push_back(MakeNode(NODE_NEGATE, 0, iNegative, -1));
+      iChain = (int)vOut.size() - 1;
+    }
+    else
+    {
+      Node.cOperator = '-';
+      Node.iLeft = iPositive;
+      Node.iRight = iNegative;
+      vOut.push_back(Node);
+      iChain = (int)vOut.size() - 1;
+    }
+    vResult.push_back(iChain);
+  }
+  return vResult.back();
+}
+
+void CCompiledExpression::Linearise(int iRoot)
+// Reorders the nodes reachable from iRoot into post-order and works out
+// how deep the operand stack gets when they are evaluated in that order.
+{
+  pmr::vector<tNODE> vOut(pScratch);
+  pmr::vector<int> vNewIndex(vNode.size(), -1, pScratch);
+  pmr::vector<pair<int,bool> > vStack(pScratch);     // (node, children already pushed)
+  int Depth = 0;
+
+  vOut.reserve(vNode.size());
+  MaxStackDepth = 0;
+
+  vStack.push_back(make_pair(iRoot, false));
+  while (!vStack.empty())
+  {
+    int n = vStack.back().first;
+    bool ChildrenDone = vStack.back().second;
+    tNODE Node = vNode[n];
+
+    if (!ChildrenDone && Node.Type != NODE_CONSTANT && Node.Type != NODE_VARIABLE)
+    {
+      vStack.back().second = true;
+      if (Node.Type == NODE_OPERATOR)
+        vStack.push_back(make_pair(Node.iRight, false));
+      vStack.push_back(make_pair(Node.iLeft, false));
+      continue;
+    }
+    vStack.pop_back();
+
+    if (Node.Type == NODE_CONSTANT || Node.Type == NODE_VARIABLE)
+    {
+      Depth++;
+    }
+    else
+    {
+      Node.iLeft = vNewIndex[Node.iLeft];
+      if (Node.Type == NODE_OPERATOR)
+      {
+        Node.iRight = vNewIndex[Node.iRight];
+        Depth--;
+      }
+    }
+    if (Depth > MaxStackDepth)
+      MaxStackDepth = Depth;
+
+    vOut.push_back(Node);
+    vNewIndex[n] = (int)vOut.size() - 1;
+  }
+
+  // Copied rather than swapped, so that vNode stays in its own memory
+  // resource; it is never smaller, so this does not allocate.
+  vNode.assign(vOut.begin(), vOut.end());
+  PlanChains();
+  PlanKernels();
+  AnalyseRanges();
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Specialisation
+// Bound variables become constants, then any operator whose operands are now
+// all constant is evaluated here, once, instead of on every Evaluate().
+// Only exact rewrites are made, so that the residual gives bit for bit the
+// same results: constant sub-trees are folded, and x*1, 1*x, x/1 and x-0
+// reduce to x. (x+0 does not, since -0.0 + 0 is +0.0.) Chains such as
+// a+1+b+2 keep both constants, as combining them would change the rounding.
+// A constant division by zero is left in place, so that evaluating the
+// residual still reports ERR_DIVIDE_BY_ZERO.
+////////////////////////////////////////////////////////////////////////////
+static bool IsConstant(const tNODE &Node, const pmr::vector<double> &vLiteral, double lfValue)
+{
+  return Node.Type == NODE_CONSTANT && vLiteral[Node.iLiteral] == lfValue;
+}
+
+bool CCompiledExpression::Specialise(const vector<CVariable> &vBinding, CCompiledExpression &Residual) const
+{
+  char aScratch[COMPILE_SCRATCH_BYTES];
+  pmr::monotonic_buffer_resource Scratch(aScratch, sizeof(aScratch));
+  pmr::vector<int> vNewSlot(vVariableName.size(), -1, &Scratch);
+  pmr::vector<bool> vIsBound(vVariableName.size(), false, &Scratch);
+  pmr::vector<double> vBoundValue(vVariableName.size(), 0.0, &Scratch);
+  pmr::vector<int> vNewIndex(vNode.size(), -1, &Scratch);
+  pmr::unordered_map<unsigned long long, int> mLiteralIndex(&Scratch);
+
+  Residual.vNode.clear();
+  Residual.vLiteral.clear();
+  Residual.vChain.clear();
+  Residual.vChainTerm.clear();
+  Residual.vKernel.clear();
+  Residual.vBound.clear();
+  Residual.vVariableName.clear();
+  Residual.vHistory.assign(vHistory.begin(), vHistory.end());
+  Residual.uCompileFlags = uCompileFlags;
+  Residual.MaxStackDepth = 0;
+  Residual.pMemo.reset();
+  Residual.pProfile.reset();
+  Residual.ErrNo = ErrNo;
+  if (vNode.empty())
+    return false;
+
+  for (size_t i=0; i<vBinding.size(); i++)
+  {
+    CVariable Binding = vBinding[i];
+    int Slot = GetVariableSlot(Binding.GetName());
+
+    if (Slot >= 0)
+    {
+      vIsBound[Slot] = true;
+      vBoundValue[Slot] = Binding.GetValue();
+    }
+  }
+  for (size_t Slot=0; Slot<vVariableName.size(); Slot++)
+  {
+    if (!vIsBound[Slot])
+    {
+      vNewSlot[Slot] = Residual.AddVariable(vVariableName[Slot]);
+      if (Slot < vBound.size())
+        Residual.vBound.push_back(vBound[Slot]);
+    }
+  }
+
+  // Post-order, so each node's operands have already been rewritten.
+  Residual.vNode.reserve(vNode.size());
+  Residual.pLiteralIndex = &mLiteralIndex;
+  for (size_t n=0; n<vNode.size(); n++)
+  {
+    const tNODE &Node = vNode[n];
+    int iNew;
+
+    switch (Node.Type)
+    {
+      case NODE_CONSTANT:
+        iNew = Residual.AddConstant(GetValue(Node));
+        break;
+
+      case NODE_VARIABLE:
+        if (vIsBound[Node.iVariable])
+          iNew = Residual.AddConstant(vBoundValue[Node.iVariable]);
+        else
+          iNew = Residual.AddNode(NODE_VARIABLE, 0, vNewSlot[Node.iVariable], -1);
+        break;
+
+      case NODE_NEGATE:
+      {
+        int iOperand = vNewIndex[Node.iLeft];
+
+        if (Residual.vNode[iOperand].Type == NODE_CONSTANT)
+          iNew = Residual.AddConstant(-Residual.GetValue(Residual.vNode[iOperand]));
+        else
+          iNew = Residual.AddNode(NODE_NEGATE, 0, iOperand, -1);
+        break;
+      }
+
+      default: // NODE_OPERATOR
+      {
+        int iLeft = vNewIndex[Node.iLeft];
+        int iRight = vNewIndex[Node.iRight];
+        const tNODE Left = Residual.vNode[iLeft];
+        const tNODE Right = Residual.vNode[iRight];
+
+        if (Left.Type == NODE_CONSTANT && Right.Type == NODE_CONSTANT &&
+            !(Node.cOperator == '/' && Residual.GetValue(Right) == 0.0))
+        {
+          double lfValue = CEvaluator::ApplyOperator(Node.cOperator, Residual.GetValue(Left), Residual.GetValue(Right));
+          iNew = Residual.AddConstant(lfValue);
+        }
+        else if ((Node.cOperator == '*' || Node.cOperator == '/') && IsConstant(Right, Residual.vLiteral, 1.0))
+          iNew = iLeft;
+        else if (Node.cOperator == '*' && IsConstant(Left, Residual.vLiteral, 1.0))
+          iNew = iRight;
+        else if (Node.cOperator == '-' && IsConstant(Right, Residual.vLiteral, 0.0) && !signbit(Residual.GetValue(Right)))
+          iNew = iLeft;
+        else
+          iNew = Residual.AddNode(NODE_OPERATOR, Node.cOperator, iLeft, iRight);
+        break;
+      }
+    }
+    vNewIndex[n] = iNew;
+  }
+  Residual.pLiteralIndex = NULL;
+
+  // Folded operands are left behind, unreferenced; Linearise() drops them
+  // (though not their literals).
+  Residual.pScratch = &Scratch;
+  Residual.Linearise(vNewIndex[vNode.size()-1]);
+  Residual.pScratch = pmr::get_default_resource();
+  if (Residual.nMemoCapacity)
+    Residual.pMemo.reset(new CMemoCache(Residual.GetNumberOfVariables(), Residual.nMemoCapacity));
+  if (Residual.bProfile)
+    Residual.EnableProfile();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Chains
+// Evaluating node by node costs a dispatch (switch) per node, which hides
+// any benefit of a balanced tree. So long chains over leaves are found here
+// and evaluated by EvaluateChain() in a loop instead, with exactly the same
+// grouping, and so the same rounding, as the tree.
+////////////////////////////////////////////////////////////////////////////
+static bool IsLeaf(const tNODE &Node)
+{
+  return Node.Type == NODE_CONSTANT || Node.Type == NODE_VARIABLE;
+}
+
+static tCHAINTERM MakeChainTerm(const tNODE &Node, const pmr::vector<double> &vLiteral, char cOperator)
+{
+  tCHAINTERM Term;
+
+  Term.cOperator = cOperator;
+  Term.iVariable = (Node.Type == NODE_VARIABLE) ? Node.iVariable : -1;
+  Term.lfValue = (Node.Type == NODE_CONSTANT) ? vLiteral[Node.iLiteral] : 0.0;
+  return Term;
+}
+
+// The shape Balance() builds for nTerms leaves, as a post-order
+// sequence of leaves (true) and operators (false).
+static void PairwiseShape(int nTerms, pmr::vector<bool> &vShape)
+{
+  pmr::memory_resource *pScratch = vShape.get_allocator().resource();
+  pmr::vector<pair<int,int> > vChildren(nTerms, make_pair(-1, -1), pScratch);
+  pmr::vector<int> vTerm(pScratch);
+  pmr::vector<int> vNext(pScratch);
+  pmr::vector<pair<int,bool> > vStack(pScratch);
+
+  for (int i=0; i<nTerms; i++)
+    vTerm.push_back(i);
+  while (vTerm.size() > 1)
+  {
+    vNext.clear();
+    for (size_t i=0; i+1<vTerm.size(); i+=2)
+    {
+      vChildren.push_back(make_pair(vTerm[i], vTerm[i+1]));
+      vNext.push_back((int)vChildren.size() - 1);
+    }
+    if (vTerm.size() % 2)
+      vNext.push_back(vTerm.back());
+    vTerm.swap(vNext);
+  }
+
+  vShape.clear();
+  vStack.push_back(make_pair(vTerm[0], false));
+  while (!vStack.empty())
+  {
+    int n = vStack.back().first;
+    if (vChildren[n].first >= 0 && !vStack.back().second)
+    {
+      vStack.back().second = true;
+      vStack.push_back(make_pair(vChildren[n].second, false));
+      vStack.push_back(make_pair(vChildren[n].first, false));
+      continue;
+    }
+    vStack.pop_back();
+    vShape.push_back(vChildren[n].first < 0);
+  }
+}
+
+void CCompiledExpression::PlanChains(void)
+{
+  int nNodes = (int)vNode.size();
+  pmr::vector<int> vSize(nNodes, 0, pScratch);          // Nodes in the sub-tree
+  pmr::vector<int> vLeftDeep(nNodes, 0, pScratch);      // Terms, if the node roots a left-deep chain
+  pmr::vector<int> vRightDeep(nNodes, 0, pScratch);     // Terms, if the node roots a right-deep chain
+  pmr::vector<int> vUniform(nNodes, 0, pScratch);       // Leaves, if the node roots a tree of one operator over leaves
+  pmr::vector<bool> vShape(pScratch);
+
+  vChain.clear();
+  vChainTerm.clear();
+
+  for (int i=0; i<nNodes; i++)
+  {
+    const tNODE &Node = vNode[i];
+
+    if (IsLeaf(Node))
+    {
+      vSize[i] = 1;
+      vLeftDeep[i] = 1;
+      vRightDeep[i] = 1;
+      vUniform[i] = 1;
+    }
+    else if (Node.Type == NODE_NEGATE)
+    {
+      vSize[i] = vSize[Node.iLeft] + 1;
+    }
+    else
+    {
+      int l = Node.iLeft;
+      int r = Node.iRight;
+      bool ChainOperator = (Node.cOperator == '+' || Node.cOperator == '-' || Node.cOperator == '*');
+
+      vSize[i] = vSize[l] + vSize[r] + 1;
+      if (ChainOperator && vLeftDeep[l] > 0 && IsLeaf(vNode[r]))
+        vLeftDeep[i] = vLeftDeep[l] + 1;
+      if (ChainOperator && vRightDeep[r] > 0 && IsLeaf(vNode[l]))
+        vRightDeep[i] = vRightDeep[r] + 1;
+      if ((Node.cOperator == '+' || Node.cOperator == '*') && vUniform[l] > 0 && vUniform[r] > 0 &&
+          (IsLeaf(vNode[l]) || vNode[l].cOperator == Node.cOperator) &&
+          (IsLeaf(vNode[r]) || vNode[r].cOperator == Node.cOperator))
+        vUniform[i] = vUniform[l] + vUniform[r];
+    }
+  }
+
+  // Scan from the root down, so that only the largest chains are taken.
+  int CoveredFrom = nNodes;
+  for (int i=nNodes-1; i>=0; i--)
+  {
+    tCHAIN Chain;
+
+    if (i >= CoveredFrom)
+      continue;
+
+    Chain.iFirst = i - vSize[i] + 1;
+    Chain.iRoot = i;
+    Chain.cOperator = vNode[i].cOperator;
+    Chain.iFirstTerm = (int)vChainTerm.size();
+
+    if (vLeftDeep[i] >= CHAIN_MIN_TERMS)
+    {
+      // Walk down the left spine, collecting the right hand leaves.
+      int n = i;
+      Chain.Shape = CHAIN_LEFT_DEEP;
+      while (!IsLeaf(vNode[n]))
+      {
+        vChainTerm.push_back(MakeChainTerm(vNode[vNode[n].iRight], vLiteral, vNode[n].cOperator));
+        n = vNode[n].iLeft;
+      }
+      vChainTerm.push_back(MakeChainTerm(vNode[n], vLiteral, 0));
+      reverse(vChainTerm.begin() + Chain.iFirstTerm, vChainTerm.end());
+    }
+    else if (vRightDeep[i] >= CHAIN_MIN_TERMS)
+    {
+      // Walk down the right spine, collecting the left hand leaves.
+      int n = i;
+      Chain.Shape = CHAIN_RIGHT_DEEP;
+      while (!IsLeaf(vNode[n]))
+      {
+        vChainTerm.push_back(MakeChainTerm(vNode[vNode[n].iLeft], vLiteral, vNode[n].cOperator));
+        n = vNode[n].iRight;
+      }
+      vChainTerm.push_back(MakeChainTerm(vNode[n], vLiteral, 0));
+    }
+    else if (vUniform[i] >= CHAIN_MIN_TERMS)
+    {
+      // Only a tree of exactly the shape Balance() builds can be
+      // evaluated by the pairwise loop in EvaluateChain().
+      bool Match = true;
+
+      PairwiseShape(vUniform[i], vShape);
+      for (int n=Chain.iFirst; n<=i && Match; n++)
+        Match = (IsLeaf(vNode[n]) == vShape[n - Chain.iFirst]);
+      if (!Match)
+        continue;
+
+      Chain.Shape = CHAIN_BALANCED;
+      for (int n=Chain.iFirst; n<=i; n++)
+      {
+        if (IsLeaf(vNode[n]))
+          vChainTerm.push_back(MakeChainTerm(vNode[n], vLiteral, Chain.cOperator));
+      }
+    }
+    else
+      continue;
+
+    Chain.nTerms = (int)vChainTerm.size() - Chain.iFirstTerm;
+    vChain.push_back(Chain);
+    CoveredFrom = Chain.iFirst;
+  }
+
+  reverse(vChain.begin(), vChain.end());
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Kernels
+// Most expressions in practice are small affine shapes, e.g. a*x+b, which
+// node by node cost a dispatch and stack traffic for each of their five
+// nodes. Sub-trees of the shapes in tKERNELTYPE over leaves, outside any
+// chain, are found here and evaluated by EvaluateKernel() in one step, with
+// the same operations in the same order (unless COMPILE_FUSED_MULTIPLY_ADD).
+////////////////////////////////////////////////////////////////////////////
+static bool IsProductOfLeaves(const tNODE *pNode, int iNode)
+{
+  const tNODE &Node = pNode[iNode];
+
+  return Node.Type == NODE_OPERATOR && Node.cOperator == '*' &&
+         IsLeaf(pNode[Node.iLeft]) && IsLeaf(pNode[Node.iRight]);
+}
+
+static bool IsSumOfLeaves(const tNODE *pNode, int iNode)
+{
+  const tNODE &Node = pNode[iNode];
+
+  return Node.Type == NODE_OPERATOR && (Node.cOperator == '+' || Node.cOperator == '-') &&
+         IsLeaf(pNode[Node.iLeft]) && IsLeaf(pNode[Node.iRight]);
+}
+
+void CCompiledExpression::PlanKernels(void)
+{
+  int nNodes = (int)vNode.size();
+  pmr::vector<bool> vInChain(nNodes, false, pScratch);
+  const tNODE *pNode = vNode.data();
+
+  vKernel.clear();
+  if (uCompileFlags & COMPILE_NO_KERNELS)
+    return;
+
+  for (size_t c=0; c<vChain.size(); c++)
+  {
+    for (int n=vChain[c].iFirst; n<=vChain[c].iRoot; n++)
+      vInChain[n] = true;
+  }
+
+  // From the root down, as for chains, so that a kernel never holds another.
+  int CoveredFrom = nNodes;
+  for (int i=nNodes-1; i>=0; i--)
+  {
+    const tNODE &Node = vNode[i];
+    tKERNEL Kernel;
+    int aLeaf[KERNEL_MAX_TERMS];
+    int nLeaves = 0;
+    int l = Node.iLeft;
+    int r = Node.iRight;
+
+    if (i >= CoveredFrom || vInChain[i] || Node.Type != NODE_OPERATOR)
+      continue;
+
+    Kernel.cOuter = Node.cOperator;
+    Kernel.cInner = 0;
+    if (Node.cOperator == '+' || Node.cOperator == '-')
+    {
+      if (IsProductOfLeaves(pNode, l) && IsProductOfLeaves(pNode, r))
+        Kernel.Type = KERNEL_DOT2;
+      else if (IsProductOfLeaves(pNode, l) && IsLeaf(vNode[r]))
+        Kernel.Type = KERNEL_MUL_ADD;
+      else if (IsLeaf(vNode[l]) && IsProductOfLeaves(pNode, r))
+        Kernel.Type = KERNEL_ADD_MUL;
+      else
+        continue;
+      Kernel.cInner = '*';
+    }
+    else if (Node.cOperator == '*' || Node.cOperator == '/')
+    {
+      if (IsSumOfLeaves(pNode, l) && IsLeaf(vNode[r]))
+      {
+        Kernel.Type = KERNEL_SUM_SCALE;
+        Kernel.cInner = vNode[l].cOperator;
+      }
+      else if (IsLeaf(vNode[l]) && IsSumOfLeaves(pNode, r))
+      {
+        Kernel.Type = KERNEL_SCALE_SUM;
+        Kernel.cInner = vNode[r].cOperator;
+      }
+      else
+        continue;
+    }
+    else
+      continue;
+
+    // The leaves, left to right, are t0..t3.
+    if (IsLeaf(vNode[l]))
+      aLeaf[nLeaves++] = l;
+    else
+    {
+      aLeaf[nLeaves++] = vNode[l].iLeft;
+      aLeaf[nLeaves++] = vNode[l].iRight;
+    }
+    if (IsLeaf(vNode[r]))
+      aLeaf[nLeaves++] = r;
+    else
+    {
+      aLeaf[nLeaves++] = vNode[r].iLeft;
+      aLeaf[nLeaves++] = vNode[r].iRight;
+    }
+    for (int t=0; t<KERNEL_MAX_TERMS; t++)
+      Kernel.aTerm[t] = MakeChainTerm(vNode[aLeaf[t < nLeaves ? t : 0]], vLiteral, 0);
+
+    Kernel.iFirst = IsLeaf(vNode[l]) ? l : l - 2;
+    Kernel.iRoot = i;
+    Kernel.bFused = (uCompileFlags & COMPILE_FUSED_MULTIPLY_ADD) &&
+                    Kernel.Type != KERNEL_SUM_SCALE && Kernel.Type != KERNEL_SCALE_SUM;
+    Kernel.bSafeDivide = false; // Until AnalyseRanges()
+    vKernel.push_back(Kernel);
+    CoveredFrom = Kernel.iFirst;
+  }
+
+  reverse(vKernel.begin(), vKernel.end());
+}
+
+static inline double GetTermValue(const tCHAINTERM &Term, const double *pValues)
+{
+  return (Term.iVariable >= 0) ? pValues[Term.iVariable] : Term.lfValue;
+}
+
+bool CCompiledExpression::EvaluateKernel(const tKERNEL &Kernel, const double *pValues, double &lfResult) // static
+// Returns false on a divide by zero.
+{
+  double t0 = GetTermValue(Kernel.aTerm[0], pValues);
+  double t1 = GetTermValue(Kernel.aTerm[1], pValues);
+  double t2 = GetTermValue(Kernel.aTerm[2], pValues);
+  double lfSum;
+
+  switch (Kernel.Type)
+  {
+    case KERNEL_MUL_ADD:
+      if (Kernel.bFused)
+        lfResult = fma(t0, t1, (Kernel.cOuter == '+') ? t2 : -t2);
+      else
+        lfResult = (Kernel.cOuter == '+') ? t0 * t1 + t2 : t0 * t1 - t2;
+      return true;
+
+    case KERNEL_ADD_MUL:
+      if (Kernel.bFused)
+        lfResult = fma((Kernel.cOuter == '+') ? t1 : -t1, t2, t0);
+      else
+        lfResult = (Kernel.cOuter == '+') ? t0 + t1 * t2 : t0 - t1 * t2;
+      return true;
+
+    case KERNEL_DOT2:
+    {
+      double t3 = GetTermValue(Kernel.aTerm[3], pValues);
+
+      if (Kernel.bFused)
+        lfResult = fma(t0, t1, (Kernel.cOuter == '+') ? t2 * t3 : -(t2 * t3));
+      else
+        lfResult = (Kernel.cOuter == '+') ? t0 * t1 + t2 * t3 : t0 * t1 - t2 * t3;
+      return true;
+    }
+
+    case KERNEL_SUM_SCALE:
+      lfSum = (Kernel.cInner == '+') ? t0 + t1 : t0 - t1;
+      if (Kernel.cOuter == '*')
+      {
+        lfResult = lfSum * t2;
+        return true;
+      }
+      if (!Kernel.bSafeDivide && t2 == 0.0)
+        return false;
+      lfResult = lfSum / t2;
+      return true;
+
+    case KERNEL_SCALE_SUM:
+      lfSum = (Kernel.cInner == '+') ? t1 + t2 : t1 - t2;
+      if (Kernel.cOuter == '*')
+      {
+        lfResult = t0 * lfSum;
+        return true;
+      }
+      if (!Kernel.bSafeDivide && lfSum == 0.0)
+        return false;
+      lfResult = t0 / lfSum;
+      return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Range analysis
+// The range of each node is worked out from those of its operands, in
+// post-order. Rounding is monotonic, so doing each operation on the ends of
+// its operands' ranges, rounded just as Evaluate() rounds, gives a range which
+// holds for the rounded results too. Where an end is NaN (0 * Inf, Inf - Inf)
+// the range is taken to be everything. Operands are taken to be independent,
+// except that a variable times itself is known not to be negative.
+////////////////////////////////////////////////////////////////////////////
+static tRANGE MakeRange(double lfLow, double lfHigh)
+{
+  tRANGE Range;
+
+  Range.lfLow = lfLow;
+  Range.lfHigh = lfHigh;
+  return Range;
+}
+
+static bool ContainsZero(const tRANGE &Range)
+{
+  return Range.lfLow <= 0.0 && Range.lfHigh >= 0.0;
+}
+
+static tRANGE Negated(const tRANGE &Range)
+{
+  return MakeRange(-Range.lfHigh, -Range.lfLow);
+}
+
+// The smallest range holding all of alfValue[]
+static tRANGE RangeOf(const double *alfValue, int nValues)
+{
+  tRANGE Range = MakeRange(alfValue[0], alfValue[0]);
+
+  for (int i=0; i<nValues; i++)
+  {
+    if (isnan(alfValue[i]))
+      return MakeRange(-HUGE_VAL, HUGE_VAL);
+    Range.lfLow = min(Range.lfLow, alfValue[i]);
+    Range.lfHigh = max(Range.lfHigh, alfValue[i]);
+  }
+  return Range;
+}
+
+static tRANGE OperatorRange(char cOperator, const tRANGE &Left, const tRANGE &Right, bool bSquare)
+{
+  double alfEnd[4];
+
+  switch (cOperator)
+  {
+    case '+':
+      alfEnd[0] = Left.lfLow + Right.lfLow;
+      alfEnd[1] = Left.lfHigh + Right.lfHigh;
+      return RangeOf(alfEnd, 2);
+
+    case '-':
+      alfEnd[0] = Left.lfLow - Right.lfHigh;
+      alfEnd[1] = Left.lfHigh - Right.lfLow;
+      return RangeOf(alfEnd, 2);
+
+    case '*':
+      if (bSquare)
+      {
+        tRANGE Range;
+
+        alfEnd[0] = Left.lfLow * Left.lfLow;
+        alfEnd[1] = Left.lfHigh * Left.lfHigh;
+        Range = RangeOf(alfEnd, 2);
+        if (ContainsZero(Left))
+          Range.lfLow = 0.0;
+        return Range;
+      }
+      alfEnd[0] = Left.lfLow * Right.lfLow;
+      alfEnd[1] = Left.lfLow * Right.lfHigh;
+      alfEnd[2] = Left.lfHigh * Right.lfLow;
+      alfEnd[3] = Left.lfHigh * Right.lfHigh;
+      return RangeOf(alfEnd, 4);
+
+    case '/':
+      if (ContainsZero(Right))
+        return MakeRange(-HUGE_VAL, HUGE_VAL); // Whenever it does not fail, anything
+      alfEnd[0] = Left.lfLow / Right.lfLow;
+      alfEnd[1] = Left.lfLow / Right.lfHigh;
+      alfEnd[2] = Left.lfHigh / Right.lfLow;
+      alfEnd[3] = Left.lfHigh / Right.lfHigh;
+      return RangeOf(alfEnd, 4);
+
+    default: // Comparisons and logical operators
+      return MakeRange(0.0, 1.0);
+  }
+}
+
+// Of fma(p1, p2, q), which is rounded once rather than after the product too
+static tRANGE FusedRange(const tRANGE &P1, const tRANGE &P2, const tRANGE &Q)
+{
+  double alfEnd[8];
+  int n = 0;
+
+  for (int i=0; i<2; i++)
+  {
+    for (int j=0; j<2; j++)
+    {
+      for (int k=0; k<2; k++)
+        alfEnd[n++] = fma(i ? P1.lfHigh : P1.lfLow, j ? P2.lfHigh : P2.lfLow, k ? Q.lfHigh : Q.lfLow);
+    }
+  }
+  return RangeOf(alfEnd, 8);
+}
+
+void CCompiledExpression::GetRanges(vector<tRANGE> &vRange) const
+{
+  size_t NextKernel = 0;
+
+  vRange.resize(vNode.size());
+  for (size_t n=0; n<vNode.size(); n++)
+  {
+    const tNODE &Node = vNode[n];
+
+    switch (Node.Type)
+    {
+      case NODE_CONSTANT:
+        vRange[n] = MakeRange(GetValue(Node), GetValue(Node));
+        break;
+
+      case NODE_VARIABLE:
+        vRange[n] = vBound[Node.iVariable];
+        break;
+
+      case NODE_NEGATE:
+        vRange[n] = Negated(vRange[Node.iLeft]);
+        break;
+
+      case NODE_OPERATOR:
+      {
+        const tNODE &Left = vNode[Node.iLeft];
+        const tNODE &Right = vNode[Node.iRight];
+        bool bSquare = Left.Type == NODE_VARIABLE && Right.Type == NODE_VARIABLE && Left.iVariable == Right.iVariable;
+
+        vRange[n] = OperatorRange(Node.cOperator, vRange[Node.iLeft], vRange[Node.iRight], bSquare);
+        break;
+      }
+    }
+
+    // A fused kernel, ending here, rounds differently on the way.
+    if (NextKernel < vKernel.size() && vKernel[NextKernel].iRoot == (int)n)
+    {
+      const tKERNEL &Kernel = vKernel[NextKernel++];
+
+      if (Kernel.bFused && Kernel.Type == KERNEL_ADD_MUL)
+      {
+        const tNODE &Product = vNode[Node.iRight];
+        tRANGE Multiplier = vRange[Product.iLeft];
+
+        vRange[n] = FusedRange((Node.cOperator == '+') ? Multiplier : Negated(Multiplier),
+                               vRange[Product.iRight], vRange[Node.iLeft]);
+      }
+      else if (Kernel.bFused) // KERNEL_MUL_ADD, KERNEL_DOT2
+      {
+        const tNODE &Product = vNode[Node.iLeft];
+        tRANGE Addend = vRange[Node.iRight];
+
+        vRange[n] = FusedRange(vRange[Product.iLeft], vRange[Product.iRight],
+                               (Node.cOperator == '+') ? Addend : Negated(Addend));
+      }
+    }
+  }
+}
+
+void CCompiledExpression::AnalyseRanges(void)
+// Marks the divisions which cannot fail, in the nodes and kernels.
+{
+  vector<tRANGE> vRange;
+
+  vBound.resize(vVariableName.size(), MakeRange(-HUGE_VAL, HUGE_VAL));
+  GetRanges(vRange);
+  for (size_t n=0; n<vNode.size(); n++)
+  {
+    tNODE &Node = vNode[n];
+
+    if (Node.Type == NODE_OPERATOR && Node.cOperator == '/' && !ContainsZero(vRange[Node.iRight]))
+      Node.Flags |= NODE_FLAG_SAFE_DIVIDE;
+    else
+      Node.Flags &= (unsigned short)~NODE_FLAG_SAFE_DIVIDE;
+  }
+  for (size_t k=0; k<vKernel.size(); k++)
+    vKernel[k].bSafeDivide = (vNode[vKernel[k].iRoot].Flags & NODE_FLAG_SAFE_DIVIDE) != 0;
+  ResultRange = vRange.empty() ? MakeRange(-HUGE_VAL, HUGE_VAL) : vRange.back();
+}
+
+bool CCompiledExpression::SetBounds(char VariableName, double lfLow, double lfHigh)
+{
+  int Slot = GetVariableSlot(VariableName);
+
+  if (Slot < 0 || vNode.empty() || !(lfLow <= lfHigh)) // Nor NaN
+    return false;
+  vBound[Slot] = MakeRange(lfLow, lfHigh);
+  AnalyseRanges();
+  if (nMemoCapacity) // Results for values outside the bounds may change
+    pMemo.reset(new CMemoCache(GetNumberOfVariables(), nMemoCapacity));
+  return true;
+}
+
+void CCompiledExpression::ClearBounds(void)
+{
+  if (vNode.empty())
+    return;
+  vBound.assign(vVariableName.size(), MakeRange(-HUGE_VAL, HUGE_VAL));
+  AnalyseRanges();
+  if (nMemoCapacity)
+    pMemo.reset(new CMemoCache(GetNumberOfVariables(), nMemoCapacity));
+}
+
+tRANGE CCompiledExpression::GetResultRange(void) const
+{
+  return ResultRange;
+}
+
+size_t CCompiledExpression::GetDivideWarnings(vector<int> &vWarning) const
+{
+  vWarning.clear();
+  for (size_t n=0; n<vNode.size(); n++)
+  {
+    if (vNode[n].Type == NODE_OPERATOR && vNode[n].cOperator == '/' && !(vNode[n].Flags & NODE_FLAG_SAFE_DIVIDE))
+      vWarning.push_back((int)n);
+  }
+  return vWarning.size();
+}
+
+void CCompiledExpression::PrintRanges(ostream &os) const
+{
+  vector<tRANGE> vRange;
+  char szLine[128];
+
+  if (vNode.empty())
+    return;
+  GetRanges(vRange);
+  snprintf(szLine, sizeof(szLine), "%-32s %14s %14s", "node", "low", "high");
+  os << szLine << endl;
+
+  // Top down, left before right, from a stack of (node, depth)
+  vector<pair<int,int> > vStack(1, make_pair(GetRoot(), 0));
+  while (!vStack.empty())
+  {
+    int iNode = vStack.back().first;
+    int Depth = vStack.back().second;
+    const tNODE &Node = vNode[iNode];
+
+    vStack.pop_back();
+    PrintRangeNode(os, vRange, iNode, Depth);
+    if (Node.Type == NODE_OPERATOR)
+      vStack.push_back(make_pair((int)Node.iRight, Depth + 1));
+    if (Node.Type == NODE_NEGATE || Node.Type == NODE_OPERATOR)
+      vStack.push_back(make_pair((int)Node.iLeft, Depth + 1));
+  }
+}
+
+// static
+string CCompiledExpression::GetPrintIndent(int Depth)
+{
+  char szLevel[16];
+
+  if (Depth <= PRINT_MAX_INDENT)
+    return string(Depth * 2, ' ');
+  snprintf(szLevel, sizeof(szLevel), "%d: ", Depth);
+  return string(PRINT_MAX_INDENT * 2, ' ') + szLevel;
+}
+
+// One line, for the node alone
+void CCompiledExpression::PrintRangeNode(ostream &os, const vector<tRANGE> &vRange, int iNode, int Depth) const
+{
+  const tNODE &Node = vNode[iNode];
+  string sLabel = GetPrintIndent(Depth) + GetNodeLabel(Node);
+  char szLine[128];
+
+  if (sLabel.length() < 32)
+    sLabel.resize(32, ' ');
+  snprintf(szLine, sizeof(szLine), " %14g %14g", vRange[iNode].lfLow, vRange[iNode].lfHigh);
+  os << sLabel << szLine;
+  if (Node.Type == NODE_OPERATOR && Node.cOperator == '/' && !(Node.Flags & NODE_FLAG_SAFE_DIVIDE))
+    os << "  divisor may be zero";
+  os << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Evaluation
+////////////////////////////////////////////////////////////////////////////
+double CCompiledExpression::EvaluateChain(const tCHAIN &Chain, const tCHAINTERM *pTerm, const double *pValues) // static
+{
+  size_t nTerms = Chain.nTerms;
+
+  if (Chain.Shape == CHAIN_LEFT_DEEP)
+  {
+    // One serial dependency chain, exactly as written
+    double lfResult = (pTerm[0].iVariable >= 0) ? pValues[pTerm[0].iVariable] : pTerm[0].lfValue;
+
+    for (size_t i=1; i<nTerms; i++)
+    {
+      double lfValue = (pTerm[i].iVariable >= 0) ? pValues[pTerm[i].iVariable] : pTerm[i].lfValue;
+      switch (pTerm[i].cOperator)
+      {
+        case '+': lfResult = lfResult + lfValue; break;
+        case '-': lfResult = lfResult - lfValue; break;
+        case '*': lfResult = lfResult * lfValue; break;
+      }
+    }
+    return lfResult;
+  }
+
+  if (Chain.Shape == CHAIN_RIGHT_DEEP)
+  {
+    // Also serial, but folded from the innermost (last) term outwards
+    double lfResult = (pTerm[nTerms-1].iVariable >= 0) ? pValues[pTerm[nTerms-1].iVariable] : pTerm[nTerms-1].lfValue;
+
+    for (size_t i=nTerms-1; i-- > 0; )
+    {
+      double lfValue = (pTerm[i].iVariable >= 0) ? pValues[pTerm[i].iVariable] : pTerm[i].lfValue;
+      switch (pTerm[i].cOperator)
+      {
+        case '+': lfResult = lfValue + lfResult; break;
+        case '-': lfResult = lfValue - lfResult; break;
+        case '*': lfResult = lfValue * lfResult; break;
+      }
+    }
+    return lfResult;
+  }
+
+  // Balanced: reduce pairwise, a level at a time, as Balance() grouped them.
+  // The operations within a level are independent of each other.
+  // The first level is combined with fetching the terms, starting with the
+  // first pair, which every chain has (CHAIN_MIN_TERMS).
+  double aLocalTerm[CHAIN_LOCAL_TERMS / 2 + 1];
+  vector<double> vHeapTerm;
+  double *t = aLocalTerm;
+  size_t nPairs = nTerms / 2;
+
+  if (nPairs + 1 > sizeof(aLocalTerm) / sizeof(aLocalTerm[0]))
+  {
+    vHeapTerm.resize(nPairs + 1);
+    t = &vHeapTerm[0];
+  }
+  double lfFirst1 = (pTerm[0].iVariable >= 0) ? pValues[pTerm[0].iVariable] : pTerm[0].lfValue;
+  double lfFirst2 = (pTerm[1].iVariable >= 0) ? pValues[pTerm[1].iVariable] : pTerm[1].lfValue;
+  t[0] = (Chain.cOperator == '+') ? lfFirst1 + lfFirst2 : lfFirst1 * lfFirst2;
+  for (size_t i=1; i<nPairs; i++)
+  {
+    const tCHAINTERM &Term1 = pTerm[2*i];
+    const tCHAINTERM &Term2 = pTerm[2*i+1];
+    double lfValue1 = (Term1.iVariable >= 0) ? pValues[Term1.iVariable] : Term1.lfValue;
+    double lfValue2 = (Term2.iVariable >= 0) ? pValues[Term2.iVariable] : Term2.lfValue;
+    t[i] = (Chain.cOperator == '+') ? lfValue1 + lfValue2 : lfValue1 * lfValue2;
+  }
+  if (nTerms % 2)
+    t[nPairs] = (pTerm[nTerms-1].iVariable >= 0) ? pValues[pTerm[nTerms-1].iVariable] : pTerm[nTerms-1].lfValue;
+  nTerms = nPairs + nTerms % 2;
+
+  while (nTerms > 1)
+  {
+    nPairs = nTerms / 2;
+
+    if (Chain.cOperator == '+')
+    {
+      for (size_t i=0; i<nPairs; i++)
+        t[i] = t[2*i] + t[2*i+1];
+    }
+    else
+    {
+      for (size_t i=0; i<nPairs; i++)
+        t[i] = t[2*i] * t[2*i+1];
+    }
+    if (nTerms % 2)
+      t[nPairs] = t[nTerms-1];
+    nTerms = nPairs + nTerms % 2;
+  }
+  return t[0];
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Batches
+// The rows are evaluated a tile at a time (see EvaluateTiles()), or, with the
+// memo cache, one at a time, gathering each row's values from the columns
+// into a row array for Evaluate().
+////////////////////////////////////////////////////////////////////////////
+void CCompiledExpression::ProfileRows(const double *const *ppColumns, const unsigned int *pSelection,
+                                      size_t First, size_t End, double *pResults, tERRNO *pErrNo, bool bTime) const
+{
+  // Column by column: each node over a block of rows, then the next node,
+  // so that timing each node costs two clock reads per block, not per row.
+  size_t nNodes = vNode.size();
+  size_t BlockRows = min((size_t)PROFILE_BLOCK_ROWS, End - First);
+
+  if (First >= End)
+    return;
+
+  vector<tNODEPROFILE> vLocal(nNodes, tNODEPROFILE());
+  vector<double> vValue(nNodes * BlockRows);
+  vector<bool> vFailed(BlockRows);
+  CPerfCounters *pCounters = bTime ? &GetThreadCounters() : NULL;
+  tPERFCOUNTS Counts;
+
+  // The counts include the timing of each node, as the times do
+  if (pCounters && pCounters->IsOpen())
+    pCounters->Start();
+  else
+    pCounters = NULL;
+
+  for (size_t Block=First; Block<End; Block+=BlockRows)
+  {
+    size_t nRows = min(BlockRows, End - Block);
+
+    vFailed.assign(BlockRows, false);
+    for (size_t n=0; n<nNodes; n++)
+    {
+      const tNODE &Node = vNode[n];
+      tNODEPROFILE &Profile = vLocal[n];
+      double *pValue = &vValue[n * BlockRows];
+      chrono::steady_clock::time_point Start;
+
+      if (bTime)
+        Start = chrono::steady_clock::now();
+      for (size_t r=0; r<nRows; r++)
+      {
+        if (vFailed[r])
+          continue; // An earlier node failed, so the interpreter would have stopped
+        Profile.nRuns++;
+        switch (Node.Type)
+        {
+          case NODE_CONSTANT:
+            pValue[r] = GetValue(Node);
+            break;
+          case NODE_VARIABLE:
+            pValue[r] = ppColumns[Node.iVariable][pSelection ? pSelection[Block + r] : Block + r];
+            break;
+          case NODE_NEGATE:
+            pValue[r] = -vValue[Node.iLeft * BlockRows + r];
+            break;
+          case NODE_OPERATOR:
+          {
+            double lfRight = vValue[Node.iRight * BlockRows + r];
+
+            if (Node.cOperator == '/' && !(Node.Flags & NODE_FLAG_SAFE_DIVIDE) && lfRight == 0.0)
+            {
+              Profile.nErrors++;
+              vFailed[r] = true;
+              continue;
+            }
+            pValue[r] = CEvaluator::ApplyOperator(Node.cOperator, vValue[Node.iLeft * BlockRows + r], lfRight);
+            break;
+          }
+        }
+        if (isnan(pValue[r]))
+          Profile.nNaN++;
+        else if (isinf(pValue[r]))
+          Profile.nInf++;
+      }
+      if (bTime)
+        Profile.lfSeconds += chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+    }
+
+    for (size_t r=0; r<nRows; r++)
+    {
+      pResults[Block - First + r] = vFailed[r] ? 0.0 : vValue[(nNodes - 1) * BlockRows + r];
+      if (pErrNo)
+        pErrNo[Block - First + r] = vFailed[r] ? ERR_DIVIDE_BY_ZERO : ERR_OK;
+    }
+  }
+
+  if (pCounters)
+    pCounters->Stop(Counts);
+  pProfile->nEvaluations += End - First;
+  if (bTime)
+    pProfile->nTimedRows += End - First;
+
+  lock_guard<mutex> Lock(pProfile->Mutex);
+  if (pCounters)
+  {
+    CPerfCounters::AddCounts(pProfile->Hardware, Counts);
+    pProfile->nCountedRows += End - First;
+  }
+  for (size_t n=0; n<nNodes; n++)
+  {
+    tNODEPROFILE &Total = pProfile->vNode[n];
+
+    Total.nRuns += vLocal[n].nRuns;
+    Total.nErrors += vLocal[n].nErrors;
+    Total.nNaN += vLocal[n].nNaN;
+    Total.nInf += vLocal[n].nInf;
+    Total.lfSeconds += vLocal[n].lfSeconds;
+  }
+}
+
+void CCompiledExpression::PrintProfile(ostream &os) const
+{
+  double lfTotalSeconds = 0.0;
+  char szLine[128];
+
+  if (!pProfile || vNode.empty())
+  {
+    os << "Not profiling" << endl;
+    return;
+  }
+  {
+    lock_guard<mutex> Lock(pProfile->Mutex);
+
+    for (size_t n=0; n<vNode.size(); n++)
+      lfTotalSeconds += pProfile->vNode[n].lfSeconds;
+  }
+
+  os << "Profile: " << pProfile->nEvaluations << " evaluations, " << pProfile->nTimedRows
+     << " of them timed (" << lfTotalSeconds * 1e6 << " us)" << endl;
+  snprintf(szLine, sizeof(szLine), "%-32s %12s %10s %6s %10s %10s %10s", "node", "runs", "time us", "time%", "errors", "NaN", "Inf");
+  os << szLine << endl;
+
+  // Top down, left before right, from a stack of (node, depth)
+  vector<pair<int,int> > vStack(1, make_pair(GetRoot(), 0));
+  while (!vStack.empty())
+  {
+    int iNode = vStack.back().first;
+    int Depth = vStack.back().second;
+    const tNODE &Node = vNode[iNode];
+
+    vStack.pop_back();
+    PrintProfileNode(os, iNode, Depth, lfTotalSeconds);
+    if (Node.Type == NODE_OPERATOR)
+      vStack.push_back(make_pair((int)Node.iRight, Depth + 1));
+    if (Node.Type == NODE_NEGATE || Node.Type == NODE_OPERATOR)
+      vStack.push_back(make_pair((int)Node.iLeft, Depth + 1));
+  }
+
+  tPERFCOUNTS Counts;
+  unsigned long long nCountedRows;
+
+  if (GetHardwareProfile(Counts, nCountedRows))
+  {
+    os << "Hardware, ";
+    CPerfCounters::PrintCounts(os, Counts, (double)nCountedRows, "timed row");
+  }
+  else
+    os << "Hardware counters not available: " << GetThreadCounters().GetErrorText() << endl;
+}
+
+string CCompiledExpression::GetNodeLabel(const tNODE &Node) const
+{
+  char szValue[32];
+
+  switch (Node.Type)
+  {
+    case NODE_CONSTANT:
+      snprintf(szValue, sizeof(szValue), "%g", GetValue(Node));
+      return szValue;
+    case NODE_VARIABLE:
+      return GetVariableText(Node.iVariable);
+    case NODE_NEGATE:
+      return "-()";
+    default: // NODE_OPERATOR
+      return CEvaluator::GetOperatorText(Node.cOperator);
+  }
+}
+
+// One line, for the node alone
+void CCompiledExpression::PrintProfileNode(ostream &os, int iNode, int Depth, double lfTotalSeconds) const
+{
+  const tNODE &Node = vNode[iNode];
+  tNODEPROFILE Profile;
+  string sLabel = GetPrintIndent(Depth) + GetNodeLabel(Node);
+  char szLine[128];
+
+  GetNodeProfile(iNode, Profile);
+  if (sLabel.length() < 32)
+    sLabel.resize(32, ' ');
+  snprintf(szLine, sizeof(szLine), " %12llu %10.1f %5.1f%% %10llu %10llu %10llu", Profile.nRuns,
+           Profile.lfSeconds * 1e6, lfTotalSeconds > 0.0 ? 100.0 * Profile.lfSeconds / lfTotalSeconds : 0.0,
+           Profile.nErrors, Profile.nNaN, Profile.nInf);
+  os << sLabel << szLine << endl;
+}
+
+void CCompiledExpression::GetRow(const double *const *ppColumns, size_t Row, double *pRow) const
+{
+  for (size_t Slot=0; Slot<vVariableName.size(); Slot++)
+    pRow[Slot] = ppColumns[Slot][Row];
+}
+
+void CCompiledExpression::EvaluateBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo,
+                                        const unsigned int *pSelection, size_t nSelected) const
+{
+  if (pSelection)
+    nRows = nSelected;
+  EvaluateRows(ppColumns, pSelection, 0, nRows, pResults, pErrNo);
+}
+
+tBATCHSTATUS CCompiledExpression::EvaluateBatch(const double *const *ppColumns, size_t nRows, double *pResults,
+                                                tERRNO *pErrNo, const tBATCHLIMITS &Limits, size_t &Cursor,
+                                                const unsigned int *pSelection, size_t nSelected) const
+{
+  size_t nChunkRows = Limits.nChunkRows ? Limits.nChunkRows : BATCH_DEFAULT_CHUNK_ROWS;
+  bool bDeadline = Limits.Deadline != chrono::steady_clock::time_point::max();
+
+  if (pSelection)
+    nRows = nSelected;
+
+  // Checked before each chunk, so nothing is done once the deadline has passed.
+  while (Cursor < nRows)
+  {
+    size_t End = min(nRows, Cursor + nChunkRows);
+
+    if (Limits.pCancel && Limits.pCancel->load(memory_order_relaxed))
+      return BATCH_CANCELLED;
+    if (bDeadline && chrono::steady_clock::now() >= Limits.Deadline)
+      return BATCH_DEADLINE;
+
+    EvaluateRows(ppColumns, pSelection, Cursor, End, pResults, pErrNo);
+    Cursor = End;
+  }
+  return BATCH_COMPLETE;
+}
+
+void CCompiledExpression::InitialiseLimits(tBATCHLIMITS &Limits) // static
+{
+  Limits.pCancel = NULL;
+  Limits.Deadline = chrono::steady_clock::time_point::max();
+  Limits.nChunkRows = 0;
+}
+
+void CCompiledExpression::EvaluateRows(const double *const *ppColumns, const unsigned int *pSelection,
+                                       size_t First, size_t End, double *pResults, tERRNO *pErrNo) const
+{
+  // pResults[k] and pErrNo[k] are for row (or selection entry) k, as in EvaluateBatch().
+  vector<double> vRow(vVariableName.size() + 1);
+
+  if (pProfile && !vNode.empty())
+  {
+    ProfileRows(ppColumns, pSelection, First, End, pResults + First, pErrNo ? pErrNo + First : NULL,
+                pProfile->nBatches.fetch_add(1) % PROFILE_SAMPLE_BATCHES == 0);
+    return;
+  }
+  if (!pMemo && !vNode.empty())
+  {
+    size_t nTileRows = min(GetTileRows(), TILE_CACHE_BYTES / (sizeof(double) * MaxStackDepth));
+
+    // No bigger than the batch, so that a small batch allocates little
+    nTileRows = min(max(nTileRows, (size_t)TILE_MIN_ROWS), End - First);
+    if (nTileRows > 0)
+      EvaluateTiles(ppColumns, pSelection, First, End, pResults, pErrNo, nTileRows);
+    return;
+  }
+  for (size_t k=First; k<End; k++)
+  {
+    GetRow(ppColumns, pSelection ? pSelection[k] : k, &vRow[0]);
+    pResults[k] = Evaluate(&vRow[0], pErrNo ? &pErrNo[k] : NULL);
+  }
+}
+
+void CCompiledExpression::EvaluateTiles(const double *const *ppColumns, const unsigned int *pSelection,
+                                        size_t First, size_t End, double *pResults, tERRNO *pErrNo,
+                                        size_t nTileRows) const
+// Each node over every row of a tile, in post-order, on an operand stack
+// whose every level is a tile's worth of values. A row which divides by zero
+// is marked failed, and carries on (with Inf or NaN) so that the loops have no
+// branches. Chains and kernels are done node by node, which rounds just the
+// same, except for fused kernels, which are done row by row as in Evaluate().
+{
+  vector<double> vStack((size_t)MaxStackDepth * nTileRows);
+  vector<char> vFailed(nTileRows);
+  vector<double> vRow(vVariableName.size() + 1);
+  double *pStack = &vStack[0];
+  char *pFailed = &vFailed[0];
+
+  for (size_t Tile=First; Tile<End; Tile+=nTileRows)
+  {
+    size_t nRows = min(nTileRows, End - Tile);
+    const unsigned int *pTileSelection = pSelection ? pSelection + Tile : NULL;
+    size_t NextKernel = 0;
+    int Top = -1;
+
+    for (size_t r=0; r<nRows; r++)
+      pFailed[r] = false;
+
+    for (int n=0; n<(int)vNode.size(); n++)
+    {
+      const tNODE &Node = vNode[n];
+
+      if (NextKernel < vKernel.size() && vKernel[NextKernel].iFirst == n)
+      {
+        const tKERNEL &Kernel = vKernel[NextKernel++];
+
+        if (Kernel.bFused)
+        {
+          double *pOut = pStack + ++Top * nTileRows;
+
+          for (size_t r=0; r<nRows; r++)
+          {
+            size_t Row = pTileSelection ? pTileSelection[r] : Tile + r;
+
+            for (int t=0; t<KERNEL_MAX_TERMS; t++)
+            {
+              if (Kernel.aTerm[t].iVariable >= 0)
+                vRow[Kernel.aTerm[t].iVariable] = ppColumns[Kernel.aTerm[t].iVariable][Row];
+            }
+            EvaluateKernel(Kernel, &vRow[0], pOut[r]);   // Fused kernels do not divide
+          }
+          n = Kernel.iRoot;
+          continue;
+        }
+      }
+
+      switch (Node.Type)
+      {
+        case NODE_CONSTANT:
+        {
+          double *pOut = pStack + ++Top * nTileRows;
+          double lfValue = GetValue(Node);
+
+          for (size_t r=0; r<nRows; r++)
+            pOut[r] = lfValue;
+          break;
+        }
+
+        case NODE_VARIABLE:
+        {
+          double *pOut = pStack + ++Top * nTileRows;
+          const double *pColumn = ppColumns[Node.iVariable];
+
+          if (pTileSelection)
+          {
+            for (size_t r=0; r<nRows; r++)
+              pOut[r] = pColumn[pTileSelection[r]];
+          }
+          else
+          {
+            for (size_t r=0; r<nRows; r++)
+              pOut[r] = pColumn[Tile + r];
+          }
+          break;
+        }
+
+        case NODE_NEGATE:
+        {
+          double *pOut = pStack + Top * nTileRows;
+
+          for (size_t r=0; r<nRows; r++)
+            pOut[r] = -pOut[r];
+          break;
+        }
+
+        case NODE_OPERATOR:
+        {
+          const double *pRight = pStack + Top-- * nTileRows;
+          double *pLeft = pStack + Top * nTileRows;
+
+          switch (Node.cOperator)
+          {
+            case '+':
+              for (size_t r=0; r<nRows; r++)
+                pLeft[r] = pLeft[r] + pRight[r];
+              break;
+            case '-':
+              for (size_t r=0; r<nRows; r++)
+                pLeft[r] = pLeft[r] - pRight[r];
+              break;
+            case '*':
+              for (size_t r=0; r<nRows; r++)
+                pLeft[r] = pLeft[r] * pRight[r];
+              break;
+            case '/':
+              if (!(Node.Flags & NODE_FLAG_SAFE_DIVIDE))
+              {
+                for (size_t r=0; r<nRows; r++)
+                  pFailed[r] |= (pRight[r] == 0.0);
+              }
+              for (size_t r=0; r<nRows; r++)
+                pLeft[r] = pLeft[r] / pRight[r];
+              break;
+            default:
+              for (size_t r=0; r<nRows; r++)
+                pLeft[r] = CEvaluator::ApplyOperator(Node.cOperator, pLeft[r], pRight[r]);
+              break;
+          }
+          break;
+        }
+      }
+    }
+
+    for (size_t r=0; r<nRows; r++)
+    {
+      pResults[Tile + r] = pFailed[r] ? 0.0 : pStack[r];
+      if (pErrNo)
+        pErrNo[Tile + r] = pFailed[r] ? ERR_DIVIDE_BY_ZERO : ERR_OK;
+    }
+  }
+}
+
+void CCompiledExpression::SetTileRows(size_t nRows) // static
+{
+  if (nRows != 0)
+    nRows = min(max(nRows, (size_t)TILE_MIN_ROWS), (size_t)TILE_MAX_ROWS);
+  TileRows.store(nRows);
+}
+
+size_t CCompiledExpression::GetTileRows(void) // static
+{
+  size_t nRows = TileRows.load(memory_order_relaxed);
+
+  if (nRows == 0)
+  {
+    // Only one thread calibrates; any others wait for it.
+    lock_guard<mutex> Lock(TileMutex);
+
+    nRows = TileRows.load();
+    if (nRows == 0)
+      nRows = CalibrateTileRows();
+  }
+  return nRows;
+}
+
+size_t CCompiledExpression::CalibrateTileRows(void) // static
+// Times a batch of an expression of 100 operators over 8 variables at each
+// tile size, from TILE_MIN_ROWS up, doubling, and keeps the fastest. Takes a
+// few tens of milliseconds.
+{
+  const int nVariables = 8;
+  CCompiledExpression Compiled;
+  vector<vector<double> > vvColumn(nVariables, vector<double>(TILE_CALIBRATE_ROWS));
+  vector<const double *> vpColumn(nVariables);
+  vector<double> vResult(TILE_CALIBRATE_ROWS);
+  vector<tERRNO> vErrNo(TILE_CALIBRATE_ROWS);
+  string sExpression;
+  size_t BestRows = TILE_MIN_ROWS;
+  double lfBestSeconds = HUGE_VAL;
+
+  // 20 groups of ((v*v + v*v) - v/v), of 4 operators each, 19 + and - between
+  // them, and one * 0.5: 100 operators in all.
+  for (int g=0; g<20; g++)
+  {
+    char szGroup[32];
+
+    snprintf(szGroup, sizeof(szGroup), "%s((%c*%c + %c*%c) - %c/%c)", g ? ((g % 2) ? " + " : " - ") : "",
+             'a' + g % 8, 'a' + (g + 1) % 8, 'a' + (g + 2) % 8, 'a' + (g + 3) % 8, 'a' + (g + 4) % 8, 'a' + (g + 5) % 8);
+    sExpression += szGroup;
+    if (g == 9)
+      sExpression = "(" + sExpression + ")*0.5";
+  }
+  Compiled.Compile(sExpression.c_str());
+  for (int i=0; i<nVariables; i++)
+  {
+    for (size_t r=0; r<TILE_CALIBRATE_ROWS; r++)
+      vvColumn[i][r] = 1.5 + (r * (i + 3)) % 17;
+    vpColumn[Compiled.GetVariableSlot((char)('a' + i))] = &vvColumn[i][0];
+  }
+
+  for (size_t nRows=TILE_MIN_ROWS; nRows<=TILE_MAX_ROWS; nRows*=2)
+  {
+    for (int i=0; i<TILE_CALIBRATE_REPEATS; i++)
+    {
+      chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+
+      Compiled.EvaluateTiles(&vpColumn[0], NULL, 0, TILE_CALIBRATE_ROWS, &vResult[0], &vErrNo[0], nRows);
+      double lfSeconds = chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+      if (lfSeconds < lfBestSeconds)
+      {
+        lfBestSeconds = lfSeconds;
+        BestRows = nRows;
+      }
+    }
+  }
+  TileRows.store(BestRows);
+  return BestRows;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Dictionary-encoded columns
+// The codes of a row make its key, code0 + nDictionary0 * (code1 + ...),
+// which is looked up (in a table, or hashed for a large key space) to find
+// which combination the row is. The combinations first seen in a chunk of
+// rows are decoded and evaluated together by EvaluateBatch() (so tiled,
+// memoised and profiled as any batch), then the chunk's results are copied
+// from those of its combinations. Combination 0 stands for every row with a
+// code outside its dictionary, so that copying needs no test.
+////////////////////////////////////////////////////////////////////////////
+#define DICTIONARY_NOT_FOUND   (~0U)
+#define DICTIONARY_INVALID_KEY (~0ULL)   // Above any valid key, since there are at most 2^64-1
+
+size_t CCompiledExpression::EvaluateDictionary(const tDICTCOLUMN *pColumns, size_t nRows, double *pResults,
+                                               tERRNO *pErrNo) const
+{
+  size_t nSlots = vVariableName.size();
+  size_t nChunkRows = min(nRows, (size_t)DICTIONARY_CHUNK_ROWS);
+  unsigned long long nKeys = 1;
+
+  for (size_t Slot=0; Slot<nSlots; Slot++)
+  {
+    unsigned long long nDictionary = max(pColumns[Slot].nDictionary, (size_t)1);
+
+    if (nKeys > ~0ULL / nDictionary)
+    {
+      EvaluateDecoded(pColumns, 0, nRows, pResults, pErrNo);
+      return 0;
+    }
+    nKeys *= nDictionary;
+  }
+
+  bool bTable = nKeys <= DICTIONARY_TABLE_KEYS;
+  vector<unsigned int> vTable(bTable ? (size_t)nKeys : 0, DICTIONARY_NOT_FOUND);
+  unordered_map<unsigned long long, unsigned int> mCombination;
+  vector<unsigned long long> vKey(nChunkRows);
+  vector<unsigned int> vRowCombination(nChunkRows);
+  vector<vector<double> > vvNew(nSlots);         // Decoded values of the combinations new to the chunk
+  vector<const double *> vpNew(nSlots + 1, (const double *)NULL);
+  vector<double> vResult(1, 0.0);                // Of each combination
+  vector<tERRNO> vErrNo(1, ERR_EVALUATION_FAILED);
+
+  for (size_t First=0; First<nRows; First+=nChunkRows)
+  {
+    size_t nChunk = min(nChunkRows, nRows - First);
+    unsigned long long *pKey = &vKey[0];
+    unsigned int *pRowCombination = &vRowCombination[0];
+    unsigned long long Scale = 1;
+    size_t nOld = vResult.size();
+    size_t nNew = 0;
+    bool bInvalid = false;
+
+    // The keys are built a column at a time, which the compiler vectorises;
+    // the rows with an invalid code are looked for only if there are any.
+    for (size_t r=0; r<nChunk; r++)
+      pKey[r] = 0;
+    for (size_t Slot=0; Slot<nSlots; Slot++)
+    {
+      const unsigned int *pCode = pColumns[Slot].pCode + First;
+      unsigned int MaxCode = 0;
+
+      for (size_t r=0; r<nChunk; r++)
+      {
+        MaxCode = max(MaxCode, pCode[r]);
+        pKey[r] += pCode[r] * Scale;
+      }
+      bInvalid = bInvalid || MaxCode >= pColumns[Slot].nDictionary;
+      Scale *= max(pColumns[Slot].nDictionary, (size_t)1);
+      vvNew[Slot].clear();
+    }
+    for (size_t Slot=0; bInvalid && Slot<nSlots; Slot++)
+    {
+      const unsigned int *pCode = pColumns[Slot].pCode + First;
+
+      for (size_t r=0; r<nChunk; r++)
+      {
+        if (pCode[r] >= pColumns[Slot].nDictionary)
+          pKey[r] = DICTIONARY_INVALID_KEY;
+      }
+    }
+
+    for (size_t r=0; r<nChunk; r++)
+    {
+      unsigned int *pCombination;
+
+      if (pKey[r] == DICTIONARY_INVALID_KEY)
+      {
+        pRowCombination[r] = 0;
+        continue;
+      }
+      if (bTable)
+        pCombination = &vTable[(size_t)pKey[r]];
+      else
+        pCombination = &mCombination.insert(make_pair(pKey[r], DICTIONARY_NOT_FOUND)).first->second;
+      if (*pCombination == DICTIONARY_NOT_FOUND)
+      {
+        *pCombination = (unsigned int)(nOld + nNew++);
+        for (size_t Slot=0; Slot<nSlots; Slot++)
+          vvNew[Slot].push_back(pColumns[Slot].pDictionary[pColumns[Slot].pCode[First + r]]);
+      }
+      pRowCombination[r] = *pCombination;
+    }
+
+    if (nNew > 0)
+    {
+      vResult.resize(nOld + nNew);
+      vErrNo.resize(nOld + nNew);
+      for (size_t Slot=0; Slot<nSlots; Slot++)
+        vpNew[Slot] = &vvNew[Slot][0];
+      EvaluateBatch(&vpNew[0], nNew, &vResult[nOld], &vErrNo[nOld]);
+    }
+
+    double *pChunkResults = pResults + First;
+    for (size_t r=0; r<nChunk; r++)
+      pChunkResults[r] = vResult[pRowCombination[r]];
+    if (pErrNo)
+    {
+      tERRNO *pChunkErrNo = pErrNo + First;
+
+      for (size_t r=0; r<nChunk; r++)
+        pChunkErrNo[r] = vErrNo[pRowCombination[r]];
+    }
+
+    // Nearly every row a combination of its own: the lookups cost more than
+    // they save, so the rest of the batch is decoded instead.
+    if (nNew * DICTIONARY_MAX_NEW_SHARE > nChunk && First + nChunk < nRows)
+    {
+      EvaluateDecoded(pColumns, First + nChunk, nRows - First - nChunk, pResults + First + nChunk,
+                      pErrNo ? pErrNo + First + nChunk : NULL);
+      return 0;
+    }
+  }
+  return vResult.size() - 1;
+}
+
+// Rows First.. First+nRows-1 of pColumns, decoded a chunk at a time, into pResults[0..]
+void CCompiledExpression::EvaluateDecoded(const tDICTCOLUMN *pColumns, size_t First, size_t nRows,
+                                          double *pResults, tERRNO *pErrNo) const
+{
+  size_t nSlots = vVariableName.size();
+  size_t nChunkRows = min(nRows, (size_t)DICTIONARY_CHUNK_ROWS);
+  vector<vector<double> > vvDecoded(nSlots, vector<double>(nChunkRows));
+  vector<const double *> vpDecoded(nSlots + 1, (const double *)NULL);
+  vector<char> vInvalid(nChunkRows);
+
+  for (size_t Done=0; Done<nRows; Done+=nChunkRows)
+  {
+    size_t nChunk = min(nChunkRows, nRows - Done);
+    bool bInvalid = false;
+
+    for (size_t Slot=0; Slot<nSlots; Slot++)
+    {
+      const tDICTCOLUMN &Column = pColumns[Slot];
+      const unsigned int *pCode = Column.pCode + First + Done;
+      double *pDecoded = &vvDecoded[Slot][0];
+
+      for (size_t r=0; r<nChunk; r++)
+      {
+        if (pCode[r] < Column.nDictionary)
+          pDecoded[r] = Column.pDictionary[pCode[r]];
+        else
+        {
+          pDecoded[r] = 0.0;
+          vInvalid[r] = bInvalid = true;
+        }
+      }
+      vpDecoded[Slot] = pDecoded;
+    }
+    EvaluateBatch(&vpDecoded[0], nChunk, pResults + Done, pErrNo ? pErrNo + Done : NULL);
+    for (size_t r=0; bInvalid && r<nChunk; r++)
+    {
+      if (vInvalid[r])
+      {
+        pResults[Done + r] = 0.0;
+        if (pErrNo)
+          pErrNo[Done + r] = ERR_EVALUATION_FAILED;
+        vInvalid[r] = false;
+      }
+    }
+  }
+}
+
+size_t CCompiledExpression::Filter(const double *const *ppColumns, size_t nRows, vector<unsigned int> &vSelected,
+                                   const unsigned int *pSelection, size_t nSelected) const
+{
+  vector<double> vRow(vVariableName.size() + 1);
+
+  vSelected.clear();
+  if (pSelection)
+    nRows = nSelected;
+  for (size_t k=0; k<nRows; k++)
+  {
+    unsigned int Row = pSelection ? pSelection[k] : (unsigned int)k;
+    tERRNO RowErrNo;
+
+    GetRow(ppColumns, Row, &vRow[0]);
+    if (Evaluate(&vRow[0], &RowErrNo) != 0.0 && RowErrNo == ERR_OK)
+      vSelected.push_back(Row);
+  }
+  return vSelected.size();
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Grids
+// Each node (or chain or kernel, taken whole) belongs to the loop of the
+// innermost variable it uses, or to none if it uses none. Going through the
+// grid like an odometer, only the loops whose variable has changed are run,
+// outermost first, so everything else keeps its value from before. The
+// operations are those Evaluate() does, so the results are identical.
+////////////////////////////////////////////////////////////////////////////
+size_t CCompiledExpression::GetGridPoints(const tGRIDAXIS *pAxis) const
+{
+  size_t nPoints = 1;
+
+  for (size_t Slot=0; Slot<vVariableName.size(); Slot++)
+    nPoints *= pAxis[Slot].nCount;
+  return nPoints;
+}
+
+bool CCompiledExpression::EvaluateGrid(const tGRIDAXIS *pAxis, double *pResults, tERRNO *pErrNo) const
+{
+  typedef struct tagGRIDSTEP
+  {
+    int iFirst;        // As for a chain or kernel; iFirst == iRoot for a single node
+    int iRoot;
+    int iChain;        // -1 if not a chain
+    int iKernel;       // -1 if not a kernel
+    int Loop;          // Slot of the innermost variable used, -1 for none
+  } tGRIDSTEP;
+
+  int nSlots = (int)vVariableName.size();
+  int nNodes = (int)vNode.size();
+  size_t nPoints = GetGridPoints(pAxis);
+  vector<int> vLoop(nNodes, -1);
+  vector<tGRIDSTEP> vStep;
+  vector<size_t> vLoopStep(nSlots + 2, 0);    // Steps of loop L start at vLoopStep[L+1]
+  vector<double> vValue(nNodes, 0.0);
+  vector<char> vFailed(nNodes, false);
+  vector<double> vPoint(nSlots + 1, 0.0);
+  vector<size_t> vIndex(nSlots, 0);
+  size_t NextChain = 0;
+  size_t NextKernel = 0;
+
+  if (vNode.empty())
+    return false;
+
+  // Post-order, so each node's operands have their loop by now.
+  for (int n=0; n<nNodes; n++)
+  {
+    const tNODE &Node = vNode[n];
+
+    if (Node.Type == NODE_VARIABLE)
+      vLoop[n] = Node.iVariable;
+    else if (Node.Type == NODE_NEGATE)
+      vLoop[n] = vLoop[Node.iLeft];
+    else if (Node.Type == NODE_OPERATOR)
+      vLoop[n] = max(vLoop[Node.iLeft], vLoop[Node.iRight]);
+  }
+  for (int n=0; n<nNodes; n++)
+  {
+    tGRIDSTEP Step = { n, n, -1, -1, vLoop[n] };
+
+    if (NextChain < vChain.size() && vChain[NextChain].iFirst == n)
+    {
+      Step.iChain = (int)NextChain++;
+      Step.iRoot = vChain[Step.iChain].iRoot;
+    }
+    else if (NextKernel < vKernel.size() && vKernel[NextKernel].iFirst == n)
+    {
+      Step.iKernel = (int)NextKernel++;
+      Step.iRoot = vKernel[Step.iKernel].iRoot;
+    }
+    Step.Loop = vLoop[Step.iRoot];
+    vStep.push_back(Step);
+    n = Step.iRoot;
+  }
+  // Stable, so post-order is kept within each loop; operands in outer loops
+  // are always done before.
+  stable_sort(vStep.begin(), vStep.end(), [](const tGRIDSTEP &Step1, const tGRIDSTEP &Step2)
+  {
+    return Step1.Loop < Step2.Loop;
+  });
+  for (size_t i=0; i<vStep.size(); i++)
+    vLoopStep[vStep[i].Loop + 2] = i + 1;
+  for (int L=0; L<=nSlots; L++)
+    vLoopStep[L+1] = max(vLoopStep[L+1], vLoopStep[L]);
+
+  auto RunLoop = [&](int Loop)
+  {
+    for (size_t i=vLoopStep[Loop + 1]; i<vLoopStep[Loop + 2]; i++)
+    {
+      const tGRIDSTEP &Step = vStep[i];
+      const tNODE &Node = vNode[Step.iRoot];
+      int n = Step.iRoot;
+
+      if (Step.iChain >= 0)
+      {
+        vValue[n] = EvaluateChain(vChain[Step.iChain], &vChainTerm[vChain[Step.iChain].iFirstTerm], &vPoint[0]);
+        continue;
+      }
+      if (Step.iKernel >= 0)
+      {
+        vFailed[n] = !EvaluateKernel(vKernel[Step.iKernel], &vPoint[0], vValue[n]);
+        continue;
+      }
+      switch (Node.Type)
+      {
+        case NODE_CONSTANT:
+          vValue[n] = GetValue(Node);
+          break;
+        case NODE_VARIABLE:
+          vValue[n] = vPoint[Node.iVariable];
+          break;
+        case NODE_NEGATE:
+          vFailed[n] = vFailed[Node.iLeft];
+          vValue[n] = -vValue[Node.iLeft];
+          break;
+        case NODE_OPERATOR:
+        {
+          double lfRight = vValue[Node.iRight];
+
+          vFailed[n] = vFailed[Node.iLeft] || vFailed[Node.iRight] || (Node.cOperator == '/' && !(Node.Flags & NODE_FLAG_SAFE_DIVIDE) && lfRight == 0.0);
+          if (!vFailed[n])
+            vValue[n] = CEvaluator::ApplyOperator(Node.cOperator, vValue[Node.iLeft], lfRight);
+          break;
+        }
+      }
+    }
+  };
+
+  // A failure anywhere reaches the root, as any divide by zero fails Evaluate().
+  int Changed = -1;
+  int iRoot = nNodes - 1;
+  for (size_t p=0; p<nPoints; p++)
+  {
+    for (int L=Changed; L<nSlots; L++)
+    {
+      if (L >= 0)
+        vPoint[L] = pAxis[L].lfStart + (double)vIndex[L] * pAxis[L].lfStep;
+      RunLoop(L);
+    }
+    pResults[p] = vFailed[iRoot] ? 0.0 : vValue[iRoot];
+    if (pErrNo)
+      pErrNo[p] = vFailed[iRoot] ? ERR_DIVIDE_BY_ZERO : ERR_OK;
+
+    // Next point: the innermost variable, carrying into the ones outside it
+    Changed = nSlots - 1;
+    while (Changed >= 0 && ++vIndex[Changed] == pAxis[Changed].nCount)
+      vIndex[Changed--] = 0;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Aggregation
+// Each part is reduced in row order with Welford's update for the mean and
+// M2, then the parts are merged in part order with Chan et al.'s formula.
+// Both orders are fixed, so the result is the same for any nThreads, and
+// only AGGREGATE_MAX_PARTS partial results are ever held.
+////////////////////////////////////////////////////////////////////////////
+void CCompiledExpression::ClearAggregate(tAGGREGATE &Result) // static
+{
+  Result.nRows = 0;
+  Result.nErrors = 0;
+  Result.lfSum = 0.0;
+  Result.lfMin = HUGE_VAL;
+  Result.lfMax = -HUGE_VAL;
+  Result.lfMean = 0.0;
+  Result.lfM2 = 0.0;
+  Result.lfVariance = 0.0;
+}
+
+void CCompiledExpression::MergeAggregate(tAGGREGATE &Result, const tAGGREGATE &Part) // static
+{
+  if (Part.nRows > 0)
+  {
+    double nA = (double)Result.nRows;
+    double nB = (double)Part.nRows;
+    double lfDelta = Part.lfMean - Result.lfMean;
+
+    Result.lfMean += lfDelta * nB / (nA + nB);
+    Result.lfM2 += Part.lfM2 + lfDelta * lfDelta * nA * nB / (nA + nB);
+    Result.lfSum += Part.lfSum;
+    if (Part.lfMin < Result.lfMin)
+      Result.lfMin = Part.lfMin;
+    if (Part.lfMax > Result.lfMax)
+      Result.lfMax = Part.lfMax;
+    Result.nRows += Part.nRows;
+  }
+  Result.nErrors += Part.nErrors;
+}
+
+void CCompiledExpression::AggregateRows(const double *const *ppColumns, const unsigned int *pSelection,
+                                        size_t First, size_t End, tAGGREGATE &Result) const
+{
+  vector<double> vRow(vVariableName.size() + 1);
+
+  ClearAggregate(Result);
+  for (size_t k=First; k<End; k++)
+  {
+    tERRNO RowErrNo;
+
+    GetRow(ppColumns, pSelection ? pSelection[k] : k, &vRow[0]);
+    double lfValue = Evaluate(&vRow[0], &RowErrNo);
+    if (RowErrNo != ERR_OK)
+    {
+      Result.nErrors++;
+      continue;
+    }
+
+    Result.nRows++;
+    double lfDelta = lfValue - Result.lfMean;
+    Result.lfMean += lfDelta / (double)Result.nRows;
+    Result.lfM2 += lfDelta * (lfValue - Result.lfMean);
+    Result.lfSum += lfValue;
+    if (lfValue < Result.lfMin)
+      Result.lfMin = lfValue;
+    if (lfValue > Result.lfMax)
+      Result.lfMax = lfValue;
+  }
+}
+
+void CCompiledExpression::Aggregate(const double *const *ppColumns, size_t nRows, tAGGREGATE &Result, int nThreads,
+                                    const unsigned int *pSelection, size_t nSelected) const
+{
+  tAGGREGATE aPart[AGGREGATE_MAX_PARTS];
+
+  if (pSelection)
+    nRows = nSelected;    // From here on, "rows" are positions in the selection
+
+  size_t nParts = (nRows + AGGREGATE_MIN_PART_ROWS - 1) / AGGREGATE_MIN_PART_ROWS;
+
+  if (nParts > AGGREGATE_MAX_PARTS)
+    nParts = AGGREGATE_MAX_PARTS;
+  if (nParts == 0)
+    nParts = 1;
+
+  if (nThreads <= 0)
+    nThreads = CThreadPool::GetDefaultNumberOfThreads();
+  if ((size_t)nThreads > nParts)
+    nThreads = (int)nParts;
+
+  if (nThreads <= 1)
+  {
+    for (size_t p=0; p<nParts; p++)
+      AggregateRows(ppColumns, pSelection, p * nRows / nParts, (p + 1) * nRows / nParts, aPart[p]);
+  }
+  else
+  {
+    CThreadPool Pool(nThreads);
+
+    for (size_t p=0; p<nParts; p++)
+      Pool.Submit([this, ppColumns, pSelection, nRows, nParts, p, &aPart]()
+      {
+        AggregateRows(ppColumns, pSelection, p * nRows / nParts, (p + 1) * nRows / nParts, aPart[p]);
+      });
+    Pool.Wait();
+  }
+
+  ClearAggregate(Result);
+  for (size_t p=0; p<nParts; p++)
+    MergeAggregate(Result, aPart[p]);
+  if (Result.nRows > 0)
+    Result.lfVariance = Result.lfM2 / (double)Result.nRows;
+}
+
+double CCompiledExpression::Evaluate(const double *pValues, tERRNO *pErrNo) const
+{
+  CMemoCache *pCache = pMemo.get();
+  double lfResult;
+  tERRNO ResultErrNo;
+
+  if (pProfile && !vNode.empty())
+  {
+    // One row, whose columns are the values
+    const double *apLocalColumn[EVAL_LOCAL_STACK];
+    vector<const double *> vHeapColumn;
+    const double **ppColumns = apLocalColumn;
+
+    if (vVariableName.size() > EVAL_LOCAL_STACK)
+    {
+      vHeapColumn.resize(vVariableName.size());
+      ppColumns = &vHeapColumn[0];
+    }
+    for (size_t Slot=0; Slot<vVariableName.size(); Slot++)
+      ppColumns[Slot] = &pValues[Slot];
+    ProfileRows(ppColumns, NULL, 0, 1, &lfResult, &ResultErrNo, false);
+    if (pErrNo)
+      *pErrNo = ResultErrNo;
+    return lfResult;
+  }
+
+  if (pCache == NULL)
+    return EvaluateNodes(pValues, pErrNo);
+
+  if (!pCache->Lookup(pValues, lfResult, ResultErrNo))
+  {
+    lfResult = EvaluateNodes(pValues, &ResultErrNo);
+    pCache->Insert(pValues, lfResult, ResultErrNo);
+  }
+  if (pErrNo)
+    *pErrNo = ResultErrNo;
+  return lfResult;
+}
+
+double CCompiledExpression::EvaluateNodes(const double *pValues, tERRNO *pErrNo) const
+{
+  double aLocalStack[EVAL_LOCAL_STACK];
+  vector<double> vHeapStack;
+  double *pStack = aLocalStack;
+  int Top = -1;
+  size_t NextChain = 0;
+  size_t NextKernel = 0;
+
+  if (vNode.empty())
+  {
+    if (pErrNo)
+      *pErrNo = ErrNo;
+    return 0.0;
+  }
+  if (MaxStackDepth > EVAL_LOCAL_STACK)
+  {
+    vHeapStack.resize(MaxStackDepth);
+    pStack = &vHeapStack[0];
+  }
+
+  for (int n=0; n<(int)vNode.size(); n++)
+  {
+    const tNODE &Node = vNode[n];
+
+    if (NextChain < vChain.size() && vChain[NextChain].iFirst == n)
+    {
+      // The whole sub-tree in one go, then carry on after its root.
+      pStack[++Top] = EvaluateChain(vChain[NextChain], &vChainTerm[vChain[NextChain].iFirstTerm], pValues);
+      n = vChain[NextChain].iRoot;
+      NextChain++;
+      continue;
+    }
+    if (NextKernel < vKernel.size() && vKernel[NextKernel].iFirst == n)
+    {
+      if (!EvaluateKernel(vKernel[NextKernel], pValues, pStack[++Top]))
+      {
+        if (pErrNo)
+          *pErrNo = ERR_DIVIDE_BY_ZERO;
+        return 0.0;
+      }
+      n = vKernel[NextKernel].iRoot;
+      NextKernel++;
+      continue;
+    }
+
+    switch (Node.Type)
+    {
+      case NODE_CONSTANT:
+        pStack[++Top] = GetValue(Node);
+        break;
+
+      case NODE_VARIABLE:
+        pStack[++Top] = pValues[Node.iVariable];
+        break;
+
+      case NODE_NEGATE:
+        pStack[Top] = -pStack[Top];
+        break;
+
+      case NODE_OPERATOR:
+      {
+        double Operand1 = pStack[Top--];
+        double Operand2 = pStack[Top];
+
+        switch (Node.cOperator)
+        {
+          case '+': pStack[Top] = Operand2 + Operand1; break;
+          case '-': pStack[Top] = Operand2 - Operand1; break;
+          case '*': pStack[Top] = Operand2 * Operand1; break;
+          case '/':
+            if (!(Node.Flags & NODE_FLAG_SAFE_DIVIDE) && Operand1 == 0.0)
+            {
+              if (pErrNo)
+                *pErrNo = ERR_DIVIDE_BY_ZERO;
+              return 0.0;
+            }
+            pStack[Top] = Operand2 / Operand1;
+            break;
+          default:
+            pStack[Top] = CEvaluator::ApplyOperator(Node.cOperator, Operand2, Operand1);
+            break;
+        }
+        break;
+      }
+    }
+  }
+
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return pStack[0];
+}
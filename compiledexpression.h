@@ -0,0 +1,514 @@
+// compiledexpression.h :
+// Interface/Include file for compiledexpression.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CCompiledExpression Class
+// A parsed (compiled) form of an expression, for callers that evaluate the
+// same expression many times. The expression is parsed once into a tree of
+// nodes which is then evaluated without re-reading the expression string.
+//
+// The tree mirrors the evaluation order of CEvaluator::EvaluateExpression
+// exactly (including the right to left grouping of consecutive * and /
+// operators), so compiled and interpreted results are identical unless
+// the caller asks for an optimisation which changes rounding.
+//
+// Variables are identified by slot number, allocated in order of first
+// appearance in the expression (the same order as CEvaluator uses).
+// Evaluate() takes an array of values indexed by slot.
+//
+// Nodes are held in a flat array in post-order (children before parents,
+// root last), so that evaluation is a single linear pass using a small
+// operand stack. Each node is 12 bytes: operands are referred to by 32-bit
+// index, variables by slot and constants by index into a table of the
+// distinct values used (GetLiteral()), so that formulas of millions of
+// tokens stay small. Parsing is iterative, so any depth of braces will do.
+// Long chains of + - or * over variables and constants are evaluated by a
+// tight loop rather than node by node (see tCHAIN), and small sub-trees of a
+// few common shapes, such as a*x+b, (a-b)/c and a*b+c*d, by a kernel written
+// for that shape (see tKERNEL). GetKernel() tells which matched.
+//
+// Evaluate() does not modify the object, so a compiled expression may be
+// evaluated by any number of threads concurrently.
+//
+// Specialise() binds some of the variables to constants for good (e.g. per
+// tenant parameters), folding away all the work that then becomes constant,
+// and leaves a smaller residual expression over the remaining variables.
+//
+// CompileAll() compiles a whole set of expressions (e.g. a rule base) in
+// parallel, using every core.
+//
+// Aggregate() evaluates the expression over a batch of rows and reduces the
+// results (sum, min, max, mean, variance) in the same pass, without storing
+// them.
+//
+// EvaluateBatch() works through the rows a tile at a time: each node over
+// every row of the tile, then the next node, so that each operation is a
+// simple loop over rows, which the compiler vectorises, while the operand
+// stack of the tile stays in the L1/L2 cache rather than going out to memory
+// as whole columns would. The number of rows in a tile is chosen by a short
+// calibration run the first time it is needed (or by CalibrateTileRows()),
+// unless set by SetTileRows(). With the memo cache enabled, or no expression
+// compiled, rows are evaluated one at a time by Evaluate() instead.
+//
+// EvaluateBatch() can also be given a tBATCHLIMITS: a cancellation flag and a
+// deadline, checked between chunks of rows. It then stops early if need be,
+// leaving the results so far and a cursor from which to carry on later.
+//
+// EvaluateGrid() evaluates the expression at every point of a grid, the
+// Cartesian product of a range (start, step, count) for each variable, into
+// a dense array. Work which does not depend on a variable is done once per
+// value of the variables outside it, rather than at every point.
+//
+// SetBounds() declares the range of values a variable can take. The range of
+// every subexpression is then worked out by interval arithmetic (GetRanges()),
+// and a division whose divisor cannot be zero is done without the check for
+// zero. Divisions which may still divide by zero are reported by
+// GetDivideWarnings(). With no bounds declared, only divisions by a non-zero
+// constant are found safe.
+//
+// EvaluateDictionary() takes a batch whose columns are dictionary-encoded (a
+// code for each row, and the value of each code), as low-cardinality
+// categorical inputs often are. It finds the distinct combinations of codes
+// present, evaluates each combination once (as a batch), and copies the
+// results out to the rows, so that a batch of millions of rows with a few
+// hundred distinct combinations costs little more than reading the codes.
+// Where nearly every row turns out to be a combination of its own, it gives up
+// and decodes the rest of the rows instead.
+//
+// Filter() gives the rows of a batch for which a predicate (e.g. "a*2 > b+10")
+// is true, as a selection vector: their row numbers in ascending order.
+// EvaluateBatch(), Aggregate() and Filter() itself accept a selection vector,
+// and then evaluate only the rows selected.
+//
+// The compiled form is allocated from the std::pmr::memory_resource given to
+// the constructor, e.g. a std::pmr::monotonic_buffer_resource, so that a
+// whole rule set can live in one arena and be released all at once. The
+// temporaries used while compiling come from a small arena on the stack
+// instead, so they neither use the caller's arena nor (usually) malloc.
+//
+// EnableProfile() records, for each node, how often it ran, how many errors
+// and NaN/Inf results it gave and, for one batch in PROFILE_SAMPLE_BATCHES,
+// how long it took; PrintProfile() shows these against the tree of the
+// expression. While profiling, evaluation is node by node (and a batch column
+// by column), so it is slower and the memo cache is not used. The timed
+// batches are also counted with the hardware performance counters, where
+// there are any (see perfcounters.h), for cycles, instructions, branch misses
+// and cache misses per row.
+//
+// A variable may be followed by a lag or a window, for expressions over time
+// series (see streamevaluator.h): a[-k] is the value of a k samples before
+// the current one, and a[-k:-j] is the sum of its values from k samples back
+// to j samples back, inclusive, so a[-9:0] is the sum of the last ten and
+// a[-9:0]/10 their mean. Each distinct lag or window has a variable slot of
+// its own, whose name is not a letter but one from HISTORY_FIRST_NAME up, so
+// they do not count towards the 52 variables. GetHistoryReference() gives
+// what such a slot refers to; its value is supplied like any other variable's
+// (CStreamEvaluator does so from the history it keeps). CEvaluator does not
+// accept them, nor does CCodeGenerator.
+//
+// EnableMemo() adds a CMemoCache (see memocache.h), consulted by Evaluate()
+// before doing any work. The cache is internally locked, so this is still
+// safe from many threads. Copies of the object share the cache until either
+// is recompiled.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(COMPILEDEXPRESSION_H_INCLUDED_)
+#define COMPILEDEXPRESSION_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "evaluator.h"
+#include "memocache.h"
+#include "perfcounters.h"
+
+// Compilation flags
+#define COMPILE_DEFAULT      0x0000
+#define COMPILE_REASSOCIATE  0x0001  // Rebalance long + - and * chains into balanced trees.
+                                     // Shortens the dependency chain, but changes rounding.
+#define COMPILE_FUSED_MULTIPLY_ADD 0x0002  // Kernels use fma() for x*y+z, x*y-z and w*x+y*z.
+                                           // Faster where fma() is done in hardware (e.g. built
+                                           // with /arch:AVX2), but changes rounding.
+#define COMPILE_NO_KERNELS   0x0004  // Evaluate the kernel shapes node by node (e.g. to compare).
+
+// Chains with fewer terms than this are left alone by COMPILE_REASSOCIATE,
+// and are evaluated node by node.
+#define CHAIN_MIN_TERMS 4
+
+// Aggregate() splits the rows into at most AGGREGATE_MAX_PARTS parts of at least
+// AGGREGATE_MIN_PART_ROWS rows. The parts depend only on the number of rows, never
+// on the number of threads, so the results are the same however many are used.
+#define AGGREGATE_MAX_PARTS     64
+#define AGGREGATE_MIN_PART_ROWS 1024
+
+// EvaluateBatch() times every node of one batch (or chunk, given a tBATCHLIMITS)
+// in this many, while profiling.
+#define PROFILE_SAMPLE_BATCHES 16
+
+// Rows evaluated between checks of a tBATCHLIMITS, by default. A check costs
+// about as much as evaluating a row, so this keeps it well under 1%, yet at
+// typical speeds still responds in well under a millisecond.
+#define BATCH_DEFAULT_CHUNK_ROWS 1024
+
+// Tile sizes tried by CalibrateTileRows(), and accepted by SetTileRows(), in rows.
+// A tile is also cut down so that its operand stack (rows * stack depth
+// doubles) fits in TILE_CACHE_BYTES, for very deep expressions.
+#define TILE_MIN_ROWS    16
+#define TILE_MAX_ROWS    4096
+#define TILE_CACHE_BYTES (256 * 1024)
+
+typedef struct tagBATCHLIMITS
+{
+  const std::atomic<bool> *pCancel;                    // Set (by any thread) to stop; NULL for none
+  std::chrono::steady_clock::time_point Deadline;      // time_point::max() for none
+  size_t nChunkRows;                                   // 0 for BATCH_DEFAULT_CHUNK_ROWS
+} tBATCHLIMITS;
+
+typedef enum tagBATCHSTATUS
+{
+  BATCH_COMPLETE  = 1,
+  BATCH_CANCELLED = 2,
+  BATCH_DEADLINE  = 3,   // The deadline passed first
+} tBATCHSTATUS;
+
+// One axis of EvaluateGrid(): the values lfStart + i * lfStep, for i = 0 .. nCount-1
+typedef struct tagGRIDAXIS
+{
+  double lfStart;
+  double lfStep;
+  size_t nCount;
+} tGRIDAXIS;
+
+// A dictionary-encoded column for EvaluateDictionary(): the value of row r is
+// pDictionary[pCode[r]]
+typedef struct tagDICTCOLUMN
+{
+  const unsigned int *pCode;
+  const double *pDictionary;
+  size_t nDictionary;          // Number of codes; a code of this or more is an error
+} tDICTCOLUMN;
+
+// Combinations of codes up to this many are looked up in a table, indexed by
+// the combination; larger key spaces are hashed.
+#define DICTIONARY_TABLE_KEYS 65536
+
+// Rows whose codes are read before the new combinations among them are evaluated
+#define DICTIONARY_CHUNK_ROWS 16384
+
+// A chunk in which more than one row in this many is a new combination ends
+// the lookups; the rest of the batch is decoded and evaluated row for row.
+#define DICTIONARY_MAX_NEW_SHARE 2
+
+// Names of the slots of lags and windows, e.g. a[-1], in order of first
+// appearance. Never letters, so never the name of a variable.
+#define HISTORY_FIRST_NAME     ((char)0x80)
+#define HISTORY_MAX_REFERENCES 128      // Distinct lags and windows in one expression
+#define HISTORY_MAX_SAMPLES    1000000  // Furthest back a lag or window may reach
+
+// A lag or window: samples back from the current one (0), oldest and newest
+// inclusive; the two are the same for a lag.
+typedef struct tagHISTORYREF
+{
+  char VariableName;
+  int Oldest;
+  int Newest;
+} tHISTORYREF;
+
+// The values a variable or subexpression can take; either end may be infinite.
+typedef struct tagRANGE
+{
+  double lfLow;
+  double lfHigh;
+} tRANGE;
+
+typedef struct tagNODEPROFILE
+{
+  unsigned long long nRuns;     // Rows for which the node was evaluated
+  unsigned long long nErrors;   // Of which gave an error (e.g. divide by zero)
+  unsigned long long nNaN;      // Of which gave NaN
+  unsigned long long nInf;      // Of which gave +/-Inf
+  double lfSeconds;             // Time spent in the node, in the sampled batches only
+} tNODEPROFILE;
+
+typedef struct tagAGGREGATE
+{
+  unsigned long long nRows;     // Rows evaluated without error
+  unsigned long long nErrors;   // Rows with an error (e.g. divide by zero), which are left out
+  double lfSum;
+  double lfMin;                 // HUGE_VAL if there were no rows (NaN results are not compared)
+  double lfMax;                 // -HUGE_VAL likewise
+  double lfMean;
+  double lfM2;                  // Sum of squared differences from the mean
+  double lfVariance;            // Population variance, lfM2 / nRows
+} tAGGREGATE;
+
+typedef enum tagNODETYPE
+{
+  NODE_CONSTANT = 1,
+  NODE_VARIABLE = 2,
+  NODE_NEGATE   = 3,   // Unary minus
+  NODE_OPERATOR = 4,   // Binary operator
+} tNODETYPE;
+
+typedef struct tagNODE
+{
+  unsigned char Type;  // A tNODETYPE
+  char cOperator;      // NODE_OPERATOR : '+', '-', '*', '/', or a comparison or logical
+                       // operator as held by CEvaluator (e.g. '<', OP_LESS_EQUAL, OP_AND)
+  unsigned short Flags; // NODE_FLAG_...
+  union
+  {
+    int iLeft;         // NODE_NEGATE, NODE_OPERATOR : (left) operand node
+    int iVariable;     // NODE_VARIABLE : variable slot
+    int iLiteral;      // NODE_CONSTANT : value, as index for GetLiteral()
+  };
+  int iRight;          // NODE_OPERATOR : right operand node
+} tNODE;
+
+#define NODE_FLAG_SAFE_DIVIDE 0x0001   // A '/' whose divisor cannot be zero, within the bounds
+
+// A sub-tree which is a chain of operators over leaves (variables and constants),
+// either left-deep as written, e.g. ((a+b)-c)+d, right-deep as the * and / grouping
+// produces, e.g. a*(b*(c*d)), or pairwise balanced as built by COMPILE_REASSOCIATE,
+// e.g. (a+b)+(c+d). Evaluate() runs these in a tight loop.
+// Left and right-deep chains are serial dependency chains; a balanced one is
+// not, so the CPU can overlap its operations.
+typedef enum tagCHAINSHAPE
+{
+  CHAIN_LEFT_DEEP  = 1,
+  CHAIN_RIGHT_DEEP = 2,
+  CHAIN_BALANCED   = 3,
+} tCHAINSHAPE;
+
+typedef struct tagCHAINTERM
+{
+  char cOperator;      // Left/right-deep: combines the term with the running result
+                       // (ignored for the first/last term respectively)
+  int iVariable;       // Variable slot, or -1 for a constant
+  double lfValue;      // Constant value
+} tCHAINTERM;
+
+typedef struct tagCHAIN
+{
+  int iFirst;          // First node of the sub-tree in post-order
+  int iRoot;           // Its root, i.e. its last node
+  tCHAINSHAPE Shape;
+  char cOperator;      // Balanced: the one operator used throughout
+  int iFirstTerm;      // Its terms, in CCompiledExpression::vChainTerm
+  int nTerms;
+} tCHAIN;
+
+// A sub-tree of one of these shapes, over leaves t0..t3 (variables and constants),
+// which Evaluate() runs as a single step. cOuter is the operator at its root and
+// cInner the one below it.
+typedef enum tagKERNELTYPE
+{
+  KERNEL_MUL_ADD   = 1,   // (t0 * t1) +- t2      e.g. a*x+b
+  KERNEL_ADD_MUL   = 2,   // t0 +- (t1 * t2)      e.g. b+a*x
+  KERNEL_DOT2      = 3,   // (t0 * t1) +- (t2 * t3)  e.g. a*b+c*d
+  KERNEL_SUM_SCALE = 4,   // (t0 +- t1) */ t2     e.g. (a-b)/c
+  KERNEL_SCALE_SUM = 5,   // t0 */ (t1 +- t2)     e.g. c*(a+b)
+} tKERNELTYPE;
+
+#define KERNEL_MAX_TERMS 4
+
+typedef struct tagKERNEL
+{
+  int iFirst;          // First node of the sub-tree in post-order
+  int iRoot;           // Its root, i.e. its last node
+  tKERNELTYPE Type;
+  char cOuter;
+  char cInner;
+  bool bFused;         // COMPILE_FUSED_MULTIPLY_ADD applies
+  bool bSafeDivide;    // Its '/' is NODE_FLAG_SAFE_DIVIDE
+  tCHAINTERM aTerm[KERNEL_MAX_TERMS];   // Operators unused
+} tKERNEL;
+
+class CCompiledExpression
+{
+  public:
+    CCompiledExpression(std::pmr::memory_resource *pResource = NULL);   // NULL means the default resource
+    ~CCompiledExpression();
+
+    bool Compile(const char *szExpression, unsigned int uFlags = COMPILE_DEFAULT);
+    tERRNO GetErrorNumber(void) const;
+
+    // vCompiled[i] and vErrNo[i] are the compiled form of, and the error number from,
+    // vExpression[i]. See CEvaluator::GetErrorDescription() for the error text.
+    // nThreads 0 means one per core. Returns false if any expression failed.
+    // The compiled forms are allocated from pResource, which must be thread safe
+    // (e.g. std::pmr::synchronized_pool_resource) unless nThreads is 1.
+    static bool CompileAll(const std::vector<std::string> &vExpression,
+                           std::vector<CCompiledExpression> &vCompiled,
+                           std::vector<tERRNO> &vErrNo,
+                           unsigned int uFlags = COMPILE_DEFAULT, int nThreads = 0,
+                           std::pmr::memory_resource *pResource = NULL);
+
+    int GetNumberOfVariables(void) const;
+    char GetVariableName(int Slot) const;
+    int GetVariableSlot(char VariableName) const;    // -1 if the variable is not used
+    bool HasHistory(void) const;                     // Any lags or windows
+    bool GetHistoryReference(int Slot, tHISTORYREF &Reference) const;   // false for a plain variable
+    std::string GetVariableText(int Slot) const;     // As written, e.g. "a", "a[-1]" or "a[-9:0]"
+
+    // pValues[Slot] is the value of each variable.
+    // On error (e.g. divide by zero) 0.0 is returned and *pErrNo is set.
+    double Evaluate(const double *pValues, tERRNO *pErrNo = NULL) const;
+
+    // Batches: ppColumns[Slot][Row] is the value of each variable in each of nRows rows.
+    // If pSelection is given, only its nSelected rows are evaluated (nRows is then unused).
+    // pResults[k] and pErrNo[k] are for the k'th row evaluated.
+    void EvaluateBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL,
+                       const unsigned int *pSelection = NULL, size_t nSelected = 0) const;
+
+    // As above, from row (or selection entry) Cursor on, until done or stopped by Limits.
+    // Cursor is left after the last row evaluated, and results are in place up to it,
+    // so calling again with the same arguments carries on where this left off.
+    tBATCHSTATUS EvaluateBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo,
+                               const tBATCHLIMITS &Limits, size_t &Cursor,
+                               const unsigned int *pSelection = NULL, size_t nSelected = 0) const;
+    static void InitialiseLimits(tBATCHLIMITS &Limits);   // No cancellation flag, no deadline
+
+    // Rows per tile for EvaluateBatch(), for all expressions. 0 means calibrate
+    // again when next needed; other values are clamped to TILE_MIN_ROWS..TILE_MAX_ROWS.
+    static void SetTileRows(size_t nRows);
+    static size_t GetTileRows(void);                     // Calibrating first if need be
+    static size_t CalibrateTileRows(void);               // Times each tile size, and keeps the fastest
+
+    // pAxis[Slot] is the range of each variable. The results are in row-major
+    // order, slot 0 outermost and the last slot innermost (varying fastest), so
+    // the point (i0, i1, .. iN) is at ((i0 * nCount1 + i1) * nCount2 + ..) + iN.
+    // pResults and pErrNo must hold GetGridPoints() entries. Neither profiled
+    // nor memoised. Returns false if there is nothing compiled.
+    bool EvaluateGrid(const tGRIDAXIS *pAxis, double *pResults, tERRNO *pErrNo = NULL) const;
+    size_t GetGridPoints(const tGRIDAXIS *pAxis) const;
+
+    // pColumns[Slot] is the column of each variable. A row with a code outside
+    // its dictionary gives ERR_EVALUATION_FAILED. Returns the number of
+    // distinct combinations evaluated, or 0 if the rows were decoded and
+    // evaluated one by one instead, because there are more possible
+    // combinations than a 64-bit key can tell apart, or too many distinct ones
+    // turned up (see DICTIONARY_MAX_NEW_SHARE). The results are the same either way.
+    size_t EvaluateDictionary(const tDICTCOLUMN *pColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL) const;
+
+    // vSelected is the rows for which the expression is non-zero and without error.
+    // Returns the number of them.
+    size_t Filter(const double *const *ppColumns, size_t nRows, std::vector<unsigned int> &vSelected,
+                  const unsigned int *pSelection = NULL, size_t nSelected = 0) const;
+
+    // nThreads 0 means one per core.
+    void Aggregate(const double *const *ppColumns, size_t nRows, tAGGREGATE &Result, int nThreads = 1,
+                   const unsigned int *pSelection = NULL, size_t nSelected = 0) const;
+
+    // Residual is compiled over the variables not in vBinding, in the same
+    // relative order. Its results are identical to this expression's with the
+    // bound values supplied. Bindings for variables not used are ignored.
+    bool Specialise(const std::vector<CVariable> &vBinding, CCompiledExpression &Residual) const;
+
+    // Values of the variable are promised to lie within [lfLow, lfHigh], which
+    // may be infinite at either end. Outside the bounds, a division found safe
+    // gives Inf or NaN rather than ERR_DIVIDE_BY_ZERO. Bounds last until the
+    // next Compile(); a residual from Specialise() keeps those of its variables.
+    // False if the variable is not used or lfLow > lfHigh. Not while evaluating.
+    bool SetBounds(char VariableName, double lfLow, double lfHigh);
+    void ClearBounds(void);
+    void GetRanges(std::vector<tRANGE> &vRange) const;   // Of each node, by node number
+    tRANGE GetResultRange(void) const;
+    // The NODE_OPERATOR '/' nodes whose divisor may be zero. Returns how many.
+    size_t GetDivideWarnings(std::vector<int> &vWarning) const;
+    void PrintRanges(std::ostream &os) const;
+
+    void EnableProfile(void);                        // Starts again if already profiling
+    void DisableProfile(void);
+    bool GetNodeProfile(int iNode, tNODEPROFILE &Profile) const;   // false unless profiling
+    // Over the nRows rows of the timed batches. false unless profiling with hardware counters.
+    bool GetHardwareProfile(tPERFCOUNTS &Counts, unsigned long long &nRows) const;
+    void PrintProfile(std::ostream &os) const;
+
+    void EnableMemo(size_t nCapacity = MEMO_DEFAULT_CAPACITY);
+    void DisableMemo(void);
+    CMemoCache *GetMemo(void) const;                 // NULL unless enabled
+
+    int GetNumberOfNodes(void) const;
+    const tNODE &GetNode(int iNode) const;
+    int GetRoot(void) const;
+    int GetHeight(void) const;                       // Longest path from the root to a leaf
+    double GetLiteral(int iLiteral) const;
+    int GetNumberOfLiterals(void) const;
+    size_t GetMemoryUsage(void) const;               // Bytes held by the compiled form
+
+    int GetNumberOfKernels(void) const;
+    const tKERNEL &GetKernel(int iKernel) const;     // In order of iFirst
+    static const char *GetKernelName(tKERNELTYPE Type);
+
+  private:
+    struct tagPROFILE;
+
+    bool CompileExpression(const char *szExpression, unsigned int uFlags);
+    bool ParseExpression(const std::pmr::string &sExpr, int &iResult);
+    bool ProcessOperators(std::pmr::vector<int> &vOperand, std::pmr::vector<char> &vOperator,
+                          size_t OperandBase, size_t OperatorBase, int MinPrecedence = 0);
+    int AddNode(tNODETYPE Type, char cOperator, int iLeft, int iRight);
+    int AddConstant(double lfValue);
+    int AddVariable(char ch);
+    int AddHistoryReference(char VariableName, int Oldest, int Newest);   // -1 if too many
+    static bool ParseHistoryReference(const std::pmr::string &sExpr, size_t &i, int &Oldest, int &Newest);
+    double GetValue(const tNODE &Node) const;        // Of a NODE_CONSTANT
+
+    int Reassociate(int iRoot, std::pmr::vector<tNODE> &vOut);
+    int Balance(std::pmr::vector<int> &vTerm, char cOperator, std::pmr::vector<tNODE> &vOut);
+    void Linearise(int iRoot);
+    void PlanChains(void);
+    void PlanKernels(void);
+    static double EvaluateChain(const tCHAIN &Chain, const tCHAINTERM *pTerm, const double *pValues);
+    void AnalyseRanges(void);
+    void PrintRangeNode(std::ostream &os, const std::vector<tRANGE> &vRange, int iNode, int Depth) const;
+    static std::string GetPrintIndent(int Depth);
+    static bool EvaluateKernel(const tKERNEL &Kernel, const double *pValues, double &lfResult);
+    double EvaluateNodes(const double *pValues, tERRNO *pErrNo) const;
+    void GetRow(const double *const *ppColumns, size_t Row, double *pRow) const;
+    void AggregateRows(const double *const *ppColumns, const unsigned int *pSelection,
+                       size_t First, size_t End, tAGGREGATE &Result) const;
+    void EvaluateRows(const double *const *ppColumns, const unsigned int *pSelection,
+                      size_t First, size_t End, double *pResults, tERRNO *pErrNo) const;
+    void EvaluateDecoded(const tDICTCOLUMN *pColumns, size_t First, size_t nRows, double *pResults, tERRNO *pErrNo) const;
+    void EvaluateTiles(const double *const *ppColumns, const unsigned int *pSelection,
+                       size_t First, size_t End, double *pResults, tERRNO *pErrNo, size_t nTileRows) const;
+    void ProfileRows(const double *const *ppColumns, const unsigned int *pSelection,
+                     size_t First, size_t End, double *pResults, tERRNO *pErrNo, bool bTime) const;
+    std::string GetNodeLabel(const tNODE &Node) const;   // As in PrintProfile()
+    void PrintProfileNode(std::ostream &os, int iNode, int Depth, double lfTotalSeconds) const;
+    static void ClearAggregate(tAGGREGATE &Result);
+    static void MergeAggregate(tAGGREGATE &Result, const tAGGREGATE &Part);
+
+    std::pmr::vector<tNODE> vNode;
+    std::pmr::vector<double> vLiteral;        // Each distinct constant once
+    std::pmr::unordered_map<unsigned long long, int> *pLiteralIndex;   // Literal of each bit pattern, while compiling
+    std::pmr::vector<tCHAIN> vChain;          // In order of iFirst
+    std::pmr::vector<tCHAINTERM> vChainTerm;
+    std::pmr::vector<tKERNEL> vKernel;        // In order of iFirst, none within a chain
+    std::pmr::vector<tRANGE> vBound;          // Of each variable, by slot
+    tRANGE ResultRange;
+    unsigned int uCompileFlags;
+    std::pmr::vector<char> vVariableName;
+    std::pmr::vector<tHISTORYREF> vHistory;   // Of each name from HISTORY_FIRST_NAME on
+    std::pmr::memory_resource *pScratch;      // For temporaries, during Compile() and Specialise()
+    int MaxStackDepth;
+    tERRNO ErrNo;
+    std::shared_ptr<CMemoCache> pMemo;
+    size_t nMemoCapacity;            // Non-zero if the memo cache is enabled
+    std::shared_ptr<tagPROFILE> pProfile;
+    bool bProfile;
+};
+
+#endif // !defined(COMPILEDEXPRESSION_H_INCLUDED_)
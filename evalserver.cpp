@@ -0,0 +1,452 @@
+// evalserver.cpp :
+// Implementation of the local evaluation server (POSIX only).
+// Jonathan Gilmore, 19/10/2026
+//
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Threading model:
+// - One thread accepts connections on the listening socket.
+// - One (detached) thread per connection reads request lines and queues
+//   them (Enqueue).
+// - Batches of requests are evaluated by the CThreadPool workers (ProcessBatch).
+//   Each batch uses its own CBatchEvaluator, so no evaluator is ever shared
+//   between threads.
+// - Replies are written by the worker that evaluated the batch, under the
+//   connection's write mutex, with one write per connection per batch.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sstream>
+
+#include "evalserver.h"
+#include "resultring.h"
+
+using namespace std;
+
+// A connection is shared by its reader thread and by every request
+// queued from it, so the socket is closed only once the last reply
+// for it has been written.
+typedef struct tagSERVERCONNECTION
+{
+  int Socket;
+  mutex WriteMutex;
+
+  ~tagSERVERCONNECTION() { close(Socket); }
+} tSERVERCONNECTION;
+
+////////////////////////////////////////////////////////////////////////////
+// CBatchEvaluator
+// Supplies variable values from the bindings of the request being evaluated,
+// rather than prompting the user.
+////////////////////////////////////////////////////////////////////////////
+class CBatchEvaluator : public CEvaluator
+{
+  public:
+    CBatchEvaluator() { pBinding = NULL; }
+
+    void SetBindings(const vector<CVariable> *pArgBinding) { pBinding = pArgBinding; ErrNo = ERR_OK; }
+    bool InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet);
+
+  private:
+    const vector<CVariable> *pBinding;
+};
+
+bool CBatchEvaluator::InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet)
+{
+  for (size_t i=0; i<pBinding->size(); i++)
+  {
+    CVariable Variable = (*pBinding)[i];
+    if (Variable.GetName() == VariableName)
+    {
+      ValueRet = Variable.GetValue();
+      return true;
+    }
+  }
+  // Unlike the interactive case, there is no sensible default to fall back on.
+  ErrNo = ERR_INVALID_VARNAME;
+  return false;
+}
+
+static long long SteadyTicks(void)
+{
+  return (long long)chrono::steady_clock::now().time_since_epoch().count();
+}
+
+static void FormatReply(string &sReply, const string &sId, tERRNO ErrNo, double lfResult)
+{
+  char szBuffer[64];
+
+  snprintf(szBuffer, sizeof(szBuffer), "|%d|%.17g\n", (int)ErrNo, lfResult);
+  sReply += sId;
+  sReply += szBuffer;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CEvaluationServer implementation
+////////////////////////////////////////////////////////////////////////////
+CEvaluationServer::CEvaluationServer(int nThreads, size_t nArgMaxBatch) : Pool(nThreads)
+{
+  nMaxBatch = (nArgMaxBatch > 0) ? nArgMaxBatch : 1;
+  ListenSocket = -1;
+  bStopping = false;
+  pRing = NULL;
+  ResetStatistics();
+}
+
+CEvaluationServer::~CEvaluationServer(void)
+{
+  Stop();
+}
+
+bool CEvaluationServer::Start(const char *szSocketPath)
+{
+  struct sockaddr_un Address;
+
+  if (strlen(szSocketPath) >= sizeof(Address.sun_path))
+    return false;
+
+  ListenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (ListenSocket < 0)
+    return false;
+
+  memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  strcpy(Address.sun_path, szSocketPath);
+  unlink(szSocketPath); // Remove any stale socket left by a previous run
+
+  if (::bind(ListenSocket, (struct sockaddr *)&Address, sizeof(Address)) < 0 ||
+      listen(ListenSocket, SOMAXCONN) < 0)
+  {
+    close(ListenSocket);
+    ListenSocket = -1;
+    return false;
+  }
+
+  sSocketPath = szSocketPath;
+  bStopping = false;
+  ResetStatistics();
+  AcceptThread = thread(&CEvaluationServer::AcceptLoop, this);
+  return true;
+}
+
+void CEvaluationServer::Stop(void)
+{
+  if (ListenSocket < 0)
+    return;
+
+  bStopping = true;
+
+  // shutdown() wakes any thread blocked in accept() or recv() on the socket.
+  shutdown(ListenSocket, SHUT_RDWR);
+  AcceptThread.join();
+  close(ListenSocket);
+  ListenSocket = -1;
+  unlink(sSocketPath.c_str());
+
+  {
+    unique_lock<mutex> Lock(ConnectionMutex);
+    for (size_t i=0; i<vConnection.size(); i++)
+      shutdown(vConnection[i]->Socket, SHUT_RDWR);
+    while (!vConnection.empty())
+      ConnectionClosed.wait(Lock);
+  }
+
+  // Let any queued batches finish. The last reference to each
+  // connection is dropped (and its socket closed) as they do.
+  Pool.Wait();
+}
+
+void CEvaluationServer::AcceptLoop(void)
+{
+  while (!bStopping)
+  {
+    int Socket = accept(ListenSocket, NULL, NULL);
+    if (Socket < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      break; // Listening socket has been shut down
+    }
+
+    shared_ptr<tSERVERCONNECTION> pConnection(new tSERVERCONNECTION);
+    pConnection->Socket = Socket;
+
+    lock_guard<mutex> Lock(ConnectionMutex);
+    vConnection.push_back(pConnection);
+    thread(&CEvaluationServer::ConnectionLoop, this, pConnection).detach();
+  }
+}
+
+void CEvaluationServer::ConnectionLoop(shared_ptr<tSERVERCONNECTION> pConnection)
+{
+  char szBuffer[16384];
+  string sPartial;
+
+  while (!bStopping)
+  {
+    ssize_t n = recv(pConnection->Socket, szBuffer, sizeof(szBuffer), 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break; // Client closed the connection (or we are stopping)
+
+    // Split the received bytes into lines, keeping any incomplete
+    // trailing line until the rest of it arrives.
+    sPartial.append(szBuffer, (size_t)n);
+    size_t Start = 0;
+    size_t End;
+    while ((End = sPartial.find('\n', Start)) != string::npos)
+    {
+      HandleLine(pConnection, sPartial.substr(Start, End - Start));
+      Start = End + 1;
+    }
+    sPartial.erase(0, Start);
+
+    // A line with no end in sight: refuse it and stop reading
+    if (sPartial.length() > SERVER_MAX_LINE_BYTES)
+    {
+      string sReply;
+
+      FormatReply(sReply, "?", ERR_UNKNOWN, 0.0);
+      Reply(pConnection.get(), sReply);
+      break;
+    }
+  }
+
+  lock_guard<mutex> Lock(ConnectionMutex);
+  for (size_t i=0; i<vConnection.size(); i++)
+  {
+    if (vConnection[i] == pConnection)
+    {
+      vConnection.erase(vConnection.begin() + i);
+      break;
+    }
+  }
+  ConnectionClosed.notify_all();
+}
+
+bool CEvaluationServer::ParseBindings(const string &sBindings, vector<CVariable> &vBinding) // static
+{
+  size_t Start = 0;
+
+  while (Start < sBindings.length())
+  {
+    size_t End = sBindings.find(',', Start);
+    if (End == string::npos)
+      End = sBindings.length();
+
+    string sBinding = sBindings.substr(Start, End - Start);
+    size_t Equals = sBinding.find('=');
+    if (Equals != 1 || !isalpha(sBinding[0]))
+      return false;
+
+    CVariable Variable(sBinding[0]);
+    string sValue = sBinding.substr(2);
+    Variable.SetValue(sValue);
+    vBinding.push_back(Variable);
+
+    Start = End + 1;
+  }
+  return true;
+}
+
+void CEvaluationServer::HandleLine(shared_ptr<tSERVERCONNECTION> &pConnection, const string &sLine)
+{
+  tSERVERREQUEST Request;
+
+  if (sLine == "STATS")
+  {
+    ostringstream os;
+    PrintStatistics(os);
+    Reply(pConnection.get(), os.str());
+    return;
+  }
+
+  // The expression may itself contain bars (||), but the id and the
+  // bindings cannot, so split at the first and last bars.
+  size_t Bar1 = sLine.find('|');
+  size_t Bar2 = sLine.rfind('|');
+
+  if (Bar2 == Bar1)
+    Bar2 = string::npos;
+
+  Request.pConnection = pConnection;
+  Request.Received = chrono::steady_clock::now();
+  Request.ParseErrNo = ERR_OK;
+
+  if (Bar2 == string::npos)
+  {
+    string sReply;
+    Request.sId = (Bar1 == string::npos) ? string("?") : sLine.substr(0, Bar1);
+    FormatReply(sReply, Request.sId, ERR_UNKNOWN, 0.0);
+    Reply(pConnection.get(), sReply);
+    return;
+  }
+
+  Request.sId = sLine.substr(0, Bar1);
+  if (!ParseBindings(sLine.substr(Bar2 + 1), Request.vBinding))
+    Request.ParseErrNo = ERR_INVALID_VARNAME;
+
+  Enqueue(sLine.substr(Bar1 + 1, Bar2 - Bar1 - 1), Request);
+}
+
+void CEvaluationServer::Enqueue(const string &sExpression, tSERVERREQUEST &Request)
+{
+  bool bSchedule;
+
+  {
+    lock_guard<mutex> Lock(PendingMutex);
+    vector<tSERVERREQUEST> &vBatch = mPending[sExpression];
+    // Only the first request for an expression schedules a job; later ones
+    // join the batch for as long as that job is waiting in the pool queue.
+    bSchedule = vBatch.empty();
+    vBatch.push_back(Request);
+  }
+
+  if (bSchedule)
+    Pool.Submit([this, sExpression]() { ProcessBatch(sExpression); });
+}
+
+void CEvaluationServer::ProcessBatch(const string &sExpression)
+{
+  vector<tSERVERREQUEST> vBatch;
+  bool bMoreToDo = false;
+
+  {
+    lock_guard<mutex> Lock(PendingMutex);
+    map<string, vector<tSERVERREQUEST> >::iterator it = mPending.find(sExpression);
+    if (it == mPending.end())
+      return;
+
+    if (it->second.size() <= nMaxBatch)
+    {
+      vBatch.swap(it->second);
+      mPending.erase(it);
+    }
+    else
+    {
+      vBatch.assign(it->second.begin(), it->second.begin() + nMaxBatch);
+      it->second.erase(it->second.begin(), it->second.begin() + nMaxBatch);
+      bMoreToDo = true;
+    }
+  }
+
+  if (bMoreToDo)
+    Pool.Submit([this, sExpression]() { ProcessBatch(sExpression); });
+
+  // Parse the expression once for the whole batch.
+  CBatchEvaluator Evaluator;
+  bool bParsed = Evaluator.SetExpression(sExpression.c_str());
+  tERRNO ParseErrNo = Evaluator.GetErrorNumber();
+
+  // Build the replies for each connection, so that each gets one write.
+  map<tSERVERCONNECTION *, string> mReply;
+  vector<tRINGRECORD> vRecord(pRing ? vBatch.size() : 0);
+
+  for (size_t i=0; i<vBatch.size(); i++)
+  {
+    tSERVERREQUEST &Request = vBatch[i];
+    double lfResult = 0.0;
+    tERRNO ErrNo;
+
+    if (!bParsed)
+      ErrNo = ParseErrNo;
+    else if (Request.ParseErrNo != ERR_OK)
+      ErrNo = Request.ParseErrNo;
+    else
+    {
+      Evaluator.SetBindings(&Request.vBinding);
+      if (Evaluator.InitialiseVariables())
+        lfResult = Evaluator.EvaluateExpression();
+      ErrNo = Evaluator.GetErrorNumber();
+    }
+    FormatReply(mReply[Request.pConnection.get()], Request.sId, ErrNo, lfResult);
+    if (pRing)
+    {
+      vRecord[i].RowId = strtoull(Request.sId.c_str(), NULL, 10);
+      vRecord[i].lfResult = lfResult;
+      vRecord[i].ErrNo = (int)ErrNo;
+      vRecord[i].Reserved = 0;
+    }
+  }
+
+  map<tSERVERCONNECTION *, string>::iterator it;
+  for (it=mReply.begin(); it!=mReply.end(); it++)
+    Reply(it->first, it->second);
+  if (pRing)
+  {
+    lock_guard<mutex> Lock(RingMutex);
+    pRing->Write(&vRecord[0], vRecord.size());
+  }
+
+  chrono::steady_clock::time_point Now = chrono::steady_clock::now();
+  for (size_t i=0; i<vBatch.size(); i++)
+    Latency.Record((unsigned long long)chrono::duration_cast<chrono::nanoseconds>(Now - vBatch[i].Received).count());
+
+  nCompleted.fetch_add(vBatch.size());
+  nBatches.fetch_add(1);
+}
+
+void CEvaluationServer::Reply(tSERVERCONNECTION *pConnection, const string &sReply)
+{
+  lock_guard<mutex> Lock(pConnection->WriteMutex);
+  const char *p = sReply.data();
+  size_t nRemaining = sReply.length();
+
+  while (nRemaining > 0)
+  {
+    ssize_t n = send(pConnection->Socket, p, nRemaining, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return; // Client has gone away; nothing useful to do with the reply
+    p += n;
+    nRemaining -= (size_t)n;
+  }
+}
+
+void CEvaluationServer::SetResultRing(CResultRing *pArgRing)
+{
+  pRing = pArgRing;
+}
+
+void CEvaluationServer::ResetStatistics(void)
+{
+  Latency.Reset();
+  nCompleted = 0;
+  nBatches = 0;
+  StatisticsStart = SteadyTicks();
+}
+
+void CEvaluationServer::GetStatistics(tSERVERSTATS &Stats)
+{
+  chrono::steady_clock::duration Elapsed(SteadyTicks() - StatisticsStart.load());
+
+  Stats.nCompleted = nCompleted.load();
+  Stats.nBatches = nBatches.load();
+  Stats.lfElapsedSeconds = chrono::duration<double>(Elapsed).count();
+  Stats.lfThroughput = (Stats.lfElapsedSeconds > 0.0) ? Stats.nCompleted / Stats.lfElapsedSeconds : 0.0;
+  Stats.lfMeanBatchSize = Stats.nBatches ? (double)Stats.nCompleted / (double)Stats.nBatches : 0.0;
+  Stats.P50Nanoseconds = Latency.GetPercentile(50.0);
+  Stats.P99Nanoseconds = Latency.GetPercentile(99.0);
+}
+
+void CEvaluationServer::PrintStatistics(ostream &os)
+{
+  tSERVERSTATS Stats;
+
+  GetStatistics(Stats);
+  os << "completed=" << Stats.nCompleted
+     << " batches=" << Stats.nBatches
+     << " mean_batch=" << Stats.lfMeanBatchSize
+     << " throughput=" << Stats.lfThroughput << "/s"
+     << " p50=" << Stats.P50Nanoseconds / 1000.0 << "us"
+     << " p99=" << Stats.P99Nanoseconds / 1000.0 << "us" << endl;
+}
@@ -0,0 +1,139 @@
+// evalserver.h :
+// Interface/Include file for evalserver.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CEvaluationServer Class
+// A local evaluation daemon listening on a Unix domain socket (POSIX only).
+// Several processes on a host can share the one server rather than each
+// embedding their own CEvaluator.
+//
+// The protocol is line based. Each request is a single line:
+//   <id>|<expression>|<name>=<value>,<name>=<value>,...
+// and each reply is a single line:
+//   <id>|<error number>|<result>
+// where <error number> is a tERRNO value (0 == ERR_OK).
+// Replies on a connection may be returned out of order, hence the <id>.
+// The line "STATS" returns a one line summary of the server statistics.
+// A malformed line gets the reply <id>|<ERR_UNKNOWN>|0 (or ?|... with no id).
+// A line longer than SERVER_MAX_LINE_BYTES gets ?|<ERR_UNKNOWN>|0 and the
+// connection is closed, so that one client cannot use up the server's memory.
+// Braces nested more than EVALUATOR_MAX_DEPTH deep get <id>|<ERR_BRACES_TOO_DEEP>|0.
+//
+// Requests for the same expression that arrive while a batch for that
+// expression is waiting to run are coalesced into that batch, so the
+// expression is parsed once (SetExpression) and then evaluated once per
+// request. Batches are run on a CThreadPool.
+//
+// Given a CResultRing (SetResultRing()), every result is also published to
+// it, for other processes on the host to read from shared memory.
+//
+// Build (POSIX), as one command:
+//   g++ -O2 -std=c++20 -pthread -o evalserver evalserverapp.cpp evalserver.cpp loadgenerator.cpp latencyhistogram.cpp threadpool.cpp evaluator.cpp variable.cpp compiledexpression.cpp memocache.cpp perfcounters.cpp resultring.cpp -lrt
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(EVALSERVER_H_INCLUDED_)
+#define EVALSERVER_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "evaluator.h"
+#include "variable.h"
+#include "latencyhistogram.h"
+#include "threadpool.h"
+
+#define SERVER_DEFAULT_MAX_BATCH 256
+#define SERVER_MAX_LINE_BYTES    (64 << 20)   // Room for expressions of a few million terms
+
+class CResultRing;
+
+typedef struct tagSERVERSTATS
+{
+  unsigned long long nCompleted;          // Requests answered
+  unsigned long long nBatches;            // Batches evaluated
+  double lfElapsedSeconds;                // Since Start() or ResetStatistics()
+  double lfThroughput;                    // Requests per second
+  double lfMeanBatchSize;
+  unsigned long long P50Nanoseconds;      // Receipt of request to reply sent
+  unsigned long long P99Nanoseconds;
+} tSERVERSTATS;
+
+struct tagSERVERCONNECTION;
+
+class CEvaluationServer
+{
+  public:
+    CEvaluationServer(int nThreads = 0, size_t nMaxBatch = SERVER_DEFAULT_MAX_BATCH);
+    ~CEvaluationServer();
+
+    bool Start(const char *szSocketPath);
+    void Stop(void);
+
+    // Also write each result to pRing, with the request id (which must then be
+    // numeric) as its RowId. Waits for room if the readers fall behind.
+    // Set before Start(); pRing must outlive the server.
+    void SetResultRing(CResultRing *pRing);
+
+    void GetStatistics(tSERVERSTATS &Stats);
+    void ResetStatistics(void);
+    void PrintStatistics(std::ostream &os);
+
+  private:
+    typedef struct tagSERVERREQUEST
+    {
+      std::shared_ptr<struct tagSERVERCONNECTION> pConnection;
+      std::string sId;
+      std::vector<CVariable> vBinding;
+      tERRNO ParseErrNo;                  // Set if the request line itself was malformed
+      std::chrono::steady_clock::time_point Received;
+    } tSERVERREQUEST;
+
+    void AcceptLoop(void);
+    void ConnectionLoop(std::shared_ptr<struct tagSERVERCONNECTION> pConnection);
+    void HandleLine(std::shared_ptr<struct tagSERVERCONNECTION> &pConnection, const std::string &sLine);
+    void Enqueue(const std::string &sExpression, tSERVERREQUEST &Request);
+    void ProcessBatch(const std::string &sExpression);
+    void Reply(struct tagSERVERCONNECTION *pConnection, const std::string &sReply);
+
+    static bool ParseBindings(const std::string &sBindings, std::vector<CVariable> &vBinding);
+
+    CThreadPool Pool;
+    size_t nMaxBatch;
+
+    std::string sSocketPath;
+    int ListenSocket;
+    std::thread AcceptThread;
+    std::atomic<bool> bStopping;
+
+    // Connections whose reader thread is still running.
+    std::mutex ConnectionMutex;
+    std::condition_variable ConnectionClosed;
+    std::vector<std::shared_ptr<struct tagSERVERCONNECTION> > vConnection;
+
+    // Requests waiting to be evaluated, keyed by expression.
+    // An entry exists only while a batch job for that expression is queued.
+    std::mutex PendingMutex;
+    std::map<std::string, std::vector<tSERVERREQUEST> > mPending;
+
+    CResultRing *pRing;
+    std::mutex RingMutex;                   // The ring has a single writer
+
+    CLatencyHistogram Latency;
+    std::atomic<unsigned long long> nCompleted;
+    std::atomic<unsigned long long> nBatches;
+    std::atomic<long long> StatisticsStart; // steady_clock ticks
+};
+
+#endif // !defined(EVALSERVER_H_INCLUDED_)
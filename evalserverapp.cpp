@@ -0,0 +1,367 @@
+// evalserverapp.cpp : Defines the entry point for the evaluation server daemon (POSIX only).
+// Jonathan Gilmore, 19/10/2026
+//
+
+//////////////////////////////////////////////////////////////////////////////
+// Usage:
+//   evalserver <socket path> [threads] [ring name]
+//     Run the server until SIGINT or SIGTERM, printing statistics every
+//     STATS_INTERVAL seconds. Given a ring name (e.g. /evalresults), every
+//     result is also published to a CResultRing of that name.
+//   evalserver --loadtest [clients] [requests per client] [window] [threads]
+//     Start a server on a temporary socket, drive it with the local load
+//     generator and print both client and server statistics.
+//     The exit code is non-zero if any reply failed or was incorrect.
+//   evalserver --ringbench [rows] [readers]
+//     Evaluate a batch into a CResultRing read by reader processes, then
+//     send the same results to the same number of processes through pipes,
+//     and compare. The exit code is non-zero if any reader lost a record.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "compiledexpression.h"
+#include "evalserver.h"
+#include "loadgenerator.h"
+#include "resultring.h"
+
+using namespace std;
+
+#define STATS_INTERVAL 10
+
+// Records each reader takes at a time in --ringbench
+#define RING_BENCH_READ_RECORDS 1024
+
+static int RunLoadTest(int argc, char* argv[])
+{
+  int nClients   = (argc > 2) ? atoi(argv[2]) : 8;
+  int nRequests  = (argc > 3) ? atoi(argv[3]) : 20000;
+  int nWindow    = (argc > 4) ? atoi(argv[4]) : 32;
+  int nThreads   = (argc > 5) ? atoi(argv[5]) : 0;
+  char szSocketPath[64];
+
+  snprintf(szSocketPath, sizeof(szSocketPath), "/tmp/evalserver.%d.sock", (int)getpid());
+
+  CEvaluationServer Server(nThreads);
+  if (!Server.Start(szSocketPath))
+  {
+    cout << "Unable to listen on " << szSocketPath << " : " << strerror(errno) << endl;
+    return 1;
+  }
+
+  CLoadGenerator Generator(nClients, nRequests, nWindow);
+  bool rc = Generator.Run(szSocketPath);
+
+  Generator.PrintStatistics(cout);
+  cout << "Server: ";
+  Server.PrintStatistics(cout);
+  Server.Stop();
+
+  return rc ? 0 : 1;
+}
+
+// The rows written in --ringbench, known to the reader processes too, as they are forked
+static vector<double> vBenchResult;
+
+// Reader process for --ringbench: true if it has seen rows 0 .. NextRowId-1 in order, as expected
+static bool CheckRecords(const tRINGRECORD *pRecords, size_t nRecords, unsigned long long &NextRowId)
+{
+  for (size_t i=0; i<nRecords; i++)
+  {
+    if (pRecords[i].RowId != NextRowId || pRecords[i].ErrNo != ERR_OK ||
+        memcmp(&pRecords[i].lfResult, &vBenchResult[NextRowId], sizeof(double)) != 0)
+      return false;
+    NextRowId++;
+  }
+  return true;
+}
+
+static int RunRingReader(const char *szRingName)
+{
+  CResultRingReader Reader;
+  vector<tRINGRECORD> vRecord(RING_BENCH_READ_RECORDS);
+  unsigned long long NextRowId = 0;
+  size_t n;
+
+  while (!Reader.Open(szRingName))
+    usleep(1000);
+  while ((n = Reader.Read(&vRecord[0], vRecord.size())) > 0)
+  {
+    if (!CheckRecords(&vRecord[0], n, NextRowId))
+      return 1;
+  }
+  return NextRowId == vBenchResult.size() ? 0 : 1;
+}
+
+static int RunPipeReader(int fd)
+{
+  vector<tRINGRECORD> vRecord(RING_BENCH_READ_RECORDS);
+  unsigned long long NextRowId = 0;
+  size_t nBytes = 0;
+  ssize_t n;
+
+  // Records may arrive split across reads
+  while ((n = read(fd, (char *)&vRecord[0] + nBytes, vRecord.size() * sizeof(tRINGRECORD) - nBytes)) > 0 ||
+         (n < 0 && errno == EINTR))
+  {
+    if (n < 0)
+      continue;
+    nBytes += (size_t)n;
+    if (!CheckRecords(&vRecord[0], nBytes / sizeof(tRINGRECORD), NextRowId))
+      return 1;
+    memmove(&vRecord[0], (char *)&vRecord[0] + nBytes / sizeof(tRINGRECORD) * sizeof(tRINGRECORD),
+            nBytes % sizeof(tRINGRECORD));
+    nBytes %= sizeof(tRINGRECORD);
+  }
+  return NextRowId == vBenchResult.size() ? 0 : 1;
+}
+
+static bool WaitForReaders(const vector<pid_t> &vPid)
+{
+  bool bOK = true;
+
+  for (size_t i=0; i<vPid.size(); i++)
+  {
+    int Status;
+
+    if (waitpid(vPid[i], &Status, 0) < 0 || !WIFEXITED(Status) || WEXITSTATUS(Status) != 0)
+      bOK = false;
+  }
+  return bOK;
+}
+
+static bool WriteAll(int fd, const void *p, size_t nBytes)
+{
+  while (nBytes > 0)
+  {
+    ssize_t n = write(fd, p, nBytes);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    p = (const char *)p + n;
+    nBytes -= (size_t)n;
+  }
+  return true;
+}
+
+// Seconds to deliver every row to nReaders processes through a ring, evaluating
+// on the way (bEvaluate) or from vBenchResult; negative if a reader failed.
+static double RunRing(const CCompiledExpression &Compiled, const double *const *ppColumns, int nReaders, bool bEvaluate)
+{
+  size_t nRows = vBenchResult.size();
+  vector<tERRNO> vErrNo(nRows, ERR_OK);
+  CResultRing Ring;
+  tRINGSTATS Stats;
+  vector<pid_t> vPid;
+  char szRingName[64];
+
+  snprintf(szRingName, sizeof(szRingName), "/evalserver.%d.ring", (int)getpid());
+  if (!Ring.Create(szRingName))
+  {
+    cout << "Unable to create " << szRingName << " : " << strerror(errno) << endl;
+    return -1.0;
+  }
+  for (int i=0; i<nReaders; i++)
+  {
+    pid_t Pid = fork();
+    if (Pid == 0)
+      _exit(RunRingReader(szRingName));
+    vPid.push_back(Pid);
+  }
+
+  // The readers attach before anything is written, so see every row
+  do
+  {
+    usleep(1000);
+    Ring.GetStatistics(Stats);
+  } while (Stats.nReaders < nReaders);
+
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  if (bEvaluate)
+    Ring.EvaluateBatch(Compiled, ppColumns, nRows, 0);
+  else
+    Ring.WriteResults(0, &vBenchResult[0], &vErrNo[0], nRows);
+  Ring.Close();
+  bool bOK = WaitForReaders(vPid);
+  double lfSeconds = chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+
+  return bOK ? lfSeconds : -1.0;
+}
+
+// Likewise through a pipe to each reader, a chunk of records at a time
+static double RunPipes(const CCompiledExpression &Compiled, const double *const *ppColumns, int nReaders, bool bEvaluate)
+{
+  size_t nRows = vBenchResult.size();
+  int nSlots = Compiled.GetNumberOfVariables();
+  vector<tRINGRECORD> vRecord(RING_BENCH_READ_RECORDS);
+  vector<double> vResult(RING_BENCH_READ_RECORDS);
+  vector<tERRNO> vErrNo(RING_BENCH_READ_RECORDS, ERR_OK);
+  vector<const double *> vpChunk(nSlots + 1);
+  vector<int> vPipe;
+  vector<pid_t> vPid;
+  bool bOK = true;
+
+  signal(SIGPIPE, SIG_IGN);
+  for (int i=0; i<nReaders; i++)
+  {
+    int afd[2];
+
+    if (pipe(afd) < 0)
+      return -1.0;
+    pid_t Pid = fork();
+    if (Pid == 0)
+    {
+      close(afd[1]);
+      for (size_t p=0; p<vPipe.size(); p++)
+        close(vPipe[p]);
+      _exit(RunPipeReader(afd[0]));
+    }
+    close(afd[0]);
+    vPipe.push_back(afd[1]);
+    vPid.push_back(Pid);
+  }
+
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  for (size_t First=0; First<nRows; First+=vRecord.size())
+  {
+    size_t n = min(vRecord.size(), nRows - First);
+    const double *pResult = &vBenchResult[First];
+
+    if (bEvaluate)
+    {
+      for (int Slot=0; Slot<nSlots; Slot++)
+        vpChunk[Slot] = ppColumns[Slot] + First;
+      Compiled.EvaluateBatch(&vpChunk[0], n, &vResult[0], &vErrNo[0]);
+      pResult = &vResult[0];
+    }
+    for (size_t i=0; i<n; i++)
+    {
+      vRecord[i].RowId = First + i;
+      vRecord[i].lfResult = pResult[i];
+      vRecord[i].ErrNo = (int)vErrNo[i];
+      vRecord[i].Reserved = 0;
+    }
+    for (size_t p=0; p<vPipe.size(); p++)
+      bOK = WriteAll(vPipe[p], &vRecord[0], n * sizeof(tRINGRECORD)) && bOK;
+  }
+  for (size_t p=0; p<vPipe.size(); p++)
+    close(vPipe[p]);
+  bOK = WaitForReaders(vPid) && bOK;
+  double lfSeconds = chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+
+  return bOK ? lfSeconds : -1.0;
+}
+
+static int RunRingBenchmark(int argc, char* argv[])
+{
+  size_t nRows   = (argc > 2) ? (size_t)atol(argv[2]) : 4000000;
+  int nReaders   = (argc > 3) ? atoi(argv[3]) : 2;
+  const char *szExpression = "(a + 10) * 50 / ((b - 6.5) * 9) + c";
+  CCompiledExpression Compiled;
+  vector<vector<double> > vvColumn;
+  vector<const double *> vpColumn;
+  bool bOK = true;
+
+  if (nReaders < 1 || nReaders > RING_MAX_READERS)
+    nReaders = 2;
+  Compiled.Compile(szExpression);
+  vvColumn.assign(Compiled.GetNumberOfVariables(), vector<double>(nRows));
+  for (size_t i=0; i<vvColumn.size(); i++)
+  {
+    for (size_t r=0; r<nRows; r++)
+      vvColumn[i][r] = 1.0 + (r * (i + 3)) % 17;
+    vpColumn.push_back(&vvColumn[i][0]);
+  }
+  vBenchResult.resize(nRows);
+  Compiled.EvaluateBatch(&vpColumn[0], nRows, &vBenchResult[0]);
+
+  cout << nRows << " rows of " << sizeof(tRINGRECORD) << " bytes to " << nReaders << " reader processes (M rows/s)" << endl;
+  for (int bEvaluate=0; bEvaluate<2; bEvaluate++)
+  {
+    double lfRing = RunRing(Compiled, &vpColumn[0], nReaders, bEvaluate != 0);
+    double lfPipe = RunPipes(Compiled, &vpColumn[0], nReaders, bEvaluate != 0);
+
+    printf("  %-22s ring %7.2f  pipe %7.2f  %.2fx%s\n", bEvaluate ? "evaluated on the way" : "results ready",
+           nRows / lfRing / 1e6, nRows / lfPipe / 1e6, lfPipe / lfRing,
+           (lfRing < 0.0 || lfPipe < 0.0) ? "  FAILED" : "");
+    bOK = bOK && lfRing >= 0.0 && lfPipe >= 0.0;
+  }
+  return bOK ? 0 : 1;
+}
+
+static int RunServer(int argc, char* argv[])
+{
+  int nThreads = (argc > 2) ? atoi(argv[2]) : 0;
+  CResultRing Ring;
+  sigset_t Signals;
+  struct timespec Interval;
+
+  // Block the termination signals before any threads are started, so that
+  // they are only ever delivered to the sigtimedwait() below.
+  sigemptyset(&Signals);
+  sigaddset(&Signals, SIGINT);
+  sigaddset(&Signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &Signals, NULL);
+
+  CEvaluationServer Server(nThreads);
+  if (argc > 3)
+  {
+    if (!Ring.Create(argv[3]))
+    {
+      cout << "Unable to create " << argv[3] << " : " << strerror(errno) << endl;
+      return 1;
+    }
+    Server.SetResultRing(&Ring);
+  }
+  if (!Server.Start(argv[1]))
+  {
+    cout << "Unable to listen on " << argv[1] << " : " << strerror(errno) << endl;
+    return 1;
+  }
+  cout << "Listening on " << argv[1] << endl;
+
+  Interval.tv_sec = STATS_INTERVAL;
+  Interval.tv_nsec = 0;
+  for(;;)
+  {
+    int Signal = sigtimedwait(&Signals, NULL, &Interval);
+    if (Signal == SIGINT || Signal == SIGTERM)
+      break;
+    Server.PrintStatistics(cout);
+    Server.ResetStatistics();
+  }
+
+  Server.Stop();
+  Server.PrintStatistics(cout);
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    cout << "Usage: " << argv[0] << " <socket path> [threads] [ring name]" << endl;
+    cout << "       " << argv[0] << " --loadtest [clients] [requests per client] [window] [threads]" << endl;
+    cout << "       " << argv[0] << " --ringbench [rows] [readers]" << endl;
+    return 1;
+  }
+
+  if (strcmp(argv[1], "--loadtest") == 0)
+    return RunLoadTest(argc, argv);
+  if (strcmp(argv[1], "--ringbench") == 0)
+    return RunRingBenchmark(argc, argv);
+
+  return RunServer(argc, argv);
+}
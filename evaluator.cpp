@@ -25,6 +25,10 @@
 //    At any time that low precedence operators are encountered (+/-), then
 //    the stacks are evaluated down to a single operand before this operator is 
 //    put on the stack for future processing.
+//    (With comparison and logical operators too, the stacks are evaluated down
+//    only as far as the operators of the same or higher precedence, so that
+//    e.g. in "a < b+c" the + is done before the <. * and / never cause this,
+//    so consecutive * and / are evaluated right to left, as they always were.)
 //    If an open-brace is encountered, then the evaluator is called recursively
 //    and retuns when the associated close-brace is found - again resulting in a 
 //    single operand on the stack of the calling context.
@@ -32,31 +36,112 @@
 //    This is the result.
 ////////////////////////////////////////////////////////////////////////////////////////
 
-#include "stdafx.h"
+#include "StdAfx.h"
 
 //#define SHOW_DEBUGGING
 
 #include <math.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #ifdef SHOW_DEBUGGING
 #include <iostream>
 #endif
 
 #include "evaluator.h"
+#include "compiledexpression.h"
+#include "memocache.h"
+#include "threadpool.h"
 
 using namespace std;
 
+// Threads compiling expressions in the background, for all CEvaluators
+#define BACKGROUND_COMPILE_THREADS 1
+
+// States of a background compile
+#define BACKGROUND_PENDING 0
+#define BACKGROUND_READY   1   // Compiled may be used
+#define BACKGROUND_FAILED  2   // Or was abandoned; stays interpreted
+
+// The background compile of one expression. The compile job has its own
+// reference, so an evaluator may move on to another expression (or be
+// destroyed) while the job is still running.
+struct tagBACKGROUNDCOMPILE
+{
+  string sExpression;
+  unsigned int uFlags;
+  chrono::steady_clock::time_point Set;   // When SetExpression() was called
+
+  // Written by the job before State is released, so read only once it is seen
+  CCompiledExpression Compiled;
+  double lfOptimisedSeconds;
+  double lfCompileSeconds;
+  tERRNO CompileErrNo;
+  atomic<int> State;
+  atomic<bool> bAbandoned;                // The evaluator no longer wants it
+  mutex Mutex;                            // For Finished
+  condition_variable Finished;
+
+  // The evaluating thread's own
+  double lfFirstResultSeconds;
+  unsigned long long nInterpreted;
+  unsigned long long nCompiled;
+};
+
+static CThreadPool &GetCompilePool(void)
+{
+  static CThreadPool Pool(BACKGROUND_COMPILE_THREADS);
+
+  return Pool;
+}
+
+static void CompileInBackground(shared_ptr<tagBACKGROUNDCOMPILE> pBackground)
+{
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  int State = BACKGROUND_FAILED;
+
+  pBackground->CompileErrNo = ERR_EVALUATION_FAILED;
+  if (!pBackground->bAbandoned.load())
+  {
+    if (pBackground->Compiled.Compile(pBackground->sExpression.c_str(), pBackground->uFlags))
+      State = BACKGROUND_READY;
+    pBackground->CompileErrNo = pBackground->Compiled.GetErrorNumber();
+    // Lags and windows have slots of their own, with no variable to fill them
+    if (State == BACKGROUND_READY && pBackground->Compiled.HasHistory())
+    {
+      State = BACKGROUND_FAILED;
+      pBackground->CompileErrNo = ERR_INVALID_HISTORY;
+    }
+  }
+  chrono::steady_clock::time_point End = chrono::steady_clock::now();
+  pBackground->lfCompileSeconds = chrono::duration<double>(End - Start).count();
+  pBackground->lfOptimisedSeconds = chrono::duration<double>(End - pBackground->Set).count();
+
+  lock_guard<mutex> Lock(pBackground->Mutex);
+  pBackground->State.store(State, memory_order_release);
+  pBackground->Finished.notify_all();
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // CEvaluator implementation
 ////////////////////////////////////////////////////////////////////////////
-CEvaluator::CEvaluator(void)
+CEvaluator::CEvaluator(pmr::memory_resource *pResource)
+  : sExpression(pResource ? pResource : pmr::get_default_resource()),
+    vVariable(pResource ? pResource : pmr::get_default_resource())
 {
   ErrNo = ERR_OK;
   sExpression.resize(0);
   vVariable.clear();
+  nMemoCapacity = 0;
+  bBackgroundCompile = false;
+  uBackgroundFlags = 0;
 }
 
 CEvaluator::~CEvaluator(void)
 {
+  if (pBackground)
+    pBackground->bAbandoned = true;
   sExpression.resize(0);
   vVariable.clear();
 }
@@ -66,9 +151,9 @@ tERRNO CEvaluator::GetErrorNumber(void)
   return ErrNo;
 }
 
-const char const *CEvaluator::GetErrorDescription(tERRNO ErrNo)
+const char *CEvaluator::GetErrorDescription(tERRNO ErrNo) // static
 {
-  char *pErrDesc;
+  const char *pErrDesc;
   switch(ErrNo)
   {
     case ERR_OK                : pErrDesc = "No Errors"; break;
@@ -84,6 +169,9 @@ const char const *CEvaluator::GetErrorDescription(tERRNO ErrNo)
     case ERR_TOO_MANY_OPERATORS: pErrDesc = "SYNTAX ERROR: Too many operators"; break;
     case ERR_TOO_MANY_OPERANDS : pErrDesc = "SYNTAX ERROR: Too many operands"; break;
     case ERR_NO_MEMORY         : pErrDesc = "FATAL ERROR: Out of memory"; break;
+    case ERR_INVALID_HISTORY   : pErrDesc = "SYNTAX ERROR: Invalid lag or window. Valid ones are e.g. a[-1] and a[-9:0]"; break;
+    case ERR_INSUFFICIENT_HISTORY: pErrDesc = "WARNING: Not enough samples yet for the lags and windows"; break;
+    case ERR_BRACES_TOO_DEEP   : pErrDesc = "SYNTAX ERROR: Braces nested too deeply"; break;
     default                    : pErrDesc = "UNKNOWN ERROR"; break;
   }
   return pErrDesc;
@@ -92,13 +180,30 @@ const char const *CEvaluator::GetErrorDescription(tERRNO ErrNo)
 
 bool CEvaluator::SetExpression(const char *szExpression)
 {
+  if (pBackground)
+  {
+    pBackground->bAbandoned = true;
+    pBackground.reset();
+  }
+  // Only the new expression's variables, in its own order: the compiled form
+  // and the memo key take their values by position.
+  vVariable.clear();
+  // Results cached for the last expression are wrong for this one, even if
+  // it does not parse.
+  pMemo.reset();
   sExpression = szExpression;
-  return ParseExpressionForVariableNames();
+  if (!ParseExpressionForVariableNames())
+    return false;
+  if (nMemoCapacity)
+    pMemo.reset(new CMemoCache(GetNumberOfVariables(), nMemoCapacity));
+  if (bBackgroundCompile)
+    StartBackgroundCompile();
+  return true;
 }
 
 bool CEvaluator::InitialiseVariables(void)
 {
-  vector<CVariable>::iterator cii;
+  pmr::vector<CVariable>::iterator cii;
   double lfValue = 0.0;
   bool rc;
 
@@ -119,7 +224,7 @@ bool CEvaluator::InitialiseVariables(void)
 
 bool CEvaluator::VariableExists(char ch)
 {
-  vector<CVariable>::iterator cii;
+  pmr::vector<CVariable>::iterator cii;
 
   for(cii=vVariable.begin(); cii!=vVariable.end(); cii++)
   {
@@ -173,7 +278,13 @@ bool CEvaluator::ParseExpressionForVariableNames(void)
       PosOfLastVariable = i;
     }
     else if (ch=='(')
-      depth++;
+    {
+      if (++depth > EVALUATOR_MAX_DEPTH)
+      {
+        ErrNo = ERR_BRACES_TOO_DEEP;
+        return false;
+      }
+    }
     else if (ch==')')
       depth--;
   }
@@ -195,7 +306,7 @@ int CEvaluator::GetNumberOfVariables(void)
 
 double CEvaluator::GetVariableValue(char ch)
 {
-  vector<CVariable>::iterator cii;
+  pmr::vector<CVariable>::iterator cii;
 
   for(cii=vVariable.begin(); cii!=vVariable.end(); cii++)
   {
@@ -205,21 +316,278 @@ double CEvaluator::GetVariableValue(char ch)
   return 0.0;
 }
 
+bool CEvaluator::Compile(CCompiledExpression &Compiled, unsigned int uFlags)
+{
+  // Compiled from the same expression text, so the compiled form has the
+  // same variables in the same order as vVariable, as long as there are no
+  // lags or windows, which have slots of their own.
+  if (!Compiled.Compile(sExpression.c_str(), uFlags))
+  {
+    ErrNo = Compiled.GetErrorNumber();
+    return false;
+  }
+  if (Compiled.HasHistory())
+  {
+    ErrNo = ERR_INVALID_HISTORY;
+    return false;
+  }
+  return true;
+}
+
+void CEvaluator::EnableMemo(size_t nCapacity)
+{
+  nMemoCapacity = nCapacity;
+  pMemo.reset(new CMemoCache(GetNumberOfVariables(), nCapacity));
+}
+
+void CEvaluator::DisableMemo(void)
+{
+  nMemoCapacity = 0;
+  pMemo.reset();
+}
+
+CMemoCache *CEvaluator::GetMemo(void)
+{
+  return pMemo.get();
+}
+
+void CEvaluator::EnableBackgroundCompile(unsigned int uFlags)
+{
+  bBackgroundCompile = true;
+  uBackgroundFlags = uFlags;
+  if (!pBackground && sExpression.length() > 0)
+    StartBackgroundCompile();
+}
+
+void CEvaluator::DisableBackgroundCompile(void)
+{
+  bBackgroundCompile = false;
+  if (pBackground)
+  {
+    pBackground->bAbandoned = true;
+    pBackground.reset();
+  }
+}
+
+void CEvaluator::StartBackgroundCompile(void)
+{
+  shared_ptr<tagBACKGROUNDCOMPILE> pNew(new tagBACKGROUNDCOMPILE);
+
+  pNew->sExpression = sExpression.c_str();
+  pNew->uFlags = uBackgroundFlags;
+  pNew->Set = chrono::steady_clock::now();
+  pNew->lfOptimisedSeconds = -1.0;
+  pNew->lfCompileSeconds = -1.0;
+  pNew->CompileErrNo = ERR_OK;
+  pNew->State = BACKGROUND_PENDING;
+  pNew->bAbandoned = false;
+  pNew->lfFirstResultSeconds = -1.0;
+  pNew->nInterpreted = 0;
+  pNew->nCompiled = 0;
+  pBackground = pNew;
+  GetCompilePool().Submit([pNew]() { CompileInBackground(pNew); });
+}
+
+bool CEvaluator::IsOptimised(void)
+{
+  return pBackground && pBackground->State.load(memory_order_acquire) == BACKGROUND_READY;
+}
+
+bool CEvaluator::WaitForOptimised(unsigned int uTimeoutMs)
+{
+  if (!pBackground)
+    return false;
+
+  unique_lock<mutex> Lock(pBackground->Mutex);
+  pBackground->Finished.wait_for(Lock, chrono::milliseconds(uTimeoutMs),
+                                 [this]() { return pBackground->State.load() != BACKGROUND_PENDING; });
+  return pBackground->State.load() == BACKGROUND_READY;
+}
+
+bool CEvaluator::GetExpressionMetrics(tEXPRESSIONMETRICS &Metrics)
+{
+  Metrics.lfFirstResultSeconds = -1.0;
+  Metrics.lfOptimisedSeconds = -1.0;
+  Metrics.lfCompileSeconds = -1.0;
+  Metrics.nInterpreted = 0;
+  Metrics.nCompiled = 0;
+  Metrics.CompileErrNo = ERR_OK;
+  if (!pBackground)
+    return false;
+
+  Metrics.lfFirstResultSeconds = pBackground->lfFirstResultSeconds;
+  Metrics.nInterpreted = pBackground->nInterpreted;
+  Metrics.nCompiled = pBackground->nCompiled;
+  if (pBackground->State.load(memory_order_acquire) != BACKGROUND_PENDING)
+  {
+    Metrics.lfOptimisedSeconds = pBackground->lfOptimisedSeconds;
+    Metrics.lfCompileSeconds = pBackground->lfCompileSeconds;
+    Metrics.CompileErrNo = pBackground->CompileErrNo;
+  }
+  return true;
+}
+
+double CEvaluator::EvaluateCompiled(void)
+{
+  // Compiled from the same text, so its slots are in the order of vVariable.
+  double aValue[64];
+  tERRNO CompiledErrNo;
+
+  for (size_t i=0; i<vVariable.size(); i++)
+    aValue[i] = vVariable[i].GetValue();
+  double lfResult = pBackground->Compiled.Evaluate(aValue, &CompiledErrNo);
+  if (CompiledErrNo != ERR_OK)
+  {
+    // The interpreter's result and error number, exactly
+    pBackground->nInterpreted++;
+    return EvaluateExpression(&sExpression);
+  }
+  pBackground->nCompiled++;
+  return lfResult;
+}
+
+double CEvaluator::EvaluateMemo(void)
+{
+  vector<double> vValue(vVariable.size());
+  tERRNO PreviousErrNo = ErrNo;
+  tERRNO ResultErrNo;
+  double lfResult;
+
+  // The key is the variable values in order of first appearance.
+  for (size_t i=0; i<vVariable.size(); i++)
+    vValue[i] = vVariable[i].GetValue();
+
+  if (!pMemo->Lookup(vValue.empty() ? NULL : &vValue[0], lfResult, ResultErrNo))
+  {
+    // Start from ERR_OK so that only the error (if any) from this
+    // evaluation is cached, not one left over from before.
+    ErrNo = ERR_OK;
+    if (IsOptimised())
+      lfResult = EvaluateCompiled();
+    else
+    {
+      if (pBackground)
+        pBackground->nInterpreted++;
+      lfResult = EvaluateExpression(&sExpression);
+    }
+    ResultErrNo = ErrNo;
+    pMemo->Insert(vValue.empty() ? NULL : &vValue[0], lfResult, ResultErrNo);
+  }
+
+  // As EvaluateExpression(), an earlier error is only replaced by a new one.
+  ErrNo = (ResultErrNo != ERR_OK) ? ResultErrNo : PreviousErrNo;
+  return lfResult;
+}
+
 bool CEvaluator::IsOperator(char ch) // static
 {
-  return (ch=='*' || ch=='/' || ch=='+' || ch=='-' );
+  return (ch=='*' || ch=='/' || ch=='+' || ch=='-' ||
+          ch=='<' || ch=='>' || ch=='=' || ch=='!' || ch=='&' || ch=='|');
+}
+
+int CEvaluator::GetOperator(const char *szToken, char &cOperator) // static
+{
+  char ch = szToken[0];
+  char next = (ch != '\0') ? szToken[1] : '\0';
+
+  switch (ch)
+  {
+    case '+': case '-': case '*': case '/':
+      cOperator = ch;
+      return 1;
+    case '<':
+      cOperator = (next == '=') ? OP_LESS_EQUAL : '<';
+      return (next == '=') ? 2 : 1;
+    case '>':
+      cOperator = (next == '=') ? OP_GREATER_EQUAL : '>';
+      return (next == '=') ? 2 : 1;
+    case '=':
+      cOperator = OP_EQUAL;
+      return (next == '=') ? 2 : 0;
+    case '!':
+      cOperator = OP_NOT_EQUAL;
+      return (next == '=') ? 2 : 0;
+    case '&':
+      cOperator = OP_AND;
+      return (next == '&') ? 2 : 0;
+    case '|':
+      cOperator = OP_OR;
+      return (next == '|') ? 2 : 0;
+  }
+  return 0;
+}
+
+int CEvaluator::GetPrecedence(char cOperator) // static
+{
+  switch (cOperator)
+  {
+    case '*': case '/': return PRECEDENCE_MULTIPLICATIVE;
+    case '+': case '-': return PRECEDENCE_ADDITIVE;
+    case OP_AND:        return PRECEDENCE_AND;
+    case OP_OR:         return PRECEDENCE_OR;
+    default:            return PRECEDENCE_COMPARISON;
+  }
 }
 
-bool CEvaluator::ProcessOperators(vector<double> &vOperand, vector<char> &vOperator)
+const char *CEvaluator::GetOperatorText(char cOperator) // static
 {
-  // Evaluate Expression
-  while (vOperator.size() > 0)
+  switch (cOperator)
+  {
+    case '+':              return "+";
+    case '-':              return "-";
+    case '*':              return "*";
+    case '/':              return "/";
+    case '<':              return "<";
+    case '>':              return ">";
+    case OP_LESS_EQUAL:    return "<=";
+    case OP_GREATER_EQUAL: return ">=";
+    case OP_EQUAL:         return "==";
+    case OP_NOT_EQUAL:     return "!=";
+    case OP_AND:           return "&&";
+    case OP_OR:            return "||";
+  }
+  return "?";
+}
+
+double CEvaluator::ApplyOperator(char cOperator, double lfLeft, double lfRight) // static
+{
+  // Both operands have already been evaluated, so && and || do not
+  // short-circuit; an error on either side is an error.
+  switch (cOperator)
+  {
+    case '+':              return lfLeft + lfRight;
+    case '-':              return lfLeft - lfRight;
+    case '*':              return lfLeft * lfRight;
+    case '/':              return lfLeft / lfRight;
+    case '<':              return (lfLeft <  lfRight) ? 1.0 : 0.0;
+    case '>':              return (lfLeft >  lfRight) ? 1.0 : 0.0;
+    case OP_LESS_EQUAL:    return (lfLeft <= lfRight) ? 1.0 : 0.0;
+    case OP_GREATER_EQUAL: return (lfLeft >= lfRight) ? 1.0 : 0.0;
+    case OP_EQUAL:         return (lfLeft == lfRight) ? 1.0 : 0.0;
+    case OP_NOT_EQUAL:     return (lfLeft != lfRight) ? 1.0 : 0.0;
+    case OP_AND:           return (lfLeft != 0.0 && lfRight != 0.0) ? 1.0 : 0.0;
+    case OP_OR:            return (lfLeft != 0.0 || lfRight != 0.0) ? 1.0 : 0.0;
+  }
+  return 0.0;
+}
+
+bool CEvaluator::ProcessOperators(vector<double> &vOperand, vector<char> &vOperator, int MinPrecedence)
+{
+  // Evaluate Expression (down to the first operator below MinPrecedence)
+  while (vOperator.size() > 0 && GetPrecedence(vOperator.back()) >= MinPrecedence)
   {
     double Operand1;
     double Operand2;
     char Operator;
     double lfTempResult;
 
+    // A trailing operator (e.g. "4*") leaves us one operand short.
+    if (vOperand.size() < 2)
+    {
+      ErrNo = ERR_OPERAND_EXPECTED;
+      return false;
+    }
+
     // Get last operator, and remove from stack
     Operator = vOperator.back();
     vOperator.pop_back();
@@ -254,6 +622,11 @@ bool CEvaluator::ProcessOperators(vector<double> &vOperand, vector<char> &vOpera
         lfTempResult = Operand2 / Operand1;
         break;
 
+      case '<': case '>': case OP_LESS_EQUAL: case OP_GREATER_EQUAL:
+      case OP_EQUAL: case OP_NOT_EQUAL: case OP_AND: case OP_OR:
+        lfTempResult = ApplyOperator(Operator, Operand2, Operand1);
+        break;
+
       default:
         ErrNo = ERR_UNKNOWN_OPERATOR;
         return false;
@@ -270,14 +643,14 @@ bool CEvaluator::ProcessOperators(vector<double> &vOperand, vector<char> &vOpera
   return true;
 }
 
-double CEvaluator::EvaluateExpression(string *pExpression,int *pNumberOfCharactersProcessed)
+double CEvaluator::EvaluateExpression(pmr::string *pExpression,int *pNumberOfCharactersProcessed,int Start)
 {
   double lfResult = 0.0;
   int i;
   double value1 = 0.0;
   tSTATE state = STATE_EXPECT_OPERAND;
   bool NegateNextOperand = false;
-  string *pExpr;
+  pmr::string *pExpr;
   
   vector<double> vOperand;
   vector<char> vOperator;
@@ -285,12 +658,31 @@ double CEvaluator::EvaluateExpression(string *pExpression,int *pNumberOfCharacte
   vOperand.clear();
   vOperator.clear();
 
+  if (pExpression==NULL && pBackground)
+  {
+    // The whole expression, compiled if it is ready
+    if (pMemo)
+      lfResult = EvaluateMemo();
+    else if (IsOptimised())
+      lfResult = EvaluateCompiled();
+    else
+    {
+      pBackground->nInterpreted++;
+      lfResult = EvaluateExpression(&sExpression);
+    }
+    if (pBackground->lfFirstResultSeconds < 0.0)
+      pBackground->lfFirstResultSeconds = chrono::duration<double>(chrono::steady_clock::now() - pBackground->Set).count();
+    return lfResult;
+  }
+  if (pExpression==NULL && pMemo)
+    return EvaluateMemo(); // Comes back here for the whole expression on a cache miss
+
   if (pExpression==NULL)
     pExpr = &sExpression; // member var as initialised with SetExpression(). (typically on first 'high level' call)
   else
     pExpr = pExpression; // sub-Expression (typically during recursion)
 
-  for(i=0;i<pExpr->length();)
+  for(i=Start;i<pExpr->length();)
   {
     if (isspace((*pExpr)[i])) // Ignore all spaces
     {
@@ -312,7 +704,16 @@ double CEvaluator::EvaluateExpression(string *pExpression,int *pNumberOfCharacte
             // Recursively evaluate the sub-expression found inside the open-brace.
             // If the sub-expression contains a subsequent open brace, the same will happen again.
             // Each recursed call will return when a close brace is encountered.
-            value1 = EvaluateExpression(&pExpr->substr(i),&iNumberOfCharactersProcessed);
+            // It starts from here in the same string: copying the rest of the
+            // expression for each brace took time in the square of its length.
+            value1 = EvaluateExpression(pExpr,&iNumberOfCharactersProcessed,i);
+            // e.g. "-(4+3)". This used to be left pending for the operand after
+            // the brace, so that "-(4+3)+2" was 5.
+            if (NegateNextOperand)
+            {
+              value1 = -value1;
+              NegateNextOperand = false;
+            }
 #ifdef SHOW_DEBUGGING
             cout << "OPERAND(" << value1 << ")" << endl;
 #endif
@@ -385,22 +786,33 @@ double CEvaluator::EvaluateExpression(string *pExpression,int *pNumberOfCharacte
 #ifdef SHOW_DEBUGGING
             cout << "CLOSEBRACE)" << endl;
 #endif
-            i++;
+            // Leave i on the close brace, exactly as if it had immediately followed
+            // the operand, so that it is counted in pNumberOfCharactersProcessed.
+            // Stepping past it here, the test below no longer saw the brace and
+            // the bracket went on, so that "10-(1 )-(2 )" was 10-(1-(2)) = 11.
             break; // return from recursive call (this break will break from the switch. See "break from loop" below)
           }
           else if (IsOperator((*pExpr)[i])) // Recognsed Operator found
           {
-            char op = (*pExpr)[i];
+            char op;
+            int OperatorLength = GetOperator(pExpr->c_str() + i, op);
 
-            if (vOperator.size()>0 && (op=='+' || op=='-'))
+            if (OperatorLength == 0) // e.g. a single '=' or '&'
             {
-              // If this operator is + or -, (i.e. lowest precedence)
+              ErrNo = ERR_UNKNOWN_OPERATOR;
+              return lfResult;
+            }
+
+            if (vOperator.size()>0 && GetPrecedence(op) < PRECEDENCE_MULTIPLICATIVE)
+            {
+              // If this operator is + or -, (i.e. lower precedence than * and /)
               // then evaluate the sub expressions we have parsed so far.
               // These may, or may not, include higher precedence operators.
               // If not, then this step makes no difference to the final result.
               // If yes, then this step is vital in order to evaluate * & /
               // before processing the + or -.
-              if (!ProcessOperators(vOperand,vOperator))
+              // Operators of lower precedence still (e.g. <) are left on the stack.
+              if (!ProcessOperators(vOperand,vOperator,GetPrecedence(op)))
               {
                 ErrNo = ERR_EVALUATION_FAILED; // Intermediate Evaluation failed
                 return lfResult;
@@ -409,9 +821,9 @@ double CEvaluator::EvaluateExpression(string *pExpression,int *pNumberOfCharacte
 #ifdef SHOW_DEBUGGING
             cout << "OPERATOR(" << op << ")" << endl;
 #endif
-            // Now we can push the operator (+ or -) onto the stack.
+            // Now we can push the operator onto the stack.
             vOperator.push_back(op);
-            i++;
+            i += OperatorLength;
             state = STATE_EXPECT_OPERAND;
           }
           else
@@ -458,7 +870,7 @@ double CEvaluator::EvaluateExpression(string *pExpression,int *pNumberOfCharacte
 
   if (pNumberOfCharactersProcessed)
   {
-    *pNumberOfCharactersProcessed = i+1;
+    *pNumberOfCharactersProcessed = i+1-Start;
 #ifdef SHOW_DEBUGGING
     cout << "CHARSPROCESSED(" << *pNumberOfCharactersProcessed << ")" << endl;
 #endif
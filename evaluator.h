@@ -7,10 +7,26 @@
 // This class defines a simple Expression Evaluator object.
 // Expressions are limited to the 4 basic operators, braces, 
 // numeric constants and numeric variables with single letter names.
+// Comparisons (< > <= >= == !=) and logical && and || are also allowed;
+// they give 1.0 for true and 0.0 for false, and treat non-zero as true.
 // Operator precedence is respected. Embedded spaces are ignored.
 // There is no (practical) limit to the length of the expression. 
 // The maximum number of variables is 52 [a-z,A-Z].
 // 
+// The expression and its variables are allocated from the memory resource
+// given to the constructor (see compiledexpression.h). The temporaries of
+// each evaluation are not, so that evaluating never grows an arena.
+//
+// With EnableBackgroundCompile(), SetExpression() also hands the expression to
+// a background thread to be compiled (see compiledexpression.h), and returns
+// at once. Until the compiled form is ready, EvaluateExpression() interprets
+// the expression as always; from then on it evaluates the compiled form, the
+// switch being a single atomic flag. Results are the same either way (unless
+// the COMPILE_ flags given change rounding), and an evaluation which gives an
+// error is done again by the interpreter, so that its result and error number
+// are exactly the interpreter's. GetExpressionMetrics() gives the time from
+// SetExpression() to the first result, and to the compiled form being used.
+//
 // This class is implemented as an abstract class so as to keep all 
 // platform specific UI separate from the functionality of the 
 // Evaluator itself.
@@ -25,16 +41,39 @@
 #pragma once
 #endif // _MSC_VER > 1000
 
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 #include "variable.h"
 
+class CCompiledExpression;
+class CMemoCache;
+struct tagBACKGROUNDCOMPILE;
+
 typedef enum tagSTATE
 {
   STATE_EXPECT_OPERAND = 1,
   STATE_EXPECT_OPERATOR = 2,
 } tSTATE;
 
+// Operators are held as a single character. Those written with two
+// characters are held as follows.
+#define OP_LESS_EQUAL    '{'   // <=
+#define OP_GREATER_EQUAL '}'   // >=
+#define OP_EQUAL         '='   // ==
+#define OP_NOT_EQUAL     '#'   // !=
+#define OP_AND           '&'   // &&
+#define OP_OR            '|'   // ||
+
+// Operator precedence, lowest first. Consecutive operators of the same
+// precedence are evaluated left to right, except * and / (see evaluator.cpp).
+#define PRECEDENCE_OR             1
+#define PRECEDENCE_AND            2
+#define PRECEDENCE_COMPARISON     3
+#define PRECEDENCE_ADDITIVE       4
+#define PRECEDENCE_MULTIPLICATIVE 5
+
 typedef enum tagERRNO
 {
   ERR_OK = 0,
@@ -50,19 +89,61 @@ typedef enum tagERRNO
   ERR_TOO_MANY_OPERATORS,
   ERR_TOO_MANY_OPERANDS ,
   ERR_NO_MEMORY         ,
-  ERR_UNKNOWN
+  ERR_UNKNOWN           ,
+  // New values go here, after the rest: the numbers are sent to evalserver clients
+  ERR_INVALID_HISTORY   ,
+  ERR_INSUFFICIENT_HISTORY,
+  ERR_BRACES_TOO_DEEP
 } tERRNO;
 
+// The interpreter recurses for each open brace, so SetExpression() refuses
+// braces nested deeper than this (ERR_BRACES_TOO_DEEP) rather than run out
+// of stack. CCompiledExpression has no such limit.
+#define EVALUATOR_MAX_DEPTH 256
+
+// Of the current expression, with EnableBackgroundCompile(). Times are in
+// seconds from SetExpression(), or -1.0 if not yet.
+typedef struct tagEXPRESSIONMETRICS
+{
+  double lfFirstResultSeconds;        // Until the first EvaluateExpression() returned
+  double lfOptimisedSeconds;          // Until the compiled form was ready
+  double lfCompileSeconds;            // Spent compiling, on the background thread
+  unsigned long long nInterpreted;    // Evaluations by the interpreter
+  unsigned long long nCompiled;       // Evaluations by the compiled form
+  tERRNO CompileErrNo;                // If compiling failed, in which case it stays interpreted
+} tEXPRESSIONMETRICS;
+
 class CEvaluator 
 {
   public:
-    CEvaluator();
+    CEvaluator(std::pmr::memory_resource *pResource = NULL);   // NULL means the default resource
     ~CEvaluator(); 
 
     bool SetExpression(const char *szExpression);
     bool InitialiseVariables(void);
     int GetNumberOfVariables(void);
-    double EvaluateExpression(std::string *pExpression=NULL, int *pNumberOfCharactersProcessed=NULL);
+    // Recursing, pExpression is the whole expression, and Start just after the open brace.
+    double EvaluateExpression(std::pmr::string *pExpression=NULL, int *pNumberOfCharactersProcessed=NULL, int Start=0);
+
+    // Parse the expression once into a CCompiledExpression (see compiledexpression.h),
+    // for callers who will evaluate it many times. uFlags are the COMPILE_ flags.
+    bool Compile(CCompiledExpression &Compiled, unsigned int uFlags = 0);
+
+    // Remember results by variable values (see memocache.h), so that evaluating
+    // again with values already seen skips the evaluation. nCapacity is usually
+    // MEMO_DEFAULT_CAPACITY. SetExpression() empties the cache.
+    void EnableMemo(size_t nCapacity);
+    void DisableMemo(void);
+    CMemoCache *GetMemo(void);                       // NULL unless enabled
+
+    // Compile each expression from SetExpression() on, in the background, and
+    // switch to the compiled form once it is ready. uFlags are the COMPILE_ flags.
+    // The compiled forms are allocated from the default memory resource.
+    void EnableBackgroundCompile(unsigned int uFlags = 0);
+    void DisableBackgroundCompile(void);
+    bool IsOptimised(void);                          // The compiled form is in use
+    bool WaitForOptimised(unsigned int uTimeoutMs);  // IsOptimised(), waiting up to uTimeoutMs for it
+    bool GetExpressionMetrics(tEXPRESSIONMETRICS &Metrics);   // false unless enabled
 
     // The names of the variables for which values are required, are only known after 
     // the initial parsing of the expression.
@@ -71,7 +152,13 @@ class CEvaluator
     virtual bool InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet) = 0;
 
     tERRNO GetErrorNumber(void);
-    const char const *GetErrorDescription(tERRNO ErrNo);
+    static const char *GetErrorDescription(tERRNO ErrNo);
+
+    static bool IsOperator(char cToken);               // Any character an operator can start with
+    static int GetOperator(const char *szToken, char &cOperator); // Length of the operator at szToken, 0 if none
+    static int GetPrecedence(char cOperator);
+    static const char *GetOperatorText(char cOperator); // As written, e.g. "<=" for OP_LESS_EQUAL
+    static double ApplyOperator(char cOperator, double lfLeft, double lfRight); // Except divide by zero
 
   protected:
     tERRNO ErrNo;
@@ -81,12 +168,18 @@ class CEvaluator
     bool VariableExists(char ch);
     bool AddVariable(char ch);
     double GetVariableValue(char ch);
-    bool ProcessOperators(std::vector<double> &vOperand, std::vector<char> &vOperator);
-
-    static bool IsOperator(char cToken);
+    bool ProcessOperators(std::vector<double> &vOperand, std::vector<char> &vOperator, int MinPrecedence = 0);
+    double EvaluateMemo(void);
+    void StartBackgroundCompile(void);
+    double EvaluateCompiled(void);
 
-    std::string sExpression;
-    std::vector<CVariable> vVariable;
+    std::pmr::string sExpression;
+    std::pmr::vector<CVariable> vVariable;
+    std::unique_ptr<CMemoCache> pMemo;
+    size_t nMemoCapacity;
+    std::shared_ptr<struct tagBACKGROUNDCOMPILE> pBackground;   // Of the current expression, shared with the compile job
+    bool bBackgroundCompile;
+    unsigned int uBackgroundFlags;
 };
 
 #endif // !defined(EVALUATOR_H_INCLUDED_)
@@ -0,0 +1,169 @@
+// expressionhandle.cpp :
+// Implementation of expression handle class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+#include "expressionhandle.h"
+
+using namespace std;
+
+// Reader slot values other than an announced epoch. Epochs start at 1.
+#define HANDLE_READER_FREE 0ULL          // Not registered
+#define HANDLE_READER_IDLE (~0ULL)       // Registered, not reading
+
+////////////////////////////////////////////////////////////////////////////
+// CExpressionHandle implementation
+////////////////////////////////////////////////////////////////////////////
+CExpressionHandle::CExpressionHandle(void)
+{
+  pCurrent = NULL;
+  Epoch = 1;
+  for (int i=0; i<HANDLE_MAX_READERS; i++)
+    aReader[i].Epoch = HANDLE_READER_FREE;
+  nPublished = 0;
+  nReclaimed = 0;
+}
+
+CExpressionHandle::~CExpressionHandle(void)
+{
+  for (size_t i=0; i<vRetired.size(); i++)
+    delete vRetired[i];
+  delete pCurrent.load();
+}
+
+bool CExpressionHandle::Publish(const char *szExpression, unsigned int uFlags, tERRNO *pErrNo)
+{
+  // Compiled before taking the lock; only the switch over is serialised.
+  tVERSION *pNew = new tVERSION;
+
+  if (!pNew->Compiled.Compile(szExpression, uFlags))
+  {
+    if (pErrNo)
+      *pErrNo = pNew->Compiled.GetErrorNumber();
+    delete pNew;
+    return false;
+  }
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+
+  lock_guard<mutex> Lock(WriterMutex);
+
+  pNew->Version = ++nPublished;
+  pNew->RetiredEpoch = 0;
+
+  tVERSION *pOld = pCurrent.exchange(pNew);
+  if (pOld)
+  {
+    // Readers announcing this epoch or later started after the exchange,
+    // so cannot have found pOld.
+    pOld->RetiredEpoch = Epoch.fetch_add(1) + 1;
+    vRetired.push_back(pOld);
+  }
+  ReclaimLocked();
+  return true;
+}
+
+size_t CExpressionHandle::Reclaim(void)
+{
+  lock_guard<mutex> Lock(WriterMutex);
+
+  return ReclaimLocked();
+}
+
+size_t CExpressionHandle::ReclaimLocked(void)
+{
+  unsigned long long OldestReader = HANDLE_READER_IDLE;
+
+  for (int i=0; i<HANDLE_MAX_READERS; i++)
+  {
+    unsigned long long Announced = aReader[i].Epoch.load();
+
+    if (Announced != HANDLE_READER_FREE && Announced < OldestReader)
+      OldestReader = Announced;
+  }
+
+  size_t nKept = 0;
+  for (size_t i=0; i<vRetired.size(); i++)
+  {
+    if (vRetired[i]->RetiredEpoch <= OldestReader)
+    {
+      delete vRetired[i];
+      nReclaimed++;
+    }
+    else
+      vRetired[nKept++] = vRetired[i];
+  }
+  vRetired.resize(nKept);
+  return nKept;
+}
+
+void CExpressionHandle::GetStatistics(tHANDLESTATS &Stats)
+{
+  lock_guard<mutex> Lock(WriterMutex);
+  tVERSION *pVersion = pCurrent.load();
+
+  Stats.nPublished = nPublished;
+  Stats.nReclaimed = nReclaimed;
+  Stats.nPending = vRetired.size();
+  Stats.Version = pVersion ? pVersion->Version : 0;
+}
+
+int CExpressionHandle::RegisterReader(void)
+{
+  for (int i=0; i<HANDLE_MAX_READERS; i++)
+  {
+    unsigned long long Expected = HANDLE_READER_FREE;
+
+    if (aReader[i].Epoch.compare_exchange_strong(Expected, HANDLE_READER_IDLE))
+      return i;
+  }
+  return -1;
+}
+
+void CExpressionHandle::UnregisterReader(int iReader)
+{
+  aReader[iReader].Epoch = HANDLE_READER_FREE;
+}
+
+const CExpressionHandle::tVERSION *CExpressionHandle::BeginRead(int iReader)
+{
+  // Announce, then load. Both are sequentially consistent, as are the
+  // exchange and the scan in Publish(), so either the scan sees this
+  // announcement or this load sees the new version.
+  aReader[iReader].Epoch.store(Epoch.load());
+  return pCurrent.load();
+}
+
+void CExpressionHandle::EndRead(int iReader)
+{
+  aReader[iReader].Epoch.store(HANDLE_READER_IDLE, memory_order_release);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CExpressionHandle::CReadGuard implementation
+////////////////////////////////////////////////////////////////////////////
+CExpressionHandle::CReadGuard::CReadGuard(CExpressionHandle &Handle, int iReader)
+  : Handle(Handle)
+{
+  const tVERSION *pVersion = Handle.BeginRead(iReader);
+
+  this->iReader = iReader;
+  pCompiled = pVersion ? &pVersion->Compiled : NULL;
+  Version = pVersion ? pVersion->Version : 0;
+}
+
+CExpressionHandle::CReadGuard::~CReadGuard(void)
+{
+  Handle.EndRead(iReader);
+}
+
+const CCompiledExpression *CExpressionHandle::CReadGuard::Get(void) const
+{
+  return pCompiled;
+}
+
+unsigned long long CExpressionHandle::CReadGuard::GetVersion(void) const
+{
+  return Version;
+}
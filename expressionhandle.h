@@ -0,0 +1,122 @@
+// expressionhandle.h :
+// Interface/Include file for expressionhandle.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CExpressionHandle Class
+// Holds the current version of an expression, compiled, for threads which
+// evaluate it while another thread replaces it (e.g. an operator updating a
+// formula while the workers keep running).
+//
+// Publish() compiles the new expression and then makes it current with a
+// single atomic exchange. Evaluations already under way finish on the version
+// they started with; the old version is deleted once no reader can still be
+// using it.
+//
+// Readers take no locks. Each reading thread registers once, for a slot of its
+// own, and then wraps each evaluation in a CReadGuard:
+//
+//   CExpressionHandle::CReadGuard Guard(Handle, iReader);
+//   lfResult = Guard.Get()->Evaluate(aValues);
+//
+// Reclamation is epoch based. On entering, a reader announces the global epoch
+// in its slot; each Publish() advances the epoch and retires the old version
+// with the new epoch. A retired version is deleted when every reader that is
+// reading has announced that epoch or later, since such readers must have
+// found the newer version. Publish() and Reclaim() serialise on a mutex, which
+// readers never touch.
+//
+// The versions of an expression may use different variables, so readers
+// should look up slots (GetVariableSlot()) from the version they hold.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(EXPRESSIONHANDLE_H_INCLUDED_)
+#define EXPRESSIONHANDLE_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "compiledexpression.h"
+
+#define HANDLE_MAX_READERS 64
+
+typedef struct tagHANDLESTATS
+{
+  unsigned long long nPublished;
+  unsigned long long nReclaimed;
+  size_t nPending;             // Retired, but possibly still being read
+  unsigned long long Version;  // Current version, 0 before the first Publish()
+} tHANDLESTATS;
+
+class CExpressionHandle
+{
+  public:
+    CExpressionHandle();
+    ~CExpressionHandle();                            // No reader may still be reading
+
+    // Compiles szExpression, and if that succeeds makes it the current version.
+    // On failure the current version is kept and *pErrNo says why.
+    bool Publish(const char *szExpression, unsigned int uFlags = COMPILE_DEFAULT, tERRNO *pErrNo = NULL);
+
+    // Deletes the retired versions no longer being read. Returns the number left.
+    size_t Reclaim(void);
+    void GetStatistics(tHANDLESTATS &Stats);
+
+    int RegisterReader(void);                        // -1 if all HANDLE_MAX_READERS slots are taken
+    void UnregisterReader(int iReader);
+
+    class CReadGuard
+    {
+      public:
+        CReadGuard(CExpressionHandle &Handle, int iReader);
+        ~CReadGuard();
+
+        const CCompiledExpression *Get(void) const;  // NULL before the first Publish()
+        unsigned long long GetVersion(void) const;
+
+      private:
+        CReadGuard(const CReadGuard &);
+        CReadGuard &operator=(const CReadGuard &);
+
+        CExpressionHandle &Handle;
+        int iReader;
+        const CCompiledExpression *pCompiled;
+        unsigned long long Version;
+    };
+
+  private:
+    typedef struct tagVERSION
+    {
+      CCompiledExpression Compiled;
+      unsigned long long Version;
+      unsigned long long RetiredEpoch;
+    } tVERSION;
+
+    // One per cache line, so that readers do not slow each other down
+    struct alignas(64) tREADERSLOT
+    {
+      std::atomic<unsigned long long> Epoch;  // Epoch announced, or one of the HANDLE_READER_ values
+    };
+
+    CExpressionHandle(const CExpressionHandle &);
+    CExpressionHandle &operator=(const CExpressionHandle &);
+
+    const tVERSION *BeginRead(int iReader);
+    void EndRead(int iReader);
+    size_t ReclaimLocked(void);
+
+    std::atomic<tVERSION *> pCurrent;
+    std::atomic<unsigned long long> Epoch;
+    tREADERSLOT aReader[HANDLE_MAX_READERS];
+
+    std::mutex WriterMutex;                   // For the members below
+    std::vector<tVERSION *> vRetired;
+    unsigned long long nPublished;
+    unsigned long long nReclaimed;
+};
+
+#endif // !defined(EXPRESSIONHANDLE_H_INCLUDED_)
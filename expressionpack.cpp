@@ -0,0 +1,372 @@
+// expressionpack.cpp :
+// Implementation of expression pack class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+#include <string>
+#include <unordered_map>
+
+#include "expressionpack.h"
+
+using namespace std;
+
+// Levels of the operand stack kept on the (machine) stack while evaluating a group
+#define PACK_LOCAL_LEVELS 16
+
+////////////////////////////////////////////////////////////////////////////
+// CExpressionPack implementation
+////////////////////////////////////////////////////////////////////////////
+CExpressionPack::CExpressionPack()
+{
+  Clear();
+}
+
+CExpressionPack::~CExpressionPack(void)
+{
+}
+
+void CExpressionPack::Clear(void)
+{
+  vpExpression.clear();
+  vGroup.clear();
+  vNode.clear();
+  vLane.clear();
+  vConstant.clear();
+  vSingle.clear();
+  vSingleSlot.clear();
+  vRejected.clear();
+  vVariableName.clear();
+  for (int i=0; i<256; i++)
+    aSlot[i] = -1;
+  nLargestGroup = 0;
+}
+
+int CExpressionPack::AddVariable(char VariableName)
+{
+  int &Slot = aSlot[(unsigned char)VariableName];
+
+  if (Slot < 0)
+  {
+    vVariableName.push_back(VariableName);
+    Slot = (int)vVariableName.size() - 1;
+  }
+  return Slot;
+}
+
+int CExpressionPack::GetNumberOfVariables(void) const
+{
+  return (int)vVariableName.size();
+}
+
+char CExpressionPack::GetVariableName(int Slot) const
+{
+  return vVariableName[Slot];
+}
+
+int CExpressionPack::GetVariableSlot(char VariableName) const
+{
+  return aSlot[(unsigned char)VariableName];
+}
+
+size_t CExpressionPack::Build(const vector<const CCompiledExpression *> &vpCompiled)
+{
+  unordered_map<string, int> ShapeIndex;
+  vector<vector<int> > vvMember;             // Expressions of each shape
+  string sShape;
+
+  Clear();
+  vpExpression = vpCompiled;
+
+  // The shape of an expression is its nodes without their constants: the
+  // type, operator and flags of each, and the name of each variable.
+  for (size_t i=0; i<vpCompiled.size(); i++)
+  {
+    const CCompiledExpression &Compiled = *vpCompiled[i];
+    bool bGroup = Compiled.GetErrorNumber() == ERR_OK && Compiled.GetNumberOfNodes() > 0;
+
+    // The slot names of lags and windows would be confused with another's
+    if (Compiled.HasHistory())
+    {
+      vRejected.push_back((int)i);
+      continue;
+    }
+    for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+      AddVariable(Compiled.GetVariableName(Slot));
+    for (int k=0; k<Compiled.GetNumberOfKernels(); k++)
+    {
+      if (Compiled.GetKernel(k).bFused)
+        bGroup = false;
+    }
+    if (!bGroup)
+    {
+      vvMember.push_back(vector<int>(1, (int)i));
+      continue;
+    }
+
+    sShape.clear();
+    for (int n=0; n<Compiled.GetNumberOfNodes(); n++)
+    {
+      const tNODE &Node = Compiled.GetNode(n);
+
+      sShape += (char)Node.Type;
+      sShape += (char)(Node.Flags & 0xFF);
+      sShape += (char)(Node.Flags >> 8);
+      if (Node.Type == NODE_OPERATOR)
+        sShape += Node.cOperator;
+      else if (Node.Type == NODE_VARIABLE)
+        sShape += Compiled.GetVariableName(Node.iVariable);
+    }
+    unordered_map<string, int>::iterator it = ShapeIndex.find(sShape);
+    if (it == ShapeIndex.end())
+    {
+      ShapeIndex[sShape] = (int)vvMember.size();
+      vvMember.push_back(vector<int>(1, (int)i));
+    }
+    else
+      vvMember[it->second].push_back((int)i);
+  }
+
+  for (size_t s=0; s<vvMember.size(); s++)
+  {
+    const vector<int> &vMember = vvMember[s];
+
+    if (vMember.size() == 1)
+    {
+      const CCompiledExpression &Compiled = *vpCompiled[vMember[0]];
+
+      vSingle.push_back(vMember[0]);
+      for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+        vSingleSlot.push_back(aSlot[(unsigned char)Compiled.GetVariableName(Slot)]);
+      continue;
+    }
+
+    // The nodes are those of the first member, with the constants numbered
+    // in turn; each constant's column then has an entry for every member.
+    const CCompiledExpression &First = *vpCompiled[vMember[0]];
+    tPACKGROUP Group;
+    int nConstants = 0;
+    int Depth = 0;
+
+    Group.iFirstNode = (int)vNode.size();
+    Group.nNodes = First.GetNumberOfNodes();
+    Group.iFirstLane = (int)vLane.size();
+    Group.nLanes = (int)vMember.size();
+    Group.iFirstConstant = vConstant.size();
+    Group.MaxStackDepth = 0;
+    for (int n=0; n<Group.nNodes; n++)
+    {
+      const tNODE &Node = First.GetNode(n);
+      tPACKNODE PackNode;
+
+      PackNode.Type = Node.Type;
+      PackNode.cOperator = Node.cOperator;
+      PackNode.Flags = Node.Flags;
+      PackNode.iOperand = -1;
+      if (Node.Type == NODE_CONSTANT)
+        PackNode.iOperand = nConstants++;
+      else if (Node.Type == NODE_VARIABLE)
+        PackNode.iOperand = aSlot[(unsigned char)First.GetVariableName(Node.iVariable)];
+      vNode.push_back(PackNode);
+
+      if (Node.Type == NODE_CONSTANT || Node.Type == NODE_VARIABLE)
+        Depth++;
+      else if (Node.Type == NODE_OPERATOR)
+        Depth--;
+      if (Depth > Group.MaxStackDepth)
+        Group.MaxStackDepth = Depth;
+    }
+
+    vConstant.resize(vConstant.size() + (size_t)nConstants * Group.nLanes);
+    for (int Lane=0; Lane<Group.nLanes; Lane++)
+    {
+      const CCompiledExpression &Compiled = *vpCompiled[vMember[Lane]];
+      int iConstant = 0;
+
+      for (int n=0; n<Group.nNodes; n++)
+      {
+        const tNODE &Node = Compiled.GetNode(n);
+
+        if (Node.Type == NODE_CONSTANT)
+          vConstant[Group.iFirstConstant + (size_t)iConstant++ * Group.nLanes + Lane] = Compiled.GetLiteral(Node.iLiteral);
+      }
+      vLane.push_back(vMember[Lane]);
+    }
+    if (vMember.size() > nLargestGroup)
+      nLargestGroup = vMember.size();
+    vGroup.push_back(Group);
+  }
+  return vGroup.size();
+}
+
+void CExpressionPack::Evaluate(const double *pValues, double *pResults, tERRNO *pErrNo) const
+{
+  double aRow[256];                          // Enough for any expression, one slot per variable name
+  size_t iSlot = 0;
+
+  for (size_t s=0; s<vSingle.size(); s++)
+  {
+    const CCompiledExpression &Compiled = *vpExpression[vSingle[s]];
+    tERRNO ErrNo;
+
+    for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+      aRow[Slot] = pValues[vSingleSlot[iSlot++]];
+    pResults[vSingle[s]] = Compiled.Evaluate(aRow, &ErrNo);
+    if (pErrNo)
+      pErrNo[vSingle[s]] = ErrNo;
+  }
+
+  for (size_t g=0; g<vGroup.size(); g++)
+    EvaluateGroup(vGroup[g], pValues, pResults, pErrNo);
+
+  for (size_t r=0; r<vRejected.size(); r++)
+  {
+    pResults[vRejected[r]] = 0.0;
+    if (pErrNo)
+      pErrNo[vRejected[r]] = ERR_INVALID_HISTORY;
+  }
+}
+
+void CExpressionPack::EvaluateGroup(const tPACKGROUP &Group, const double *pValues, double *pResults,
+                                    tERRNO *pErrNo) const
+{
+  double aLocalStack[PACK_LOCAL_LEVELS * PACK_BLOCK_LANES];
+  vector<double> vHeapStack;
+  double *pStack = aLocalStack;
+
+  if (Group.MaxStackDepth > PACK_LOCAL_LEVELS)
+  {
+    vHeapStack.resize((size_t)Group.MaxStackDepth * PACK_BLOCK_LANES);
+    pStack = &vHeapStack[0];
+  }
+  for (int FirstLane=0; FirstLane<Group.nLanes; FirstLane+=PACK_BLOCK_LANES)
+  {
+    int nLanes = Group.nLanes - FirstLane;
+
+    if (nLanes > PACK_BLOCK_LANES)
+      nLanes = PACK_BLOCK_LANES;
+    EvaluateBlock(Group, FirstLane, nLanes, pValues, pStack, pResults, pErrNo);
+  }
+}
+
+void CExpressionPack::EvaluateBlock(const tPACKGROUP &Group, int FirstLane, int nLanes, const double *pValues,
+                                    double *pStack, double *pResults, tERRNO *pErrNo) const
+{
+  const tPACKNODE *pNode = &vNode[Group.iFirstNode];
+  const double *pConstant = vConstant.data() + Group.iFirstConstant + FirstLane;
+  bool aFailed[PACK_BLOCK_LANES];
+  int Top = -1;                                  // Each level of the stack is a block of lanes
+
+  for (int l=0; l<nLanes; l++)
+    aFailed[l] = false;
+
+  // Every lane is evaluated to the end, even one that has divided by zero
+  // (giving Inf or NaN, which is then thrown away), so that the loops have
+  // no branches.
+  for (int n=0; n<Group.nNodes; n++)
+  {
+    const tPACKNODE &Node = pNode[n];
+
+    switch (Node.Type)
+    {
+      case NODE_CONSTANT:
+      {
+        const double *pColumn = pConstant + (size_t)Node.iOperand * Group.nLanes;
+        double *pTop = pStack + ++Top * PACK_BLOCK_LANES;
+
+        for (int l=0; l<nLanes; l++)
+          pTop[l] = pColumn[l];
+        break;
+      }
+
+      case NODE_VARIABLE:
+      {
+        double lfValue = pValues[Node.iOperand];
+        double *pTop = pStack + ++Top * PACK_BLOCK_LANES;
+
+        for (int l=0; l<nLanes; l++)
+          pTop[l] = lfValue;
+        break;
+      }
+
+      case NODE_NEGATE:
+      {
+        double *pTop = pStack + Top * PACK_BLOCK_LANES;
+
+        for (int l=0; l<nLanes; l++)
+          pTop[l] = -pTop[l];
+        break;
+      }
+
+      case NODE_OPERATOR:
+      {
+        const double *pRight = pStack + Top-- * PACK_BLOCK_LANES;
+        double *pLeft = pStack + Top * PACK_BLOCK_LANES;
+
+        switch (Node.cOperator)
+        {
+          case '+':
+            for (int l=0; l<nLanes; l++)
+              pLeft[l] = pLeft[l] + pRight[l];
+            break;
+          case '-':
+            for (int l=0; l<nLanes; l++)
+              pLeft[l] = pLeft[l] - pRight[l];
+            break;
+          case '*':
+            for (int l=0; l<nLanes; l++)
+              pLeft[l] = pLeft[l] * pRight[l];
+            break;
+          case '/':
+            if (!(Node.Flags & NODE_FLAG_SAFE_DIVIDE))
+            {
+              for (int l=0; l<nLanes; l++)
+                aFailed[l] |= (pRight[l] == 0.0);
+            }
+            for (int l=0; l<nLanes; l++)
+              pLeft[l] = pLeft[l] / pRight[l];
+            break;
+          default:
+            for (int l=0; l<nLanes; l++)
+              pLeft[l] = CEvaluator::ApplyOperator(Node.cOperator, pLeft[l], pRight[l]);
+            break;
+        }
+        break;
+      }
+    }
+  }
+
+  const int *pLane = &vLane[Group.iFirstLane + FirstLane];
+  for (int l=0; l<nLanes; l++)
+  {
+    pResults[pLane[l]] = aFailed[l] ? 0.0 : pStack[l];
+    if (pErrNo)
+      pErrNo[pLane[l]] = aFailed[l] ? ERR_DIVIDE_BY_ZERO : ERR_OK;
+  }
+}
+
+size_t CExpressionPack::GetNumberOfGroups(void) const
+{
+  return vGroup.size();
+}
+
+void CExpressionPack::GetStatistics(tPACKSTATS &Stats) const
+{
+  Stats.nExpressions = vpExpression.size();
+  Stats.nGroups = vGroup.size();
+  Stats.nGrouped = vLane.size();
+  Stats.nLargestGroup = nLargestGroup;
+  Stats.nSingle = vSingle.size();
+}
+
+void CExpressionPack::PrintStatistics(ostream &os) const
+{
+  tPACKSTATS Stats;
+
+  GetStatistics(Stats);
+  os << "Pack: expressions=" << Stats.nExpressions
+     << " groups=" << Stats.nGroups
+     << " grouped=" << Stats.nGrouped
+     << " largest group=" << Stats.nLargestGroup
+     << " single=" << Stats.nSingle << endl;
+}
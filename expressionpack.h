@@ -0,0 +1,127 @@
+// expressionpack.h :
+// Interface/Include file for expressionpack.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CExpressionPack Class
+// Evaluates a large set of compiled expressions (e.g. a rule base) on one row
+// of variable values at a time, where many of the expressions have the same
+// form and differ only in their constants, e.g. a*k1 + b*k2 with k1 and k2
+// different for each rule.
+//
+// Build() puts expressions which are identical but for their constants into
+// a group. A group is evaluated node by node across all of its expressions at
+// once, one expression per lane: each constant is held as a vector with one
+// entry per lane, each variable is the same in every lane, and each operator
+// is a simple loop over the lanes, which the compiler vectorises. This does
+// the dispatch on each node once for the whole group, rather than once per
+// expression. An expression with no other of its form is evaluated by its own
+// Evaluate().
+//
+// Results are identical to each expression's own Evaluate(), including
+// ERR_DIVIDE_BY_ZERO for the lanes which divide by zero. Expressions compiled
+// with COMPILE_FUSED_MULTIPLY_ADD are not grouped, since their kernels round
+// differently, nor are those which failed to compile. Memo caches and
+// profiling are not used by grouped expressions.
+//
+// The variables of the pack are those of all its expressions, in slots of
+// their own, in order of first appearance. Expressions with lags or windows
+// (e.g. a[-1]) are not supported, since the names of their slots are only
+// unique within each expression: they are left out of the pack, and always
+// give 0.0 and ERR_INVALID_HISTORY.
+//
+//   CExpressionPack Pack;
+//   Pack.Build(vpCompiled);                 // Returns the number of groups
+//   Pack.Evaluate(aValues, &vResult[0], &vErrNo[0]);
+//
+// Evaluate() does not modify the object, so it may be called by any number of
+// threads concurrently.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(EXPRESSIONPACK_H_INCLUDED_)
+#define EXPRESSIONPACK_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <ostream>
+#include <vector>
+#include "compiledexpression.h"
+
+// Lanes evaluated together; the operand stack of a block is this many
+// doubles per level, so it stays in the L1 cache.
+#define PACK_BLOCK_LANES 32
+
+typedef struct tagPACKNODE
+{
+  unsigned char Type;  // A tNODETYPE
+  char cOperator;
+  unsigned short Flags; // NODE_FLAG_...
+  int iOperand;        // NODE_VARIABLE : pack slot; NODE_CONSTANT : constant column in the group
+} tPACKNODE;
+
+typedef struct tagPACKGROUP
+{
+  int iFirstNode;      // Its nodes, in post-order, in CExpressionPack::vNode
+  int nNodes;
+  int iFirstLane;      // Its expressions, in CExpressionPack::vLane
+  int nLanes;
+  size_t iFirstConstant; // Its constants, nLanes to a column, in CExpressionPack::vConstant
+  int MaxStackDepth;
+} tPACKGROUP;
+
+typedef struct tagPACKSTATS
+{
+  size_t nExpressions;
+  size_t nGroups;      // Of two or more expressions
+  size_t nGrouped;     // Expressions in those groups
+  size_t nLargestGroup;
+  size_t nSingle;      // Expressions evaluated on their own
+} tPACKSTATS;
+
+class CExpressionPack
+{
+  public:
+    CExpressionPack();
+    ~CExpressionPack();
+
+    // The expressions must outlast the pack, unchanged. Returns the number of groups formed.
+    size_t Build(const std::vector<const CCompiledExpression *> &vpCompiled);
+    void Clear(void);
+
+    int GetNumberOfVariables(void) const;
+    char GetVariableName(int Slot) const;
+    int GetVariableSlot(char VariableName) const;    // -1 if no expression uses the variable
+
+    // pValues[Slot] is the value of each of the pack's variables. pResults[i]
+    // and pErrNo[i] are for the i'th expression given to Build().
+    void Evaluate(const double *pValues, double *pResults, tERRNO *pErrNo = NULL) const;
+
+    size_t GetNumberOfGroups(void) const;
+    void GetStatistics(tPACKSTATS &Stats) const;
+    void PrintStatistics(std::ostream &os) const;
+
+  private:
+    CExpressionPack(const CExpressionPack &);
+    CExpressionPack &operator=(const CExpressionPack &);
+
+    int AddVariable(char VariableName);
+    void EvaluateGroup(const tPACKGROUP &Group, const double *pValues, double *pResults, tERRNO *pErrNo) const;
+    void EvaluateBlock(const tPACKGROUP &Group, int FirstLane, int nLanes, const double *pValues,
+                       double *pStack, double *pResults, tERRNO *pErrNo) const;
+
+    std::vector<const CCompiledExpression *> vpExpression;
+    std::vector<tPACKGROUP> vGroup;
+    std::vector<tPACKNODE> vNode;
+    std::vector<int> vLane;                   // Expression of each lane
+    std::vector<double> vConstant;
+    std::vector<int> vSingle;                 // Expressions evaluated on their own
+    std::vector<int> vSingleSlot;             // Pack slot of each of their variables, in turn
+    std::vector<int> vRejected;               // Expressions with lags or windows, not evaluated
+    std::vector<char> vVariableName;
+    int aSlot[256];                           // Pack slot of each variable name, or -1
+    size_t nLargestGroup;
+};
+
+#endif // !defined(EXPRESSIONPACK_H_INCLUDED_)
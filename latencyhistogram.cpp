@@ -0,0 +1,126 @@
+// latencyhistogram.cpp :
+// Implementation of latency histogram class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+#include "latencyhistogram.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////
+// CLatencyHistogram implementation
+////////////////////////////////////////////////////////////////////////////
+CLatencyHistogram::CLatencyHistogram(void)
+{
+  Reset();
+}
+
+CLatencyHistogram::~CLatencyHistogram(void)
+{
+}
+
+void CLatencyHistogram::Reset(void)
+{
+  for (int i=0; i<HISTOGRAM_BUCKETS; i++)
+    aCount[i] = 0;
+  TotalCount = 0;
+  TotalNanoseconds = 0;
+  Maximum = 0;
+}
+
+int CLatencyHistogram::GetBucket(unsigned long long Value) // static
+{
+  // Values below HISTOGRAM_SUBBUCKETS get a bucket each.
+  // Above that, each power of two is split into HISTOGRAM_SUBBUCKETS
+  // linear sub-buckets, selected by the bits following the leading 1.
+  if (Value < HISTOGRAM_SUBBUCKETS)
+    return (int)Value;
+
+  int Exponent = 0;
+  while ((Value >> (Exponent+1)) != 0)
+    Exponent++;
+
+  int SubBucket = (int)((Value >> (Exponent - HISTOGRAM_SUBBUCKET_BITS)) & (HISTOGRAM_SUBBUCKETS-1));
+  return (Exponent - HISTOGRAM_SUBBUCKET_BITS + 1) * HISTOGRAM_SUBBUCKETS + SubBucket;
+}
+
+unsigned long long CLatencyHistogram::GetBucketUpperBound(int Bucket) // static
+{
+  if (Bucket < HISTOGRAM_SUBBUCKETS)
+    return (unsigned long long)Bucket;
+
+  int Exponent = Bucket / HISTOGRAM_SUBBUCKETS + HISTOGRAM_SUBBUCKET_BITS - 1;
+  unsigned long long SubBucket = Bucket % HISTOGRAM_SUBBUCKETS;
+  int Shift = Exponent - HISTOGRAM_SUBBUCKET_BITS;
+
+  return ((HISTOGRAM_SUBBUCKETS + SubBucket + 1) << Shift) - 1;
+}
+
+void CLatencyHistogram::Record(unsigned long long Nanoseconds)
+{
+  aCount[GetBucket(Nanoseconds)].fetch_add(1, memory_order_relaxed);
+  TotalCount.fetch_add(1, memory_order_relaxed);
+  TotalNanoseconds.fetch_add(Nanoseconds, memory_order_relaxed);
+
+  unsigned long long Previous = Maximum.load(memory_order_relaxed);
+  while (Nanoseconds > Previous && !Maximum.compare_exchange_weak(Previous, Nanoseconds, memory_order_relaxed))
+    ;
+}
+
+unsigned long long CLatencyHistogram::GetCount(void)
+{
+  return TotalCount.load();
+}
+
+double CLatencyHistogram::GetMean(void)
+{
+  unsigned long long n = TotalCount.load();
+  return n ? (double)TotalNanoseconds.load() / (double)n : 0.0;
+}
+
+unsigned long long CLatencyHistogram::GetMaximum(void)
+{
+  return Maximum.load();
+}
+
+unsigned long long CLatencyHistogram::GetPercentile(double Percentile)
+{
+  unsigned long long n = 0;
+  unsigned long long Seen = 0;
+  unsigned long long Rank;
+
+  // Sum the buckets rather than using TotalCount, so that a
+  // concurrent Record() cannot leave us short of the requested rank.
+  for (int i=0; i<HISTOGRAM_BUCKETS; i++)
+    n += aCount[i].load(memory_order_relaxed);
+  if (n == 0)
+    return 0;
+
+  Rank = (unsigned long long)(Percentile / 100.0 * (double)n + 0.5);
+  if (Rank < 1)
+    Rank = 1;
+  if (Rank > n)
+    Rank = n;
+
+  for (int i=0; i<HISTOGRAM_BUCKETS; i++)
+  {
+    Seen += aCount[i].load(memory_order_relaxed);
+    if (Seen >= Rank)
+    {
+      unsigned long long UpperBound = GetBucketUpperBound(i);
+      unsigned long long Max = Maximum.load();
+      return (UpperBound < Max) ? UpperBound : Max;
+    }
+  }
+  return Maximum.load();
+}
+
+void CLatencyHistogram::Print(ostream &os, const char *szTitle)
+{
+  os << szTitle << ": n=" << GetCount()
+     << " mean=" << GetMean() / 1000.0 << "us"
+     << " p50=" << GetPercentile(50.0) / 1000.0 << "us"
+     << " p99=" << GetPercentile(99.0) / 1000.0 << "us"
+     << " max=" << GetMaximum() / 1000.0 << "us" << endl;
+}
@@ -0,0 +1,55 @@
+// latencyhistogram.h :
+// Interface/Include file for latencyhistogram.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CLatencyHistogram Class
+// A log-linear histogram of latencies, recorded in nanoseconds.
+// Each power of two is split into a fixed number of linear sub-buckets, so the
+// relative error of a reported percentile is bounded (about 6%) whatever the
+// magnitude of the latencies being recorded.
+// Record() only touches atomic counters, so any number of threads may record
+// into the same histogram concurrently.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(LATENCYHISTOGRAM_H_INCLUDED_)
+#define LATENCYHISTOGRAM_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <atomic>
+#include <ostream>
+
+#define HISTOGRAM_SUBBUCKET_BITS 3
+#define HISTOGRAM_SUBBUCKETS     (1 << HISTOGRAM_SUBBUCKET_BITS)
+#define HISTOGRAM_BUCKETS        (64 * HISTOGRAM_SUBBUCKETS)
+
+class CLatencyHistogram
+{
+  public:
+    CLatencyHistogram();
+    ~CLatencyHistogram();
+
+    void Record(unsigned long long Nanoseconds);
+    void Reset(void);
+
+    unsigned long long GetCount(void);
+    double GetMean(void);                                // Nanoseconds
+    unsigned long long GetPercentile(double Percentile); // Nanoseconds, Percentile in [0,100]
+    unsigned long long GetMaximum(void);                 // Nanoseconds
+
+    void Print(std::ostream &os, const char *szTitle);
+
+  private:
+    static int GetBucket(unsigned long long Value);
+    static unsigned long long GetBucketUpperBound(int Bucket);
+
+    std::atomic<unsigned long long> aCount[HISTOGRAM_BUCKETS];
+    std::atomic<unsigned long long> TotalCount;
+    std::atomic<unsigned long long> TotalNanoseconds;
+    std::atomic<unsigned long long> Maximum;
+};
+
+#endif // !defined(LATENCYHISTOGRAM_H_INCLUDED_)
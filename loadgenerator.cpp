@@ -0,0 +1,217 @@
+// loadgenerator.cpp :
+// Implementation of the local load generator for the evaluation server (POSIX only).
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "evaluator.h"
+#include "loadgenerator.h"
+
+using namespace std;
+
+static const char *LoadExpression[] =
+{
+  "(a + 10) * 50 / ((b - 6) * 9)",
+  "a*b+c",
+  "a/(b+1)-c*2",
+  "((a-b)*(a+b)+c*c)/(b+c+1)",
+};
+#define NUMBER_OF_LOAD_EXPRESSIONS (sizeof(LoadExpression)/sizeof(LoadExpression[0]))
+
+// Check one reply in every VERIFY_EVERY against a local evaluation.
+#define VERIFY_EVERY 16
+
+////////////////////////////////////////////////////////////////////////////
+// CFixedEvaluator
+// Supplies variable values from a fixed table, for local verification.
+////////////////////////////////////////////////////////////////////////////
+class CFixedEvaluator : public CEvaluator
+{
+  public:
+    double a, b, c;
+    bool InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet)
+    {
+      ValueRet = (VariableName=='a') ? a : (VariableName=='b') ? b : c;
+      return true;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CLoadGenerator implementation
+////////////////////////////////////////////////////////////////////////////
+CLoadGenerator::CLoadGenerator(int nArgClients, int nArgRequestsPerClient, int nArgWindow)
+{
+  nClients = (nArgClients > 0) ? nArgClients : 1;
+  nRequestsPerClient = (nArgRequestsPerClient > 0) ? nArgRequestsPerClient : 1;
+  nWindow = (nArgWindow > 0) ? nArgWindow : 1;
+  lfElapsedSeconds = 0.0;
+  nCompleted = 0;
+  nMismatches = 0;
+  nFailures = 0;
+}
+
+CLoadGenerator::~CLoadGenerator(void)
+{
+}
+
+unsigned long long CLoadGenerator::GetMismatches(void)
+{
+  return nMismatches.load();
+}
+
+unsigned long long CLoadGenerator::GetFailures(void)
+{
+  return nFailures.load();
+}
+
+bool CLoadGenerator::Run(const char *szSocketPath)
+{
+  vector<thread> vClient;
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+
+  Latency.Reset();
+  nCompleted = 0;
+  nMismatches = 0;
+  nFailures = 0;
+
+  for (int i=0; i<nClients; i++)
+    vClient.push_back(thread(&CLoadGenerator::ClientLoop, this, szSocketPath, i));
+  for (size_t i=0; i<vClient.size(); i++)
+    vClient[i].join();
+
+  lfElapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+  return nFailures == 0 && nMismatches == 0;
+}
+
+void CLoadGenerator::ClientLoop(const char *szSocketPath, int Client)
+{
+  struct sockaddr_un Address;
+  int Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  mt19937 Random((unsigned int)(Client + 1));
+  uniform_real_distribution<double> Value(1.0, 100.0);
+  CFixedEvaluator Evaluator;
+
+  memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  strncpy(Address.sun_path, szSocketPath, sizeof(Address.sun_path) - 1);
+  if (Socket < 0 || connect(Socket, (struct sockaddr *)&Address, sizeof(Address)) < 0)
+  {
+    nFailures++;
+    if (Socket >= 0)
+      close(Socket);
+    return;
+  }
+
+  vector<chrono::steady_clock::time_point> vSent(nWindow);
+  vector<double> vExpected(nWindow);
+  string sPartial;
+  char szBuffer[16384];
+
+  for (int First=0; First<nRequestsPerClient; First+=nWindow)
+  {
+    int nInWindow = (nRequestsPerClient - First < nWindow) ? nRequestsPerClient - First : nWindow;
+    string sRequests;
+
+    // Send the whole window in one go ...
+    for (int i=0; i<nInWindow; i++)
+    {
+      int Id = First + i;
+      const char *szExpression = LoadExpression[Id % NUMBER_OF_LOAD_EXPRESSIONS];
+      char szLine[256];
+
+      Evaluator.a = Value(Random);
+      Evaluator.b = Value(Random);
+      Evaluator.c = Value(Random);
+      snprintf(szLine, sizeof(szLine), "%d|%s|a=%.17g,b=%.17g,c=%.17g\n",
+               Id, szExpression, Evaluator.a, Evaluator.b, Evaluator.c);
+      sRequests += szLine;
+
+      vExpected[i] = 0.0;
+      if (Id % VERIFY_EVERY == 0)
+      {
+        Evaluator.SetExpression(szExpression);
+        Evaluator.InitialiseVariables();
+        vExpected[i] = Evaluator.EvaluateExpression();
+      }
+      vSent[i] = chrono::steady_clock::now();
+    }
+
+    if (send(Socket, sRequests.data(), sRequests.length(), MSG_NOSIGNAL) != (ssize_t)sRequests.length())
+    {
+      nFailures++;
+      break;
+    }
+
+    // ... then wait for all of its replies, which may arrive in any order.
+    int nReplies = 0;
+    while (nReplies < nInWindow)
+    {
+      ssize_t n = recv(Socket, szBuffer, sizeof(szBuffer), 0);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+      {
+        nFailures++;
+        close(Socket);
+        return;
+      }
+
+      chrono::steady_clock::time_point Now = chrono::steady_clock::now();
+      sPartial.append(szBuffer, (size_t)n);
+
+      size_t Start = 0;
+      size_t End;
+      while ((End = sPartial.find('\n', Start)) != string::npos)
+      {
+        int Id = 0;
+        int ErrNo = 0;
+        double lfResult = 0.0;
+
+        if (sscanf(sPartial.c_str() + Start, "%d|%d|%lf", &Id, &ErrNo, &lfResult) != 3 ||
+            Id < First || Id >= First + nInWindow || ErrNo != ERR_OK)
+        {
+          nFailures++;
+        }
+        else
+        {
+          int i = Id - First;
+          Latency.Record((unsigned long long)chrono::duration_cast<chrono::nanoseconds>(Now - vSent[i]).count());
+          if (Id % VERIFY_EVERY == 0 && fabs(lfResult - vExpected[i]) > 1e-9 * (1.0 + fabs(vExpected[i])))
+            nMismatches++;
+        }
+        nReplies++;
+        Start = End + 1;
+      }
+      sPartial.erase(0, Start);
+    }
+    nCompleted += nInWindow;
+  }
+
+  close(Socket);
+}
+
+void CLoadGenerator::PrintStatistics(ostream &os)
+{
+  os << "Load generator: clients=" << nClients
+     << " window=" << nWindow
+     << " completed=" << nCompleted.load()
+     << " elapsed=" << lfElapsedSeconds << "s"
+     << " throughput=" << ((lfElapsedSeconds > 0.0) ? nCompleted.load() / lfElapsedSeconds : 0.0) << "/s"
+     << " failures=" << nFailures.load()
+     << " mismatches=" << nMismatches.load() << endl;
+  Latency.Print(os, "Client latency");
+}
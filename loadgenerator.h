@@ -0,0 +1,52 @@
+// loadgenerator.h :
+// Interface/Include file for loadgenerator.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CLoadGenerator Class
+// A local load generator for CEvaluationServer (POSIX only).
+// Each client thread opens its own connection to the server and keeps a
+// window of requests in flight, drawn from a small fixed set of expressions
+// with random variable values. Client side latencies are recorded in a
+// CLatencyHistogram and a sample of the replies is checked against a local
+// evaluation of the same expression.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(LOADGENERATOR_H_INCLUDED_)
+#define LOADGENERATOR_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <atomic>
+#include <ostream>
+#include "latencyhistogram.h"
+
+class CLoadGenerator
+{
+  public:
+    CLoadGenerator(int nClients = 8, int nRequestsPerClient = 10000, int nWindow = 32);
+    ~CLoadGenerator();
+
+    bool Run(const char *szSocketPath);
+    void PrintStatistics(std::ostream &os);
+
+    unsigned long long GetMismatches(void);
+    unsigned long long GetFailures(void);
+
+  private:
+    void ClientLoop(const char *szSocketPath, int Client);
+
+    int nClients;
+    int nRequestsPerClient;
+    int nWindow;
+
+    CLatencyHistogram Latency;
+    double lfElapsedSeconds;
+    std::atomic<unsigned long long> nCompleted;
+    std::atomic<unsigned long long> nMismatches;   // Sampled replies that disagreed with a local evaluation
+    std::atomic<unsigned long long> nFailures;     // Connection or protocol errors
+};
+
+#endif // !defined(LOADGENERATOR_H_INCLUDED_)
@@ -0,0 +1,202 @@
+// memocache.cpp :
+// Implementation of memo cache class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+#include <string.h>
+
+#include "memocache.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////
+// CMemoCache implementation
+////////////////////////////////////////////////////////////////////////////
+CMemoCache::CMemoCache(int nValues, size_t nCapacity)
+{
+  this->nValues = nValues;
+
+  // At least one entry per shard, and a power of two number of sets so
+  // that the set can be selected with a mask.
+  size_t nEntriesPerShard = 1;
+  while (nEntriesPerShard * MEMO_SHARDS < nCapacity)
+    nEntriesPerShard *= 2;
+  nWays = (nEntriesPerShard < MEMO_WAYS) ? nEntriesPerShard : MEMO_WAYS;
+  nSetsPerShard = nEntriesPerShard / nWays;
+
+  for (int s=0; s<MEMO_SHARDS; s++)
+  {
+    tMEMOSHARD &Shard = aShard[s];
+
+    Shard.vHash.assign(nEntriesPerShard, 0);
+    Shard.vKey.assign(nEntriesPerShard * nValues, 0.0);
+    Shard.vResult.assign(nEntriesPerShard, 0.0);
+    Shard.vErrNo.assign(nEntriesPerShard, ERR_OK);
+    Shard.vNextVictim.assign(nSetsPerShard, 0);
+    Shard.nEntries = 0;
+    Shard.nLookups = 0;
+    Shard.nHits = 0;
+    Shard.nInserts = 0;
+    Shard.nEvictions = 0;
+  }
+}
+
+CMemoCache::~CMemoCache(void)
+{
+}
+
+int CMemoCache::GetNumberOfValues(void) const
+{
+  return nValues;
+}
+
+size_t CMemoCache::GetCapacity(void) const
+{
+  return nSetsPerShard * nWays * MEMO_SHARDS;
+}
+
+unsigned long long CMemoCache::Hash(const double *pValues, int nValues) // static
+{
+  // Multiply-xorshift over the bit patterns of the values, then the
+  // MurmurHash3 finaliser so that the low bits (used to pick the shard
+  // and set) depend on every bit of every value.
+  unsigned long long h = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)nValues;
+
+  for (int i=0; i<nValues; i++)
+  {
+    unsigned long long Bits;
+    memcpy(&Bits, &pValues[i], sizeof(Bits));
+    h = (h ^ Bits) * 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 32;
+  }
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+
+  return h ? h : 1; // 0 marks an empty entry
+}
+
+bool CMemoCache::KeyMatches(const tMEMOSHARD &Shard, size_t Entry, const double *pValues) const
+{
+  return nValues == 0 ||
+         memcmp(&Shard.vKey[Entry * nValues], pValues, nValues * sizeof(double)) == 0;
+}
+
+CMemoCache::tMEMOSHARD &CMemoCache::GetShard(unsigned long long h, size_t &FirstEntry)
+{
+  // The low bits pick the shard, the next bits the set within it.
+  FirstEntry = (size_t)((h >> MEMO_SHARD_BITS) & (nSetsPerShard-1)) * nWays;
+  return aShard[h & (MEMO_SHARDS-1)];
+}
+
+bool CMemoCache::Lookup(const double *pValues, double &lfResult, tERRNO &ErrNo)
+{
+  unsigned long long h = Hash(pValues, nValues);
+  size_t FirstEntry;
+  tMEMOSHARD &Shard = GetShard(h, FirstEntry);
+  lock_guard<mutex> Lock(Shard.Mutex);
+
+  Shard.nLookups++;
+  for (size_t Entry=FirstEntry; Entry<FirstEntry+nWays; Entry++)
+  {
+    if (Shard.vHash[Entry] == h && KeyMatches(Shard, Entry, pValues))
+    {
+      Shard.nHits++;
+      lfResult = Shard.vResult[Entry];
+      ErrNo = Shard.vErrNo[Entry];
+      return true;
+    }
+  }
+  return false;
+}
+
+void CMemoCache::Insert(const double *pValues, double lfResult, tERRNO ErrNo)
+{
+  unsigned long long h = Hash(pValues, nValues);
+  size_t FirstEntry;
+  tMEMOSHARD &Shard = GetShard(h, FirstEntry);
+  size_t Entry;
+  lock_guard<mutex> Lock(Shard.Mutex);
+
+  // The same key (another thread may have got here first), else an
+  // empty entry, else evict the set's entries in turn.
+  for (Entry=FirstEntry; Entry<FirstEntry+nWays; Entry++)
+  {
+    if (Shard.vHash[Entry] == h && KeyMatches(Shard, Entry, pValues))
+      break;
+  }
+  if (Entry == FirstEntry+nWays)
+  {
+    for (Entry=FirstEntry; Entry<FirstEntry+nWays; Entry++)
+    {
+      if (Shard.vHash[Entry] == 0)
+        break;
+    }
+    if (Entry < FirstEntry+nWays)
+      Shard.nEntries++;
+    else
+    {
+      unsigned char &NextVictim = Shard.vNextVictim[FirstEntry / nWays];
+      Entry = FirstEntry + NextVictim;
+      NextVictim = (unsigned char)((NextVictim + 1) % nWays);
+      Shard.nEvictions++;
+    }
+  }
+
+  Shard.nInserts++;
+  Shard.vHash[Entry] = h;
+  if (nValues > 0)
+    memcpy(&Shard.vKey[Entry * nValues], pValues, nValues * sizeof(double));
+  Shard.vResult[Entry] = lfResult;
+  Shard.vErrNo[Entry] = ErrNo;
+}
+
+void CMemoCache::Clear(void)
+{
+  for (int s=0; s<MEMO_SHARDS; s++)
+  {
+    lock_guard<mutex> Lock(aShard[s].Mutex);
+
+    aShard[s].vHash.assign(aShard[s].vHash.size(), 0);
+    aShard[s].vNextVictim.assign(nSetsPerShard, 0);
+    aShard[s].nEntries = 0;
+  }
+}
+
+void CMemoCache::GetStatistics(tMEMOSTATS &Stats)
+{
+  memset(&Stats, 0, sizeof(Stats));
+  Stats.nCapacity = GetCapacity();
+
+  for (int s=0; s<MEMO_SHARDS; s++)
+  {
+    lock_guard<mutex> Lock(aShard[s].Mutex);
+
+    Stats.nLookups += aShard[s].nLookups;
+    Stats.nHits += aShard[s].nHits;
+    Stats.nInserts += aShard[s].nInserts;
+    Stats.nEvictions += aShard[s].nEvictions;
+    Stats.nEntries += aShard[s].nEntries;
+  }
+}
+
+double CMemoCache::GetHitRate(void)
+{
+  tMEMOSTATS Stats;
+
+  GetStatistics(Stats);
+  return Stats.nLookups ? (double)Stats.nHits / Stats.nLookups : 0.0;
+}
+
+void CMemoCache::PrintStatistics(ostream &os, const char *szTitle)
+{
+  tMEMOSTATS Stats;
+
+  GetStatistics(Stats);
+  os << szTitle << ": lookups=" << Stats.nLookups
+     << " hits=" << Stats.nHits
+     << " hit rate=" << (Stats.nLookups ? 100.0 * Stats.nHits / Stats.nLookups : 0.0) << "%"
+     << " evictions=" << Stats.nEvictions
+     << " entries=" << Stats.nEntries << "/" << Stats.nCapacity << endl;
+}
@@ -0,0 +1,97 @@
+// memocache.h :
+// Interface/Include file for memocache.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CMemoCache Class
+// A bounded cache of expression results, keyed by the exact tuple of variable
+// values the expression was evaluated with. Worthwhile when the same
+// combinations of values recur, e.g. categorical inputs, or the interactive
+// loop where the defaults shown in [] are accepted again and again.
+//
+// Keys are compared bit for bit, so 0.0 and -0.0 are different keys and a NaN
+// matches only an identical NaN. Errors (e.g. divide by zero) are cached along
+// with results, since they too depend only on the values.
+//
+// The cache is split into MEMO_SHARDS shards, selected by hash, each with its
+// own lock, so that threads sharing a cache rarely contend. Within a shard a
+// key can live in one of MEMO_WAYS entries (a set); when all of them are in
+// use, inserting a new key evicts them in turn. The capacity is therefore a
+// hard bound, and memory is allocated once, up front.
+//
+// Lookup()/Insert() keep hit, miss and eviction counts, for deciding whether
+// the cache is earning its keep for a given workload (see GetStatistics()).
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(MEMOCACHE_H_INCLUDED_)
+#define MEMOCACHE_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include "evaluator.h"
+
+#define MEMO_DEFAULT_CAPACITY 4096   // Entries, rounded up to a power of two
+#define MEMO_SHARD_BITS       4
+#define MEMO_SHARDS           (1 << MEMO_SHARD_BITS)
+#define MEMO_WAYS             4      // Entries per set
+
+typedef struct tagMEMOSTATS
+{
+  unsigned long long nLookups;
+  unsigned long long nHits;
+  unsigned long long nInserts;
+  unsigned long long nEvictions;   // Inserts which replaced a different key
+  size_t nEntries;
+  size_t nCapacity;
+} tMEMOSTATS;
+
+class CMemoCache
+{
+  public:
+    CMemoCache(int nValues, size_t nCapacity = MEMO_DEFAULT_CAPACITY);
+    ~CMemoCache();
+
+    // pValues points to GetNumberOfValues() doubles.
+    bool Lookup(const double *pValues, double &lfResult, tERRNO &ErrNo);
+    void Insert(const double *pValues, double lfResult, tERRNO ErrNo);
+    void Clear(void);                                 // Empties the cache; the statistics are kept
+
+    int GetNumberOfValues(void) const;
+    size_t GetCapacity(void) const;
+    void GetStatistics(tMEMOSTATS &Stats);
+    double GetHitRate(void);                          // In [0,1]; 0 before any lookups
+    void PrintStatistics(std::ostream &os, const char *szTitle);
+
+    static unsigned long long Hash(const double *pValues, int nValues);
+
+  private:
+    typedef struct tagMEMOSHARD
+    {
+      std::mutex Mutex;
+      std::vector<unsigned long long> vHash;    // 0 marks an empty entry
+      std::vector<double> vKey;                 // nValues per entry
+      std::vector<double> vResult;
+      std::vector<tERRNO> vErrNo;
+      std::vector<unsigned char> vNextVictim;   // Per set
+      size_t nEntries;
+      unsigned long long nLookups;
+      unsigned long long nHits;
+      unsigned long long nInserts;
+      unsigned long long nEvictions;
+    } tMEMOSHARD;
+
+    bool KeyMatches(const tMEMOSHARD &Shard, size_t Entry, const double *pValues) const;
+    tMEMOSHARD &GetShard(unsigned long long h, size_t &FirstEntry);
+
+    tMEMOSHARD aShard[MEMO_SHARDS];
+    int nValues;
+    size_t nWays;
+    size_t nSetsPerShard;                       // A power of two
+};
+
+#endif // !defined(MEMOCACHE_H_INCLUDED_)
@@ -0,0 +1,220 @@
+// perfcounters.cpp :
+// Implementation of hardware performance counter class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+
+#include <stdio.h>
+#include <string.h>
+#if defined(__linux__)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif // defined(__linux__)
+
+#include "perfcounters.h"
+
+using namespace std;
+
+#if defined(__linux__)
+static const unsigned long long aPerfConfig[PERF_COUNTERS] =
+{
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_BRANCH_MISSES,
+  PERF_COUNT_HW_CACHE_MISSES,
+};
+
+// As given by read() with PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+typedef struct tagPERFREAD
+{
+  unsigned long long Value;
+  unsigned long long TimeEnabled;
+  unsigned long long TimeRunning;
+} tPERFREAD;
+#endif // defined(__linux__)
+
+////////////////////////////////////////////////////////////////////////////
+// CPerfCounters implementation
+////////////////////////////////////////////////////////////////////////////
+CPerfCounters::CPerfCounters()
+{
+  for (int c=0; c<PERF_COUNTERS; c++)
+    aFd[c] = -1;
+}
+
+CPerfCounters::~CPerfCounters(void)
+{
+  Close();
+}
+
+bool CPerfCounters::Open(void)
+{
+  Close();
+#if defined(__linux__)
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    struct perf_event_attr Attr;
+
+    memset(&Attr, 0, sizeof(Attr));
+    Attr.size = sizeof(Attr);
+    Attr.type = PERF_TYPE_HARDWARE;
+    Attr.config = aPerfConfig[c];
+    Attr.disabled = 1;
+    Attr.exclude_kernel = 1;
+    Attr.exclude_hv = 1;
+    Attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // This thread (0), on any CPU (-1), in no group (-1)
+    aFd[c] = (int)syscall(SYS_perf_event_open, &Attr, 0, -1, -1, 0);
+    if (aFd[c] < 0)
+    {
+      aFd[c] = -1;
+      if (sError.empty())
+        sError = string("perf_event_open(") + GetCounterName((tPERFCOUNTER)c) + "): " + strerror(errno);
+    }
+  }
+#else // defined(__linux__)
+  sError = "hardware counters are only supported on Linux";
+#endif // defined(__linux__)
+  return IsOpen();
+}
+
+void CPerfCounters::Close(void)
+{
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+#if defined(__linux__)
+    if (aFd[c] >= 0)
+      close(aFd[c]);
+#endif // defined(__linux__)
+    aFd[c] = -1;
+  }
+  sError.clear();
+}
+
+bool CPerfCounters::IsOpen(void) const
+{
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    if (aFd[c] >= 0)
+      return true;
+  }
+  return false;
+}
+
+bool CPerfCounters::IsAvailable(tPERFCOUNTER Counter) const
+{
+  return aFd[Counter] >= 0;
+}
+
+const string &CPerfCounters::GetErrorText(void) const
+{
+  return sError;
+}
+
+void CPerfCounters::Start(void)
+{
+#if defined(__linux__)
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    if (aFd[c] >= 0)
+    {
+      ioctl(aFd[c], PERF_EVENT_IOC_RESET, 0);
+      ioctl(aFd[c], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif // defined(__linux__)
+}
+
+void CPerfCounters::Stop(tPERFCOUNTS &Counts)
+{
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    Counts.aCount[c] = 0;
+    Counts.abValid[c] = false;
+  }
+#if defined(__linux__)
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    if (aFd[c] >= 0)
+      ioctl(aFd[c], PERF_EVENT_IOC_DISABLE, 0);
+  }
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    tPERFREAD Read;
+
+    if (aFd[c] < 0 || read(aFd[c], &Read, sizeof(Read)) != (ssize_t)sizeof(Read) || Read.TimeRunning == 0)
+      continue;
+    // Scaled up to the whole time if the counter was multiplexed
+    if (Read.TimeRunning < Read.TimeEnabled)
+      Read.Value = (unsigned long long)((double)Read.Value * Read.TimeEnabled / Read.TimeRunning);
+    Counts.aCount[c] = Read.Value;
+    Counts.abValid[c] = true;
+  }
+#endif // defined(__linux__)
+}
+
+// static
+const char *CPerfCounters::GetCounterName(tPERFCOUNTER Counter)
+{
+  switch (Counter)
+  {
+    case PERF_CYCLES:        return "cycles";
+    case PERF_INSTRUCTIONS:  return "instructions";
+    case PERF_BRANCH_MISSES: return "branch misses";
+    case PERF_CACHE_MISSES:  return "cache misses";
+    default:                 return "?";
+  }
+}
+
+// static
+void CPerfCounters::ClearCounts(tPERFCOUNTS &Counts)
+{
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    Counts.aCount[c] = 0;
+    Counts.abValid[c] = true;
+  }
+}
+
+// static
+void CPerfCounters::AddCounts(tPERFCOUNTS &Total, const tPERFCOUNTS &Counts)
+{
+  // A total is only valid if every part of it was
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    Total.aCount[c] += Counts.aCount[c];
+    Total.abValid[c] = Total.abValid[c] && Counts.abValid[c];
+  }
+}
+
+// static
+void CPerfCounters::PrintCounts(ostream &os, const tPERFCOUNTS &Counts, double lfUnits, const char *szUnit)
+{
+  char szCount[64];
+  bool bAny = false;
+
+  os << "per " << szUnit << ":";
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    if (!Counts.abValid[c])
+      continue;
+    snprintf(szCount, sizeof(szCount), "%s %.2f %s", bAny ? "," : "", Counts.aCount[c] / lfUnits,
+             GetCounterName((tPERFCOUNTER)c));
+    os << szCount;
+    bAny = true;
+  }
+  if (Counts.abValid[PERF_CYCLES] && Counts.abValid[PERF_INSTRUCTIONS] && Counts.aCount[PERF_CYCLES] > 0)
+  {
+    snprintf(szCount, sizeof(szCount), " (%.2f instructions per cycle)",
+             (double)Counts.aCount[PERF_INSTRUCTIONS] / Counts.aCount[PERF_CYCLES]);
+    os << szCount;
+  }
+  if (!bAny)
+    os << " no hardware counters";
+  os << endl;
+}
@@ -0,0 +1,92 @@
+// perfcounters.h :
+// Interface/Include file for perfcounters.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CPerfCounters Class
+// Counts CPU cycles, instructions retired, branch misses and cache misses
+// over a stretch of code, with the hardware performance counters, so that a
+// change can be seen to be bound by the front end, by mispredicted branches
+// (e.g. the switch on the state in CEvaluator::EvaluateExpression()) or by
+// memory, not just to take more or less time.
+//
+//   CPerfCounters Counters;
+//   tPERFCOUNTS Counts;
+//   Counters.Open();                        // false if there are none to be had
+//   Counters.Start();
+//   ... the code to be measured ...
+//   Counters.Stop(Counts);
+//   CPerfCounters::PrintCounts(cout, Counts, nEvaluations, "evaluation");
+//
+// Only the calling thread is counted, in user mode. Where the kernel has more
+// events to count than counters, it takes turns (multiplexes) and the counts
+// are scaled up to the whole time; a counter which never got a turn is not
+// valid.
+//
+// Uses perf_event_open(2), so on Linux only. Elsewhere, or where the kernel
+// will not give the counters (perf_event_paranoid, a container, a virtual
+// machine without a PMU), Open() returns false, GetErrorText() says why,
+// and Start()/Stop() do nothing but give counts which are all not valid.
+// Each counter stands alone, so one the CPU lacks does not lose the others.
+//
+// CCompiledExpression::EnableProfile() also counts the batches it times,
+// with a CPerfCounters per thread (see PrintProfile()).
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(PERFCOUNTERS_H_INCLUDED_)
+#define PERFCOUNTERS_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <ostream>
+#include <string>
+
+typedef enum tagPERFCOUNTER
+{
+  PERF_CYCLES = 0,
+  PERF_INSTRUCTIONS,
+  PERF_BRANCH_MISSES,
+  PERF_CACHE_MISSES,           // Last level cache
+  PERF_COUNTERS                // Number of counters
+} tPERFCOUNTER;
+
+typedef struct tagPERFCOUNTS
+{
+  unsigned long long aCount[PERF_COUNTERS];
+  bool abValid[PERF_COUNTERS]; // false if the counter could not be opened, or never ran
+} tPERFCOUNTS;
+
+class CPerfCounters
+{
+  public:
+    CPerfCounters();
+    ~CPerfCounters();
+
+    // For the calling thread. true if any counter is available.
+    bool Open(void);
+    void Close(void);
+    bool IsOpen(void) const;
+    bool IsAvailable(tPERFCOUNTER Counter) const;
+    const std::string &GetErrorText(void) const;     // Why Open() failed, or a counter is missing
+
+    void Start(void);                                // Zeroes every counter and starts them
+    void Stop(tPERFCOUNTS &Counts);                  // Stops them, and gives the counts since Start()
+
+    static const char *GetCounterName(tPERFCOUNTER Counter);
+    static void ClearCounts(tPERFCOUNTS &Counts);    // All zero and valid, ready for AddCounts()
+    static void AddCounts(tPERFCOUNTS &Total, const tPERFCOUNTS &Counts);
+    // One line: each valid counter divided by lfUnits, e.g. per evaluation,
+    // and instructions per cycle.
+    static void PrintCounts(std::ostream &os, const tPERFCOUNTS &Counts, double lfUnits, const char *szUnit);
+
+  private:
+    CPerfCounters(const CPerfCounters &);
+    CPerfCounters &operator=(const CPerfCounters &);
+
+    int aFd[PERF_COUNTERS];                          // -1 for a counter not available
+    std::string sError;
+};
+
+#endif // !defined(PERFCOUNTERS_H_INCLUDED_)
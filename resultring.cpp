@@ -0,0 +1,467 @@
+// resultring.cpp :
+// Implementation of shared memory result ring classes (POSIX only).
+// Jonathan Gilmore, 19/10/2026
+//
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Layout of the shared memory: a tagRINGHEADER, then nCapacity records.
+// Record n (counting from 0 since the ring was created) is in slot
+// n & (nCapacity - 1). The write cursor is the number of records published;
+// each reader's cursor is the number it has read.
+//
+// A reader joins by announcing a cursor no later than the write cursor, then
+// marking its slot active, then moving its cursor up to the write cursor as it
+// now is. The writer looks at the readers only after publishing, and then
+// writes at most nCapacity records beyond what it published. So whether or
+// not the writer saw the new reader, it cannot overwrite a record the reader
+// has yet to read. All of these are sequentially consistent.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "resultring.h"
+
+using namespace std;
+
+#define RING_MAGIC   0x474E4952        // "RING"
+#define RING_VERSION 1
+
+// Reader slot states
+#define RING_SLOT_FREE    0
+#define RING_SLOT_CLAIMED 1            // Being joined; not yet holding back the writer
+#define RING_SLOT_ACTIVE  2
+
+// Waiting: spin this many times, then yield this many, then sleep
+#define RING_SPIN_WAITS  64
+#define RING_YIELD_WAITS 256
+#define RING_SLEEP_US    50
+
+// The writer looks for dead readers every this many waits
+#define RING_DEAD_READER_WAITS 1024
+
+// Rows EvaluateBatch() evaluates at a time
+#define RING_EVALUATE_CHUNK 256
+
+static_assert(atomic<unsigned long long>::is_always_lock_free && atomic<unsigned int>::is_always_lock_free,
+              "the ring needs lock-free atomics, to share them between processes");
+
+// One per cache line, so that readers do not slow each other (or the writer) down
+struct alignas(64) tRINGREADERSLOT
+{
+  atomic<unsigned int> State;
+  atomic<int> Pid;
+  atomic<unsigned long long> Cursor;
+};
+
+struct tagRINGHEADER
+{
+  atomic<unsigned int> Magic;          // Set last, once the rest is ready
+  unsigned int uVersion;
+  unsigned long long nCapacity;        // A power of two
+  alignas(64) atomic<unsigned long long> WriteCursor;
+  atomic<unsigned int> bClosed;
+  tRINGREADERSLOT aReader[RING_MAX_READERS];
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CRingWait
+// Waits a little longer each time, until the timeout.
+////////////////////////////////////////////////////////////////////////////
+class CRingWait
+{
+  public:
+    CRingWait(unsigned int uTimeoutMs)
+    {
+      nWaits = 0;
+      bForever = (uTimeoutMs == RING_WAIT_FOREVER);
+      if (!bForever)
+        Deadline = chrono::steady_clock::now() + chrono::milliseconds(uTimeoutMs);
+    }
+
+    // False once the timeout has passed
+    bool Wait(void)
+    {
+      nWaits++;
+      if (nWaits <= RING_SPIN_WAITS)
+        return true;
+      if (!bForever && chrono::steady_clock::now() >= Deadline)
+        return false;
+      if (nWaits <= RING_SPIN_WAITS + RING_YIELD_WAITS)
+        this_thread::yield();
+      else
+        this_thread::sleep_for(chrono::microseconds(RING_SLEEP_US));
+      return true;
+    }
+
+    unsigned int GetNumberOfWaits(void) const { return nWaits; }
+
+  private:
+    unsigned int nWaits;
+    bool bForever;
+    chrono::steady_clock::time_point Deadline;
+};
+
+static size_t GetMappedBytes(unsigned long long nCapacity)
+{
+  return sizeof(tagRINGHEADER) + (size_t)nCapacity * sizeof(tRINGRECORD);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CResultRing implementation
+////////////////////////////////////////////////////////////////////////////
+CResultRing::CResultRing(void)
+{
+  pHeader = NULL;
+  pRecord = NULL;
+  nMappedBytes = 0;
+  Cursor = 0;
+  Limit = 0;
+  nWaits = 0;
+  nDetached = 0;
+}
+
+CResultRing::~CResultRing(void)
+{
+  if (pHeader == NULL)
+    return;
+
+  // Readers still attached keep their mapping; the name goes now.
+  Close();
+  munmap(pHeader, nMappedBytes);
+  shm_unlink(sName.c_str());
+}
+
+bool CResultRing::Create(const char *szName, size_t nCapacity)
+{
+  unsigned long long nRecords = 2;
+  void *pMapped;
+  int fd;
+
+  if (pHeader)
+    return false;
+  while (nRecords < nCapacity)
+    nRecords *= 2;
+
+  shm_unlink(szName); // Remove any stale ring left by a previous run
+  fd = shm_open(szName, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+  if (ftruncate(fd, (off_t)GetMappedBytes(nRecords)) < 0)
+  {
+    close(fd);
+    shm_unlink(szName);
+    return false;
+  }
+  pMapped = mmap(NULL, GetMappedBytes(nRecords), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (pMapped == MAP_FAILED)
+  {
+    shm_unlink(szName);
+    return false;
+  }
+
+  pHeader = new (pMapped) tagRINGHEADER;
+  pRecord = (tRINGRECORD *)(pHeader + 1);
+  nMappedBytes = GetMappedBytes(nRecords);
+  sName = szName;
+  Cursor = 0;
+  Limit = 0;
+
+  pHeader->uVersion = RING_VERSION;
+  pHeader->nCapacity = nRecords;
+  pHeader->WriteCursor = 0;
+  pHeader->bClosed = 0;
+  for (int i=0; i<RING_MAX_READERS; i++)
+  {
+    pHeader->aReader[i].State = RING_SLOT_FREE;
+    pHeader->aReader[i].Pid = 0;
+    pHeader->aReader[i].Cursor = 0;
+  }
+  pHeader->Magic = RING_MAGIC;
+  return true;
+}
+
+void CResultRing::Close(void)
+{
+  if (pHeader)
+    pHeader->bClosed = 1;
+}
+
+size_t CResultRing::GetReadersLimit(void)
+{
+  unsigned long long Oldest = Cursor;
+
+  for (int i=0; i<RING_MAX_READERS; i++)
+  {
+    tRINGREADERSLOT &Slot = pHeader->aReader[i];
+
+    if (Slot.State.load() == RING_SLOT_ACTIVE)
+      Oldest = min(Oldest, Slot.Cursor.load());
+  }
+  return Oldest + pHeader->nCapacity;
+}
+
+void CResultRing::DetachDeadReaders(void)
+{
+  for (int i=0; i<RING_MAX_READERS; i++)
+  {
+    tRINGREADERSLOT &Slot = pHeader->aReader[i];
+    unsigned int State = RING_SLOT_ACTIVE;
+
+    if (Slot.State.load() == RING_SLOT_ACTIVE && kill(Slot.Pid.load(), 0) < 0 && errno == ESRCH &&
+        Slot.State.compare_exchange_strong(State, RING_SLOT_FREE))
+      nDetached++;
+  }
+}
+
+size_t CResultRing::Reserve(size_t nWanted, unsigned int uTimeoutMs)
+// The number of records, up to nWanted, which may be written at Cursor now
+// without wrapping. 0 if there was no room within the timeout.
+{
+  if (Limit <= Cursor)
+    Limit = GetReadersLimit();
+  if (Limit <= Cursor)
+  {
+    CRingWait Wait(uTimeoutMs);
+
+    nWaits++;
+    while (Limit <= Cursor)
+    {
+      if (!Wait.Wait())
+        return 0;
+      if (Wait.GetNumberOfWaits() % RING_DEAD_READER_WAITS == 0)
+        DetachDeadReaders();
+      Limit = GetReadersLimit();
+    }
+  }
+
+  unsigned long long nCapacity = pHeader->nCapacity;
+  return (size_t)min((unsigned long long)nWanted, min(Limit - Cursor, nCapacity - (Cursor & (nCapacity - 1))));
+}
+
+void CResultRing::Publish(size_t nRecords)
+{
+  Cursor += nRecords;
+  pHeader->WriteCursor.store(Cursor);
+}
+
+size_t CResultRing::Write(const tRINGRECORD *pRecords, size_t nRecords, unsigned int uTimeoutMs)
+{
+  size_t nWritten = 0;
+
+  while (pHeader && nWritten < nRecords)
+  {
+    size_t n = Reserve(nRecords - nWritten, uTimeoutMs);
+
+    if (n == 0)
+      break;
+    memcpy(&pRecord[Cursor & (pHeader->nCapacity - 1)], pRecords + nWritten, n * sizeof(tRINGRECORD));
+    Publish(n);
+    nWritten += n;
+  }
+  return nWritten;
+}
+
+size_t CResultRing::WriteResults(unsigned long long FirstRowId, const double *pResults, const tERRNO *pErrNo,
+                                 size_t nRows, unsigned int uTimeoutMs)
+{
+  size_t nWritten = 0;
+
+  while (pHeader && nWritten < nRows)
+  {
+    size_t n = Reserve(nRows - nWritten, uTimeoutMs);
+    tRINGRECORD *p = &pRecord[Cursor & (pHeader->nCapacity - 1)];
+
+    if (n == 0)
+      break;
+    for (size_t i=0; i<n; i++)
+    {
+      p[i].RowId = FirstRowId + nWritten + i;
+      p[i].lfResult = pResults[nWritten + i];
+      p[i].ErrNo = pErrNo ? (int)pErrNo[nWritten + i] : (int)ERR_OK;
+      p[i].Reserved = 0;
+    }
+    Publish(n);
+    nWritten += n;
+  }
+  return nWritten;
+}
+
+size_t CResultRing::EvaluateBatch(const CCompiledExpression &Compiled, const double *const *ppColumns, size_t nRows,
+                                  unsigned long long FirstRowId, unsigned int uTimeoutMs)
+{
+  int nSlots = Compiled.GetNumberOfVariables();
+  vector<const double *> vColumn(nSlots + 1);
+  double aResult[RING_EVALUATE_CHUNK];
+  tERRNO aErrNo[RING_EVALUATE_CHUNK];
+  size_t nWritten = 0;
+
+  // Evaluated a chunk at a time, each as soon as there is room for it,
+  // so the results go into the ring while still in the cache.
+  while (pHeader && nWritten < nRows)
+  {
+    size_t n = Reserve(min(nRows - nWritten, (size_t)RING_EVALUATE_CHUNK), uTimeoutMs);
+    tRINGRECORD *p = &pRecord[Cursor & (pHeader->nCapacity - 1)];
+
+    if (n == 0)
+      break;
+    for (int Slot=0; Slot<nSlots; Slot++)
+      vColumn[Slot] = ppColumns[Slot] + nWritten;
+    Compiled.EvaluateBatch(&vColumn[0], n, aResult, aErrNo);
+    for (size_t i=0; i<n; i++)
+    {
+      p[i].RowId = FirstRowId + nWritten + i;
+      p[i].lfResult = aResult[i];
+      p[i].ErrNo = (int)aErrNo[i];
+      p[i].Reserved = 0;
+    }
+    Publish(n);
+    nWritten += n;
+  }
+  return nWritten;
+}
+
+void CResultRing::GetStatistics(tRINGSTATS &Stats) const
+{
+  Stats.nWritten = Cursor;
+  Stats.nWaits = nWaits;
+  Stats.nDetached = nDetached;
+  Stats.nReaders = 0;
+  for (int i=0; pHeader && i<RING_MAX_READERS; i++)
+  {
+    if (pHeader->aReader[i].State.load() == RING_SLOT_ACTIVE)
+      Stats.nReaders++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CResultRingReader implementation
+////////////////////////////////////////////////////////////////////////////
+CResultRingReader::CResultRingReader(void)
+{
+  pHeader = NULL;
+  pRecord = NULL;
+  nMappedBytes = 0;
+  iSlot = -1;
+  Cursor = 0;
+}
+
+CResultRingReader::~CResultRingReader(void)
+{
+  Close();
+}
+
+bool CResultRingReader::Open(const char *szName)
+{
+  struct stat Status;
+  void *pMapped;
+  int fd;
+
+  if (pHeader)
+    return false;
+
+  fd = shm_open(szName, O_RDWR, 0);
+  if (fd < 0)
+    return false;
+  if (fstat(fd, &Status) < 0 || (size_t)Status.st_size < sizeof(tagRINGHEADER))
+  {
+    close(fd);
+    return false;
+  }
+  pMapped = mmap(NULL, (size_t)Status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (pMapped == MAP_FAILED)
+    return false;
+
+  pHeader = (tagRINGHEADER *)pMapped;
+  nMappedBytes = (size_t)Status.st_size;
+  if (pHeader->Magic.load() != RING_MAGIC || pHeader->uVersion != RING_VERSION ||
+      GetMappedBytes(pHeader->nCapacity) != nMappedBytes)
+  {
+    Close();
+    return false;
+  }
+  pRecord = (const tRINGRECORD *)(pHeader + 1);
+
+  for (int i=0; i<RING_MAX_READERS && iSlot<0; i++)
+  {
+    unsigned int State = RING_SLOT_FREE;
+
+    if (pHeader->aReader[i].State.compare_exchange_strong(State, RING_SLOT_CLAIMED))
+      iSlot = i;
+  }
+  if (iSlot < 0)
+  {
+    Close();
+    return false;
+  }
+
+  // See the top of the file.
+  tRINGREADERSLOT &Slot = pHeader->aReader[iSlot];
+  Slot.Pid = (int)getpid();
+  Slot.Cursor = pHeader->WriteCursor.load();
+  Slot.State = RING_SLOT_ACTIVE;
+  Cursor = pHeader->WriteCursor.load();
+  Slot.Cursor = Cursor;
+  return true;
+}
+
+void CResultRingReader::Close(void)
+{
+  if (pHeader == NULL)
+    return;
+  if (iSlot >= 0)
+    pHeader->aReader[iSlot].State = RING_SLOT_FREE;
+  munmap(pHeader, nMappedBytes);
+  pHeader = NULL;
+  pRecord = NULL;
+  iSlot = -1;
+}
+
+size_t CResultRingReader::Read(tRINGRECORD *pRecords, size_t nMaxRecords, unsigned int uTimeoutMs)
+{
+  CRingWait Wait(uTimeoutMs);
+  unsigned long long Written;
+
+  if (pHeader == NULL || nMaxRecords == 0)
+    return 0;
+
+  while ((Written = pHeader->WriteCursor.load(memory_order_acquire)) == Cursor)
+  {
+    // Closed after the last record was published, so look again before giving up.
+    if (pHeader->bClosed.load() && pHeader->WriteCursor.load() == Cursor)
+      return 0;
+    if (!Wait.Wait())
+      return 0;
+  }
+
+  unsigned long long nCapacity = pHeader->nCapacity;
+  size_t n = (size_t)min((unsigned long long)nMaxRecords, Written - Cursor);
+  size_t First = (size_t)(Cursor & (nCapacity - 1));
+  size_t nToEnd = min(n, (size_t)nCapacity - First);
+
+  memcpy(pRecords, &pRecord[First], nToEnd * sizeof(tRINGRECORD));
+  memcpy(pRecords + nToEnd, &pRecord[0], (n - nToEnd) * sizeof(tRINGRECORD));
+  Cursor += n;
+  pHeader->aReader[iSlot].Cursor.store(Cursor, memory_order_release);
+  return n;
+}
+
+bool CResultRingReader::IsEnd(void) const
+{
+  return pHeader == NULL || (pHeader->bClosed.load() && pHeader->WriteCursor.load() == Cursor);
+}
@@ -0,0 +1,133 @@
+// resultring.h :
+// Interface/Include file for resultring.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CResultRing and CResultRingReader Classes
+// A ring buffer of evaluation results in POSIX shared memory, written by one
+// process (CResultRing) and read by any number of others on the same host
+// (CResultRingReader), without the copies and system calls of a pipe.
+//
+// Every reader sees every record written while it is attached, in order.
+// Each reader has a cursor of its own in the shared memory, on a cache line of
+// its own. The writer never overwrites a record before every attached reader
+// has read it, but waits instead (back-pressure), or gives up after a timeout.
+// With no readers attached, records are written and nobody waits.
+//
+// Neither side takes a lock. The writer publishes records by advancing the
+// shared write cursor after writing them, and a reader releases them by
+// advancing its own cursor after reading them. A reader whose process has died
+// is detached by the writer when it finds itself waiting for it.
+//
+// Only one thread may write at a time (CEvaluationServer serialises its
+// workers); any number of threads or processes may each have their own reader.
+//
+//   Writer                                  Reader
+//   CResultRing Ring;                       CResultRingReader Reader;
+//   Ring.Create("/results");                Reader.Open("/results");
+//   Ring.EvaluateBatch(Compiled, ...);      while ((n = Reader.Read(aRecord, 256)) > 0)
+//   Ring.Close();                             ...
+//
+// Build (POSIX): add resultring.cpp to the evalserver build (see evalserver.h),
+// and -lrt with glibc older than 2.17.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(RESULTRING_H_INCLUDED_)
+#define RESULTRING_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <string>
+#include "compiledexpression.h"
+
+#define RING_MAX_READERS      16
+#define RING_DEFAULT_CAPACITY 65536     // Records; rounded up to a power of two
+#define RING_WAIT_FOREVER     (~0U)
+
+typedef struct tagRINGRECORD
+{
+  unsigned long long RowId;
+  double lfResult;
+  int ErrNo;                   // A tERRNO value
+  int Reserved;
+} tRINGRECORD;
+
+typedef struct tagRINGSTATS
+{
+  unsigned long long nWritten;
+  unsigned long long nWaits;   // Times the writer found the ring full
+  unsigned long long nDetached; // Readers detached because their process had died
+  int nReaders;                // Attached now
+} tRINGSTATS;
+
+struct tagRINGHEADER;
+
+class CResultRing
+{
+  public:
+    CResultRing();
+    ~CResultRing();                                  // Closes, and removes the shared memory
+
+    // szName is as for shm_open(), e.g. "/results". Replaces any ring of that name.
+    bool Create(const char *szName, size_t nCapacity = RING_DEFAULT_CAPACITY);
+    void Close(void);                                // Readers reach the end once they have read everything
+
+    // Each returns the number of records written, fewer than asked only on a timeout.
+    size_t Write(const tRINGRECORD *pRecords, size_t nRecords, unsigned int uTimeoutMs = RING_WAIT_FOREVER);
+    // Rows FirstRowId, FirstRowId+1, ... pErrNo NULL means all ERR_OK.
+    size_t WriteResults(unsigned long long FirstRowId, const double *pResults, const tERRNO *pErrNo, size_t nRows,
+                        unsigned int uTimeoutMs = RING_WAIT_FOREVER);
+    // As CCompiledExpression::EvaluateBatch(), but straight into the ring, a chunk at a time.
+    size_t EvaluateBatch(const CCompiledExpression &Compiled, const double *const *ppColumns, size_t nRows,
+                         unsigned long long FirstRowId, unsigned int uTimeoutMs = RING_WAIT_FOREVER);
+
+    void GetStatistics(tRINGSTATS &Stats) const;
+
+  private:
+    CResultRing(const CResultRing &);
+    CResultRing &operator=(const CResultRing &);
+
+    size_t Reserve(size_t nWanted, unsigned int uTimeoutMs);
+    void Publish(size_t nRecords);
+    size_t GetReadersLimit(void);
+    void DetachDeadReaders(void);
+
+    struct tagRINGHEADER *pHeader;
+    tRINGRECORD *pRecord;
+    size_t nMappedBytes;
+    std::string sName;
+    unsigned long long Cursor;       // Records written; the writer's copy of the shared cursor
+    unsigned long long Limit;        // The cursor may go up to here without looking at the readers again
+    unsigned long long nWaits;
+    unsigned long long nDetached;
+};
+
+class CResultRingReader
+{
+  public:
+    CResultRingReader();
+    ~CResultRingReader();
+
+    // Reads from the next record written. False if there is no such ring
+    // (yet), or RING_MAX_READERS are already attached.
+    bool Open(const char *szName);
+    void Close(void);
+
+    // Waits for at least one record. Returns 0 on a timeout, or at the end.
+    size_t Read(tRINGRECORD *pRecords, size_t nMaxRecords, unsigned int uTimeoutMs = RING_WAIT_FOREVER);
+    bool IsEnd(void) const;                          // The ring is closed and everything has been read
+
+  private:
+    CResultRingReader(const CResultRingReader &);
+    CResultRingReader &operator=(const CResultRingReader &);
+
+    struct tagRINGHEADER *pHeader;
+    const tRINGRECORD *pRecord;
+    size_t nMappedBytes;
+    int iSlot;
+    unsigned long long Cursor;
+};
+
+#endif // !defined(RESULTRING_H_INCLUDED_)
@@ -15,7 +15,7 @@
 // The resultant string is retrieved via the GetResult() method.
 ////////////////////////////////////////////////////////////////////////////////////////
 
-#include "stdafx.h"
+#include "StdAfx.h"
 #include <conio.h>
 
 #include "simpleeditor.h"
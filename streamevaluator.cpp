@@ -0,0 +1,355 @@
+// streamevaluator.cpp :
+// Implementation of streaming (time series) evaluator class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "streamevaluator.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////
+// CStreamEvaluator implementation
+////////////////////////////////////////////////////////////////////////////
+CStreamEvaluator::CStreamEvaluator()
+{
+  nSamples = 0;
+  WarmUp = 0;
+  ErrNo = ERR_OK;
+}
+
+CStreamEvaluator::~CStreamEvaluator(void)
+{
+}
+
+bool CStreamEvaluator::SetExpression(const char *szExpression, unsigned int uFlags)
+{
+  vector<int> vMaxBack;
+  size_t nRing = 0;
+
+  vInput.clear();
+  vSlot.clear();
+  vRing.clear();
+  WarmUp = 0;
+  Compiled.Compile(szExpression, uFlags);
+  ErrNo = Compiled.GetErrorNumber();
+  if (ErrNo != ERR_OK)
+  {
+    Reset();
+    return false;
+  }
+
+  // An input for each variable, however it is referred to
+  for (int s=0; s<Compiled.GetNumberOfVariables(); s++)
+  {
+    tHISTORYREF Reference;
+    tSTREAMSLOT Slot;
+
+    if (!Compiled.GetHistoryReference(s, Reference))
+    {
+      Reference.VariableName = Compiled.GetVariableName(s);
+      Reference.Oldest = 0;
+      Reference.Newest = 0;
+    }
+    memset(&Slot, 0, sizeof(Slot));
+    Slot.iInput = GetInputIndex(Reference.VariableName);
+    if (Slot.iInput < 0)
+    {
+      tSTREAMINPUT Input = { Reference.VariableName, 0, 0 };
+
+      Slot.iInput = (int)vInput.size();
+      vInput.push_back(Input);
+      vMaxBack.push_back(0);
+    }
+    Slot.Oldest = Reference.Oldest;
+    Slot.Newest = Reference.Newest;
+    vSlot.push_back(Slot);
+    vMaxBack[Slot.iInput] = max(vMaxBack[Slot.iInput], Reference.Oldest);
+    WarmUp = max(WarmUp, Reference.Oldest);
+  }
+
+  // A window taking in sample n lets go of sample n-Oldest-1, so the ring
+  // keeps the Oldest+1 samples before the current one (the current one is
+  // still in the caller's hands).
+  for (size_t i=0; i<vInput.size(); i++)
+  {
+    size_t Length = 1;
+
+    if (vMaxBack[i] == 0)
+      continue;
+    while (Length < (size_t)vMaxBack[i] + 1)
+      Length <<= 1;
+    vInput[i].iFirst = nRing;
+    vInput[i].Mask = Length - 1;
+    nRing += Length;
+  }
+  vRing.resize(nRing);
+
+  vValue.resize(vSlot.size());
+  vpValue.resize(vSlot.size());
+  for (size_t s=0; s<vSlot.size(); s++)
+    vpValue[s] = &vValue[s];
+  vpSample.resize(vInput.size());
+  vColumn.resize(vSlot.size() * STREAM_BLOCK_SAMPLES);
+  vpColumn.resize(vSlot.size());
+  for (size_t s=0; s<vSlot.size(); s++)
+    vpColumn[s] = &vColumn[s * STREAM_BLOCK_SAMPLES];
+  vpBatchColumn.resize(vSlot.size());
+  Reset();
+  return true;
+}
+
+tERRNO CStreamEvaluator::GetErrorNumber(void) const
+{
+  return ErrNo;
+}
+
+const CCompiledExpression &CStreamEvaluator::GetCompiled(void) const
+{
+  return Compiled;
+}
+
+int CStreamEvaluator::GetNumberOfInputs(void) const
+{
+  return (int)vInput.size();
+}
+
+char CStreamEvaluator::GetInputName(int Input) const
+{
+  return vInput[Input].VariableName;
+}
+
+int CStreamEvaluator::GetInputIndex(char VariableName) const
+{
+  for (size_t i=0; i<vInput.size(); i++)
+  {
+    if (vInput[i].VariableName == VariableName)
+      return (int)i;
+  }
+  return -1;
+}
+
+int CStreamEvaluator::GetWarmUpSamples(void) const
+{
+  return WarmUp;
+}
+
+void CStreamEvaluator::Reset(void)
+{
+  nSamples = 0;
+  fill(vRing.begin(), vRing.end(), 0.0);
+  for (size_t s=0; s<vSlot.size(); s++)
+  {
+    vSlot[s].lfSum = 0.0;
+    vSlot[s].nNaN = 0;
+    vSlot[s].nPosInf = 0;
+    vSlot[s].nNegInf = 0;
+    vSlot[s].nMoves = 0;
+  }
+}
+
+unsigned long long CStreamEvaluator::GetNumberOfSamples(void) const
+{
+  return nSamples;
+}
+
+double CStreamEvaluator::Push(const double *pSample, tERRNO *pErrNo)
+{
+  double lfResult = 0.0;
+  tERRNO ResultErrNo = ErrNo;
+
+  if (ErrNo != ERR_OK)
+  {
+    if (pErrNo)
+      *pErrNo = ErrNo;
+    return 0.0;
+  }
+
+  // A block of one sample, so as to be the same as PushBatch()
+  for (size_t i=0; i<vInput.size(); i++)
+    vpSample[i] = &pSample[i];
+  FillBlock(vpSample.data(), 1, vpValue.data());
+  for (size_t s=0; s<vSlot.size(); s++)
+  {
+    if (vSlot[s].Oldest == 0)
+      vValue[s] = pSample[vSlot[s].iInput];
+  }
+  if (nSamples < (unsigned long long)WarmUp)
+    ResultErrNo = ERR_INSUFFICIENT_HISTORY;
+  else
+    lfResult = Compiled.Evaluate(vValue.data(), &ResultErrNo);
+  StoreBlock(vpSample.data(), 1);
+  nSamples++;
+
+  if (pErrNo)
+    *pErrNo = ResultErrNo;
+  return lfResult;
+}
+
+void CStreamEvaluator::PushBatch(const double *const *ppInputs, size_t nBatch, double *pResults, tERRNO *pErrNo)
+{
+  if (ErrNo != ERR_OK)
+  {
+    fill(pResults, pResults + nBatch, 0.0);
+    if (pErrNo)
+      fill(pErrNo, pErrNo + nBatch, ErrNo);
+    return;
+  }
+
+  for (size_t Done=0; Done<nBatch; )
+  {
+    size_t nBlock = min(nBatch - Done, (size_t)STREAM_BLOCK_SAMPLES);
+    size_t nWarmUp = 0;
+
+    for (size_t i=0; i<vInput.size(); i++)
+      vpSample[i] = ppInputs[i] + Done;
+    FillBlock(vpSample.data(), nBlock, vpColumn.data());
+
+    // Rows before the end of the warm up have no result
+    if (nSamples < (unsigned long long)WarmUp)
+      nWarmUp = (size_t)min((unsigned long long)nBlock, WarmUp - nSamples);
+    fill(pResults + Done, pResults + Done + nWarmUp, 0.0);
+    if (pErrNo)
+      fill(pErrNo + Done, pErrNo + Done + nWarmUp, ERR_INSUFFICIENT_HISTORY);
+    if (nWarmUp < nBlock)
+    {
+      // The current values are the inputs themselves
+      for (size_t s=0; s<vSlot.size(); s++)
+        vpBatchColumn[s] = (vSlot[s].Oldest == 0 ? vpSample[vSlot[s].iInput] : vpColumn[s]) + nWarmUp;
+      Compiled.EvaluateBatch(vpBatchColumn.data(), nBlock - nWarmUp,
+                             pResults + Done + nWarmUp, pErrNo ? pErrNo + Done + nWarmUp : NULL);
+    }
+
+    StoreBlock(vpSample.data(), nBlock);
+    nSamples += nBlock;
+    Done += nBlock;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Lags and windows over a block
+////////////////////////////////////////////////////////////////////////////
+
+// Sample number Sample of an input, from the block (starting at sample First)
+// or, before it, from the ring. Samples before the first are 0.
+inline double CStreamEvaluator::GetSample(const tSTREAMINPUT &Input, unsigned long long Sample,
+                                          unsigned long long First, const double *pBlock) const
+{
+  if (Sample >= First)
+    return pBlock[Sample - First];
+  return vRing[Input.iFirst + (size_t)(Sample & Input.Mask)];
+}
+
+// Fills ppColumns[Slot][0..nBlock-1] for each lag and window, for the samples
+// from nSamples on, whose values are ppInputs[Input][0..nBlock-1]. Moves the
+// windows on to the end of the block.
+void CStreamEvaluator::FillBlock(const double *const *ppInputs, size_t nBlock, double *const *ppColumns)
+{
+  unsigned long long First = nSamples;
+
+  for (size_t s=0; s<vSlot.size(); s++)
+  {
+    tSTREAMSLOT &Slot = vSlot[s];
+    const tSTREAMINPUT &Input = vInput[Slot.iInput];
+    const double *pBlock = ppInputs[Slot.iInput];
+    double *pColumn = ppColumns[s];
+
+    if (Slot.Oldest == 0)
+      continue;
+
+    if (Slot.Oldest == Slot.Newest)
+    {
+      // A lag: the input shifted down, the first few from the ring
+      size_t Lag = (size_t)Slot.Oldest;
+      size_t j = 0;
+
+      for (; j<nBlock && j<Lag; j++)
+        pColumn[j] = (First + j >= Lag) ? GetSample(Input, First + j - Lag, First, pBlock) : 0.0;
+      if (j < nBlock)
+        memcpy(pColumn + j, pBlock, (nBlock - j) * sizeof(double));
+      continue;
+    }
+
+    // A window: the sample which enters it added, the one which leaves taken away
+    int Width = Slot.Oldest - Slot.Newest + 1;
+
+    for (size_t j=0; j<nBlock; j++)
+    {
+      unsigned long long Sample = First + j;
+
+      if (Sample >= (unsigned long long)Slot.Newest)
+        AddToWindow(Slot, GetSample(Input, Sample - Slot.Newest, First, pBlock), 1);
+      if (Sample >= (unsigned long long)Slot.Oldest + 1)
+        AddToWindow(Slot, GetSample(Input, Sample - Slot.Oldest - 1, First, pBlock), -1);
+      if (++Slot.nMoves >= Width && Sample >= (unsigned long long)Slot.Oldest)
+        SumWindow(Slot, Sample, First, pBlock);
+      pColumn[j] = GetWindowValue(Slot);
+    }
+  }
+}
+
+// Keeps the end of the block in the ring of each input with history.
+void CStreamEvaluator::StoreBlock(const double *const *ppInputs, size_t nBlock)
+{
+  for (size_t i=0; i<vInput.size(); i++)
+  {
+    const tSTREAMINPUT &Input = vInput[i];
+    size_t j = 0;
+
+    if (Input.Mask == 0)
+      continue;
+    if (nBlock > Input.Mask + 1)
+      j = nBlock - (Input.Mask + 1);
+    for (; j<nBlock; j++)
+      vRing[Input.iFirst + (size_t)((nSamples + j) & Input.Mask)] = ppInputs[i][j];
+  }
+}
+
+// Sums the window at Sample again from its samples, so that the rounding
+// errors of adding and taking away do not build up. Once every Width moves, so
+// the same work per sample on average as moving it.
+void CStreamEvaluator::SumWindow(tSTREAMSLOT &Slot, unsigned long long Sample, unsigned long long First,
+                                 const double *pBlock) const
+{
+  const tSTREAMINPUT &Input = vInput[Slot.iInput];
+
+  Slot.lfSum = 0.0;
+  Slot.nNaN = 0;
+  Slot.nPosInf = 0;
+  Slot.nNegInf = 0;
+  Slot.nMoves = 0;
+  for (int Back=Slot.Oldest; Back>=Slot.Newest; Back--)
+    AddToWindow(Slot, GetSample(Input, Sample - Back, First, pBlock), 1);
+}
+
+// static
+// Sign is 1 for a sample entering the window, -1 for one leaving it.
+inline void CStreamEvaluator::AddToWindow(tSTREAMSLOT &Slot, double lfValue, int Sign)
+{
+  if (isfinite(lfValue))
+    Slot.lfSum += Sign * lfValue;
+  else if (isnan(lfValue))
+    Slot.nNaN += Sign;
+  else if (lfValue > 0.0)
+    Slot.nPosInf += Sign;
+  else
+    Slot.nNegInf += Sign;
+}
+
+// static
+// The sum as it would be added up: NaN with any NaN, or with both infinities.
+inline double CStreamEvaluator::GetWindowValue(const tSTREAMSLOT &Slot)
+{
+  if (Slot.nNaN > 0 || (Slot.nPosInf > 0 && Slot.nNegInf > 0))
+    return nan("");
+  if (Slot.nPosInf > 0)
+    return HUGE_VAL;
+  if (Slot.nNegInf > 0)
+    return -HUGE_VAL;
+  return Slot.lfSum;
+}
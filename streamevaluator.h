@@ -0,0 +1,137 @@
+// streamevaluator.h :
+// Interface/Include file for streamevaluator.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CStreamEvaluator Class
+// Evaluates an expression over time series, one time step (sample) at a
+// time as the samples arrive, where the expression may refer to earlier
+// values of its variables: a[-1] is the value of a one sample ago, and
+// a[-9:0] the sum of its last ten values (see compiledexpression.h), e.g.
+//
+//   a - a[-1]                     the change since the last sample
+//   a[-19:0] / 20                 the moving average over twenty samples
+//   (a[-4:0] - a[-9:-5]) / 5      the change in that average over five
+//
+// Each variable (input) has a ring buffer of as many of its latest samples as
+// its lags and windows reach back. Each window keeps its running sum, adding
+// the sample which enters it and taking away the one which leaves, so a
+// sample costs the same however wide the windows. So that rounding errors do
+// not build up, a window is summed again from its samples once every time it
+// has moved its own width, which is still constant work per sample on
+// average. Infinite and NaN samples are counted rather than summed, so that a
+// window gives Inf or NaN only while they are in it.
+//
+// Until the furthest lag or window reaches back to the first sample
+// (GetWarmUpSamples()), there is no result: 0.0 and ERR_INSUFFICIENT_HISTORY.
+// The samples are kept all the same.
+//
+// PushBatch() takes many time steps at once, a block of STREAM_BLOCK_SAMPLES
+// at a time: it fills a column for each lag and window over the block (a lag
+// is a copy of the input shifted down) and evaluates the block with
+// CCompiledExpression::EvaluateBatch(). The results are the same as pushing
+// the samples one at a time.
+//
+//   CStreamEvaluator Stream;
+//   Stream.SetExpression("a[-19:0]/20 - b");
+//   for (;;)
+//   {
+//     aSample[Stream.GetInputIndex('a')] = ...;
+//     aSample[Stream.GetInputIndex('b')] = ...;
+//     double lfResult = Stream.Push(aSample, &ErrNo);
+//   }
+//
+// An object holds the state of one stream, so it may be used by only one
+// thread at a time.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(STREAMEVALUATOR_H_INCLUDED_)
+#define STREAMEVALUATOR_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <vector>
+#include "compiledexpression.h"
+
+// Time steps PushBatch() evaluates together
+#define STREAM_BLOCK_SAMPLES 4096
+
+typedef struct tagSTREAMINPUT
+{
+  char VariableName;
+  size_t iFirst;               // Its ring buffer, in CStreamEvaluator::vRing
+  size_t Mask;                 // Its length less one (a power of two); 0 with no history
+} tSTREAMINPUT;
+
+typedef struct tagSTREAMSLOT
+{
+  int iInput;
+  int Oldest;                  // As in tHISTORYREF; both 0 for the current value
+  int Newest;
+  double lfSum;                // A window's finite samples
+  int nNaN;                    // And those which are not
+  int nPosInf;
+  int nNegInf;
+  int nMoves;                  // Since lfSum was last summed from the samples
+} tSTREAMSLOT;
+
+class CStreamEvaluator
+{
+  public:
+    CStreamEvaluator();
+    ~CStreamEvaluator();
+
+    // Compiles the expression (uFlags are the COMPILE_ flags), and starts a new stream.
+    bool SetExpression(const char *szExpression, unsigned int uFlags = COMPILE_DEFAULT);
+    tERRNO GetErrorNumber(void) const;
+    const CCompiledExpression &GetCompiled(void) const;
+
+    // The variables, each once however many lags and windows it has, in order
+    // of first appearance.
+    int GetNumberOfInputs(void) const;
+    char GetInputName(int Input) const;
+    int GetInputIndex(char VariableName) const;      // -1 if the expression does not use it
+    int GetWarmUpSamples(void) const;                // Samples before the first result
+
+    // pSample[Input] is the value of each input at the next time step. Returns
+    // the result at that step (see GetErrorNumber()/pErrNo as for Evaluate()).
+    double Push(const double *pSample, tERRNO *pErrNo = NULL);
+    // nSamples steps: ppInputs[Input][k] is each input's value at the k'th.
+    void PushBatch(const double *const *ppInputs, size_t nSamples, double *pResults, tERRNO *pErrNo = NULL);
+
+    void Reset(void);                                // Forgets every sample
+    unsigned long long GetNumberOfSamples(void) const;
+
+  private:
+    CStreamEvaluator(const CStreamEvaluator &);
+    CStreamEvaluator &operator=(const CStreamEvaluator &);
+
+    double GetSample(const tSTREAMINPUT &Input, unsigned long long Sample, unsigned long long First,
+                     const double *pBlock) const;
+    void FillBlock(const double *const *ppInputs, size_t nSamples, double *const *ppColumns);
+    void StoreBlock(const double *const *ppInputs, size_t nSamples);
+    void SumWindow(tSTREAMSLOT &Slot, unsigned long long Sample, unsigned long long First,
+                   const double *pBlock) const;
+    static void AddToWindow(tSTREAMSLOT &Slot, double lfValue, int Sign);
+    static double GetWindowValue(const tSTREAMSLOT &Slot);
+
+    CCompiledExpression Compiled;
+    std::vector<tSTREAMINPUT> vInput;
+    std::vector<tSTREAMSLOT> vSlot;           // Of each slot of Compiled
+    std::vector<double> vRing;                // Each input's ring buffer in turn; sample n is at n & Mask
+    unsigned long long nSamples;
+    int WarmUp;
+    tERRNO ErrNo;
+
+    // Kept between calls, so as not to allocate for each
+    std::vector<double> vValue;               // Push(): of each slot
+    std::vector<double *> vpValue;
+    std::vector<const double *> vpSample;
+    std::vector<double> vColumn;              // PushBatch(): a block for each slot
+    std::vector<double *> vpColumn;
+    std::vector<const double *> vpBatchColumn;
+};
+
+#endif // !defined(STREAMEVALUATOR_H_INCLUDED_)
@@ -1,13 +1,30 @@
 // testdata.cpp : Test functions for MyExpressionEvaluator.
 // Jonathan Gilmore, 28/02/2009
 
-#include "stdafx.h"
+#include "StdAfx.h"
 #include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory_resource>
+#include <set>
 #include <conio.h>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 #include "MyExpressionEvaluator.h"
 #include "evaluator.h"
+#include "asyncevaluator.h"
+#include "compiledexpression.h"
+#include "expressionhandle.h"
+#include "expressionpack.h"
+#include "memocache.h"
+#include "perfcounters.h"
+#include "streamevaluator.h"
+#include "threadpool.h"
+#include "testformulas.h"
 
 using namespace std;
 
@@ -95,14 +112,1976 @@ static tTESTDATA TestData[] =
   "(1 + 10) * 50 / ((2 - 6) * 9)", (1.0 + 10.0) * 50.0 / ((2.0 - 6.0) * 9.0),
   "(0 + 10) * 50 / ((0 - 6) * 9)", (0.0 + 10.0) * 50.0 / ((0.0 - 6.0) * 9.0),
 
+  "-(4+3)*2"    , (-(4.0+3.0)*2.0),
+  "5-(4 )*2"    , (5.0-(4.0)*2.0),
+  "1+2+3+4+5+6+7+8"     , (1.0+2.0+3.0+4.0+5.0+6.0+7.0+8.0),
+  "1-2+3-4+5-6+7-8"     , (1.0-2.0+3.0-4.0+5.0-6.0+7.0-8.0),
+  "1*2*3*4*5*6*7*8+1"   , (1.0*2.0*3.0*4.0*5.0*6.0*7.0*8.0+1.0),
+
+  "4*2 > 3+1"           , (4.0*2.0 > 3.0+1.0),
+  "4*2 < 3+1"           , (4.0*2.0 < 3.0+1.0),
+  "1+1 == 2"            , (1.0+1.0 == 2.0),
+  "3 <= 2"              , (3.0 <= 2.0),
+  "3 >= 3"              , (3.0 >= 3.0),
+  "2 != 2*1"            , (2.0 != 2.0*1.0),
+  "1 < 2 && 3 > 4"      , (1.0 < 2.0 && 3.0 > 4.0),
+  "1 < 2 || 3 > 4"      , (1.0 < 2.0 || 3.0 > 4.0),
+  "1 || 0 && 0"         , (1.0 || (0.0 && 0.0)),
+  "(4 > 3) * 5 - 1"     , ((4.0 > 3.0) * 5.0 - 1.0),
+  "5 - 1 > 2 - -2"      , (5.0 - 1.0 > 2.0 - -2.0),
+  "8/4/2 == 4"          , (8.0/(4.0/2.0) == 4.0),
+
+  // A unary minus before '(', and spaces before ')'
+  "-(4+3)+2"            , (-(4.0+3.0)+2.0),
+  "2*-(1+1)+1"          , (2.0*-(1.0+1.0)+1.0),
+  "-(-(2))"             , (-(-(2.0))),
+  "10-(1 )-(2 )"        , (10.0-(1.0)-(2.0)),
+  "((1+2 ) )*3"         , (((1.0+2.0))*3.0),
+
   NULL, 0
 };
 
+static bool TestCompiled(CEvaluator *pEvaluator, unsigned int uFlags, double ExpectedResult)
+{
+  CCompiledExpression Compiled;
+  tERRNO ErrNo;
+  double ActualResult;
+
+  if (!pEvaluator->Compile(Compiled, uFlags))
+    return false;
+  ActualResult = Compiled.Evaluate(NULL, &ErrNo);
+  return ErrNo == ERR_OK && abs(ActualResult-ExpectedResult)<0.0001;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CTestEvaluator
+// Supplies variable values from a table, indexed by variable name.
+////////////////////////////////////////////////////////////////////////////
+class CTestEvaluator : public CEvaluator
+{
+  public:
+    CTestEvaluator(pmr::memory_resource *pResource = NULL) : CEvaluator(pResource) {}
+
+    double aValue[128];
+    bool InitialiseVariable(char VariableName, double DefaultValue, double &ValueRet)
+    {
+      ValueRet = aValue[(unsigned char)VariableName];
+      return true;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// CSlowProvider
+// Supplies variable values from a table after a simulated latency, and counts
+// how many fetches are outstanding at once. Variable z cannot be fetched.
+////////////////////////////////////////////////////////////////////////////
+class CSlowProvider : public CAsyncProvider
+{
+  public:
+    CSlowProvider(CTimerQueue &Timer) : pTimer(&Timer), nInFlight(0), nMaxInFlight(0) {}
+
+    double aValue[128];
+    chrono::microseconds Latency;
+    CFetchTask Fetch(char VariableName)
+    {
+      tFETCH Result = { VariableName != 'z', aValue[(unsigned char)VariableName] };
+      int n = ++nInFlight;
+      int nMax = nMaxInFlight;
+
+      while (n > nMax && !nMaxInFlight.compare_exchange_weak(nMax, n))
+        ;
+      if (Latency.count() > 0)
+        co_await pTimer->Sleep(Latency);
+      nInFlight--;
+      co_return Result;
+    }
+
+    CTimerQueue *pTimer;
+    atomic<int> nInFlight;
+    atomic<int> nMaxInFlight;
+};
+
+// Counts for the checks made by the Test...() functions below.
+static int Checks;
+static int CheckSuccesses;
+
+static void Check(bool bPassed, const char *szDescription)
+{
+  Checks++;
+  if (bPassed)
+    CheckSuccesses++;
+  else
+  {
+    cout << "FAIL: " << szDescription << endl;
+    getch();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CCountingResource
+// A memory resource which counts what is allocated from it, and by whom.
+////////////////////////////////////////////////////////////////////////////
+class CCountingResource : public pmr::memory_resource
+{
+  public:
+    size_t nAllocations;
+    size_t nOutstanding;      // Bytes not yet deallocated
+
+    CCountingResource(void) : nAllocations(0), nOutstanding(0) {}
+
+  private:
+    void *do_allocate(size_t nBytes, size_t Alignment)
+    {
+      nAllocations++;
+      nOutstanding += nBytes;
+      return pmr::new_delete_resource()->allocate(nBytes, Alignment);
+    }
+    void do_deallocate(void *p, size_t nBytes, size_t Alignment)
+    {
+      nOutstanding -= nBytes;
+      pmr::new_delete_resource()->deallocate(p, nBytes, Alignment);
+    }
+    bool do_is_equal(const pmr::memory_resource &Other) const noexcept
+    {
+      return this == &Other;
+    }
+};
+
+static void ShowCheckScore(const char *szTitle)
+{
+  cout << szTitle << " SCORE = " << CheckSuccesses << "/" << Checks << endl;
+  Checks = 0;
+  CheckSuccesses = 0;
+}
+
+static void TestMemo(void)
+{
+  const char *szExpression = "(a + 10) * 50 / ((b - 6) * 9)";
+  CCompiledExpression Plain;
+  CCompiledExpression Memo;
+  double aValues[2];
+  tERRNO ErrNo;
+  tMEMOSTATS Stats;
+  bool bSame;
+
+  Plain.Compile(szExpression);
+  Memo.Compile(szExpression);
+  Memo.EnableMemo(64);
+
+  // 8 distinct (a,b) pairs, each evaluated 4 times: 8 misses then 24 hits
+  bSame = true;
+  for (int Pass=0; Pass<4; Pass++)
+  {
+    for (int i=0; i<8; i++)
+    {
+      aValues[0] = i;
+      aValues[1] = 7 + i % 3;
+      bSame = bSame && Memo.Evaluate(aValues, &ErrNo) == Plain.Evaluate(aValues) && ErrNo == ERR_OK;
+    }
+  }
+  Memo.GetMemo()->GetStatistics(Stats);
+  Check(bSame, "cached results differ");
+  Check(Stats.nLookups == 32 && Stats.nHits == 24, "unexpected hit count");
+
+  // Errors are cached too
+  aValues[0] = 1;
+  aValues[1] = 6;
+  Memo.Evaluate(aValues, &ErrNo);
+  Check(ErrNo == ERR_DIVIDE_BY_ZERO, "divide by zero not reported");
+  Memo.Evaluate(aValues, &ErrNo);
+  Check(ErrNo == ERR_DIVIDE_BY_ZERO, "cached divide by zero not reported");
+
+  // Keys are exact: 0.0 and -0.0 are different
+  {
+    CMemoCache Cache(1, 16);
+    double lfZero = 0.0;
+    double lfNegativeZero = -0.0;
+    double lfResult;
+
+    Cache.Insert(&lfZero, 1.0, ERR_OK);
+    Check(Cache.Lookup(&lfZero, lfResult, ErrNo) && lfResult == 1.0, "exact key not found");
+    Check(!Cache.Lookup(&lfNegativeZero, lfResult, ErrNo), "-0.0 matched 0.0");
+  }
+
+  // The capacity is a hard bound
+  {
+    CMemoCache Cache(2, 32);
+    double lfResult;
+
+    for (int i=0; i<1000; i++)
+    {
+      aValues[0] = i;
+      aValues[1] = -i;
+      Cache.Insert(aValues, i, ERR_OK);
+    }
+    Cache.GetStatistics(Stats);
+    Check(Stats.nEntries <= Stats.nCapacity && Stats.nCapacity == 32, "capacity exceeded");
+    Check(Stats.nInserts == 1000 && Stats.nEvictions == 1000 - Stats.nEntries, "eviction count wrong");
+
+    // Whatever survived must still be right
+    bSame = true;
+    for (int i=0; i<1000; i++)
+    {
+      aValues[0] = i;
+      aValues[1] = -i;
+      if (Cache.Lookup(aValues, lfResult, ErrNo))
+        bSame = bSame && lfResult == i;
+    }
+    Check(bSame, "evicted entry returned");
+  }
+
+  // Many threads sharing one cache get the same answers as without it
+  {
+    CThreadPool Pool(4);
+    int nMismatches = 0;
+    mutex MismatchMutex;
+
+    Memo.GetMemo()->Clear();
+    for (int t=0; t<8; t++)
+    {
+      Pool.Submit([&Memo, &Plain, &nMismatches, &MismatchMutex, t]()
+      {
+        double aThreadValues[2];
+        int nThreadMismatches = 0;
+
+        for (int i=0; i<20000; i++)
+        {
+          aThreadValues[0] = (i * 7 + t) % 50;
+          aThreadValues[1] = 7 + (i % 13);
+          if (Memo.Evaluate(aThreadValues) != Plain.Evaluate(aThreadValues))
+            nThreadMismatches++;
+        }
+        lock_guard<mutex> Lock(MismatchMutex);
+        nMismatches += nThreadMismatches;
+      });
+    }
+    Pool.Wait();
+    Check(nMismatches == 0, "threaded results differ");
+  }
+
+  // Recompiling must not return results for the old expression
+  aValues[0] = 2;
+  aValues[1] = 8;
+  Memo.Evaluate(aValues);
+  Memo.Compile("a - b");
+  Check(Memo.Evaluate(aValues) == -6.0, "stale result after recompile");
+
+  // CEvaluator: a hit sets ErrNo just as evaluating would
+  {
+    CTestEvaluator Evaluator;
+    double lfFirst;
+    double lfSecond;
+
+    Evaluator.EnableMemo(MEMO_DEFAULT_CAPACITY);
+    Evaluator.SetExpression(szExpression);
+    Evaluator.aValue['a'] = 3;
+    Evaluator.aValue['b'] = 7;
+    Evaluator.InitialiseVariables();
+    lfFirst = Evaluator.EvaluateExpression();
+    lfSecond = Evaluator.EvaluateExpression();
+    Check(lfFirst == lfSecond && Evaluator.GetMemo()->GetHitRate() == 0.5, "interpreter cache missed");
+
+    Evaluator.aValue['b'] = 6;
+    Evaluator.InitialiseVariables();
+    Evaluator.EvaluateExpression();
+    Evaluator.EvaluateExpression();
+    Check(Evaluator.GetErrorNumber() == ERR_EVALUATION_FAILED, "interpreter cached error not reported");
+
+    // Nothing cached is kept for an expression which does not parse
+    Check(!Evaluator.SetExpression("ab") && Evaluator.GetMemo() == NULL, "cache kept for a bad expression");
+    Evaluator.SetExpression(szExpression);
+    Check(Evaluator.GetMemo() != NULL && Evaluator.GetMemo()->GetHitRate() == 0.0, "cache not restarted");
+  }
+}
+
+static void TestSpecialise(void)
+{
+  CCompiledExpression Original;
+  CCompiledExpression Residual;
+  CCompiledExpression Constant;
+  vector<CVariable> vBinding;
+  double aValues[4];
+  double aResidualValues[2];
+  tERRNO ErrNo;
+  bool bSame = true;
+
+  Original.Compile("(a + 10) * 50 / ((b - 6) * 9) + c * d - b * 1");
+
+  // Bind b and d, leaving a and c, in that order
+  vBinding.push_back(CVariable('d'));
+  vBinding.push_back(CVariable('b'));
+  vBinding.push_back(CVariable('z')); // Not used; ignored
+  double lfB = 8.5;
+  double lfD = 0.25;
+  double lfZ = 1.0;
+  vBinding[0].SetValue(lfD);
+  vBinding[1].SetValue(lfB);
+  vBinding[2].SetValue(lfZ);
+
+  Check(Original.Specialise(vBinding, Residual), "specialise failed");
+  Check(Residual.GetNumberOfVariables() == 2 &&
+        Residual.GetVariableName(0) == 'a' && Residual.GetVariableName(1) == 'c', "residual variables wrong");
+  Check(Residual.GetNumberOfNodes() < Original.GetNumberOfNodes() - 6, "nothing folded");
+
+  // Bit for bit the same results
+  for (int a=-20; a<=20; a++)
+  {
+    for (int c=-3; c<=3; c++)
+    {
+      aValues[Original.GetVariableSlot('a')] = a * 0.37;
+      aValues[Original.GetVariableSlot('b')] = lfB;
+      aValues[Original.GetVariableSlot('c')] = c * 1.1;
+      aValues[Original.GetVariableSlot('d')] = lfD;
+      aResidualValues[0] = a * 0.37;
+      aResidualValues[1] = c * 1.1;
+      bSame = bSame && Original.Evaluate(aValues) == Residual.Evaluate(aResidualValues);
+    }
+  }
+  Check(bSame, "residual results differ");
+
+  // Binding everything leaves a single constant
+  vBinding.push_back(CVariable('a'));
+  vBinding.push_back(CVariable('c'));
+  vBinding[3].SetValue(lfZ);
+  vBinding[4].SetValue(lfZ);
+  Original.Specialise(vBinding, Constant);
+  aValues[Original.GetVariableSlot('a')] = 1.0;
+  aValues[Original.GetVariableSlot('c')] = 1.0;
+  Check(Constant.GetNumberOfNodes() == 1 && Constant.GetNumberOfVariables() == 0 &&
+        Constant.Evaluate(NULL) == Original.Evaluate(aValues), "not folded to a constant");
+
+  // A constant divide by zero is still reported
+  double lfSix = 6.0;
+  vBinding[1].SetValue(lfSix);
+  Original.Specialise(vBinding, Constant);
+  Constant.Evaluate(NULL, &ErrNo);
+  Check(ErrNo == ERR_DIVIDE_BY_ZERO, "divide by zero folded away");
+
+  // x - -0.0 must not be reduced to x
+  Original.Compile("a - b");
+  vBinding.clear();
+  vBinding.push_back(CVariable('b'));
+  double lfNegativeZero = -0.0;
+  vBinding[0].SetValue(lfNegativeZero);
+  Original.Specialise(vBinding, Residual);
+  aResidualValues[0] = -0.0;
+  Check(!signbit(Residual.Evaluate(aResidualValues)), "-0.0 - -0.0 gave -0.0");
+}
+
+static void TestCompileAll(void)
+{
+  static const char *BadExpressions[] = { "4*", "(4+3", "ab+1", "", "4 $ 3", "4 3", "4 = 3", "4 <" };
+  vector<string> vExpression;
+  vector<double> vExpected;
+  vector<CCompiledExpression> vCompiled;
+  vector<tERRNO> vErrNo;
+  bool bResultsOK = true;
+  bool bErrorsOK = true;
+
+  // Enough copies of the test data to keep several threads busy
+  for (int Copy=0; Copy<100; Copy++)
+  {
+    for (int i=0; TestData[i].Expression != NULL; i++)
+    {
+      vExpression.push_back(TestData[i].Expression);
+      vExpected.push_back(TestData[i].ExpectedResult);
+    }
+  }
+  for (size_t i=0; i<sizeof(BadExpressions)/sizeof(BadExpressions[0]); i++)
+    vExpression.push_back(BadExpressions[i]);
+
+  Check(!CCompiledExpression::CompileAll(vExpression, vCompiled, vErrNo, COMPILE_DEFAULT, 4), "errors not reported");
+  Check(vCompiled.size() == vExpression.size() && vErrNo.size() == vExpression.size(), "wrong number of results");
+
+  for (size_t i=0; i<vExpected.size(); i++)
+  {
+    tERRNO ErrNo;
+    double ActualResult = vCompiled[i].Evaluate(NULL, &ErrNo);
+    bResultsOK = bResultsOK && vErrNo[i] == ERR_OK && ErrNo == ERR_OK && abs(ActualResult-vExpected[i])<0.0001;
+  }
+  Check(bResultsOK, "compiled results wrong");
+
+  // Each error exactly as compiling on its own gives
+  for (size_t i=vExpected.size(); i<vExpression.size(); i++)
+  {
+    CCompiledExpression Single;
+
+    Single.Compile(vExpression[i].c_str());
+    bErrorsOK = bErrorsOK && vErrNo[i] != ERR_OK && vErrNo[i] == Single.GetErrorNumber();
+    cout << "\"" << vExpression[i] << "\": " << CEvaluator::GetErrorDescription(vErrNo[i]) << endl;
+  }
+  Check(bErrorsOK, "error numbers wrong");
+}
+
+static void TestAllocator(void)
+{
+  CCountingResource Counting;
+  bool bResultsOK = true;
+
+  // Compiled into the caller's resource, with the same results
+  {
+    CCompiledExpression Compiled(&Counting);
+
+    for (int i=0; TestData[i].Expression != NULL; i++)
+    {
+      tERRNO ErrNo;
+
+      Compiled.Compile(TestData[i].Expression, COMPILE_REASSOCIATE);
+      double ActualResult = Compiled.Evaluate(NULL, &ErrNo);
+      bResultsOK = bResultsOK && ErrNo == ERR_OK && abs(ActualResult-TestData[i].ExpectedResult)<0.0001;
+    }
+    Check(bResultsOK, "results wrong when compiled into a memory resource");
+    Check(Counting.nAllocations > 0 && Counting.nOutstanding > 0, "memory resource not used");
+
+    // Evaluating allocates nothing from it
+    Compiled.Compile("a+b+c+d+e+f+g+h+i*j");
+    size_t nAllocations = Counting.nAllocations;
+    double aValues[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    Check(Compiled.Evaluate(aValues) == 126.0 && Counting.nAllocations == nAllocations, "evaluation used the memory resource");
+
+    // The residual of Specialise() goes to its own resource
+    CCountingResource ResidualCounting;
+    CCompiledExpression Residual(&ResidualCounting);
+    vector<CVariable> vBinding;
+    CVariable Binding('a');
+    double lfBound = 100.0;
+
+    Binding.SetValue(lfBound);
+    vBinding.push_back(Binding);
+    Compiled.Specialise(vBinding, Residual);
+    Check(Residual.Evaluate(aValues + 1) == 225.0 && ResidualCounting.nAllocations > 0 &&
+          Counting.nAllocations == nAllocations, "residual not allocated from its own resource");
+  }
+  Check(Counting.nOutstanding == 0, "memory resource not released");
+
+  // A whole rule set in one arena, released all at once
+  {
+    pmr::monotonic_buffer_resource Arena(&Counting);
+    vector<string> vExpression;
+    vector<CCompiledExpression> vCompiled;
+    vector<tERRNO> vErrNo;
+
+    for (int i=0; TestData[i].Expression != NULL; i++)
+      vExpression.push_back(TestData[i].Expression);
+    CCompiledExpression::CompileAll(vExpression, vCompiled, vErrNo, COMPILE_DEFAULT, 1, &Arena);
+    bResultsOK = true;
+    for (size_t i=0; i<vCompiled.size(); i++)
+      bResultsOK = bResultsOK && abs(vCompiled[i].Evaluate(NULL)-TestData[i].ExpectedResult)<0.0001;
+    Check(bResultsOK && Counting.nOutstanding > 0, "rule set wrong when compiled into an arena");
+  }
+  Check(Counting.nOutstanding == 0, "arena not released");
+
+  // The interpreter too
+  {
+    CTestEvaluator Evaluator(&Counting);
+
+    Evaluator.aValue['x'] = 3.0;
+    Evaluator.SetExpression("(x+1)*(x-1)");
+    Evaluator.InitialiseVariables();
+    Check(Evaluator.EvaluateExpression() == 8.0 && Counting.nOutstanding > 0, "interpreter not allocated from the memory resource");
+  }
+  Check(Counting.nOutstanding == 0, "interpreter's memory resource not released");
+}
+
+static void TestHotSwap(void)
+{
+  const int nReaders = 4;
+  const int nVersions = 2000;
+  CExpressionHandle Handle;
+  atomic<bool> bStop(false);
+  atomic<bool> bResultsOK(true);
+  atomic<long long> nEvaluations(0);
+  vector<thread> vReader;
+  tHANDLESTATS Stats;
+  char szExpression[64];
+
+  // Version k gives x + 1000*k. Every other version puts y first, so that
+  // the slot of x changes too.
+  for (int r=0; r<nReaders; r++)
+  {
+    vReader.push_back(thread([&]()
+    {
+      int iReader = Handle.RegisterReader();
+      unsigned long long LastVersion = 0;
+      long long n = 0;
+      bool bOK = iReader >= 0;
+
+      while (bOK && !bStop)
+      {
+        CExpressionHandle::CReadGuard Guard(Handle, iReader);
+        const CCompiledExpression *pCompiled = Guard.Get();
+        double aValues[2] = { 0.0, 0.0 };
+        double x = (double)(n % 100);
+
+        if (pCompiled == NULL)
+          continue;
+        aValues[pCompiled->GetVariableSlot('x')] = x;
+        bOK = pCompiled->Evaluate(aValues) == x + 1000.0 * Guard.GetVersion() && Guard.GetVersion() >= LastVersion;
+        LastVersion = Guard.GetVersion();
+        n++;
+      }
+      if (iReader >= 0)
+        Handle.UnregisterReader(iReader);
+      if (!bOK)
+        bResultsOK = false;
+      nEvaluations += n;
+    }));
+  }
+
+  for (int k=1; k<=nVersions; k++)
+  {
+    sprintf(szExpression, (k % 2) ? "x + 1000*%d" : "0*y + x + 1000*%d", k);
+    Handle.Publish(szExpression);
+    if (k % 100 == 0)
+      this_thread::yield();   // Let the readers catch up now and then
+  }
+
+  // A bad expression leaves the current version alone
+  tERRNO ErrNo;
+  Check(!Handle.Publish("x +", COMPILE_DEFAULT, &ErrNo) && ErrNo == ERR_OPERAND_EXPECTED, "bad expression published");
+
+  bStop = true;
+  for (int r=0; r<nReaders; r++)
+    vReader[r].join();
+  Check(bResultsOK, "reader saw an inconsistent version");
+  Check(nEvaluations > 0, "no evaluations");
+
+  // With no readers left, every old version can go.
+  Check(Handle.Reclaim() == 0, "old versions not reclaimed");
+  Handle.GetStatistics(Stats);
+  Check(Stats.Version == nVersions && Stats.nPublished == nVersions &&
+        Stats.nReclaimed == nVersions - 1 && Stats.nPending == 0, "wrong statistics");
+  cout << "Hot swap: " << nVersions << " versions, " << nEvaluations << " evaluations" << endl;
+
+  // A reader part way through holds its version back from reclamation.
+  int iReader = Handle.RegisterReader();
+  {
+    CExpressionHandle::CReadGuard Guard(Handle, iReader);
+
+    Handle.Publish("x + 1");
+    Check(Handle.Reclaim() == 1 && Guard.GetVersion() == nVersions, "version reclaimed while being read");
+  }
+  Check(Handle.Reclaim() == 0, "version not reclaimed after reading");
+  Handle.UnregisterReader(iReader);
+}
+
+// The interpreter's result and error for szExpression, with aValue[] as in CTestEvaluator
+static double Interpret(const char *szExpression, const double *aValue, tERRNO &ErrNo)
+{
+  CTestEvaluator Evaluator;
+  double lfResult;
+
+  memcpy(Evaluator.aValue, aValue, sizeof(Evaluator.aValue));
+  Evaluator.SetExpression(szExpression);
+  Evaluator.InitialiseVariables();
+  lfResult = Evaluator.EvaluateExpression();
+  ErrNo = Evaluator.GetErrorNumber();
+  return lfResult;
+}
+
+static void TestGenerated(void)
+{
+  const int nRows = 8;
+  double aaValue[nRows][128];
+  bool bTestDataOK = true;
+  bool bScalarOK = true;
+  bool bBatchOK = true;
+  int nDivideByZero = 0;
+  int f;
+
+  // Rows of values for every variable, including 0 and 6 (the divide by
+  // zero in the mandate's example) for all of them.
+  for (int r=0; r<nRows; r++)
+  {
+    for (int ch=0; ch<128; ch++)
+      aaValue[r][ch] = (r == 0) ? 6.0 : (r == 1) ? 0.0 : ((ch*7 + r*13) % 23) * 0.5 - 3.0;
+  }
+
+  // testformulas.txt starts with TestData[], in order
+  for (f=0; TestData[f].Expression != NULL; f++)
+  {
+    string sExpected = TestData[f].Expression;
+
+    sExpected.erase(0, sExpected.find_first_not_of(' '));
+    sExpected.erase(sExpected.find_last_not_of(' ') + 1);
+    bTestDataOK = bTestDataOK && testformulasFunctions[f].szName != NULL &&
+                  sExpected == testformulasFunctions[f].szExpression;
+  }
+  Check(bTestDataOK, "testformulas.h/.cpp out of date with TestData[]");
+
+  for (f=0; testformulasFunctions[f].szName != NULL; f++)
+  {
+    const tGENERATEDFUNCTION &Function = testformulasFunctions[f];
+    CCompiledExpression Compiled;
+    int nVariables = (int)strlen(Function.szVariables);
+    vector<vector<double> > vvColumn(nVariables, vector<double>(nRows));
+    vector<const double *> vpColumn(nVariables + 1);
+    double aScalarResult[nRows];
+    tERRNO aScalarErrNo[nRows];
+    double aResult[nRows];
+    tERRNO aErrNo[nRows];
+
+    Compiled.Compile(Function.szExpression);
+    for (int r=0; r<nRows; r++)
+    {
+      double aValues[52];
+      tERRNO ExpectedErrNo;
+      tERRNO CompiledErrNo;
+      tERRNO ErrNo;
+
+      for (int i=0; i<nVariables; i++)
+      {
+        aValues[i] = aaValue[r][(unsigned char)Function.szVariables[i]];
+        vvColumn[i][r] = aValues[i];
+      }
+
+      // Bit for bit the same as the interpreter, or an error where it has one.
+      // The interpreter reports a divide by zero as ERR_EVALUATION_FAILED, so
+      // the error itself is compared with the compiled form's.
+      double lfExpected = Interpret(Function.szExpression, aaValue[r], ExpectedErrNo);
+      double lfResult = Function.pScalar(aValues, &ErrNo);
+      Compiled.Evaluate(aValues, &CompiledErrNo);
+      bScalarOK = bScalarOK && (ErrNo == ERR_OK) == (ExpectedErrNo == ERR_OK) && ErrNo == CompiledErrNo &&
+                  (ErrNo != ERR_OK || memcmp(&lfResult, &lfExpected, sizeof(double)) == 0);
+      if (ErrNo == ERR_DIVIDE_BY_ZERO)
+        nDivideByZero++;
+      aScalarResult[r] = lfResult;
+      aScalarErrNo[r] = ErrNo;
+    }
+    for (int i=0; i<nVariables; i++)
+      vpColumn[i] = &vvColumn[i][0];
+
+    Function.pBatch(&vpColumn[0], nRows, aResult, aErrNo);
+    for (int r=0; r<nRows; r++)
+      bBatchOK = bBatchOK && aErrNo[r] == aScalarErrNo[r] && memcmp(&aResult[r], &aScalarResult[r], sizeof(double)) == 0;
+  }
+  Check(bScalarOK, "generated function differs from the interpreter");
+  Check(bBatchOK, "generated batch function differs from the scalar one");
+  Check(f == 93 && nDivideByZero > 0, "generated functions missing");
+}
+
+// The first node of Compiled with the given operator, or -1
+static int FindOperatorNode(const CCompiledExpression &Compiled, char cOperator)
+{
+  for (int n=0; n<Compiled.GetNumberOfNodes(); n++)
+  {
+    if (Compiled.GetNode(n).Type == NODE_OPERATOR && Compiled.GetNode(n).cOperator == cOperator)
+      return n;
+  }
+  return -1;
+}
+
+static void TestProfile(void)
+{
+  const size_t nRows = 1000;
+  CCompiledExpression Plain;
+  CCompiledExpression Profiled;
+  vector<double> vA(nRows);
+  vector<double> vB(nRows);
+  vector<double> vC(nRows);
+  const double *ppColumns[3] = { &vA[0], &vB[0], &vC[0] };
+  vector<double> vExpected(nRows);
+  vector<double> vResult(nRows);
+  vector<tERRNO> vExpectedErrNo(nRows);
+  vector<tERRNO> vErrNo(nRows);
+  unsigned long long nZero = 0;
+  unsigned long long nNaN = 0;
+  tNODEPROFILE Profile;
+  tNODEPROFILE RootProfile;
+  ostringstream Report;
+
+  // b is 0 in one row in 10 (divide by zero), c is NaN in one in 25.
+  for (size_t r=0; r<nRows; r++)
+  {
+    vA[r] = (double)r;
+    vB[r] = (double)(r % 10);
+    vC[r] = (r % 25 == 0) ? nan("") : 0.5 * r;
+    nZero += (vB[r] == 0.0);
+    nNaN += (vB[r] != 0.0 && isnan(vC[r]));
+  }
+
+  Plain.Compile("a / b + c * 2");
+  Profiled.Compile("a / b + c * 2");
+  Profiled.EnableProfile();
+  Plain.EvaluateBatch(ppColumns, nRows, &vExpected[0], &vExpectedErrNo[0]);
+  Profiled.EvaluateBatch(ppColumns, nRows, &vResult[0], &vErrNo[0]);
+  Check(memcmp(&vResult[0], &vExpected[0], nRows * sizeof(double)) == 0 && vErrNo == vExpectedErrNo,
+        "profiled results differ");
+
+  // Every node of every row runs, up to the divide by zero
+  Profiled.GetNodeProfile(FindOperatorNode(Profiled, '/'), Profile);
+  Profiled.GetNodeProfile(Profiled.GetRoot(), RootProfile);
+  Check(Profile.nRuns == nRows && Profile.nErrors == nZero, "divide not profiled");
+  Check(RootProfile.nRuns == nRows - nZero && RootProfile.nErrors == 0 && RootProfile.nNaN == nNaN,
+        "root not profiled");
+  Check(RootProfile.lfSeconds > 0.0, "first batch not timed");
+
+  // Single evaluations count too, but are not timed
+  double aValues[3] = { 1.0, 2.0, 3.0 };
+  Check(Profiled.Evaluate(aValues) == 6.5, "profiled evaluation wrong");
+  Profiled.GetNodeProfile(Profiled.GetRoot(), Profile);
+  Check(Profile.nRuns == RootProfile.nRuns + 1 && Profile.lfSeconds == RootProfile.lfSeconds,
+        "single evaluation not profiled");
+
+  Profiled.PrintProfile(Report);
+  Check(Report.str().find("Profile: 1001 evaluations, 1000 of them timed") == 0, "profile not printed");
+  cout << Report.str();
+
+  // Recompiling starts again
+  Profiled.Compile("a - b");
+  Check(Profiled.GetNodeProfile(Profiled.GetRoot(), Profile) && Profile.nRuns == 0, "profile not reset");
+  Profiled.DisableProfile();
+  Check(!Profiled.GetNodeProfile(Profiled.GetRoot(), Profile), "profile not disabled");
+
+  // Printed a line per node, however deep the tree
+  const int nDivides = 50000;
+  string sDeep = "a";
+  for (int i=0; i<nDivides; i++)
+    sDeep += "/b";
+  Profiled.Compile(sDeep.c_str());
+  Profiled.EnableProfile();
+  Profiled.Evaluate(aValues);
+  Report.str("");
+  Profiled.PrintProfile(Report);
+  string sReport = Report.str();
+  Check(count(sReport.begin(), sReport.end(), '\n') == 4 + 2 * nDivides, "deep profile not printed");
+}
+
+static void TestKernels(void)
+{
+  static const struct
+  {
+    const char *szExpression;
+    tKERNELTYPE aType[2];    // The kernels expected, in order; 0 for none
+  } aShape[] =
+  {
+    "a*x+b",                  { KERNEL_MUL_ADD, (tKERNELTYPE)0 },
+    "a*x - b",                { KERNEL_MUL_ADD, (tKERNELTYPE)0 },
+    "b-a*x",                  { KERNEL_ADD_MUL, (tKERNELTYPE)0 },
+    "a*b+c*d",                { KERNEL_DOT2, (tKERNELTYPE)0 },
+    "(a-b)/c",                { KERNEL_SUM_SCALE, (tKERNELTYPE)0 },
+    "c*(a+b)",                { KERNEL_SCALE_SUM, (tKERNELTYPE)0 },
+    "(a*x+b)/(c*(d-e))",      { KERNEL_MUL_ADD, KERNEL_SCALE_SUM },
+    "a+b",                    { (tKERNELTYPE)0, (tKERNELTYPE)0 },
+    "a*b+c+d+e",              { (tKERNELTYPE)0, (tKERNELTYPE)0 },   // A chain instead
+  };
+  const int nShapes = sizeof(aShape) / sizeof(aShape[0]);
+  bool bMatchOK = true;
+  bool bResultOK = true;
+  bool bFusedOK = true;
+
+  for (int s=0; s<nShapes; s++)
+  {
+    CCompiledExpression Compiled;
+    CCompiledExpression Generic;
+    CCompiledExpression Fused;
+    int nExpected = (aShape[s].aType[0] != 0) + (aShape[s].aType[1] != 0);
+
+    Compiled.Compile(aShape[s].szExpression);
+    Generic.Compile(aShape[s].szExpression, COMPILE_NO_KERNELS);
+    Fused.Compile(aShape[s].szExpression, COMPILE_FUSED_MULTIPLY_ADD);
+    bMatchOK = bMatchOK && Compiled.GetNumberOfKernels() == nExpected && Generic.GetNumberOfKernels() == 0;
+    for (int k=0; k<Compiled.GetNumberOfKernels() && k<2; k++)
+      bMatchOK = bMatchOK && Compiled.GetKernel(k).Type == aShape[s].aType[k] && !Compiled.GetKernel(k).bFused;
+
+    // Small integers, including 0, so that some rows divide by zero.
+    for (int r=0; r<200; r++)
+    {
+      double aValue[128];
+      double aSlotValue[8];
+      tERRNO ErrNo, GenericErrNo, FusedErrNo, InterpretedErrNo;
+
+      for (int v=0; v<128; v++)
+        aValue[v] = (double)((r * 7 + v * 3) % 11) - 5.0 + ((r + v) % 4) * 0.1;
+      for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+        aSlotValue[Slot] = aValue[(unsigned char)Compiled.GetVariableName(Slot)];
+
+      double lfResult = Compiled.Evaluate(aSlotValue, &ErrNo);
+      double lfGeneric = Generic.Evaluate(aSlotValue, &GenericErrNo);
+      double lfFused = Fused.Evaluate(aSlotValue, &FusedErrNo);
+      double lfInterpreted = Interpret(aShape[s].szExpression, aValue, InterpretedErrNo);
+
+      bResultOK = bResultOK && ErrNo == GenericErrNo && memcmp(&lfResult, &lfGeneric, sizeof(double)) == 0 &&
+                  (ErrNo != ERR_OK || (InterpretedErrNo == ERR_OK && lfResult == lfInterpreted));
+      bFusedOK = bFusedOK && FusedErrNo == ErrNo && fabs(lfFused - lfResult) <= 1e-12 * (fabs(lfResult) + 1.0);
+    }
+  }
+  Check(bMatchOK, "kernel shapes not matched");
+  Check(bResultOK, "kernel results differ from node by node");
+  Check(bFusedOK, "fused kernel results wrong");
+
+  // (1 + 2^-30)^2 - (1 + 2^-29) is 2^-60, which only a fused multiply-add keeps.
+  CCompiledExpression Plain;
+  CCompiledExpression Fused;
+  double aValues[3] = { 1.0 + ldexp(1.0, -30), 1.0 + ldexp(1.0, -30), 1.0 + ldexp(1.0, -29) };
+  Plain.Compile("a*x-b");
+  Fused.Compile("a*x-b", COMPILE_FUSED_MULTIPLY_ADD);
+  Check(Plain.Evaluate(aValues) == 0.0 && Fused.Evaluate(aValues) == ldexp(1.0, -60) && Fused.GetKernel(0).bFused,
+        "multiply-add not fused");
+
+  // A residual keeps the compiler's choice, and its kernels take in the bound constants
+  vector<CVariable> vBinding;
+  CCompiledExpression Residual;
+  double lfY = 2.0;
+  vBinding.push_back(CVariable('y'));
+  vBinding[0].SetValue(lfY);
+  Fused.Compile("a*x+b*y", COMPILE_FUSED_MULTIPLY_ADD);
+  Fused.Specialise(vBinding, Residual);
+  Check(Residual.GetNumberOfKernels() == 1 && Residual.GetKernel(0).Type == KERNEL_DOT2 &&
+        Residual.GetKernel(0).bFused && Residual.GetKernel(0).aTerm[3].iVariable < 0,
+        "residual kernels wrong");
+}
+
+// Every point of the grid against Evaluate(), bit for bit
+static bool CheckGrid(const CCompiledExpression &Compiled, const tGRIDAXIS *pAxis)
+{
+  int nSlots = Compiled.GetNumberOfVariables();
+  size_t nPoints = Compiled.GetGridPoints(pAxis);
+  vector<double> vResult(nPoints + 1);
+  vector<tERRNO> vErrNo(nPoints + 1);
+  vector<size_t> vIndex(nSlots, 0);
+  bool bOK = Compiled.EvaluateGrid(pAxis, &vResult[0], &vErrNo[0]);
+
+  for (size_t p=0; p<nPoints && bOK; p++)
+  {
+    double aValues[26];
+    size_t Rest = p;
+    tERRNO ErrNo;
+
+    for (int Slot=nSlots-1; Slot>=0; Slot--)
+    {
+      aValues[Slot] = pAxis[Slot].lfStart + (double)(Rest % pAxis[Slot].nCount) * pAxis[Slot].lfStep;
+      Rest /= pAxis[Slot].nCount;
+    }
+    double lfExpected = Compiled.Evaluate(aValues, &ErrNo);
+    bOK = ErrNo == vErrNo[p] && memcmp(&lfExpected, &vResult[p], sizeof(double)) == 0;
+  }
+  return bOK;
+}
+
+static void TestGrid(void)
+{
+  CCompiledExpression Compiled;
+  tGRIDAXIS aAxis[4] =
+  {
+    { 0.0, 1.0, 10 },     // a
+    { 2.0, 0.5, 9 },      // b, which is 6 at i=8
+    { -1.0, 0.25, 7 },    // c
+    { 3.0, -1.5, 5 },     // d
+  };
+  double lfResult;
+
+  // Sub-trees in every loop, including a chain and kernels
+  Compiled.Compile("(a + 10) * 50 / ((b - 6) * 9) + c*d + a*b - (c+d)/a + a*a*a*a - 3*4");
+  Check(Compiled.GetNumberOfVariables() == 4 && Compiled.GetGridPoints(aAxis) == 10*9*7*5, "grid size wrong");
+  Check(CheckGrid(Compiled, aAxis), "grid differs from Evaluate()");
+
+  Compiled.Compile("a*x+b*y - (c-d)/e", COMPILE_FUSED_MULTIPLY_ADD);
+  tGRIDAXIS aAxis7[7] =
+  {
+    { 0.0, 0.1, 3 }, { 1.0, 1e-9, 4 }, { 0.0, 3.0, 2 }, { 2.0, 0.7, 3 },
+    { -1.0, 0.5, 2 }, { 1.5, 0.5, 3 }, { -1.0, 1.0, 3 },
+  };
+  Check(CheckGrid(Compiled, aAxis7), "fused grid differs from Evaluate()");
+
+  // The innermost variable varies fastest
+  Compiled.Compile("a*100 + b");
+  vector<double> vResult(6);
+  tGRIDAXIS aAxis2[2] = { { 1.0, 1.0, 2 }, { 0.0, 1.0, 3 } };
+  Compiled.EvaluateGrid(aAxis2, &vResult[0]);
+  Check(vResult[0] == 100.0 && vResult[2] == 102.0 && vResult[3] == 200.0 && vResult[5] == 202.0,
+        "grid not in row-major order");
+
+  // No variables: one point. An empty axis: no points.
+  Compiled.Compile("2 * (3 + 4)");
+  Check(Compiled.GetGridPoints(NULL) == 1 && Compiled.EvaluateGrid(NULL, &lfResult) && lfResult == 14.0,
+        "constant grid wrong");
+  Compiled.Compile("a / b");
+  aAxis[1].nCount = 0;
+  Check(Compiled.GetGridPoints(aAxis) == 0 && Compiled.EvaluateGrid(aAxis, &lfResult), "empty grid wrong");
+  Compiled.Compile("a +");
+  Check(!Compiled.EvaluateGrid(aAxis, &lfResult), "grid of nothing evaluated");
+}
+
+static void TestCompactNodes(void)
+{
+  CCompiledExpression Compiled;
+  CCompiledExpression Residual;
+  vector<CVariable> vBinding;
+  double aValues[2] = { 3.0, 5.0 };
+  tERRNO ErrNo;
+
+  Check(sizeof(tNODE) == 12, "nodes not compact");
+
+  // Each distinct constant is kept once, however often it appears.
+  Compiled.Compile("2*a + 2*b + 2 - 0.5*a + 0.5");
+  Check(Compiled.GetNumberOfLiterals() == 2 && Compiled.Evaluate(aValues) == 2*3.0 + 2*5.0 + 2 - 0.5*3.0 + 0.5,
+        "literals not shared");
+  Compiled.Compile("a - -0 + 0");
+  Check(Compiled.GetNumberOfLiterals() == 2, "-0 and 0 shared");
+
+  // Folding a residual makes new literals, shared in the same way.
+  vBinding.push_back(CVariable('b'));
+  vBinding.back().SetValue(aValues[1]);
+  Compiled.Compile("a*(b+2) + 7 - b*2 + 7");
+  Check(Compiled.Specialise(vBinding, Residual) && Residual.Evaluate(aValues) == Compiled.Evaluate(aValues),
+        "residual literals wrong");
+
+  // Nesting far deeper than any recursive parser could manage
+  const int nDepth = 200000;
+  string sDeep = string(nDepth, '(') + "a" + string(nDepth, ')') + "*2";
+  Check(Compiled.Compile(sDeep.c_str()) && Compiled.GetNumberOfNodes() == 3 && Compiled.Evaluate(aValues) == 6.0,
+        "deep braces not compiled");
+  sDeep.clear();
+  for (int i=0; i<nDepth; i++)
+    sDeep += "a-(";
+  sDeep += "b" + string(nDepth, ')');
+  Check(Compiled.Compile(sDeep.c_str()) && Compiled.Evaluate(aValues, &ErrNo) == ((nDepth % 2) ? -2.0 : 5.0) && ErrNo == ERR_OK,
+        "deep right nesting wrong");
+
+  // The interpreter recurses, so it refuses such nesting rather than run out of stack
+  CTestEvaluator Shallow;
+  CTestEvaluator Deep;
+  sDeep = string(EVALUATOR_MAX_DEPTH, '(') + "a" + string(EVALUATOR_MAX_DEPTH, ')') + "*2";
+  Shallow.aValue['a'] = aValues[0];
+  Check(Shallow.SetExpression(sDeep.c_str()) && Shallow.InitialiseVariables() && Shallow.EvaluateExpression() == 6.0 &&
+        Shallow.GetErrorNumber() == ERR_OK, "nesting to the limit refused");
+  sDeep = "(" + sDeep + ")";
+  Check(!Deep.SetExpression(sDeep.c_str()) && Deep.GetErrorNumber() == ERR_BRACES_TOO_DEEP, "nesting past the limit accepted");
+  sDeep = string(nDepth, '(') + "a" + string(nDepth, ')');
+  Check(!Deep.SetExpression(sDeep.c_str()) && Deep.GetErrorNumber() == ERR_BRACES_TOO_DEEP, "deep nesting accepted");
+
+  // Reassociated the same, however deep the divides (which are not chains) nest
+  CCompiledExpression Reassociated;
+  tERRNO ExpectedErrNo;
+  sDeep.clear();
+  for (int i=0; i<nDepth; i++)
+    sDeep += (i % 3) ? "a/(" : "a+b*(";
+  sDeep += "b" + string(nDepth, ')');
+  Compiled.Compile(sDeep.c_str());
+  Check(Reassociated.Compile(sDeep.c_str(), COMPILE_REASSOCIATE) &&
+        Reassociated.Evaluate(aValues, &ErrNo) == Compiled.Evaluate(aValues, &ExpectedErrNo) && ErrNo == ExpectedErrNo,
+        "deep right nesting not reassociated");
+  sDeep = "a";
+  for (int i=0; i<nDepth; i++)
+    sDeep += "/b";
+  Compiled.Compile(sDeep.c_str());
+  Check(Reassociated.Compile(sDeep.c_str(), COMPILE_REASSOCIATE) &&
+        Reassociated.Evaluate(aValues, &ErrNo) == Compiled.Evaluate(aValues) && ErrNo == ERR_OK,
+        "deep left nesting not reassociated");
+
+  sDeep = string(nDepth, '(') + "a" + string(nDepth-1, ')');
+  Check(!Compiled.Compile(sDeep.c_str()) && Compiled.GetErrorNumber() == ERR_UMATCHED_BRACES, "unmatched deep brace accepted");
+  Check(!Compiled.Compile("(a))") && Compiled.GetErrorNumber() == ERR_UMATCHED_BRACES, "extra close brace accepted");
+  Check(!Compiled.Compile("-(a b)") && Compiled.GetErrorNumber() == ERR_OPERATOR_EXPECTED, "missing operator accepted");
+}
+
+// Every result of Evaluate() over a grid of values within the bounds is within GetResultRange().
+static bool CheckResultRange(const CCompiledExpression &Compiled, const tRANGE *pBound)
+{
+  tRANGE Range = Compiled.GetResultRange();
+  int nSlots = Compiled.GetNumberOfVariables();
+  const int nSteps = 7;
+  int nPoints = 1;
+  bool bOK = true;
+
+  for (int Slot=0; Slot<nSlots; Slot++)
+    nPoints *= nSteps;
+  for (int p=0; p<nPoints && bOK; p++)
+  {
+    double aValues[26];
+    int Rest = p;
+    tERRNO ErrNo;
+
+    for (int Slot=0; Slot<nSlots; Slot++)
+    {
+      aValues[Slot] = pBound[Slot].lfLow + (pBound[Slot].lfHigh - pBound[Slot].lfLow) * (Rest % nSteps) / (nSteps - 1);
+      Rest /= nSteps;
+    }
+    double lfResult = Compiled.Evaluate(aValues, &ErrNo);
+    bOK = ErrNo == ERR_OK && lfResult >= Range.lfLow && lfResult <= Range.lfHigh;
+  }
+  return bOK;
+}
+
+static void TestRanges(void)
+{
+  CCompiledExpression Compiled;
+  CCompiledExpression Residual;
+  vector<CVariable> vBinding;
+  vector<int> vWarning;
+  vector<tRANGE> vRange;
+  tERRNO ErrNo;
+  double lfValue;
+
+  // With no bounds, only a constant divisor is known not to be zero.
+  Compiled.Compile("a/2 + a/b");
+  Check(Compiled.GetDivideWarnings(vWarning) == 1 && Compiled.GetNode(vWarning[0]).cOperator == '/' &&
+        Compiled.GetNode(Compiled.GetNode(vWarning[0]).iRight).Type == NODE_VARIABLE, "divide warnings wrong");
+
+  // The request's example: b in [7, 100]
+  Compiled.Compile("a/b");
+  Check(Compiled.SetBounds('a', 1.0, 2.0) && Compiled.SetBounds('b', 7.0, 100.0), "bounds not set");
+  Check(Compiled.GetDivideWarnings(vWarning) == 0 && (Compiled.GetNode(Compiled.GetRoot()).Flags & NODE_FLAG_SAFE_DIVIDE),
+        "bounded divisor not safe");
+  Check(Compiled.GetResultRange().lfLow == 1.0/100.0 && Compiled.GetResultRange().lfHigh == 2.0/7.0, "result range wrong");
+  Check(!Compiled.SetBounds('c', 0.0, 1.0) && !Compiled.SetBounds('a', 2.0, 1.0), "bad bounds accepted");
+
+  // Outside the bounds, a division found safe is no longer checked.
+  double aZero[2] = { 1.0, 0.0 };
+  lfValue = Compiled.Evaluate(aZero, &ErrNo);
+  Check(ErrNo == ERR_OK && isinf(lfValue), "safe division checked");
+  Compiled.ClearBounds();
+  Compiled.Evaluate(aZero, &ErrNo);
+  Check(ErrNo == ERR_DIVIDE_BY_ZERO && Compiled.GetDivideWarnings(vWarning) == 1, "bounds not cleared");
+
+  // A square is not negative; b-c may be zero unless the ranges do not meet.
+  Compiled.Compile("a/(a*a + 1) + a/(b - c)");
+  Compiled.SetBounds('b', 1.0, 2.0);
+  Compiled.SetBounds('c', 2.0, 3.0);
+  Check(Compiled.GetDivideWarnings(vWarning) == 1 && vWarning[0] == Compiled.GetRoot() - 1, "square or difference wrong");
+  Compiled.SetBounds('c', 2.5, 3.0);
+  Check(Compiled.GetDivideWarnings(vWarning) == 0, "separate ranges not safe");
+  Compiled.GetRanges(vRange);
+  Check(vRange.size() == (size_t)Compiled.GetNumberOfNodes() && vRange[3].lfLow == 0.0 && vRange[5].lfLow == 1.0, "node ranges wrong");
+
+  // Kernels, fused or not, and comparisons
+  static const char *aszExpression[] = { "(a-b)/c + c*(a+b)", "a*b+c - (a*b-c)/(b*c+c)", "a*b + c*a > b" };
+  static const unsigned int auFlags[2] = { COMPILE_DEFAULT, COMPILE_FUSED_MULTIPLY_ADD };
+  tRANGE aBound[3] = { { -3.0, 5.0 }, { 0.5, 2.0 }, { 1.0, 4.0 } };
+  bool bKernelsOK = true;
+  for (int e=0; e<3; e++)
+  {
+    for (int f=0; f<2; f++)
+    {
+      Compiled.Compile(aszExpression[e], auFlags[f]);
+      for (int Slot=0; Slot<3; Slot++)
+        Compiled.SetBounds(Compiled.GetVariableName(Slot), aBound[Slot].lfLow, aBound[Slot].lfHigh);
+      bKernelsOK = bKernelsOK && Compiled.GetDivideWarnings(vWarning) == 0 && CheckResultRange(Compiled, aBound);
+    }
+  }
+  Check(bKernelsOK, "kernel ranges wrong");
+  Compiled.Compile("(a-b)/c");
+  Compiled.SetBounds('c', 1.0, 2.0);
+  Check(Compiled.GetNumberOfKernels() == 1 && Compiled.GetKernel(0).bSafeDivide, "kernel division not safe");
+  Check(Compiled.Compile("a < b") && Compiled.GetResultRange().lfLow == 0.0 && Compiled.GetResultRange().lfHigh == 1.0,
+        "comparison range wrong");
+
+  // A residual keeps the bounds of the variables left.
+  Compiled.Compile("c*a/b");
+  Compiled.SetBounds('b', 7.0, 100.0);
+  vBinding.push_back(CVariable('c'));
+  lfValue = 3.0;
+  vBinding.back().SetValue(lfValue);
+  Check(Compiled.Specialise(vBinding, Residual) && Residual.GetDivideWarnings(vWarning) == 0, "residual bounds lost");
+
+  // Printed a line per node, however deep the tree
+  const int nDivides = 50000;
+  string sDeep = "a";
+  ostringstream Report;
+  for (int i=0; i<nDivides; i++)
+    sDeep += "/b";
+  Compiled.Compile(sDeep.c_str());
+  Compiled.SetBounds('b', 1.0, 2.0);
+  Compiled.PrintRanges(Report);
+  string sReport = Report.str();
+  Check(count(sReport.begin(), sReport.end(), '\n') == 2 + 2 * nDivides &&
+        sReport.size() < 200 * (size_t)(2 + 2 * nDivides), "deep ranges not printed");
+}
+
+static void TestAsync(void)
+{
+  static const char *aszExpression[] = { "a*b + c/d - e", "(a+b)*(c-d)/e", "a/(b-b)", "a + z" };
+  const int nExpressions = sizeof(aszExpression) / sizeof(aszExpression[0]);
+  const int nCopies = 50;
+  CTimerQueue Timer;
+  CSlowProvider Provider(Timer);
+  vector<CCompiledExpression> vCompiled(nExpressions);
+  vector<const CCompiledExpression *> vpCompiled;
+  vector<double> vResult;
+  vector<tERRNO> vErrNo;
+  bool bResultsOK = true;
+  tERRNO ErrNo;
+
+  for (int i=0; i<128; i++)
+    Provider.aValue[i] = 1.5 + i % 11;
+  for (int e=0; e<nExpressions; e++)
+    vCompiled[e].Compile(aszExpression[e]);
+  for (int c=0; c<nCopies; c++)
+  {
+    for (int e=0; e<nExpressions; e++)
+      vpCompiled.push_back(&vCompiled[e]);
+  }
+
+  // 200 evaluations of up to 5 variables, 20ms each: 16s one at a time.
+  CAsyncEvaluator Async(Provider);
+  Provider.Latency = chrono::milliseconds(20);
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+  Async.EvaluateAll(vpCompiled, vResult, vErrNo);
+  double lfSeconds = chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+
+  for (size_t i=0; i<vpCompiled.size(); i++)
+  {
+    const CCompiledExpression &Compiled = *vpCompiled[i];
+    double aValues[26];
+    tERRNO ExpectedErrNo;
+
+    for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+      aValues[Slot] = Provider.aValue[(unsigned char)Compiled.GetVariableName(Slot)];
+    double lfExpected = Compiled.Evaluate(aValues, &ExpectedErrNo);
+    if (Compiled.GetVariableSlot('z') >= 0)
+      bResultsOK = bResultsOK && vErrNo[i] == ERR_EVALUATION_FAILED;
+    else
+      bResultsOK = bResultsOK && vErrNo[i] == ExpectedErrNo && vResult[i] == lfExpected;
+  }
+  Check(bResultsOK, "async results differ");
+  Check(vErrNo[2] == ERR_DIVIDE_BY_ZERO && vErrNo[3] == ERR_EVALUATION_FAILED, "async errors wrong");
+  Check(lfSeconds < 2.0, "async fetches not overlapped");
+  Check(Provider.nMaxInFlight > 5 * nCopies, "fetches not all outstanding at once");
+  Check(Async.GetPending() == 0 && Provider.nInFlight == 0, "async evaluations left over");
+  cout << "Async: " << vpCompiled.size() << " evaluations in " << lfSeconds * 1e3 << " ms, "
+       << Provider.nMaxInFlight << " fetches at once" << endl;
+
+  // Values to hand (a cache hit) need no suspension.
+  Provider.Latency = chrono::microseconds(0);
+  Check(Async.Evaluate(vCompiled[1], &ErrNo) == vResult[1] && ErrNo == ERR_OK, "immediate fetches wrong");
+}
+
+static void TestPack(void)
+{
+  static const char *aszSingle[] = { "a+b+c+d", "(b-x)*(b+x)", "a+*b", "-a/2" };
+  const int nRules = 100;
+  vector<CCompiledExpression> vCompiled(4 * nRules + 5);
+  vector<const CCompiledExpression *> vpCompiled;
+  CExpressionPack Pack;
+  tPACKSTATS Stats;
+  char szExpression[64];
+  int n = 0;
+
+  // Three shapes of rule, each with constants of its own, some of which
+  // divide by zero; then expressions of shapes found once only.
+  for (int k=0; k<nRules; k++)
+  {
+    sprintf(szExpression, "a*%d + b*%d", k, (k % 3 == 0) ? k : k + 7);
+    vCompiled[n++].Compile(szExpression);
+    sprintf(szExpression, "c/(a-%d) - %d", k % 10, k);
+    vCompiled[n++].Compile(szExpression);
+    sprintf(szExpression, "a*b > %d.5 && -c < %d", k, k / 2);
+    vCompiled[n++].Compile(szExpression);
+    sprintf(szExpression, "a*%d + b*%d", k, k);
+    vCompiled[n++].Compile(szExpression, COMPILE_FUSED_MULTIPLY_ADD);
+  }
+  for (size_t i=0; i<sizeof(aszSingle)/sizeof(aszSingle[0]); i++)
+    vCompiled[n++].Compile(aszSingle[i]);
+  vCompiled[n++].Compile("x / 0.5 / 4");
+  for (int i=0; i<n; i++)
+    vpCompiled.push_back(&vCompiled[i]);
+
+  Check(Pack.Build(vpCompiled) == 3 && Pack.GetNumberOfGroups() == 3, "wrong number of groups");
+  Pack.GetStatistics(Stats);
+  Check(Stats.nGrouped == 3 * nRules && Stats.nLargestGroup == nRules && Stats.nSingle == nRules + 5,
+        "wrong expressions grouped");
+  Check(Pack.GetNumberOfVariables() == 5 && Pack.GetVariableSlot('x') == 4 && Pack.GetVariableSlot('z') < 0,
+        "wrong pack variables");
+  Pack.PrintStatistics(cout);
+
+  // Two rows: in the second, a is 3, so one rule in ten divides by zero.
+  for (int Row=0; Row<2; Row++)
+  {
+    double aValues[5];
+    vector<double> vResult(n);
+    vector<tERRNO> vErrNo(n);
+    bool bResultsOK = true;
+    int nErrors = 0;
+
+    for (int Slot=0; Slot<Pack.GetNumberOfVariables(); Slot++)
+      aValues[Slot] = (Row == 0) ? 0.25 + Slot : 3.0 + Slot * 1.5;
+    Pack.Evaluate(aValues, &vResult[0], &vErrNo[0]);
+    for (int i=0; i<n; i++)
+    {
+      double aOwnValues[5];
+      tERRNO ErrNo;
+
+      for (int Slot=0; Slot<vCompiled[i].GetNumberOfVariables(); Slot++)
+        aOwnValues[Slot] = aValues[Pack.GetVariableSlot(vCompiled[i].GetVariableName(Slot))];
+      double lfExpected = vCompiled[i].Evaluate(aOwnValues, &ErrNo);
+      bResultsOK = bResultsOK && vErrNo[i] == ErrNo && vResult[i] == lfExpected;
+      if (ErrNo == ERR_DIVIDE_BY_ZERO)
+        nErrors++;
+    }
+    Check(bResultsOK, "pack results differ");
+    Check(nErrors == ((Row == 0) ? 0 : nRules / 10), "wrong divide by zero count");
+  }
+
+  // Lags and windows are left out, rather than sharing one slot between them
+  CCompiledExpression aLagged[3];
+  double aLaggedValues[2] = { 2.0, 3.0 };
+  double aLaggedResult[3];
+  tERRNO aLaggedErrNo[3];
+  aLagged[0].Compile("a[-1] + b");
+  aLagged[1].Compile("b[-1] * 2");
+  aLagged[2].Compile("a + b");
+  Pack.Build(vector<const CCompiledExpression *>({ &aLagged[0], &aLagged[1], &aLagged[2] }));
+  Pack.Evaluate(aLaggedValues, aLaggedResult, aLaggedErrNo);
+  Check(Pack.GetNumberOfVariables() == 2 && aLaggedErrNo[0] == ERR_INVALID_HISTORY && aLaggedErrNo[1] == ERR_INVALID_HISTORY &&
+        aLaggedResult[2] == 5.0 && aLaggedErrNo[2] == ERR_OK, "lags packed");
+
+  Pack.Clear();
+  Check(Pack.Build(vector<const CCompiledExpression *>()) == 0 && Pack.GetNumberOfVariables() == 0, "empty pack wrong");
+}
+
+static void TestTiles(void)
+{
+  static const char *aszExpression[] =
+  {
+    "a+b*c-d/e", "(a-b)/(c-3)", "a*b+c*d", "a+b+c+d+e+a+b+c", "-(a-b)*c < d && e >= 2", "a*(b-c)+d*(e+a)-2",
+  };
+  const int nExpressions = sizeof(aszExpression) / sizeof(aszExpression[0]);
+  const size_t anTileRows[] = { 16, 100, 4096 };
+  const size_t nRows = 5000;
+  vector<vector<double> > vvColumn(5, vector<double>(nRows));
+  vector<unsigned int> vSelection;
+  vector<double> vResult(nRows);
+  vector<tERRNO> vErrNo(nRows);
+  string sDeep = "a";
+  bool bTilesOK = true;
+  bool bSelectionOK = true;
+  int nErrors = 0;
+
+  for (size_t r=0; r<nRows; r++)
+  {
+    vvColumn[0][r] = r * 0.37 - 50.0;
+    vvColumn[1][r] = (double)(r % 11);
+    vvColumn[2][r] = (double)(r % 7);
+    vvColumn[3][r] = 1.5 + r % 5;
+    vvColumn[4][r] = 2.0 + (r % 13) * 0.25;
+    if (r % 3 == 0)
+      vSelection.push_back((unsigned int)r);
+  }
+  // Deep enough that a tile of 4096 rows is cut down to fit the cache
+  for (int i=0; i<40; i++)
+    sDeep = string(1, 'a' + i % 5) + ((i % 2) ? "*(" : "-(") + sDeep + ")";
+
+  for (int e=0; e<=nExpressions; e++)
+  {
+    for (int Flags=0; Flags<3; Flags++)
+    {
+      CCompiledExpression Compiled;
+      const double *apColumn[5];
+      vector<double> vExpected(nRows);
+      vector<tERRNO> vExpectedErrNo(nRows);
+
+      Compiled.Compile((e < nExpressions) ? aszExpression[e] : sDeep.c_str(),
+                       (Flags == 0) ? COMPILE_DEFAULT : (Flags == 1) ? COMPILE_REASSOCIATE : COMPILE_FUSED_MULTIPLY_ADD);
+      for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+        apColumn[Slot] = &vvColumn[Compiled.GetVariableName(Slot) - 'a'][0];
+      for (size_t r=0; r<nRows; r++)
+      {
+        double aValues[5];
+
+        for (int Slot=0; Slot<Compiled.GetNumberOfVariables(); Slot++)
+          aValues[Slot] = apColumn[Slot][r];
+        vExpected[r] = Compiled.Evaluate(aValues, &vExpectedErrNo[r]);
+        if (vExpectedErrNo[r] != ERR_OK)
+          nErrors++;
+      }
+
+      for (size_t t=0; t<sizeof(anTileRows)/sizeof(anTileRows[0]); t++)
+      {
+        CCompiledExpression::SetTileRows(anTileRows[t]);
+        Compiled.EvaluateBatch(apColumn, nRows, &vResult[0], &vErrNo[0]);
+        bTilesOK = bTilesOK && vResult == vExpected && vErrNo == vExpectedErrNo;
+        Compiled.EvaluateBatch(apColumn, 0, &vResult[0], &vErrNo[0], &vSelection[0], vSelection.size());
+        for (size_t k=0; k<vSelection.size(); k++)
+          bSelectionOK = bSelectionOK && vResult[k] == vExpected[vSelection[k]] && vErrNo[k] == vExpectedErrNo[vSelection[k]];
+      }
+    }
+  }
+  Check(bTilesOK, "tiled results differ");
+  Check(bSelectionOK, "tiled selected results differ");
+  Check(nErrors > 0, "no divide by zero tested");
+
+  CCompiledExpression::SetTileRows(1);
+  Check(CCompiledExpression::GetTileRows() == TILE_MIN_ROWS, "small tile not clamped");
+  CCompiledExpression::SetTileRows(1000000);
+  Check(CCompiledExpression::GetTileRows() == TILE_MAX_ROWS, "large tile not clamped");
+  CCompiledExpression::SetTileRows(0);
+  size_t nTileRows = CCompiledExpression::GetTileRows();
+  Check(nTileRows >= TILE_MIN_ROWS && nTileRows <= TILE_MAX_ROWS && (nTileRows & (nTileRows - 1)) == 0,
+        "calibrated tile size wrong");
+  cout << "Calibrated tile: " << nTileRows << " rows" << endl;
+}
+
+static void TestBackgroundCompile(void)
+{
+  // The last two have lags, which only the interpreter's own error can come of
+  static const char *aszExpression[] = { "a*b + c/d - e", "(a < b) || (c*d >= e)", "a/(b-b)", "4 3", "-(a-b)*(c+d)",
+                                         "a + b[-1]", "a[-1] + a[-2]" };
+  const size_t nWithHistory = 2;
+  const size_t nExpressions = sizeof(aszExpression)/sizeof(aszExpression[0]);
+  CTestEvaluator Evaluator;
+  tEXPRESSIONMETRICS Metrics;
+  bool bResultsOK = true;
+  bool bOptimisedOK = true;
+
+  for (int i=0; i<128; i++)
+    Evaluator.aValue[i] = 0.5 + i % 9;
+  Check(!Evaluator.GetExpressionMetrics(Metrics), "metrics without background compiling");
+
+  // Each result and error number as the interpreter's, before and after the switch
+  for (size_t e=0; e<nExpressions; e++)
+  {
+    bool bHistory = e >= nExpressions - nWithHistory;
+    CTestEvaluator Interpreter;
+    CTestEvaluator Evaluator;
+
+    for (int i=0; i<128; i++)
+      Interpreter.aValue[i] = Evaluator.aValue[i] = 0.5 + i % 9;
+    Evaluator.EnableBackgroundCompile();
+    Interpreter.SetExpression(aszExpression[e]);
+    Interpreter.InitialiseVariables();
+    double lfExpected = Interpreter.EvaluateExpression();
+    tERRNO ExpectedErrNo = Interpreter.GetErrorNumber();
+
+    Evaluator.SetExpression(aszExpression[e]);
+    Evaluator.InitialiseVariables();
+    double lfFirst = Evaluator.EvaluateExpression();
+    bool bOptimised = Evaluator.WaitForOptimised(5000);
+    double lfSecond = Evaluator.EvaluateExpression();
+
+    Evaluator.GetExpressionMetrics(Metrics);
+    bResultsOK = bResultsOK && lfFirst == lfExpected && lfSecond == lfExpected &&
+                 Evaluator.GetErrorNumber() == ExpectedErrNo;
+    bOptimisedOK = bOptimisedOK && Metrics.lfFirstResultSeconds >= 0.0 && Metrics.nInterpreted + Metrics.nCompiled == 2 &&
+                   bOptimised == (e != 3 && !bHistory) && (Metrics.CompileErrNo == ERR_OK) == bOptimised &&
+                   Metrics.lfOptimisedSeconds >= 0.0 && (!bHistory || Metrics.CompileErrNo == ERR_INVALID_HISTORY);
+    if (bOptimised && ExpectedErrNo == ERR_OK)
+      bOptimisedOK = bOptimisedOK && Metrics.nCompiled >= 1;   // The first too, if compiling was quick
+  }
+  Check(bResultsOK, "background compiled results differ");
+  Check(bOptimisedOK, "not switched to the compiled form");
+
+  CTestEvaluator Lagged;
+  CCompiledExpression Compiled;
+  Lagged.SetExpression("a + b[-1]");
+  Check(!Lagged.Compile(Compiled) && Lagged.GetErrorNumber() == ERR_INVALID_HISTORY, "lag compiled by the interpreter");
+
+  // Usable at once, however long compiling takes; replaced before it is done
+  string sLong = "a";
+
+  Evaluator.EnableBackgroundCompile();
+  for (int i=0; i<20000; i++)
+    sLong += (i % 2) ? "+b" : "*c";
+  for (int i=0; i<5; i++)
+    Evaluator.SetExpression(sLong.c_str());
+  Evaluator.InitialiseVariables();
+  Evaluator.EvaluateExpression();
+  Check(Evaluator.WaitForOptimised(10000) && Evaluator.GetErrorNumber() == ERR_OK, "long expression not optimised");
+  Evaluator.GetExpressionMetrics(Metrics);
+  cout << "Background compile: first result " << Metrics.lfFirstResultSeconds * 1e3 << " ms, optimised after "
+       << Metrics.lfOptimisedSeconds * 1e3 << " ms (compiling " << Metrics.lfCompileSeconds * 1e3 << " ms)" << endl;
+
+  Evaluator.DisableBackgroundCompile();
+  Check(!Evaluator.IsOptimised() && !Evaluator.GetExpressionMetrics(Metrics), "still optimised once disabled");
+
+  // One evaluator for expressions with other variables, or the same in another order
+  static const char *aszReused[] = { "a-b", "b-a", "c", "a+b" };
+  static const double alfReused[] = { 7.0, -7.0, 100.0, 13.0 };
+  CTestEvaluator Reused;
+  bool bReusedOK = true;
+
+  Reused.aValue['a'] = 10.0;
+  Reused.aValue['b'] = 3.0;
+  Reused.aValue['c'] = 100.0;
+  Reused.EnableBackgroundCompile();
+  Reused.EnableMemo(16);
+  for (size_t e=0; e<sizeof(aszReused)/sizeof(aszReused[0]); e++)
+  {
+    Reused.SetExpression(aszReused[e]);
+    Reused.InitialiseVariables();
+    bool bOptimised = Reused.WaitForOptimised(5000);
+    bReusedOK = bReusedOK && bOptimised && Reused.EvaluateExpression() == alfReused[e] &&
+                Reused.GetNumberOfVariables() == (e == 2 ? 1 : 2);
+  }
+  Check(bReusedOK && Reused.GetErrorNumber() == ERR_OK, "variables left over from the last expression");
+}
+
+// Compares EvaluateDictionary() with EvaluateBatch() on the decoded columns.
+static bool DictionaryMatchesBatch(const CCompiledExpression &Compiled, const vector<tDICTCOLUMN> &vColumn,
+                                   size_t nRows, size_t &nCombinations)
+{
+  int nSlots = Compiled.GetNumberOfVariables();
+  vector<vector<double> > vvDecoded(nSlots, vector<double>(nRows));
+  vector<const double *> vpDecoded(nSlots + 1);
+  vector<double> vExpected(nRows), vResult(nRows);
+  vector<tERRNO> vExpectedErrNo(nRows), vErrNo(nRows);
+
+  for (int Slot=0; Slot<nSlots; Slot++)
+  {
+    for (size_t r=0; r<nRows; r++)
+      vvDecoded[Slot][r] = vColumn[Slot].pDictionary[vColumn[Slot].pCode[r]];
+    vpDecoded[Slot] = &vvDecoded[Slot][0];
+  }
+  Compiled.EvaluateBatch(&vpDecoded[0], nRows, &vExpected[0], &vExpectedErrNo[0]);
+  nCombinations = Compiled.EvaluateDictionary(&vColumn[0], nRows, &vResult[0], &vErrNo[0]);
+  return vResult == vExpected && vErrNo == vExpectedErrNo;
+}
+
+static void TestDictionary(void)
+{
+  const size_t nRows = 150000;                  // More than two chunks
+  vector<vector<unsigned int> > vvCode(8, vector<unsigned int>(nRows));
+  vector<vector<double> > vvDictionary(8);
+  vector<tDICTCOLUMN> vColumn(8);
+  set<vector<unsigned int> > sCombination;
+  unsigned int uRandom = 12345;
+  size_t nCombinations;
+  int nErrors = 0;
+
+  // Skewed, as real categories are: code k about twice as common as code k+1
+  for (int Slot=0; Slot<8; Slot++)
+  {
+    for (int k=0; k<6; k++)
+      vvDictionary[Slot].push_back((k == 3) ? 3.0 : 0.5 + k * (Slot + 1) * 0.75);
+    for (size_t r=0; r<nRows; r++)
+    {
+      unsigned int Code = 0;
+
+      uRandom = uRandom * 1103515245 + 12345;
+      while (Code < 5 && ((uRandom >> (16 + Code)) & 1))
+        Code++;
+      vvCode[Slot][r] = Code;
+    }
+    vColumn[Slot].pCode = &vvCode[Slot][0];
+    vColumn[Slot].pDictionary = &vvDictionary[Slot][0];
+    vColumn[Slot].nDictionary = vvDictionary[Slot].size();
+  }
+  for (size_t r=0; r<nRows; r++)
+  {
+    vector<unsigned int> vCombination;
+
+    for (int Slot=0; Slot<4; Slot++)
+      vCombination.push_back(vvCode[Slot][r]);
+    sCombination.insert(vCombination);
+    if (vvDictionary[2][vvCode[2][r]] == 3.0)
+      nErrors++;
+  }
+
+  CCompiledExpression Compiled;
+  Compiled.Compile("(a-b)/(c-3)+d");
+  Check(DictionaryMatchesBatch(Compiled, vColumn, nRows, nCombinations), "dictionary results differ");
+  Check(nCombinations == sCombination.size(), "dictionary combinations miscounted");
+  Check(nErrors > 0, "dictionary divide by zero not tested");
+
+  // Larger dictionaries (only a few codes of which are used) are hashed
+  for (int Slot=0; Slot<4; Slot++)
+  {
+    vvDictionary[Slot].resize(1000, 1.0);
+    vColumn[Slot].pDictionary = &vvDictionary[Slot][0];
+    vColumn[Slot].nDictionary = vvDictionary[Slot].size();
+  }
+  Check(DictionaryMatchesBatch(Compiled, vColumn, nRows, nCombinations), "hashed dictionary results differ");
+  Check(nCombinations == sCombination.size(), "hashed dictionary combinations miscounted");
+
+  // Nearly every row a combination of its own
+  vector<vector<unsigned int> > vvSpread(vvCode.begin(), vvCode.begin() + 4);
+  vector<tDICTCOLUMN> vSpread(vColumn.begin(), vColumn.begin() + 4);
+  for (int Slot=0; Slot<4; Slot++)
+  {
+    for (size_t r=0; r<nRows; r++)
+    {
+      uRandom = uRandom * 1103515245 + 12345;
+      vvSpread[Slot][r] = (uRandom >> 8) % 1000;
+    }
+    vSpread[Slot].pCode = &vvSpread[Slot][0];
+  }
+  Check(DictionaryMatchesBatch(Compiled, vSpread, nRows, nCombinations), "spread dictionary results differ");
+  Check(nCombinations == 0, "spread dictionary not decoded");
+
+  // 1000^8 combinations are too many for a 64-bit key
+  CCompiledExpression Wide;
+  Wide.Compile("a+b*c-d/(e-3)+f*g-h");
+  for (int Slot=4; Slot<8; Slot++)
+  {
+    vvDictionary[Slot].resize(1000, 1.0);
+    vColumn[Slot].pDictionary = &vvDictionary[Slot][0];
+    vColumn[Slot].nDictionary = vvDictionary[Slot].size();
+  }
+  Check(DictionaryMatchesBatch(Wide, vColumn, nRows, nCombinations), "undecoded dictionary results differ");
+  Check(nCombinations == 0, "too many dictionary combinations not reported");
+
+  // A code outside its dictionary
+  vector<double> vResult(nRows);
+  vector<tERRNO> vErrNo(nRows);
+  vvCode[1][7] = 1000;
+  vvCode[1][nRows - 1] = 5000;
+  Compiled.EvaluateDictionary(&vColumn[0], nRows, &vResult[0], &vErrNo[0]);
+  Check(vErrNo[7] == ERR_EVALUATION_FAILED && vResult[7] == 0.0 && vErrNo[nRows - 1] == ERR_EVALUATION_FAILED,
+        "invalid dictionary code not reported");
+  Wide.EvaluateDictionary(&vColumn[0], nRows, &vResult[0], &vErrNo[0]);
+  Check(vErrNo[7] == ERR_EVALUATION_FAILED && vResult[7] == 0.0, "invalid undecoded dictionary code not reported");
+
+  // No variables: one combination
+  CCompiledExpression Constant;
+  Constant.Compile("2*3+1");
+  nCombinations = Constant.EvaluateDictionary(NULL, nRows, &vResult[0], &vErrNo[0]);
+  Check(nCombinations == 1 && vResult[0] == 7.0 && vResult[nRows - 1] == 7.0 && vErrNo[nRows - 1] == ERR_OK,
+        "constant dictionary result wrong");
+}
+
+static void TestPerfCounters(void)
+{
+  CPerfCounters Counters;
+  tPERFCOUNTS Counts;
+  tPERFCOUNTS Total;
+  volatile double lfSum = 0.0;
+  bool bOpen = Counters.Open();
+
+  Check(bOpen || !Counters.GetErrorText().empty(), "unavailable counters not explained");
+  Counters.Start();
+  for (int i=0; i<100000; i++)
+    lfSum = lfSum + i * 0.5;
+  Counters.Stop(Counts);
+  if (Counters.IsAvailable(PERF_INSTRUCTIONS) && Counts.abValid[PERF_INSTRUCTIONS])
+    Check(Counts.aCount[PERF_INSTRUCTIONS] >= 100000, "too few instructions counted");
+  bool bValidOnlyIfOpen = true;
+  for (int c=0; c<PERF_COUNTERS; c++)
+    bValidOnlyIfOpen = bValidOnlyIfOpen && (!Counts.abValid[c] || Counters.IsAvailable((tPERFCOUNTER)c));
+  Check(bValidOnlyIfOpen, "count valid without a counter");
+  Counters.Close();
+  Counters.Start();
+  Counters.Stop(Counts);
+  Check(!Counters.IsOpen() && !Counts.abValid[PERF_CYCLES] && Counts.aCount[PERF_CYCLES] == 0,
+        "closed counters counted");
+
+  // Totals, and the report, from known counts
+  CPerfCounters::ClearCounts(Total);
+  for (int c=0; c<PERF_COUNTERS; c++)
+  {
+    Counts.aCount[c] = 100 * (c + 1);
+    Counts.abValid[c] = true;
+  }
+  CPerfCounters::AddCounts(Total, Counts);
+  CPerfCounters::AddCounts(Total, Counts);
+  Check(Total.aCount[PERF_CYCLES] == 200 && Total.aCount[PERF_CACHE_MISSES] == 800 && Total.abValid[PERF_CACHE_MISSES],
+        "counts not added");
+  Counts.abValid[PERF_CACHE_MISSES] = false;
+  CPerfCounters::AddCounts(Total, Counts);
+  Check(!Total.abValid[PERF_CACHE_MISSES] && Total.abValid[PERF_CYCLES], "partial count still valid");
+
+  ostringstream Report;
+  CPerfCounters::PrintCounts(Report, Total, 100.0, "row");
+  Check(Report.str() == "per row: 3.00 cycles, 6.00 instructions, 9.00 branch misses (2.00 instructions per cycle)\n",
+        "counts printed wrongly");
+  for (int c=0; c<PERF_COUNTERS; c++)
+    Total.abValid[c] = false;
+  Report.str("");
+  CPerfCounters::PrintCounts(Report, Total, 100.0, "row");
+  Check(Report.str() == "per row: no hardware counters\n", "missing counts printed wrongly");
+
+  // Profiling counts its timed batches, where it can
+  CCompiledExpression Compiled;
+  vector<double> vA(1000, 2.0);
+  const double *ppColumns[1] = { &vA[0] };
+  vector<double> vResult(1000);
+  unsigned long long nRows = 0;
+
+  Compiled.Compile("a*3 + 1");
+  Compiled.EnableProfile();
+  Compiled.EvaluateBatch(ppColumns, 1000, &vResult[0]);
+  Check(Compiled.GetHardwareProfile(Counts, nRows) == bOpen && nRows == (bOpen ? 1000U : 0U),
+        "hardware profile wrong");
+  Report.str("");
+  Compiled.PrintProfile(Report);
+  Check(Report.str().find(bOpen ? "Hardware, per timed row:" : "Hardware counters not available: ") != string::npos,
+        "hardware profile not printed");
+}
+
+// The naive result of a - a[-1] + b[-3:0]*2 - c[-2] at sample n, for TestStream()
+static double NaiveStream(const vector<double> *avInput, size_t n)
+{
+  double lfWindow = 0.0;
+
+  for (size_t k=n-3; k<=n; k++)
+    lfWindow += avInput[1][k];
+  return avInput[0][n] - avInput[0][n-1] + lfWindow*2 - avInput[2][n-2];
+}
+
+static void TestStream(void)
+{
+  CCompiledExpression Compiled;
+  tHISTORYREF Reference;
+
+  // Syntax: a slot for each distinct lag and window
+  Check(Compiled.Compile("a[-1] + a[-3:-1] + a + a[ -1 ]") && Compiled.GetNumberOfVariables() == 3 &&
+        Compiled.HasHistory(), "lags and windows not compiled");
+  Check(Compiled.GetVariableText(0) == "a[-1]" && Compiled.GetVariableText(1) == "a[-3:-1]" &&
+        Compiled.GetVariableText(2) == "a", "lag and window slots wrong");
+  Check(Compiled.GetHistoryReference(1, Reference) && Reference.VariableName == 'a' && Reference.Oldest == 3 &&
+        Reference.Newest == 1 && !Compiled.GetHistoryReference(2, Reference), "history reference wrong");
+  Check(Compiled.Compile("a[0]*2 + b[-9:0]") && Compiled.GetVariableText(0) == "a" &&
+        Compiled.GetVariableText(1) == "b[-9:0]", "current value or window to now wrong");
+
+  const char *aszInvalid[] = { "a[1]", "a[-2:-5]", "a[-1", "a[x]", "a[-1:-2:-3]", "a[-1000001]", "a[]", "a[-1:]" };
+  bool bAllRejected = true;
+  for (size_t i=0; i<sizeof(aszInvalid)/sizeof(aszInvalid[0]); i++)
+    bAllRejected = bAllRejected && !Compiled.Compile(aszInvalid[i]) && Compiled.GetErrorNumber() == ERR_INVALID_HISTORY;
+  Check(bAllRejected, "invalid lag or window accepted");
+
+  string sMany = "a";
+  for (int k=1; k<=HISTORY_MAX_REFERENCES; k++)
+    sMany += "+a[-" + to_string(k) + "]";
+  Check(Compiled.Compile(sMany.c_str()) && Compiled.GetNumberOfVariables() == HISTORY_MAX_REFERENCES + 1,
+        "most lags rejected");
+  sMany += "+a[-" + to_string(HISTORY_MAX_REFERENCES + 1) + "]";
+  Check(!Compiled.Compile(sMany.c_str()) && Compiled.GetErrorNumber() == ERR_INVALID_HISTORY, "too many lags accepted");
+
+  string sLetters;
+  for (char ch='a'; ch<='z'; ch++)
+    sLetters += string(1, ch) + "+" + string(1, (char)toupper(ch)) + "+";
+  sLetters += "a[-1]+Z[-2:-1]";
+  Check(Compiled.Compile(sLetters.c_str()) && Compiled.GetNumberOfVariables() == 54, "lags count as variables");
+
+  // Neither the interpreter nor a stream can take a lag it cannot parse
+  double aValue[128] = { 0.0 };
+  tERRNO ErrNo;
+  Interpret("a[-1]", aValue, ErrNo);
+  Check(ErrNo != ERR_OK, "interpreter accepted a lag");
+  Check(strstr(CEvaluator::GetErrorDescription(ERR_INVALID_HISTORY), "lag") != NULL &&
+        strstr(CEvaluator::GetErrorDescription(ERR_INSUFFICIENT_HISTORY), "samples") != NULL,
+        "history errors not described");
+
+  CStreamEvaluator Stream;
+  Check(!Stream.SetExpression("a[1]") && Stream.GetErrorNumber() == ERR_INVALID_HISTORY, "invalid stream accepted");
+  Stream.Push(aValue, &ErrNo);
+  Check(ErrNo == ERR_INVALID_HISTORY, "invalid stream evaluated");
+
+  // Against the naive result, one at a time and in batches of every size
+  const size_t nSamples = 10000;
+  vector<double> avInput[3];
+  vector<double> vResult(nSamples);
+  vector<tERRNO> vErrNo(nSamples);
+
+  for (int i=0; i<3; i++)
+  {
+    avInput[i].resize(nSamples);
+    for (size_t k=0; k<nSamples; k++)
+      avInput[i][k] = (double)((k * (7 + 2*i) + 13*i) % 101) - 50;
+  }
+  Check(Stream.SetExpression("a - a[-1] + b[-3:0]*2 - c[-2]") && Stream.GetNumberOfInputs() == 3 &&
+        Stream.GetInputName(2) == 'c' && Stream.GetInputIndex('b') == 1 && Stream.GetInputIndex('d') == -1 &&
+        Stream.GetWarmUpSamples() == 3, "stream inputs wrong");
+
+  bool bPushRight = true;
+  for (size_t k=0; k<nSamples; k++)
+  {
+    double aSample[3] = { avInput[0][k], avInput[1][k], avInput[2][k] };
+    double lfResult = Stream.Push(aSample, &ErrNo);
+
+    if (k < 3)
+      bPushRight = bPushRight && lfResult == 0.0 && ErrNo == ERR_INSUFFICIENT_HISTORY;
+    else
+      bPushRight = bPushRight && lfResult == NaiveStream(avInput, k) && ErrNo == ERR_OK;
+  }
+  Check(bPushRight && Stream.GetNumberOfSamples() == nSamples, "pushed samples evaluated wrongly");
+
+  const size_t aChunk[] = { 1, 2, 7, 1000, STREAM_BLOCK_SAMPLES + 5, nSamples };
+  for (size_t c=0; c<sizeof(aChunk)/sizeof(aChunk[0]); c++)
+  {
+    bool bBatchRight = true;
+
+    Stream.Reset();
+    for (size_t Done=0; Done<nSamples; Done+=aChunk[c])
+    {
+      size_t nChunk = min(aChunk[c], nSamples - Done);
+      const double *ppInputs[3] = { &avInput[0][Done], &avInput[1][Done], &avInput[2][Done] };
+
+      Stream.PushBatch(ppInputs, nChunk, &vResult[Done], &vErrNo[Done]);
+    }
+    for (size_t k=0; k<nSamples; k++)
+    {
+      if (k < 3)
+        bBatchRight = bBatchRight && vResult[k] == 0.0 && vErrNo[k] == ERR_INSUFFICIENT_HISTORY;
+      else
+        bBatchRight = bBatchRight && vResult[k] == NaiveStream(avInput, k) && vErrNo[k] == ERR_OK;
+    }
+    Check(bBatchRight, ("batches of " + to_string(aChunk[c]) + " evaluated wrongly").c_str());
+  }
+
+  // NaN and infinities only while they are in the window
+  const double aSpecial[] = { 1.0, NAN, 2.0, 3.0, 4.0, HUGE_VAL, -HUGE_VAL, 5.0, 6.0, 7.0 };
+  vector<double> vWindow;
+  Stream.SetExpression("a[-2:0]");
+  for (size_t k=0; k<sizeof(aSpecial)/sizeof(aSpecial[0]); k++)
+    vWindow.push_back(Stream.Push(&aSpecial[k]));
+  Check(isnan(vWindow[2]) && isnan(vWindow[3]) && vWindow[4] == 9.0 && vWindow[5] == HUGE_VAL &&
+        isnan(vWindow[6]) && isnan(vWindow[7]) && vWindow[8] == -HUGE_VAL && vWindow[9] == 18.0,
+        "window of NaN or infinities wrong");
+
+  // Reset, and errors from the expression itself
+  Stream.Reset();
+  Stream.Push(&aSpecial[2], &ErrNo);
+  Check(ErrNo == ERR_INSUFFICIENT_HISTORY && Stream.GetNumberOfSamples() == 1, "history not forgotten");
+  Stream.SetExpression("1/(a - a[-1])");
+  Stream.Push(&aSpecial[2]);
+  Stream.Push(&aSpecial[2], &ErrNo);
+  Check(ErrNo == ERR_DIVIDE_BY_ZERO, "divide by zero not reported");
+
+  // A long run of fractions does not drift from the exact sum
+  const size_t nLong = 200000;
+  const int Width = 100;
+  vector<double> vLong(nLong);
+  vector<double> vLongResult(nLong);
+  for (size_t k=0; k<nLong; k++)
+    vLong[k] = 1000.0 + (double)(k % 37) * 0.1 + (k % 3 ? 0.01 : -1e-7);
+  Stream.SetExpression("a[-99:0]/100");
+  const double *ppLong[1] = { &vLong[0] };
+  Stream.PushBatch(ppLong, nLong, &vLongResult[0]);
+  double lfWorst = 0.0;
+  for (size_t k=Width-1; k<nLong; k++)
+  {
+    double lfSum = 0.0;
+    for (size_t j=k+1-Width; j<=k; j++)
+      lfSum += vLong[j];
+    lfWorst = max(lfWorst, fabs(vLongResult[k] - lfSum/Width));
+  }
+  Check(lfWorst < 1e-9, "moving average drifted");
+}
+
+static void TestBatchLimits(void)
+{
+  const size_t nRows = 200000;
+  CCompiledExpression Compiled;
+  vector<double> vA(nRows);
+  vector<double> vB(nRows);
+  const double *ppColumns[2] = { &vA[0], &vB[0] };
+  vector<double> vExpected(nRows);
+  vector<tERRNO> vExpectedErrNo(nRows);
+  vector<double> vResult(nRows, -1.0);
+  vector<tERRNO> vErrNo(nRows, ERR_UNKNOWN);
+  vector<unsigned int> vSelection;
+  atomic<bool> bCancel(false);
+  tBATCHLIMITS Limits;
+  tBATCHSTATUS Status;
+  size_t Cursor = 0;
+  int nCalls = 0;
+  bool bPartialOK = true;
+
+  for (size_t r=0; r<nRows; r++)
+  {
+    vA[r] = (double)r;
+    vB[r] = (double)(r % 7);
+    if (r % 3 == 0)
+      vSelection.push_back((unsigned int)r);
+  }
+  Compiled.Compile("(a + 10) * 50 / ((b - 6) * 9)");
+  Compiled.EvaluateBatch(ppColumns, nRows, &vExpected[0], &vExpectedErrNo[0]);
+
+  // No limits: all in one go
+  CCompiledExpression::InitialiseLimits(Limits);
+  Status = Compiled.EvaluateBatch(ppColumns, nRows, &vResult[0], &vErrNo[0], Limits, Cursor);
+  Check(Status == BATCH_COMPLETE && Cursor == nRows && vResult == vExpected && vErrNo == vExpectedErrNo,
+        "unlimited batch wrong");
+
+  // Already cancelled, or past the deadline: nothing done
+  Limits.pCancel = &bCancel;
+  bCancel = true;
+  Cursor = 0;
+  Check(Compiled.EvaluateBatch(ppColumns, nRows, &vResult[0], &vErrNo[0], Limits, Cursor) == BATCH_CANCELLED &&
+        Cursor == 0, "cancelled batch ran");
+  bCancel = false;
+  Limits.Deadline = chrono::steady_clock::now();
+  Check(Compiled.EvaluateBatch(ppColumns, nRows, &vResult[0], &vErrNo[0], Limits, Cursor) == BATCH_DEADLINE &&
+        Cursor == 0, "batch ran past its deadline");
+
+  // A short deadline each time: resumed until done, with the same results
+  vResult.assign(nRows, -1.0);
+  vErrNo.assign(nRows, ERR_UNKNOWN);
+  Limits.nChunkRows = 1000;
+  do
+  {
+    size_t Before = Cursor;
+
+    Limits.Deadline = chrono::steady_clock::now() + chrono::microseconds(200);
+    Status = Compiled.EvaluateBatch(ppColumns, nRows, &vResult[0], &vErrNo[0], Limits, Cursor);
+    bPartialOK = bPartialOK && (Status == BATCH_COMPLETE ||
+                                (Cursor >= Before && Cursor % 1000 == 0 && vResult[Cursor] == -1.0 &&
+                                 (Cursor == 0 || vResult[Cursor-1] == vExpected[Cursor-1])));
+    nCalls++;
+  } while (Status == BATCH_DEADLINE && nCalls < 100000);
+  Check(bPartialOK, "partial batch wrong");
+  Check(Status == BATCH_COMPLETE && Cursor == nRows && vResult == vExpected && vErrNo == vExpectedErrNo,
+        "resumed batch wrong");
+  Check(nCalls > 1, "deadline never reached");
+
+  // Cancelled part way by another thread, then resumed over a selection
+  vResult.assign(vSelection.size(), -1.0);
+  Limits.Deadline = chrono::steady_clock::time_point::max();
+  Limits.nChunkRows = 100;
+  Cursor = 0;
+  thread Canceller([&]()
+  {
+    this_thread::sleep_for(chrono::microseconds(500));
+    bCancel = true;
+  });
+  Status = Compiled.EvaluateBatch(ppColumns, nRows, &vResult[0], NULL, Limits, Cursor, &vSelection[0], vSelection.size());
+  Canceller.join();
+  bCancel = false;
+  if (Status == BATCH_CANCELLED)
+    Status = Compiled.EvaluateBatch(ppColumns, nRows, &vResult[0], NULL, Limits, Cursor, &vSelection[0], vSelection.size());
+  bool bOK = Status == BATCH_COMPLETE && Cursor == vSelection.size();
+  for (size_t k=0; k<vSelection.size() && bOK; k++)
+    bOK = vExpectedErrNo[vSelection[k]] != ERR_OK || vResult[k] == vExpected[vSelection[k]];
+  Check(bOK, "cancelled selection not resumed correctly");
+}
+
+static bool Near(double lfActual, double lfExpected)
+{
+  return fabs(lfActual - lfExpected) <= 1e-9 * (fabs(lfExpected) + 1.0);
+}
+
+static void TestAggregate(void)
+{
+  const size_t nRows = 100000;
+  CCompiledExpression Compiled;
+  vector<double> vA(nRows);
+  vector<double> vB(nRows);
+  const double *ppColumns[2];
+  vector<double> vValue;
+  tAGGREGATE Result;
+  tAGGREGATE Threaded;
+  double lfMin = HUGE_VAL;
+  double lfMax = -HUGE_VAL;
+  double lfSum = 0.0;
+  double lfM2 = 0.0;
+  unsigned long long nErrors = 0;
+
+  Compiled.Compile("a / (b - 3) + a * 0.5");
+  for (size_t i=0; i<nRows; i++)
+  {
+    vA[i] = (double)i * 0.01 - 300.0;
+    vB[i] = (double)(i % 7);             // b = 3 is a divide by zero
+  }
+  ppColumns[Compiled.GetVariableSlot('a')] = &vA[0];
+  ppColumns[Compiled.GetVariableSlot('b')] = &vB[0];
+
+  // The long way round: store every result, then reduce in two passes
+  for (size_t i=0; i<nRows; i++)
+  {
+    double aRow[2];
+    tERRNO ErrNo;
+
+    aRow[Compiled.GetVariableSlot('a')] = vA[i];
+    aRow[Compiled.GetVariableSlot('b')] = vB[i];
+    double lfValue = Compiled.Evaluate(aRow, &ErrNo);
+    if (ErrNo != ERR_OK)
+    {
+      nErrors++;
+      continue;
+    }
+    vValue.push_back(lfValue);
+    lfSum += lfValue;
+    lfMin = min(lfMin, lfValue);
+    lfMax = max(lfMax, lfValue);
+  }
+  double lfMean = lfSum / vValue.size();
+  for (size_t i=0; i<vValue.size(); i++)
+    lfM2 += (vValue[i] - lfMean) * (vValue[i] - lfMean);
+
+  Compiled.Aggregate(ppColumns, nRows, Result);
+  Check(Result.nRows == vValue.size() && Result.nErrors == nErrors, "row counts wrong");
+  Check(Result.lfMin == lfMin && Result.lfMax == lfMax, "min/max wrong");
+  Check(Near(Result.lfSum, lfSum) && Near(Result.lfMean, lfMean), "sum/mean wrong");
+  Check(Near(Result.lfVariance, lfM2 / vValue.size()), "variance wrong");
+
+  // Bit for bit the same whatever the number of threads
+  bool bSame = true;
+  for (int nThreads=2; nThreads<=8; nThreads+=3)
+  {
+    Compiled.Aggregate(ppColumns, nRows, Threaded, nThreads);
+    bSame = bSame && memcmp(&Threaded, &Result, sizeof(Result)) == 0;
+  }
+  Check(bSame, "threaded result differs");
+
+  Compiled.Aggregate(ppColumns, 0, Result, 4);
+  Check(Result.nRows == 0 && Result.nErrors == 0 && Result.lfMin == HUGE_VAL, "empty batch wrong");
+}
+
+static void TestFilter(void)
+{
+  const unsigned int nRows = 1000;
+  CCompiledExpression Predicate;
+  CCompiledExpression Second;
+  CCompiledExpression Value;
+  vector<double> vA(nRows);
+  vector<double> vB(nRows);
+  const double *ppColumns[2];
+  vector<unsigned int> vSelected;
+  vector<unsigned int> vSelectedTwice;
+  vector<double> vResult;
+  vector<tERRNO> vErrNo;
+  tAGGREGATE Result;
+  bool bOK = true;
+
+  for (unsigned int i=0; i<nRows; i++)
+  {
+    vA[i] = i % 37;
+    vB[i] = i % 11;
+  }
+
+  // Same variable order in each, so the same columns do for all
+  Predicate.Compile("a*2 > b+10");
+  Second.Compile("a/b < 3");
+  Value.Compile("a - b");
+  ppColumns[0] = &vA[0];
+  ppColumns[1] = &vB[0];
+
+  Predicate.Filter(ppColumns, nRows, vSelected);
+  for (unsigned int i=0, k=0; i<nRows; i++)
+  {
+    bool bExpected = vA[i]*2 > vB[i]+10;
+    bool bSelected = k < vSelected.size() && vSelected[k] == i;
+    bOK = bOK && bExpected == bSelected;
+    if (bSelected)
+      k++;
+  }
+  Check(bOK && !vSelected.empty(), "wrong rows selected");
+
+  // Chained: only rows already selected are looked at. Rows with b = 0
+  // (divide by zero) are not selected.
+  Second.Filter(ppColumns, nRows, vSelectedTwice, &vSelected[0], vSelected.size());
+  bOK = true;
+  for (size_t k=0; k<vSelectedTwice.size(); k++)
+  {
+    unsigned int i = vSelectedTwice[k];
+    bOK = bOK && vA[i]*2 > vB[i]+10 && vB[i] != 0.0 && vA[i]/vB[i] < 3;
+  }
+  Check(bOK && vSelectedTwice.size() < vSelected.size() && !vSelectedTwice.empty(), "chained filter wrong");
+
+  // Evaluating only the selected rows
+  vResult.resize(vSelectedTwice.size());
+  vErrNo.resize(vSelectedTwice.size());
+  Value.EvaluateBatch(ppColumns, nRows, &vResult[0], &vErrNo[0], &vSelectedTwice[0], vSelectedTwice.size());
+  bOK = true;
+  double lfSum = 0.0;
+  for (size_t k=0; k<vSelectedTwice.size(); k++)
+  {
+    unsigned int i = vSelectedTwice[k];
+    bOK = bOK && vResult[k] == vA[i] - vB[i] && vErrNo[k] == ERR_OK;
+    lfSum += vA[i] - vB[i];
+  }
+  Check(bOK, "selected rows evaluated wrongly");
+
+  Value.Aggregate(ppColumns, nRows, Result, 1, &vSelectedTwice[0], vSelectedTwice.size());
+  Check(Result.nRows == vSelectedTwice.size() && Result.lfSum == lfSum, "selected rows aggregated wrongly");
+}
+
 void TestEvaluator(CEvaluator *pEvaluator)
 {
   double ActualResult;
   int i = 0;
   int Successes = 0;
+  int CompiledSuccesses = 0;
 
   while (TestData[i].Expression != NULL)
   {
@@ -127,9 +2106,68 @@ void TestEvaluator(CEvaluator *pEvaluator)
       cout << "FAIL" << endl;
       getch();
     }
+
+    // The compiled form must agree, with and without optimisation.
+    if (TestCompiled(pEvaluator, COMPILE_DEFAULT, TestData[i].ExpectedResult) &&
+        TestCompiled(pEvaluator, COMPILE_REASSOCIATE, TestData[i].ExpectedResult) &&
+        TestCompiled(pEvaluator, COMPILE_FUSED_MULTIPLY_ADD, TestData[i].ExpectedResult) &&
+        TestCompiled(pEvaluator, COMPILE_NO_KERNELS, TestData[i].ExpectedResult))
+    {
+      CompiledSuccesses++;
+    }
+    else
+    {
+      cout << "COMPILED FAIL" << endl;
+      getch();
+    }
     cout << endl;
     i++;
   }
 
-  cout << endl << "SCORE = " << Successes << "/" << i << endl << endl;
+  cout << endl << "SCORE = " << Successes << "/" << i << endl;
+  cout << "COMPILED SCORE = " << CompiledSuccesses << "/" << i << endl;
+
+  TestMemo();
+  ShowCheckScore("MEMO");
+  TestSpecialise();
+  ShowCheckScore("SPECIALISE");
+  TestCompileAll();
+  ShowCheckScore("COMPILE ALL");
+  TestAggregate();
+  ShowCheckScore("AGGREGATE");
+  TestFilter();
+  ShowCheckScore("FILTER");
+  TestAllocator();
+  ShowCheckScore("ALLOCATOR");
+  TestHotSwap();
+  ShowCheckScore("HOT SWAP");
+  TestGenerated();
+  ShowCheckScore("GENERATED");
+  TestProfile();
+  ShowCheckScore("PROFILE");
+  TestBatchLimits();
+  ShowCheckScore("BATCH LIMITS");
+  TestKernels();
+  ShowCheckScore("KERNELS");
+  TestGrid();
+  ShowCheckScore("GRID");
+  TestCompactNodes();
+  ShowCheckScore("COMPACT NODES");
+  TestRanges();
+  ShowCheckScore("RANGES");
+  TestAsync();
+  ShowCheckScore("ASYNC");
+  TestPack();
+  ShowCheckScore("PACK");
+  TestTiles();
+  ShowCheckScore("TILES");
+  TestBackgroundCompile();
+  ShowCheckScore("BACKGROUND COMPILE");
+  TestDictionary();
+  ShowCheckScore("DICTIONARY");
+  TestPerfCounters();
+  ShowCheckScore("PERF COUNTERS");
+  TestStream();
+  ShowCheckScore("STREAM");
+  cout << endl;
 }
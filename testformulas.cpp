@@ -0,0 +1,2798 @@
+// testformulas.cpp :
+// Generated by CCodeGenerator (see codegenerator.h) from 93 expressions.
+// Do not edit; regenerate instead.
+// Compile without floating point contraction (/fp:precise, or -ffp-contract=off)
+// for results identical to the interpreter's.
+
+#include <math.h>
+#include "testformulas.h"
+
+////////////////////////////////////////////////////////////////////////////
+// 4*3+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData1Variables[] = "";
+
+double TestData1(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData1Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4*3)+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData2Variables[] = "";
+
+double TestData2(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData2Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*(3+2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData3Variables[] = "";
+
+double TestData3(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 + 2.0;
+  const double t4 = 4.0 * t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData3Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 + 2.0;
+    const double t4 = 4.0 * t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4*3+2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData4Variables[] = "";
+
+double TestData4(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData4Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4)*3+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData5Variables[] = "";
+
+double TestData5(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData5Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*(3)+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData6Variables[] = "";
+
+double TestData6(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData6Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*3+(2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData7Variables[] = "";
+
+double TestData7(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData7Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+3*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData8Variables[] = "";
+
+double TestData8(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 * 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData8Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 * 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4+3)*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData9Variables[] = "";
+
+double TestData9(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 + 3.0;
+  const double t4 = t2 * 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData9Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 + 3.0;
+    const double t4 = t2 * 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+(3*2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData10Variables[] = "";
+
+double TestData10(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 * 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData10Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 * 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4+3*2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData11Variables[] = "";
+
+double TestData11(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 * 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData11Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 * 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4)+3*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData12Variables[] = "";
+
+double TestData12(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 * 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData12Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 * 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+(3)*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData13Variables[] = "";
+
+double TestData13(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 * 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData13Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 * 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+3*(2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData14Variables[] = "";
+
+double TestData14(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 * 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData14Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 * 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4/3+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData15Variables[] = "";
+
+double TestData15(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 / 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData15Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 / 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4/3)+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData16Variables[] = "";
+
+double TestData16(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 / 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData16Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 / 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4/(3+2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData17Variables[] = "";
+
+double TestData17(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 + 2.0;
+  const double t4 = 4.0 / t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData17Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 + 2.0;
+    const double t4 = 4.0 / t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4/3+2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData18Variables[] = "";
+
+double TestData18(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 / 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData18Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 / 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4)/3+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData19Variables[] = "";
+
+double TestData19(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 / 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData19Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 / 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4/(3)+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData20Variables[] = "";
+
+double TestData20(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 / 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData20Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 / 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4/3+(2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData21Variables[] = "";
+
+double TestData21(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 / 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData21Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 / 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+3/2
+////////////////////////////////////////////////////////////////////////////
+const char TestData22Variables[] = "";
+
+double TestData22(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 / 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData22Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 / 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4+3)/2
+////////////////////////////////////////////////////////////////////////////
+const char TestData23Variables[] = "";
+
+double TestData23(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 + 3.0;
+  const double t4 = t2 / 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData23Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 + 3.0;
+    const double t4 = t2 / 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+(3/2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData24Variables[] = "";
+
+double TestData24(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 / 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData24Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 / 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4+3/2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData25Variables[] = "";
+
+double TestData25(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 / 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData25Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 / 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4)+3/2
+////////////////////////////////////////////////////////////////////////////
+const char TestData26Variables[] = "";
+
+double TestData26(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 / 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData26Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 / 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+(3)/2
+////////////////////////////////////////////////////////////////////////////
+const char TestData27Variables[] = "";
+
+double TestData27(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 / 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData27Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 / 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4+3/(2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData28Variables[] = "";
+
+double TestData28(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 / 2.0;
+  const double t4 = 4.0 + t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData28Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 / 2.0;
+    const double t4 = 4.0 + t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*3+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData29Variables[] = "";
+
+double TestData29(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData29Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4*3)+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData30Variables[] = "";
+
+double TestData30(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData30Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*(3+2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData31Variables[] = "";
+
+double TestData31(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 3.0 + 2.0;
+  const double t4 = 4.0 * t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData31Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 3.0 + 2.0;
+    const double t4 = 4.0 * t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4*3+2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData32Variables[] = "";
+
+double TestData32(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData32Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4)*3+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData33Variables[] = "";
+
+double TestData33(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData33Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*(3)+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData34Variables[] = "";
+
+double TestData34(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData34Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*3+(2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData35Variables[] = "";
+
+double TestData35(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 3.0;
+  const double t4 = t2 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData35Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 3.0;
+    const double t4 = t2 + 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+3*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData36Variables[] = "";
+
+double TestData36(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData36Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-(4+3)*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData37Variables[] = "";
+
+double TestData37(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 4.0 + 3.0;
+  const double t5 = t3 * 2.0;
+  const double t6 = 5.0 - t5;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData37Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 4.0 + 3.0;
+    const double t5 = t3 * 2.0;
+    const double t6 = 5.0 - t5;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+(3*2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData38Variables[] = "";
+
+double TestData38(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData38Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-(4+3*2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData39Variables[] = "";
+
+double TestData39(const double *, tERRNO *pErrNo)
+{
+  const double t4 = 3.0 * 2.0;
+  const double t5 = 4.0 + t4;
+  const double t6 = 5.0 - t5;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData39Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t4 = 3.0 * 2.0;
+    const double t5 = 4.0 + t4;
+    const double t6 = 5.0 - t5;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-(4)+3*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData40Variables[] = "";
+
+double TestData40(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData40Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+(3)*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData41Variables[] = "";
+
+double TestData41(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData41Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+3*(2)
+////////////////////////////////////////////////////////////////////////////
+const char TestData42Variables[] = "";
+
+double TestData42(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData42Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+3*2+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData43Variables[] = "";
+
+double TestData43(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData43Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-(4+3)*2+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData44Variables[] = "";
+
+double TestData44(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 4.0 + 3.0;
+  const double t5 = t3 * 2.0;
+  const double t6 = 5.0 - t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData44Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 4.0 + 3.0;
+    const double t5 = t3 * 2.0;
+    const double t6 = 5.0 - t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+(3*2)+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData45Variables[] = "";
+
+double TestData45(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData45Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-(4+3*2)+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData46Variables[] = "";
+
+double TestData46(const double *, tERRNO *pErrNo)
+{
+  const double t4 = 3.0 * 2.0;
+  const double t5 = 4.0 + t4;
+  const double t6 = 5.0 - t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData46Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t4 = 3.0 * 2.0;
+    const double t5 = 4.0 + t4;
+    const double t6 = 5.0 - t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-(4)+3*2+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData47Variables[] = "";
+
+double TestData47(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData47Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+(3)*2+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData48Variables[] = "";
+
+double TestData48(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData48Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-4+3*(2)+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData49Variables[] = "";
+
+double TestData49(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 4.0;
+  const double t5 = 3.0 * 2.0;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData49Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 4.0;
+    const double t5 = 3.0 * 2.0;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- 4.77 + 3.1 * 2.9 +11
+////////////////////////////////////////////////////////////////////////////
+const char TestData50Variables[] = "";
+
+double TestData50(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - 4.7699999999999996;
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData50Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - 4.7699999999999996;
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123-(4.77 + 3.1)* 2.9 +11
+////////////////////////////////////////////////////////////////////////////
+const char TestData51Variables[] = "";
+
+double TestData51(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 4.7699999999999996 + 3.1000000000000001;
+  const double t5 = t3 * 2.8999999999999999;
+  const double t6 = 5.1230000000000002 - t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData51Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 4.7699999999999996 + 3.1000000000000001;
+    const double t5 = t3 * 2.8999999999999999;
+    const double t6 = 5.1230000000000002 - t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- 4.77 +(3.1 * 2.9)+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData52Variables[] = "";
+
+double TestData52(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - 4.7699999999999996;
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData52Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - 4.7699999999999996;
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123-(4.77 + 3.1 * 2.9)+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData53Variables[] = "";
+
+double TestData53(const double *, tERRNO *pErrNo)
+{
+  const double t4 = 3.1000000000000001 * 2.8999999999999999;
+  const double t5 = 4.7699999999999996 + t4;
+  const double t6 = 5.1230000000000002 - t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData53Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t4 = 3.1000000000000001 * 2.8999999999999999;
+    const double t5 = 4.7699999999999996 + t4;
+    const double t6 = 5.1230000000000002 - t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123-(4.77)+ 3.1 * 2.9 +11
+////////////////////////////////////////////////////////////////////////////
+const char TestData54Variables[] = "";
+
+double TestData54(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - 4.7699999999999996;
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData54Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - 4.7699999999999996;
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- 4.77 +(3.1)* 2.9 +11
+////////////////////////////////////////////////////////////////////////////
+const char TestData55Variables[] = "";
+
+double TestData55(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - 4.7699999999999996;
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData55Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - 4.7699999999999996;
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- 4.77 + 3.1 *(2.9)+11
+////////////////////////////////////////////////////////////////////////////
+const char TestData56Variables[] = "";
+
+double TestData56(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - 4.7699999999999996;
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + 11.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData56Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - 4.7699999999999996;
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + 11.0;
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- -4.77 + 3.1 * 2.9 +-11
+////////////////////////////////////////////////////////////////////////////
+const char TestData57Variables[] = "";
+
+double TestData57(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + (-11.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData57Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + (-11.0);
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123-(-4.77 + 3.1)* 2.9 +-11
+////////////////////////////////////////////////////////////////////////////
+const char TestData58Variables[] = "";
+
+double TestData58(const double *, tERRNO *pErrNo)
+{
+  const double t3 = (-4.7699999999999996) + 3.1000000000000001;
+  const double t5 = t3 * 2.8999999999999999;
+  const double t6 = 5.1230000000000002 - t5;
+  const double t8 = t6 + (-11.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData58Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = (-4.7699999999999996) + 3.1000000000000001;
+    const double t5 = t3 * 2.8999999999999999;
+    const double t6 = 5.1230000000000002 - t5;
+    const double t8 = t6 + (-11.0);
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- -4.77 +(3.1 * 2.9)+-11
+////////////////////////////////////////////////////////////////////////////
+const char TestData59Variables[] = "";
+
+double TestData59(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + (-11.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData59Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + (-11.0);
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123-(-4.77 + 3.1 * 2.9)+-11
+////////////////////////////////////////////////////////////////////////////
+const char TestData60Variables[] = "";
+
+double TestData60(const double *, tERRNO *pErrNo)
+{
+  const double t4 = 3.1000000000000001 * 2.8999999999999999;
+  const double t5 = (-4.7699999999999996) + t4;
+  const double t6 = 5.1230000000000002 - t5;
+  const double t8 = t6 + (-11.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData60Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t4 = 3.1000000000000001 * 2.8999999999999999;
+    const double t5 = (-4.7699999999999996) + t4;
+    const double t6 = 5.1230000000000002 - t5;
+    const double t8 = t6 + (-11.0);
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123-(-4.77)+ 3.1 * 2.9 +-11
+////////////////////////////////////////////////////////////////////////////
+const char TestData61Variables[] = "";
+
+double TestData61(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + (-11.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData61Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + (-11.0);
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- -4.77 +(3.1)* 2.9 +-11
+////////////////////////////////////////////////////////////////////////////
+const char TestData62Variables[] = "";
+
+double TestData62(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + (-11.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData62Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + (-11.0);
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5.123- -4.77 + 3.1 *(2.9)+-11
+////////////////////////////////////////////////////////////////////////////
+const char TestData63Variables[] = "";
+
+double TestData63(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+  const double t5 = 3.1000000000000001 * 2.8999999999999999;
+  const double t6 = t2 + t5;
+  const double t8 = t6 + (-11.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t8;
+}
+
+void TestData63Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.1230000000000002 - (-4.7699999999999996);
+    const double t5 = 3.1000000000000001 * 2.8999999999999999;
+    const double t6 = t2 + t5;
+    const double t8 = t6 + (-11.0);
+    pResults[Row] = t8;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (3 + 10) * 50 / ((7 - 6) * 9)
+////////////////////////////////////////////////////////////////////////////
+const char TestData64Variables[] = "";
+
+double TestData64(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 3.0 + 10.0;
+  const double t6 = 7.0 - 6.0;
+  const double t8 = t6 * 9.0;
+  const double t9 = 50.0 / t8;
+  const double t10 = t2 * t9;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t10;
+}
+
+void TestData64Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 3.0 + 10.0;
+    const double t6 = 7.0 - 6.0;
+    const double t8 = t6 * 9.0;
+    const double t9 = 50.0 / t8;
+    const double t10 = t2 * t9;
+    pResults[Row] = t10;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (1 + 10) * 50 / ((2 - 6) * 9)
+////////////////////////////////////////////////////////////////////////////
+const char TestData65Variables[] = "";
+
+double TestData65(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 1.0 + 10.0;
+  const double t6 = 2.0 - 6.0;
+  const double t8 = t6 * 9.0;
+  const double t9 = 50.0 / t8;
+  const double t10 = t2 * t9;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t10;
+}
+
+void TestData65Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 1.0 + 10.0;
+    const double t6 = 2.0 - 6.0;
+    const double t8 = t6 * 9.0;
+    const double t9 = 50.0 / t8;
+    const double t10 = t2 * t9;
+    pResults[Row] = t10;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (0 + 10) * 50 / ((0 - 6) * 9)
+////////////////////////////////////////////////////////////////////////////
+const char TestData66Variables[] = "";
+
+double TestData66(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 0.0 + 10.0;
+  const double t6 = 0.0 - 6.0;
+  const double t8 = t6 * 9.0;
+  const double t9 = 50.0 / t8;
+  const double t10 = t2 * t9;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t10;
+}
+
+void TestData66Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 0.0 + 10.0;
+    const double t6 = 0.0 - 6.0;
+    const double t8 = t6 * 9.0;
+    const double t9 = 50.0 / t8;
+    const double t10 = t2 * t9;
+    pResults[Row] = t10;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// -(4+3)*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData67Variables[] = "";
+
+double TestData67(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 + 3.0;
+  const double t3 = -t2;
+  const double t5 = t3 * 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t5;
+}
+
+void TestData67Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 + 3.0;
+    const double t3 = -t2;
+    const double t5 = t3 * 2.0;
+    pResults[Row] = t5;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5-(4 )*2
+////////////////////////////////////////////////////////////////////////////
+const char TestData68Variables[] = "";
+
+double TestData68(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 4.0 * 2.0;
+  const double t4 = 5.0 - t3;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData68Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 4.0 * 2.0;
+    const double t4 = 5.0 - t3;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 1+2+3+4+5+6+7+8
+////////////////////////////////////////////////////////////////////////////
+const char TestData69Variables[] = "";
+
+double TestData69(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 1.0 + 2.0;
+  const double t4 = t2 + 3.0;
+  const double t6 = t4 + 4.0;
+  const double t8 = t6 + 5.0;
+  const double t10 = t8 + 6.0;
+  const double t12 = t10 + 7.0;
+  const double t14 = t12 + 8.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t14;
+}
+
+void TestData69Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 1.0 + 2.0;
+    const double t4 = t2 + 3.0;
+    const double t6 = t4 + 4.0;
+    const double t8 = t6 + 5.0;
+    const double t10 = t8 + 6.0;
+    const double t12 = t10 + 7.0;
+    const double t14 = t12 + 8.0;
+    pResults[Row] = t14;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 1-2+3-4+5-6+7-8
+////////////////////////////////////////////////////////////////////////////
+const char TestData70Variables[] = "";
+
+double TestData70(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 1.0 - 2.0;
+  const double t4 = t2 + 3.0;
+  const double t6 = t4 - 4.0;
+  const double t8 = t6 + 5.0;
+  const double t10 = t8 - 6.0;
+  const double t12 = t10 + 7.0;
+  const double t14 = t12 - 8.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t14;
+}
+
+void TestData70Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 1.0 - 2.0;
+    const double t4 = t2 + 3.0;
+    const double t6 = t4 - 4.0;
+    const double t8 = t6 + 5.0;
+    const double t10 = t8 - 6.0;
+    const double t12 = t10 + 7.0;
+    const double t14 = t12 - 8.0;
+    pResults[Row] = t14;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 1*2*3*4*5*6*7*8+1
+////////////////////////////////////////////////////////////////////////////
+const char TestData71Variables[] = "";
+
+double TestData71(const double *, tERRNO *pErrNo)
+{
+  const double t8 = 7.0 * 8.0;
+  const double t9 = 6.0 * t8;
+  const double t10 = 5.0 * t9;
+  const double t11 = 4.0 * t10;
+  const double t12 = 3.0 * t11;
+  const double t13 = 2.0 * t12;
+  const double t14 = 1.0 * t13;
+  const double t16 = t14 + 1.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t16;
+}
+
+void TestData71Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t8 = 7.0 * 8.0;
+    const double t9 = 6.0 * t8;
+    const double t10 = 5.0 * t9;
+    const double t11 = 4.0 * t10;
+    const double t12 = 3.0 * t11;
+    const double t13 = 2.0 * t12;
+    const double t14 = 1.0 * t13;
+    const double t16 = t14 + 1.0;
+    pResults[Row] = t16;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*2 > 3+1
+////////////////////////////////////////////////////////////////////////////
+const char TestData72Variables[] = "";
+
+double TestData72(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 2.0;
+  const double t5 = 3.0 + 1.0;
+  const double t6 = (t2 > t5) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData72Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 2.0;
+    const double t5 = 3.0 + 1.0;
+    const double t6 = (t2 > t5) ? 1.0 : 0.0;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 4*2 < 3+1
+////////////////////////////////////////////////////////////////////////////
+const char TestData73Variables[] = "";
+
+double TestData73(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 * 2.0;
+  const double t5 = 3.0 + 1.0;
+  const double t6 = (t2 < t5) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData73Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 * 2.0;
+    const double t5 = 3.0 + 1.0;
+    const double t6 = (t2 < t5) ? 1.0 : 0.0;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 1+1 == 2
+////////////////////////////////////////////////////////////////////////////
+const char TestData74Variables[] = "";
+
+double TestData74(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 1.0 + 1.0;
+  const double t4 = (t2 == 2.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData74Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 1.0 + 1.0;
+    const double t4 = (t2 == 2.0) ? 1.0 : 0.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 3 <= 2
+////////////////////////////////////////////////////////////////////////////
+const char TestData75Variables[] = "";
+
+double TestData75(const double *, tERRNO *pErrNo)
+{
+  const double t2 = (3.0 <= 2.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t2;
+}
+
+void TestData75Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = (3.0 <= 2.0) ? 1.0 : 0.0;
+    pResults[Row] = t2;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 3 >= 3
+////////////////////////////////////////////////////////////////////////////
+const char TestData76Variables[] = "";
+
+double TestData76(const double *, tERRNO *pErrNo)
+{
+  const double t2 = (3.0 >= 3.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t2;
+}
+
+void TestData76Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = (3.0 >= 3.0) ? 1.0 : 0.0;
+    pResults[Row] = t2;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 2 != 2*1
+////////////////////////////////////////////////////////////////////////////
+const char TestData77Variables[] = "";
+
+double TestData77(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 2.0 * 1.0;
+  const double t4 = (2.0 != t3) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData77Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 2.0 * 1.0;
+    const double t4 = (2.0 != t3) ? 1.0 : 0.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 1 < 2 && 3 > 4
+////////////////////////////////////////////////////////////////////////////
+const char TestData78Variables[] = "";
+
+double TestData78(const double *, tERRNO *pErrNo)
+{
+  const double t2 = (1.0 < 2.0) ? 1.0 : 0.0;
+  const double t5 = (3.0 > 4.0) ? 1.0 : 0.0;
+  const double t6 = (t2 != 0.0 && t5 != 0.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData78Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = (1.0 < 2.0) ? 1.0 : 0.0;
+    const double t5 = (3.0 > 4.0) ? 1.0 : 0.0;
+    const double t6 = (t2 != 0.0 && t5 != 0.0) ? 1.0 : 0.0;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 1 < 2 || 3 > 4
+////////////////////////////////////////////////////////////////////////////
+const char TestData79Variables[] = "";
+
+double TestData79(const double *, tERRNO *pErrNo)
+{
+  const double t2 = (1.0 < 2.0) ? 1.0 : 0.0;
+  const double t5 = (3.0 > 4.0) ? 1.0 : 0.0;
+  const double t6 = (t2 != 0.0 || t5 != 0.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData79Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = (1.0 < 2.0) ? 1.0 : 0.0;
+    const double t5 = (3.0 > 4.0) ? 1.0 : 0.0;
+    const double t6 = (t2 != 0.0 || t5 != 0.0) ? 1.0 : 0.0;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 1 || 0 && 0
+////////////////////////////////////////////////////////////////////////////
+const char TestData80Variables[] = "";
+
+double TestData80(const double *, tERRNO *pErrNo)
+{
+  const double t3 = (0.0 != 0.0 && 0.0 != 0.0) ? 1.0 : 0.0;
+  const double t4 = (1.0 != 0.0 || t3 != 0.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData80Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = (0.0 != 0.0 && 0.0 != 0.0) ? 1.0 : 0.0;
+    const double t4 = (1.0 != 0.0 || t3 != 0.0) ? 1.0 : 0.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (4 > 3) * 5 - 1
+////////////////////////////////////////////////////////////////////////////
+const char TestData81Variables[] = "";
+
+double TestData81(const double *, tERRNO *pErrNo)
+{
+  const double t2 = (4.0 > 3.0) ? 1.0 : 0.0;
+  const double t4 = t2 * 5.0;
+  const double t6 = t4 - 1.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData81Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = (4.0 > 3.0) ? 1.0 : 0.0;
+    const double t4 = t2 * 5.0;
+    const double t6 = t4 - 1.0;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 5 - 1 > 2 - -2
+////////////////////////////////////////////////////////////////////////////
+const char TestData82Variables[] = "";
+
+double TestData82(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 5.0 - 1.0;
+  const double t5 = 2.0 - (-2.0);
+  const double t6 = (t2 > t5) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData82Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 5.0 - 1.0;
+    const double t5 = 2.0 - (-2.0);
+    const double t6 = (t2 > t5) ? 1.0 : 0.0;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 8/4/2 == 4
+////////////////////////////////////////////////////////////////////////////
+const char TestData83Variables[] = "";
+
+double TestData83(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 4.0 / 2.0;
+  const double t4 = 8.0 / t3;
+  const double t6 = (t4 == 4.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t6;
+}
+
+void TestData83Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 4.0 / 2.0;
+    const double t4 = 8.0 / t3;
+    const double t6 = (t4 == 4.0) ? 1.0 : 0.0;
+    pResults[Row] = t6;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// -(4+3)+2
+////////////////////////////////////////////////////////////////////////////
+const char TestData84Variables[] = "";
+
+double TestData84(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 4.0 + 3.0;
+  const double t3 = -t2;
+  const double t5 = t3 + 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t5;
+}
+
+void TestData84Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 4.0 + 3.0;
+    const double t3 = -t2;
+    const double t5 = t3 + 2.0;
+    pResults[Row] = t5;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 2*-(1+1)+1
+////////////////////////////////////////////////////////////////////////////
+const char TestData85Variables[] = "";
+
+double TestData85(const double *, tERRNO *pErrNo)
+{
+  const double t3 = 1.0 + 1.0;
+  const double t4 = -t3;
+  const double t5 = 2.0 * t4;
+  const double t7 = t5 + 1.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t7;
+}
+
+void TestData85Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t3 = 1.0 + 1.0;
+    const double t4 = -t3;
+    const double t5 = 2.0 * t4;
+    const double t7 = t5 + 1.0;
+    pResults[Row] = t7;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// -(-(2))
+////////////////////////////////////////////////////////////////////////////
+const char TestData86Variables[] = "";
+
+double TestData86(const double *, tERRNO *pErrNo)
+{
+  const double t1 = -2.0;
+  const double t2 = -t1;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t2;
+}
+
+void TestData86Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t1 = -2.0;
+    const double t2 = -t1;
+    pResults[Row] = t2;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// 10-(1 )-(2 )
+////////////////////////////////////////////////////////////////////////////
+const char TestData87Variables[] = "";
+
+double TestData87(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 10.0 - 1.0;
+  const double t4 = t2 - 2.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData87Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 10.0 - 1.0;
+    const double t4 = t2 - 2.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// ((1+2 ) )*3
+////////////////////////////////////////////////////////////////////////////
+const char TestData88Variables[] = "";
+
+double TestData88(const double *, tERRNO *pErrNo)
+{
+  const double t2 = 1.0 + 2.0;
+  const double t4 = t2 * 3.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t4;
+}
+
+void TestData88Batch(const double *const *, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = 1.0 + 2.0;
+    const double t4 = t2 * 3.0;
+    pResults[Row] = t4;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (a + 10) * 50 / ((b - 6) * 9)
+////////////////////////////////////////////////////////////////////////////
+const char MandateVariables[] = "ab";
+
+double Mandate(const double *pValues, tERRNO *pErrNo)
+{
+  const double t2 = pValues[0] + 10.0;
+  const double t6 = pValues[1] - 6.0;
+  const double t8 = t6 * 9.0;
+  if (t8 == 0.0)
+  {
+    if (pErrNo)
+      *pErrNo = ERR_DIVIDE_BY_ZERO;
+    return 0.0;
+  }
+  const double t9 = 50.0 / t8;
+  const double t10 = t2 * t9;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t10;
+}
+
+void MandateBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = ppColumns[0][Row] + 10.0;
+    const double t6 = ppColumns[1][Row] - 6.0;
+    const double t8 = t6 * 9.0;
+    if (t8 == 0.0)
+    {
+      pResults[Row] = 0.0;
+      if (pErrNo)
+        pErrNo[Row] = ERR_DIVIDE_BY_ZERO;
+      continue;
+    }
+    const double t9 = 50.0 / t8;
+    const double t10 = t2 * t9;
+    pResults[Row] = t10;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// x/y - y/x + -x/(y*y)
+////////////////////////////////////////////////////////////////////////////
+const char RatiosVariables[] = "xy";
+
+double Ratios(const double *pValues, tERRNO *pErrNo)
+{
+  if (pValues[1] == 0.0)
+  {
+    if (pErrNo)
+      *pErrNo = ERR_DIVIDE_BY_ZERO;
+    return 0.0;
+  }
+  const double t2 = pValues[0] / pValues[1];
+  if (pValues[0] == 0.0)
+  {
+    if (pErrNo)
+      *pErrNo = ERR_DIVIDE_BY_ZERO;
+    return 0.0;
+  }
+  const double t5 = pValues[1] / pValues[0];
+  const double t6 = t2 - t5;
+  const double t8 = -pValues[0];
+  const double t11 = pValues[1] * pValues[1];
+  if (t11 == 0.0)
+  {
+    if (pErrNo)
+      *pErrNo = ERR_DIVIDE_BY_ZERO;
+    return 0.0;
+  }
+  const double t12 = t8 / t11;
+  const double t13 = t6 + t12;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t13;
+}
+
+void RatiosBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    if (ppColumns[1][Row] == 0.0)
+    {
+      pResults[Row] = 0.0;
+      if (pErrNo)
+        pErrNo[Row] = ERR_DIVIDE_BY_ZERO;
+      continue;
+    }
+    const double t2 = ppColumns[0][Row] / ppColumns[1][Row];
+    if (ppColumns[0][Row] == 0.0)
+    {
+      pResults[Row] = 0.0;
+      if (pErrNo)
+        pErrNo[Row] = ERR_DIVIDE_BY_ZERO;
+      continue;
+    }
+    const double t5 = ppColumns[1][Row] / ppColumns[0][Row];
+    const double t6 = t2 - t5;
+    const double t8 = -ppColumns[0][Row];
+    const double t11 = ppColumns[1][Row] * ppColumns[1][Row];
+    if (t11 == 0.0)
+    {
+      pResults[Row] = 0.0;
+      if (pErrNo)
+        pErrNo[Row] = ERR_DIVIDE_BY_ZERO;
+      continue;
+    }
+    const double t12 = t8 / t11;
+    const double t13 = t6 + t12;
+    pResults[Row] = t13;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (p > 10) * p * 2 + (p <= 10) * -p / 4 - -0
+////////////////////////////////////////////////////////////////////////////
+const char BandedVariables[] = "p";
+
+double Banded(const double *pValues, tERRNO *pErrNo)
+{
+  const double t2 = (pValues[0] > 10.0) ? 1.0 : 0.0;
+  const double t5 = pValues[0] * 2.0;
+  const double t6 = t2 * t5;
+  const double t9 = (pValues[0] <= 10.0) ? 1.0 : 0.0;
+  const double t11 = -pValues[0];
+  const double t13 = t11 / 4.0;
+  const double t14 = t9 * t13;
+  const double t15 = t6 + t14;
+  const double t17 = t15 - (-0.0);
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t17;
+}
+
+void BandedBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = (ppColumns[0][Row] > 10.0) ? 1.0 : 0.0;
+    const double t5 = ppColumns[0][Row] * 2.0;
+    const double t6 = t2 * t5;
+    const double t9 = (ppColumns[0][Row] <= 10.0) ? 1.0 : 0.0;
+    const double t11 = -ppColumns[0][Row];
+    const double t13 = t11 / 4.0;
+    const double t14 = t9 * t13;
+    const double t15 = t6 + t14;
+    const double t17 = t15 - (-0.0);
+    pResults[Row] = t17;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// (a < b && b < c) || a == c / 2
+////////////////////////////////////////////////////////////////////////////
+const char LogicVariables[] = "abc";
+
+double Logic(const double *pValues, tERRNO *pErrNo)
+{
+  const double t2 = (pValues[0] < pValues[1]) ? 1.0 : 0.0;
+  const double t5 = (pValues[1] < pValues[2]) ? 1.0 : 0.0;
+  const double t6 = (t2 != 0.0 && t5 != 0.0) ? 1.0 : 0.0;
+  const double t10 = pValues[2] / 2.0;
+  const double t11 = (pValues[0] == t10) ? 1.0 : 0.0;
+  const double t12 = (t6 != 0.0 || t11 != 0.0) ? 1.0 : 0.0;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t12;
+}
+
+void LogicBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = (ppColumns[0][Row] < ppColumns[1][Row]) ? 1.0 : 0.0;
+    const double t5 = (ppColumns[1][Row] < ppColumns[2][Row]) ? 1.0 : 0.0;
+    const double t6 = (t2 != 0.0 && t5 != 0.0) ? 1.0 : 0.0;
+    const double t10 = ppColumns[2][Row] / 2.0;
+    const double t11 = (ppColumns[0][Row] == t10) ? 1.0 : 0.0;
+    const double t12 = (t6 != 0.0 || t11 != 0.0) ? 1.0 : 0.0;
+    pResults[Row] = t12;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// a+b+c+d+e+f+g+h - a*b*c*d
+////////////////////////////////////////////////////////////////////////////
+const char ChainVariables[] = "abcdefgh";
+
+double Chain(const double *pValues, tERRNO *pErrNo)
+{
+  const double t2 = pValues[0] + pValues[1];
+  const double t4 = t2 + pValues[2];
+  const double t6 = t4 + pValues[3];
+  const double t8 = t6 + pValues[4];
+  const double t10 = t8 + pValues[5];
+  const double t12 = t10 + pValues[6];
+  const double t14 = t12 + pValues[7];
+  const double t19 = pValues[2] * pValues[3];
+  const double t20 = pValues[1] * t19;
+  const double t21 = pValues[0] * t20;
+  const double t22 = t14 - t21;
+  if (pErrNo)
+    *pErrNo = ERR_OK;
+  return t22;
+}
+
+void ChainBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo)
+{
+  for (size_t Row=0; Row<nRows; Row++)
+  {
+    const double t2 = ppColumns[0][Row] + ppColumns[1][Row];
+    const double t4 = t2 + ppColumns[2][Row];
+    const double t6 = t4 + ppColumns[3][Row];
+    const double t8 = t6 + ppColumns[4][Row];
+    const double t10 = t8 + ppColumns[5][Row];
+    const double t12 = t10 + ppColumns[6][Row];
+    const double t14 = t12 + ppColumns[7][Row];
+    const double t19 = ppColumns[2][Row] * ppColumns[3][Row];
+    const double t20 = ppColumns[1][Row] * t19;
+    const double t21 = ppColumns[0][Row] * t20;
+    const double t22 = t14 - t21;
+    pResults[Row] = t22;
+    if (pErrNo)
+      pErrNo[Row] = ERR_OK;
+  }
+}
+
+const tGENERATEDFUNCTION testformulasFunctions[] =
+{
+  { "TestData1", "4*3+2", TestData1Variables, TestData1, TestData1Batch },
+  { "TestData2", "(4*3)+2", TestData2Variables, TestData2, TestData2Batch },
+  { "TestData3", "4*(3+2)", TestData3Variables, TestData3, TestData3Batch },
+  { "TestData4", "(4*3+2)", TestData4Variables, TestData4, TestData4Batch },
+  { "TestData5", "(4)*3+2", TestData5Variables, TestData5, TestData5Batch },
+  { "TestData6", "4*(3)+2", TestData6Variables, TestData6, TestData6Batch },
+  { "TestData7", "4*3+(2)", TestData7Variables, TestData7, TestData7Batch },
+  { "TestData8", "4+3*2", TestData8Variables, TestData8, TestData8Batch },
+  { "TestData9", "(4+3)*2", TestData9Variables, TestData9, TestData9Batch },
+  { "TestData10", "4+(3*2)", TestData10Variables, TestData10, TestData10Batch },
+  { "TestData11", "(4+3*2)", TestData11Variables, TestData11, TestData11Batch },
+  { "TestData12", "(4)+3*2", TestData12Variables, TestData12, TestData12Batch },
+  { "TestData13", "4+(3)*2", TestData13Variables, TestData13, TestData13Batch },
+  { "TestData14", "4+3*(2)", TestData14Variables, TestData14, TestData14Batch },
+  { "TestData15", "4/3+2", TestData15Variables, TestData15, TestData15Batch },
+  { "TestData16", "(4/3)+2", TestData16Variables, TestData16, TestData16Batch },
+  { "TestData17", "4/(3+2)", TestData17Variables, TestData17, TestData17Batch },
+  { "TestData18", "(4/3+2)", TestData18Variables, TestData18, TestData18Batch },
+  { "TestData19", "(4)/3+2", TestData19Variables, TestData19, TestData19Batch },
+  { "TestData20", "4/(3)+2", TestData20Variables, TestData20, TestData20Batch },
+  { "TestData21", "4/3+(2)", TestData21Variables, TestData21, TestData21Batch },
+  { "TestData22", "4+3/2", TestData22Variables, TestData22, TestData22Batch },
+  { "TestData23", "(4+3)/2", TestData23Variables, TestData23, TestData23Batch },
+  { "TestData24", "4+(3/2)", TestData24Variables, TestData24, TestData24Batch },
+  { "TestData25", "(4+3/2)", TestData25Variables, TestData25, TestData25Batch },
+  { "TestData26", "(4)+3/2", TestData26Variables, TestData26, TestData26Batch },
+  { "TestData27", "4+(3)/2", TestData27Variables, TestData27, TestData27Batch },
+  { "TestData28", "4+3/(2)", TestData28Variables, TestData28, TestData28Batch },
+  { "TestData29", "4*3+2", TestData29Variables, TestData29, TestData29Batch },
+  { "TestData30", "(4*3)+2", TestData30Variables, TestData30, TestData30Batch },
+  { "TestData31", "4*(3+2)", TestData31Variables, TestData31, TestData31Batch },
+  { "TestData32", "(4*3+2)", TestData32Variables, TestData32, TestData32Batch },
+  { "TestData33", "(4)*3+2", TestData33Variables, TestData33, TestData33Batch },
+  { "TestData34", "4*(3)+2", TestData34Variables, TestData34, TestData34Batch },
+  { "TestData35", "4*3+(2)", TestData35Variables, TestData35, TestData35Batch },
+  { "TestData36", "5-4+3*2", TestData36Variables, TestData36, TestData36Batch },
+  { "TestData37", "5-(4+3)*2", TestData37Variables, TestData37, TestData37Batch },
+  { "TestData38", "5-4+(3*2)", TestData38Variables, TestData38, TestData38Batch },
+  { "TestData39", "5-(4+3*2)", TestData39Variables, TestData39, TestData39Batch },
+  { "TestData40", "5-(4)+3*2", TestData40Variables, TestData40, TestData40Batch },
+  { "TestData41", "5-4+(3)*2", TestData41Variables, TestData41, TestData41Batch },
+  { "TestData42", "5-4+3*(2)", TestData42Variables, TestData42, TestData42Batch },
+  { "TestData43", "5-4+3*2+11", TestData43Variables, TestData43, TestData43Batch },
+  { "TestData44", "5-(4+3)*2+11", TestData44Variables, TestData44, TestData44Batch },
+  { "TestData45", "5-4+(3*2)+11", TestData45Variables, TestData45, TestData45Batch },
+  { "TestData46", "5-(4+3*2)+11", TestData46Variables, TestData46, TestData46Batch },
+  { "TestData47", "5-(4)+3*2+11", TestData47Variables, TestData47, TestData47Batch },
+  { "TestData48", "5-4+(3)*2+11", TestData48Variables, TestData48, TestData48Batch },
+  { "TestData49", "5-4+3*(2)+11", TestData49Variables, TestData49, TestData49Batch },
+  { "TestData50", "5.123- 4.77 + 3.1 * 2.9 +11", TestData50Variables, TestData50, TestData50Batch },
+  { "TestData51", "5.123-(4.77 + 3.1)* 2.9 +11", TestData51Variables, TestData51, TestData51Batch },
+  { "TestData52", "5.123- 4.77 +(3.1 * 2.9)+11", TestData52Variables, TestData52, TestData52Batch },
+  { "TestData53", "5.123-(4.77 + 3.1 * 2.9)+11", TestData53Variables, TestData53, TestData53Batch },
+  { "TestData54", "5.123-(4.77)+ 3.1 * 2.9 +11", TestData54Variables, TestData54, TestData54Batch },
+  { "TestData55", "5.123- 4.77 +(3.1)* 2.9 +11", TestData55Variables, TestData55, TestData55Batch },
+  { "TestData56", "5.123- 4.77 + 3.1 *(2.9)+11", TestData56Variables, TestData56, TestData56Batch },
+  { "TestData57", "5.123- -4.77 + 3.1 * 2.9 +-11", TestData57Variables, TestData57, TestData57Batch },
+  { "TestData58", "5.123-(-4.77 + 3.1)* 2.9 +-11", TestData58Variables, TestData58, TestData58Batch },
+  { "TestData59", "5.123- -4.77 +(3.1 * 2.9)+-11", TestData59Variables, TestData59, TestData59Batch },
+  { "TestData60", "5.123-(-4.77 + 3.1 * 2.9)+-11", TestData60Variables, TestData60, TestData60Batch },
+  { "TestData61", "5.123-(-4.77)+ 3.1 * 2.9 +-11", TestData61Variables, TestData61, TestData61Batch },
+  { "TestData62", "5.123- -4.77 +(3.1)* 2.9 +-11", TestData62Variables, TestData62, TestData62Batch },
+  { "TestData63", "5.123- -4.77 + 3.1 *(2.9)+-11", TestData63Variables, TestData63, TestData63Batch },
+  { "TestData64", "(3 + 10) * 50 / ((7 - 6) * 9)", TestData64Variables, TestData64, TestData64Batch },
+  { "TestData65", "(1 + 10) * 50 / ((2 - 6) * 9)", TestData65Variables, TestData65, TestData65Batch },
+  { "TestData66", "(0 + 10) * 50 / ((0 - 6) * 9)", TestData66Variables, TestData66, TestData66Batch },
+  { "TestData67", "-(4+3)*2", TestData67Variables, TestData67, TestData67Batch },
+  { "TestData68", "5-(4 )*2", TestData68Variables, TestData68, TestData68Batch },
+  { "TestData69", "1+2+3+4+5+6+7+8", TestData69Variables, TestData69, TestData69Batch },
+  { "TestData70", "1-2+3-4+5-6+7-8", TestData70Variables, TestData70, TestData70Batch },
+  { "TestData71", "1*2*3*4*5*6*7*8+1", TestData71Variables, TestData71, TestData71Batch },
+  { "TestData72", "4*2 > 3+1", TestData72Variables, TestData72, TestData72Batch },
+  { "TestData73", "4*2 < 3+1", TestData73Variables, TestData73, TestData73Batch },
+  { "TestData74", "1+1 == 2", TestData74Variables, TestData74, TestData74Batch },
+  { "TestData75", "3 <= 2", TestData75Variables, TestData75, TestData75Batch },
+  { "TestData76", "3 >= 3", TestData76Variables, TestData76, TestData76Batch },
+  { "TestData77", "2 != 2*1", TestData77Variables, TestData77, TestData77Batch },
+  { "TestData78", "1 < 2 && 3 > 4", TestData78Variables, TestData78, TestData78Batch },
+  { "TestData79", "1 < 2 || 3 > 4", TestData79Variables, TestData79, TestData79Batch },
+  { "TestData80", "1 || 0 && 0", TestData80Variables, TestData80, TestData80Batch },
+  { "TestData81", "(4 > 3) * 5 - 1", TestData81Variables, TestData81, TestData81Batch },
+  { "TestData82", "5 - 1 > 2 - -2", TestData82Variables, TestData82, TestData82Batch },
+  { "TestData83", "8/4/2 == 4", TestData83Variables, TestData83, TestData83Batch },
+  { "TestData84", "-(4+3)+2", TestData84Variables, TestData84, TestData84Batch },
+  { "TestData85", "2*-(1+1)+1", TestData85Variables, TestData85, TestData85Batch },
+  { "TestData86", "-(-(2))", TestData86Variables, TestData86, TestData86Batch },
+  { "TestData87", "10-(1 )-(2 )", TestData87Variables, TestData87, TestData87Batch },
+  { "TestData88", "((1+2 ) )*3", TestData88Variables, TestData88, TestData88Batch },
+  { "Mandate", "(a + 10) * 50 / ((b - 6) * 9)", MandateVariables, Mandate, MandateBatch },
+  { "Ratios", "x/y - y/x + -x/(y*y)", RatiosVariables, Ratios, RatiosBatch },
+  { "Banded", "(p > 10) * p * 2 + (p <= 10) * -p / 4 - -0", BandedVariables, Banded, BandedBatch },
+  { "Logic", "(a < b && b < c) || a == c / 2", LogicVariables, Logic, LogicBatch },
+  { "Chain", "a+b+c+d+e+f+g+h - a*b*c*d", ChainVariables, Chain, ChainBatch },
+  { NULL, NULL, NULL, NULL, NULL }
+};
@@ -0,0 +1,498 @@
+// testformulas.h :
+// Generated by CCodeGenerator (see codegenerator.h) from 93 expressions.
+// Do not edit; regenerate instead.
+
+#if !defined(TESTFORMULAS_H_INCLUDED_)
+#define TESTFORMULAS_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <stddef.h>
+#include "evaluator.h"
+
+#if !defined(GENERATEDFUNCTION_DEFINED_)
+#define GENERATEDFUNCTION_DEFINED_
+typedef double (*tGENERATEDSCALAR)(const double *pValues, tERRNO *pErrNo);
+typedef void (*tGENERATEDBATCH)(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo);
+
+typedef struct tagGENERATEDFUNCTION
+{
+  const char *szName;
+  const char *szExpression;
+  const char *szVariables;   // Variable names, by slot
+  tGENERATEDSCALAR pScalar;
+  tGENERATEDBATCH pBatch;
+} tGENERATEDFUNCTION;
+#endif // !defined(GENERATEDFUNCTION_DEFINED_)
+
+// 4*3+2
+extern const char TestData1Variables[];
+double TestData1(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData1Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4*3)+2
+extern const char TestData2Variables[];
+double TestData2(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData2Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*(3+2)
+extern const char TestData3Variables[];
+double TestData3(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData3Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4*3+2)
+extern const char TestData4Variables[];
+double TestData4(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData4Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4)*3+2
+extern const char TestData5Variables[];
+double TestData5(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData5Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*(3)+2
+extern const char TestData6Variables[];
+double TestData6(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData6Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*3+(2)
+extern const char TestData7Variables[];
+double TestData7(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData7Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+3*2
+extern const char TestData8Variables[];
+double TestData8(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData8Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4+3)*2
+extern const char TestData9Variables[];
+double TestData9(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData9Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+(3*2)
+extern const char TestData10Variables[];
+double TestData10(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData10Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4+3*2)
+extern const char TestData11Variables[];
+double TestData11(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData11Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4)+3*2
+extern const char TestData12Variables[];
+double TestData12(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData12Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+(3)*2
+extern const char TestData13Variables[];
+double TestData13(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData13Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+3*(2)
+extern const char TestData14Variables[];
+double TestData14(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData14Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4/3+2
+extern const char TestData15Variables[];
+double TestData15(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData15Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4/3)+2
+extern const char TestData16Variables[];
+double TestData16(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData16Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4/(3+2)
+extern const char TestData17Variables[];
+double TestData17(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData17Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4/3+2)
+extern const char TestData18Variables[];
+double TestData18(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData18Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4)/3+2
+extern const char TestData19Variables[];
+double TestData19(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData19Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4/(3)+2
+extern const char TestData20Variables[];
+double TestData20(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData20Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4/3+(2)
+extern const char TestData21Variables[];
+double TestData21(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData21Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+3/2
+extern const char TestData22Variables[];
+double TestData22(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData22Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4+3)/2
+extern const char TestData23Variables[];
+double TestData23(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData23Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+(3/2)
+extern const char TestData24Variables[];
+double TestData24(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData24Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4+3/2)
+extern const char TestData25Variables[];
+double TestData25(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData25Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4)+3/2
+extern const char TestData26Variables[];
+double TestData26(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData26Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+(3)/2
+extern const char TestData27Variables[];
+double TestData27(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData27Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4+3/(2)
+extern const char TestData28Variables[];
+double TestData28(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData28Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*3+2
+extern const char TestData29Variables[];
+double TestData29(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData29Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4*3)+2
+extern const char TestData30Variables[];
+double TestData30(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData30Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*(3+2)
+extern const char TestData31Variables[];
+double TestData31(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData31Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4*3+2)
+extern const char TestData32Variables[];
+double TestData32(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData32Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4)*3+2
+extern const char TestData33Variables[];
+double TestData33(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData33Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*(3)+2
+extern const char TestData34Variables[];
+double TestData34(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData34Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*3+(2)
+extern const char TestData35Variables[];
+double TestData35(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData35Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+3*2
+extern const char TestData36Variables[];
+double TestData36(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData36Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-(4+3)*2
+extern const char TestData37Variables[];
+double TestData37(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData37Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+(3*2)
+extern const char TestData38Variables[];
+double TestData38(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData38Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-(4+3*2)
+extern const char TestData39Variables[];
+double TestData39(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData39Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-(4)+3*2
+extern const char TestData40Variables[];
+double TestData40(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData40Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+(3)*2
+extern const char TestData41Variables[];
+double TestData41(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData41Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+3*(2)
+extern const char TestData42Variables[];
+double TestData42(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData42Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+3*2+11
+extern const char TestData43Variables[];
+double TestData43(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData43Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-(4+3)*2+11
+extern const char TestData44Variables[];
+double TestData44(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData44Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+(3*2)+11
+extern const char TestData45Variables[];
+double TestData45(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData45Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-(4+3*2)+11
+extern const char TestData46Variables[];
+double TestData46(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData46Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-(4)+3*2+11
+extern const char TestData47Variables[];
+double TestData47(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData47Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+(3)*2+11
+extern const char TestData48Variables[];
+double TestData48(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData48Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-4+3*(2)+11
+extern const char TestData49Variables[];
+double TestData49(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData49Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- 4.77 + 3.1 * 2.9 +11
+extern const char TestData50Variables[];
+double TestData50(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData50Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123-(4.77 + 3.1)* 2.9 +11
+extern const char TestData51Variables[];
+double TestData51(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData51Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- 4.77 +(3.1 * 2.9)+11
+extern const char TestData52Variables[];
+double TestData52(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData52Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123-(4.77 + 3.1 * 2.9)+11
+extern const char TestData53Variables[];
+double TestData53(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData53Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123-(4.77)+ 3.1 * 2.9 +11
+extern const char TestData54Variables[];
+double TestData54(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData54Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- 4.77 +(3.1)* 2.9 +11
+extern const char TestData55Variables[];
+double TestData55(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData55Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- 4.77 + 3.1 *(2.9)+11
+extern const char TestData56Variables[];
+double TestData56(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData56Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- -4.77 + 3.1 * 2.9 +-11
+extern const char TestData57Variables[];
+double TestData57(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData57Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123-(-4.77 + 3.1)* 2.9 +-11
+extern const char TestData58Variables[];
+double TestData58(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData58Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- -4.77 +(3.1 * 2.9)+-11
+extern const char TestData59Variables[];
+double TestData59(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData59Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123-(-4.77 + 3.1 * 2.9)+-11
+extern const char TestData60Variables[];
+double TestData60(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData60Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123-(-4.77)+ 3.1 * 2.9 +-11
+extern const char TestData61Variables[];
+double TestData61(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData61Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- -4.77 +(3.1)* 2.9 +-11
+extern const char TestData62Variables[];
+double TestData62(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData62Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5.123- -4.77 + 3.1 *(2.9)+-11
+extern const char TestData63Variables[];
+double TestData63(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData63Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (3 + 10) * 50 / ((7 - 6) * 9)
+extern const char TestData64Variables[];
+double TestData64(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData64Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (1 + 10) * 50 / ((2 - 6) * 9)
+extern const char TestData65Variables[];
+double TestData65(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData65Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (0 + 10) * 50 / ((0 - 6) * 9)
+extern const char TestData66Variables[];
+double TestData66(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData66Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// -(4+3)*2
+extern const char TestData67Variables[];
+double TestData67(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData67Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5-(4 )*2
+extern const char TestData68Variables[];
+double TestData68(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData68Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 1+2+3+4+5+6+7+8
+extern const char TestData69Variables[];
+double TestData69(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData69Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 1-2+3-4+5-6+7-8
+extern const char TestData70Variables[];
+double TestData70(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData70Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 1*2*3*4*5*6*7*8+1
+extern const char TestData71Variables[];
+double TestData71(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData71Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*2 > 3+1
+extern const char TestData72Variables[];
+double TestData72(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData72Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 4*2 < 3+1
+extern const char TestData73Variables[];
+double TestData73(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData73Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 1+1 == 2
+extern const char TestData74Variables[];
+double TestData74(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData74Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 3 <= 2
+extern const char TestData75Variables[];
+double TestData75(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData75Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 3 >= 3
+extern const char TestData76Variables[];
+double TestData76(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData76Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 2 != 2*1
+extern const char TestData77Variables[];
+double TestData77(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData77Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 1 < 2 && 3 > 4
+extern const char TestData78Variables[];
+double TestData78(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData78Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 1 < 2 || 3 > 4
+extern const char TestData79Variables[];
+double TestData79(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData79Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 1 || 0 && 0
+extern const char TestData80Variables[];
+double TestData80(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData80Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (4 > 3) * 5 - 1
+extern const char TestData81Variables[];
+double TestData81(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData81Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 5 - 1 > 2 - -2
+extern const char TestData82Variables[];
+double TestData82(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData82Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 8/4/2 == 4
+extern const char TestData83Variables[];
+double TestData83(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData83Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// -(4+3)+2
+extern const char TestData84Variables[];
+double TestData84(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData84Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 2*-(1+1)+1
+extern const char TestData85Variables[];
+double TestData85(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData85Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// -(-(2))
+extern const char TestData86Variables[];
+double TestData86(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData86Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// 10-(1 )-(2 )
+extern const char TestData87Variables[];
+double TestData87(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData87Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// ((1+2 ) )*3
+extern const char TestData88Variables[];
+double TestData88(const double *pValues, tERRNO *pErrNo = NULL);
+void TestData88Batch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (a + 10) * 50 / ((b - 6) * 9)
+extern const char MandateVariables[];
+double Mandate(const double *pValues, tERRNO *pErrNo = NULL);
+void MandateBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// x/y - y/x + -x/(y*y)
+extern const char RatiosVariables[];
+double Ratios(const double *pValues, tERRNO *pErrNo = NULL);
+void RatiosBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (p > 10) * p * 2 + (p <= 10) * -p / 4 - -0
+extern const char BandedVariables[];
+double Banded(const double *pValues, tERRNO *pErrNo = NULL);
+void BandedBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// (a < b && b < c) || a == c / 2
+extern const char LogicVariables[];
+double Logic(const double *pValues, tERRNO *pErrNo = NULL);
+void LogicBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// a+b+c+d+e+f+g+h - a*b*c*d
+extern const char ChainVariables[];
+double Chain(const double *pValues, tERRNO *pErrNo = NULL);
+void ChainBatch(const double *const *ppColumns, size_t nRows, double *pResults, tERRNO *pErrNo = NULL);
+
+// Every function above, then one with a NULL szName
+extern const tGENERATEDFUNCTION testformulasFunctions[];
+
+#endif // !defined(TESTFORMULAS_H_INCLUDED_)
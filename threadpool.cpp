@@ -0,0 +1,91 @@
+// threadpool.cpp :
+// Implementation of thread pool class.
+// Jonathan Gilmore, 19/10/2026
+//
+
+#include "StdAfx.h"
+#include "threadpool.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////
+// CThreadPool implementation
+////////////////////////////////////////////////////////////////////////////
+CThreadPool::CThreadPool(int nThreads)
+{
+  nBusy = 0;
+  bStopping = false;
+
+  if (nThreads <= 0)
+    nThreads = GetDefaultNumberOfThreads();
+
+  for (int i=0; i<nThreads; i++)
+    vWorker.push_back(thread(&CThreadPool::WorkerLoop, this));
+}
+
+CThreadPool::~CThreadPool(void)
+{
+  Wait();
+  {
+    lock_guard<mutex> Lock(Mutex);
+    bStopping = true;
+  }
+  JobAvailable.notify_all();
+  for (size_t i=0; i<vWorker.size(); i++)
+    vWorker[i].join();
+}
+
+int CThreadPool::GetDefaultNumberOfThreads(void) // static
+{
+  int n = (int)thread::hardware_concurrency();
+  return (n > 0) ? n : 1;
+}
+
+int CThreadPool::GetNumberOfThreads(void)
+{
+  return (int)vWorker.size();
+}
+
+void CThreadPool::Submit(function<void()> Job)
+{
+  {
+    lock_guard<mutex> Lock(Mutex);
+    dJob.push_back(Job);
+  }
+  JobAvailable.notify_one();
+}
+
+void CThreadPool::Wait(void)
+{
+  unique_lock<mutex> Lock(Mutex);
+  while (!dJob.empty() || nBusy > 0)
+    AllDone.wait(Lock);
+}
+
+void CThreadPool::WorkerLoop(void)
+{
+  unique_lock<mutex> Lock(Mutex);
+
+  for(;;)
+  {
+    while (dJob.empty() && !bStopping)
+      JobAvailable.wait(Lock);
+
+    if (dJob.empty()) // Stopping, and nothing left to do
+      break;
+
+    function<void()> Job = dJob.front();
+    dJob.pop_front();
+    nBusy++;
+
+    // Run the job without holding the lock so that other workers
+    // (and Submit()) can proceed in the meantime.
+    Lock.unlock();
+    Job();
+    Lock.lock();
+
+    nBusy--;
+    if (dJob.empty() && nBusy == 0)
+      AllDone.notify_all();
+  }
+}
@@ -0,0 +1,52 @@
+// threadpool.h :
+// Interface/Include file for threadpool.cpp
+// Jonathan Gilmore, 19/10/2026
+
+////////////////////////////////////////////////////////////////////////////////////////
+// CThreadPool Class
+// A small fixed size pool of worker threads.
+// Jobs are submitted as std::function objects and are run in FIFO order by
+// whichever worker becomes free first.
+// Wait() blocks until every job submitted so far has completed.
+// The destructor waits for outstanding jobs and then joins the workers.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(THREADPOOL_H_INCLUDED_)
+#define THREADPOOL_H_INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CThreadPool
+{
+  public:
+    CThreadPool(int nThreads = 0);        // 0 means one thread per hardware core
+    ~CThreadPool();
+
+    void Submit(std::function<void()> Job);
+    void Wait(void);
+    int GetNumberOfThreads(void);
+
+    static int GetDefaultNumberOfThreads(void);
+
+  private:
+    void WorkerLoop(void);
+
+    std::vector<std::thread> vWorker;
+    std::deque<std::function<void()> > dJob;
+    std::mutex Mutex;
+    std::condition_variable JobAvailable;
+    std::condition_variable AllDone;
+    int nBusy;                            // Number of jobs currently being run
+    bool bStopping;
+};
+
+#endif // !defined(THREADPOOL_H_INCLUDED_)
@@ -3,7 +3,7 @@
 // Jonathan Gilmore, 28/02/2009
 //
 
-#include "stdafx.h"
+#include "StdAfx.h"
 #include "variable.h"
 
 using namespace std;